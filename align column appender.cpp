@@ -0,0 +1,182 @@
+#pragma once
+
+#include <DataFrame/DataFrame.h>
+#include <DataFrame/Utils/Instrumentation.h>
+
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace hmdf
+{
+
+// Incremental load_align_column() for frames whose index keeps growing.
+//
+// load_align_column() spreads a summary vector over the index, writing the
+// k-th summary value at row k * interval (or (k + 1) * interval when
+// start_from_beginning is false) and null_value everywhere else. Here the
+// index rows and the summary values are appended as they arrive. Each call
+// only touches the new rows and the slots that just became reachable, so
+// an update costs O(new rows) instead of O(frame). At any point the column
+// equals what load_align_column() would produce for the summaries and
+// index rows appended so far.
+//
+// A summary value whose row does not exist yet is held until the index
+// reaches it.
+//
+// The appender holds a reference to the frame. While it is in use, the
+// aligned column must only be grown through it.
+//
+template<typename T, typename DF>
+class   AlignColumnAppender  {
+
+public:
+
+    using size_type = std::size_t;
+    using IndexType = typename DF::IndexType;
+
+    // Starts the aligned column name with the summaries in summary_vec,
+    // as load_align_column(name, summary_vec, interval,
+    // start_from_beginning, null_value) would. summary_vec may be empty.
+    // Values past the current index are kept until the index gets there.
+    //
+    AlignColumnAppender(DF &df,
+                        const char *name,
+                        std::vector<T> &&summary_vec,
+                        size_type interval,
+                        bool start_from_beginning,
+                        const T &null_value)
+        : df_(df),
+          name_(name),
+          interval_(interval),
+          first_slot_(start_from_beginning ? 0 : interval),
+          null_value_(null_value)  {
+
+        if (interval_ == 0)
+            throw NotFeasible("AlignColumnAppender: interval cannot be 0");
+
+        const size_type idx_s = df_.get_index().size();
+
+        df_.load_column(name_.c_str(),
+                        std::vector<T>(idx_s, null_value_),
+                        nan_policy::dont_pad_with_nans);
+        for (auto &value : summary_vec)
+            append_summary(std::move(value));
+    }
+
+    // Appends one summary value. It is written now if its row exists.
+    //
+    void append_summary(const T &value)  {
+
+        if (pending_.empty() && next_slot_() < column_().size())
+            column_()[next_slot_()] = value;
+        else
+            pending_.push_back(value);
+        summaries_ += 1;
+    }
+    void append_summary(T &&value)  {
+
+        if (pending_.empty() && next_slot_() < column_().size())
+            column_()[next_slot_()] = std::move(value);
+        else
+            pending_.push_back(std::move(value));
+        summaries_ += 1;
+    }
+
+    // Appends rows to the frame's index and brings the aligned column up to
+    // the new length.
+    //
+    template<typename V>
+    void append_index(const V &new_indices)  {
+
+        auto    &index = df_.get_index();
+
+        index.insert(index.end(), new_indices.begin(), new_indices.end());
+        sync();
+    }
+    void append_index(const IndexType &new_index)  {
+
+        df_.get_index().push_back(new_index);
+        sync();
+    }
+
+    // Brings the aligned column up to the index's length, if the index was
+    // grown some other way, and writes held summaries that now have a row.
+    //
+    void sync()  {
+
+        HMDF_INSTRUMENT_OP(scope, "align_column_sync");
+
+        auto            &col = column_();
+        const size_type idx_s = df_.get_index().size();
+
+        if (col.size() < idx_s)  {
+            scope.add_rows(idx_s - col.size());
+            col.resize(idx_s, null_value_);
+        }
+
+        while (! pending_.empty())  {
+            const size_type slot = slot_of_(summaries_ - pending_.size());
+
+            if (slot >= col.size())  break;
+            col[slot] = std::move(pending_.front());
+            pending_.pop_front();
+        }
+    }
+
+    // Number of summary values appended, and how many of them still wait
+    // for their row
+    //
+    [[nodiscard]] size_type
+    summary_count() const noexcept  { return (summaries_); }
+    [[nodiscard]] size_type
+    pending_count() const noexcept  { return (pending_.size()); }
+
+private:
+
+    inline size_type slot_of_(size_type summary_pos) const noexcept  {
+
+        return (first_slot_ + summary_pos * interval_);
+    }
+    inline size_type next_slot_() const noexcept  {
+
+        return (slot_of_(summaries_));
+    }
+    inline auto &column_()  {
+
+        return (df_.template get_column<T>(name_.c_str()));
+    }
+
+    DF              &df_;
+    std::string     name_;
+    size_type       interval_;
+    size_type       first_slot_;
+    T               null_value_;
+    size_type       summaries_ { 0 };
+    std::deque<T>   pending_ { };
+};
+
+// ----------------------------------------------------------------------------
+
+// The streaming counterpart of df.load_align_column(name, summary_vec,
+// interval, start_from_beginning, null_value)
+//
+template<typename T, typename DF>
+[[nodiscard]] inline AlignColumnAppender<T, DF>
+make_align_column_appender(DF &df,
+                           const char *name,
+                           std::vector<T> &&summary_vec,
+                           std::size_t interval,
+                           bool start_from_beginning,
+                           const T &null_value)  {
+
+    return (AlignColumnAppender<T, DF>(df,
+                                       name,
+                                       std::move(summary_vec),
+                                       interval,
+                                       start_from_beginning,
+                                       null_value));
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,281 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace hmdf
+{
+
+// Per-query memory for columns and temporaries.
+//
+// MonotonicArena hands out memory by bumping a pointer through blocks it
+// gets from the heap, and frees nothing until reset(). reset() rewinds it
+// and keeps the blocks, so a service that resets the arena after each query
+// stops going to the global heap once the arena has grown to the largest
+// query. The heap is not shared with other threads' queries on the hot path
+// and does not fragment over time.
+//
+// ArenaAllocator is a standard allocator over an arena. It aligns every
+// block to A bytes (or alignof(T) if that is more), which is what
+// VectorView<T, A> assumes about the memory it views. A default constructed
+// ArenaAllocator uses the arena installed on its thread by ArenaScope, or
+// the global heap if there is none, so containers that default construct
+// their allocator pick it up without being told.
+//
+// An arena is not thread-safe. Use one per thread, or per query. Memory it
+// handed out must not be used after reset().
+//
+class   MonotonicArena  {
+
+public:
+
+    using size_type = std::size_t;
+
+    static constexpr size_type  default_block_size { 1 << 20 };
+    static constexpr size_type  block_align { 64 };
+
+    explicit MonotonicArena(size_type block_size = default_block_size)
+        : first_block_size_(std::max<size_type>(block_size, block_align))  {
+    }
+    MonotonicArena(const MonotonicArena &) = delete;
+    MonotonicArena &operator = (const MonotonicArena &) = delete;
+    ~MonotonicArena()  { release(); }
+
+    // bytes of memory aligned to align, which must be a power of 2
+    //
+    [[nodiscard]] void *allocate(size_type bytes, size_type align)  {
+
+        std::byte   *ptr = align_up_(ptr_, align);
+
+        if (! ptr_ || ptr > end_ || bytes > size_type(end_ - ptr))  {
+            next_block_(bytes, align);
+            ptr = align_up_(ptr_, align);
+        }
+        ptr_ = ptr + bytes;
+        used_ += bytes;
+        allocations_ += 1;
+        return (ptr);
+    }
+
+    // Rewinds to the first block. The blocks are kept for the next query.
+    //
+    void reset() noexcept  {
+
+        if (blocks_.empty())
+            ptr_ = end_ = nullptr;
+        else
+            use_block_(0);
+        used_ = 0;
+        allocations_ = 0;
+    }
+
+    // Gives all the blocks back to the heap
+    //
+    void release() noexcept  {
+
+        for (const auto &block : blocks_)
+            ::operator delete(block.data, std::align_val_t(block_align));
+        blocks_.clear();
+        reserved_ = 0;
+        reset();
+    }
+
+    // Bytes handed out and allocate() calls since the last reset(), and
+    // bytes held from the heap
+    //
+    [[nodiscard]] size_type
+    bytes_used() const noexcept  { return (used_); }
+    [[nodiscard]] size_type
+    allocation_count() const noexcept  { return (allocations_); }
+    [[nodiscard]] size_type
+    bytes_reserved() const noexcept  { return (reserved_); }
+    [[nodiscard]] size_type
+    block_count() const noexcept  { return (blocks_.size()); }
+
+private:
+
+    struct  Block_  {
+
+        std::byte   *data;
+        size_type   size;
+    };
+
+    static std::byte *align_up_(std::byte *ptr, size_type align) noexcept  {
+
+        const auto  addr = reinterpret_cast<std::uintptr_t>(ptr);
+
+        return (ptr + ((align - addr % align) % align));
+    }
+
+    // Moves on to the first kept block that fits, or gets a new one. Each
+    // new block is at least twice the last, so a query of any size takes a
+    // logarithmic number of them.
+    //
+    void next_block_(size_type bytes, size_type align)  {
+
+        const size_type needed = bytes + (align > block_align ? align : 0);
+
+        for (size_type b = ptr_ ? current_ + 1 : 0; b < blocks_.size(); ++b)
+            if (blocks_[b].size >= needed)  {
+                use_block_(b);
+                return;
+            }
+
+        size_type   size = blocks_.empty() ? first_block_size_
+                                           : blocks_.back().size * 2;
+
+        while (size < needed)  size *= 2;
+        blocks_.push_back({ static_cast<std::byte *>(
+                                ::operator new(size,
+                                               std::align_val_t(block_align))),
+                            size });
+        reserved_ += size;
+        use_block_(blocks_.size() - 1);
+    }
+
+    void use_block_(size_type b) noexcept  {
+
+        current_ = b;
+        ptr_ = blocks_[b].data;
+        end_ = blocks_[b].data + blocks_[b].size;
+    }
+
+    const size_type     first_block_size_;
+    std::vector<Block_> blocks_ { };
+    size_type           current_ { 0 };
+    std::byte           *ptr_ { nullptr };
+    std::byte           *end_ { nullptr };
+    size_type           used_ { 0 };
+    size_type           allocations_ { 0 };
+    size_type           reserved_ { 0 };
+};
+
+// ----------------------------------------------------------------------------
+
+inline MonotonicArena *&_thread_arena_() noexcept  {
+
+    static thread_local MonotonicArena  *arena { nullptr };
+
+    return (arena);
+}
+
+// Installs an arena on the calling thread for the lifetime of the scope,
+// typically one query. By default the arena is reset on the way out.
+//
+class   ArenaScope  {
+
+public:
+
+    explicit ArenaScope(MonotonicArena &arena, bool reset_on_exit = true)
+        : arena_(arena),
+          previous_(_thread_arena_()),
+          reset_on_exit_(reset_on_exit)  {
+
+        _thread_arena_() = &arena_;
+    }
+    ArenaScope(const ArenaScope &) = delete;
+    ArenaScope &operator = (const ArenaScope &) = delete;
+    ~ArenaScope()  {
+
+        _thread_arena_() = previous_;
+        if (reset_on_exit_)  arena_.reset();
+    }
+
+private:
+
+    MonotonicArena  &arena_;
+    MonotonicArena  *previous_;
+    const bool      reset_on_exit_;
+};
+
+// ----------------------------------------------------------------------------
+
+template<typename T, std::size_t A = 0>
+class   ArenaAllocator  {
+
+public:
+
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    static constexpr std::size_t    align_value { std::max(A, alignof(T)) };
+
+    template<typename U>
+    struct  rebind  { using other = ArenaAllocator<U, A>; };
+
+    ArenaAllocator() noexcept : arena_(_thread_arena_())  {   }
+    explicit ArenaAllocator(MonotonicArena &arena) noexcept
+        : arena_(&arena)  {   }
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U, A> &that) noexcept
+        : arena_(that.arena())  {   }
+
+    [[nodiscard]] T *allocate(size_type n)  {
+
+        if (n > std::numeric_limits<size_type>::max() / sizeof(T))
+            throw std::bad_array_new_length();
+        if (arena_)
+            return (static_cast<T *>(
+                        arena_->allocate(n * sizeof(T), align_value)));
+        if constexpr (align_value > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            return (static_cast<T *>(
+                        ::operator new(n * sizeof(T),
+                                       std::align_val_t(align_value))));
+        else
+            return (static_cast<T *>(::operator new(n * sizeof(T))));
+    }
+
+    // Arena memory comes back with the arena's reset()
+    //
+    void deallocate(T *ptr, size_type) noexcept  {
+
+        if (arena_)  return;
+        if constexpr (align_value > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            ::operator delete(ptr, std::align_val_t(align_value));
+        else
+            ::operator delete(ptr);
+    }
+
+    // nullptr means the global heap
+    //
+    [[nodiscard]] MonotonicArena *
+    arena() const noexcept  { return (arena_); }
+
+    friend bool
+    operator == (const ArenaAllocator &lhs,
+                 const ArenaAllocator &rhs) noexcept  {
+
+        return (lhs.arena_ == rhs.arena_);
+    }
+
+private:
+
+    MonotonicArena  *arena_;
+};
+
+// Allocators rebound to another type compare equal if they share an arena
+//
+template<typename T, typename U, std::size_t A>
+inline bool
+operator == (const ArenaAllocator<T, A> &lhs,
+             const ArenaAllocator<U, A> &rhs) noexcept  {
+
+    return (lhs.arena() == rhs.arena());
+}
+
+// A column or query temporary in arena memory, aligned for VectorView<T, A>
+//
+template<typename T, std::size_t A = MonotonicArena::block_align>
+using ArenaVector = std::vector<T, ArenaAllocator<T, A>>;
+
+}
@@ -0,0 +1,445 @@
+#pragma once
+
+#include <DataFrame/ColumnIndex.h>
+#include <DataFrame/DataFrame.h>
+#include <DataFrame/Utils/Instrumentation.h>
+#include <DataFrame/Utils/ParallelFor.h>
+#include <DataFrame/Utils/ThreadPool.h>
+#include <DataFrame/Vectors/VectorSelectView.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace hmdf
+{
+
+// As-of joins: each row of the left frame is matched to the last row of the
+// right frame at or before its timestamp, e.g. each trade to the quote in
+// force when it printed.
+//
+//   join_asof(left, right):           over the whole right frame
+//   join_asof_by<K>(left, right, ...): only to right rows with the same key
+//                                      (e.g. symbol)
+//
+// Both frames' indices must be sorted. The match is a linear merge of the
+// two indices. It is split into chunks of left rows, each starting with a
+// binary search of the right rows, and the chunks run on a
+// WorkStealingPool. With a key, each key's rows are merged on their own
+// and a key with many rows is split the same way.
+//
+// tolerance is the largest gap allowed between a left timestamp and its
+// match. With allow_exact false the match must be strictly before. A row
+// with nothing in range is left unmatched.
+//
+// The result is an AsOfJoinedFrame. Like LazyReindexedFrame it keeps the
+// row mapping, not copies: the matched rows of either frame are read
+// through VectorIndexedConstView, or gathered one left row per row with
+// get_right_column(). Both frames must outlive it and keep their columns
+// unresized.
+//
+inline constexpr std::size_t    _asof_chunk_rows_ { 1 << 16 };
+inline constexpr std::size_t    _asof_prefetch_ { 16 };
+
+template<typename LDF, typename RDF>
+class   AsOfJoinedFrame  {
+
+public:
+
+    using IndexType = typename LDF::IndexType;
+    using row_type = RowSelection::value_type;
+    using size_type = std::size_t;
+
+    // The right row of a left row with no match
+    //
+    static constexpr row_type   no_match {
+        std::numeric_limits<row_type>::max()
+    };
+
+    // The matched pairs are listed here, so a const AsOfJoinedFrame can be
+    // read from several threads at once
+    //
+    AsOfJoinedFrame(const LDF &left, const RDF &right, RowSelection &&matches)
+        : left_(left), right_(right), matches_(std::move(matches))  {
+
+        build_pairs_();
+    }
+
+    // The right row each left row matched, or no_match
+    //
+    [[nodiscard]] const RowSelection &
+    get_matches() const noexcept  { return (matches_); }
+    [[nodiscard]] size_type
+    shape_rows() const noexcept  { return (matches_.size()); }
+    [[nodiscard]] size_type
+    match_count() const noexcept  { return (left_rows_->size()); }
+
+    // The matched pairs, in left row order
+    //
+    [[nodiscard]] const RowSelectionPtr &
+    left_rows() const noexcept  { return (left_rows_); }
+    [[nodiscard]] const RowSelectionPtr &
+    right_rows() const noexcept  { return (right_rows_); }
+
+    // Zero-copy views over the matched pairs. Every one has match_count()
+    // rows.
+    //
+    [[nodiscard]] VectorIndexedConstView<IndexType>
+    get_index_view() const  { return (left_view_(left_.get_index())); }
+    [[nodiscard]] VectorIndexedConstView<IndexType>
+    get_right_index_view() const  {
+
+        return (right_view_(right_.get_index()));
+    }
+    template<typename T>
+    [[nodiscard]] VectorIndexedConstView<T>
+    get_left_column_view(const char *name) const  {
+
+        return (left_view_(left_.template get_column<T>(name)));
+    }
+    template<typename T>
+    [[nodiscard]] VectorIndexedConstView<T>
+    get_right_column_view(const char *name) const  {
+
+        return (right_view_(right_.template get_column<T>(name)));
+    }
+
+    // A right column gathered to one value per left row, in chunks spread
+    // over pool. Unmatched rows are NaN, or T() for types without NaN.
+    //
+    template<typename T>
+    [[nodiscard]] std::vector<T>
+    get_right_column(const char *name,
+                     WorkStealingPool &pool = default_thread_pool()) const  {
+
+        const auto          &col = right_.template get_column<T>(name);
+        const size_type     col_s = col.size();
+        const size_type     result_s = matches_.size();
+        std::vector<T>      result (result_s);
+        const row_type      *rows = matches_.data();
+        const T             *src = col.data();
+        T                   *dst = result.data();
+        const auto          gather_range = [=](size_type begin,
+                                               size_type end)  {
+            for (size_type i = begin; i < end; ++i)
+                if (rows[i] < col_s)  dst[i] = src[rows[i]];
+                else if constexpr (std::numeric_limits<T>::has_quiet_NaN)
+                    dst[i] = std::numeric_limits<T>::quiet_NaN();
+        };
+
+        parallel_for_chunks(result_s, _asof_chunk_rows_, pool, gather_range);
+        return (result);
+    }
+
+private:
+
+    void build_pairs_()  {
+
+        const size_type rows_s = matches_.size();
+        size_type       count { 0 };
+
+        for (const auto r : matches_)  count += r != no_match;
+
+        auto    lrows = std::make_shared<RowSelection>();
+        auto    rrows = std::make_shared<RowSelection>();
+
+        lrows->reserve(count);
+        rrows->reserve(count);
+        for (size_type i = 0; i < rows_s; ++i)
+            if (matches_[i] != no_match)  {
+                lrows->push_back(i);
+                rrows->push_back(matches_[i]);
+                max_right_row_ = std::max(max_right_row_, matches_[i]);
+            }
+        left_rows_ = std::move(lrows);
+        right_rows_ = std::move(rrows);
+    }
+
+    template<typename V>
+    VectorIndexedConstView<typename V::value_type>
+    left_view_(const V &col) const  {
+
+        if (! left_rows_->empty() && col.size() <= left_rows_->back())
+            throw NotFeasible("AsOfJoinedFrame: "
+                              "Left column is shorter than the index");
+        return (VectorIndexedConstView<typename V::value_type>(col.data(),
+                                                               left_rows_));
+    }
+    template<typename V>
+    VectorIndexedConstView<typename V::value_type>
+    right_view_(const V &col) const  {
+
+        if (! right_rows_->empty() && col.size() <= max_right_row_)
+            throw NotFeasible("AsOfJoinedFrame: "
+                              "Right column is shorter than the index");
+        return (VectorIndexedConstView<typename V::value_type>(col.data(),
+                                                               right_rows_));
+    }
+
+    const LDF       &left_;
+    const RDF       &right_;
+    RowSelection    matches_;
+    RowSelectionPtr left_rows_ { };
+    RowSelectionPtr right_rows_ { };
+    row_type        max_right_row_ { 0 };
+};
+
+// ----------------------------------------------------------------------------
+
+// Stands in for a row list when the rows are all of them, in order
+//
+struct  _AsOfAllRows_  {
+
+    [[nodiscard]] inline RowSelection::value_type
+    operator [] (std::size_t k) const noexcept  { return (k); }
+};
+
+// Starts loading addr into the cache. A no-op on compilers without
+// __builtin_prefetch.
+//
+inline void _asof_prefetch_addr_(const void *addr) noexcept  {
+
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(addr);
+#else
+    (void) addr;
+#endif
+}
+
+// Matches left rows lrows[begin, end) to right rows rrows[0, right_s).
+// Both row lists must be in timestamp order.
+//
+template<bool EXACT, typename I, typename LR, typename RR>
+inline void
+_asof_merge_rows_(const I *left_idx,
+                  const LR &lrows,
+                  std::size_t begin,
+                  std::size_t end,
+                  const I *right_idx,
+                  const RR &rrows,
+                  std::size_t right_s,
+                  const I &tolerance,
+                  RowSelection::value_type *matches)  {
+
+    using row_type = RowSelection::value_type;
+
+    constexpr row_type  no_match { std::numeric_limits<row_type>::max() };
+
+    // Whether the right timestamp r can be the match of the left one l
+    //
+    const auto  precedes = [](const I &r, const I &l)  {
+        if constexpr (EXACT)  return (! (l < r));
+        else  return (r < l);
+    };
+
+    // The first right row that cannot match the chunk's first left row
+    //
+    const I     &first = left_idx[lrows[begin]];
+    std::size_t pos { 0 };
+    std::size_t hi { right_s };
+
+    while (pos < hi)  {
+        const std::size_t   mid = pos + (hi - pos) / 2;
+
+        if (precedes(right_idx[rrows[mid]], first))  pos = mid + 1;
+        else  hi = mid;
+    }
+
+    for (std::size_t k = begin; k < end; ++k)  {
+        const row_type  lrow = lrows[k];
+        const I         &ts = left_idx[lrow];
+
+        // A key's rows are scattered over the frame, so each one is a cache
+        // miss. Start loading the ones coming up.
+        //
+        if constexpr (! std::is_same_v<LR, _AsOfAllRows_>)
+            if (k + _asof_prefetch_ < end)
+                _asof_prefetch_addr_(left_idx + lrows[k + _asof_prefetch_]);
+        while (pos < right_s && precedes(right_idx[rrows[pos]], ts))  {
+            if constexpr (! std::is_same_v<RR, _AsOfAllRows_>)
+                if (pos + _asof_prefetch_ < right_s)
+                    _asof_prefetch_addr_(right_idx +
+                                         rrows[pos + _asof_prefetch_]);
+            pos += 1;
+        }
+        matches[lrow] =
+            pos > 0 && ! (tolerance < ts - right_idx[rrows[pos - 1]])
+                ? row_type(rrows[pos - 1]) : no_match;
+    }
+}
+
+// allow_exact picked once, rather than in the inner loop
+//
+template<typename I, typename LR, typename RR>
+inline void
+_asof_merge_(const I *left_idx,
+             const LR &lrows,
+             std::size_t begin,
+             std::size_t end,
+             const I *right_idx,
+             const RR &rrows,
+             std::size_t right_s,
+             const I &tolerance,
+             bool allow_exact,
+             RowSelection::value_type *matches)  {
+
+    if (allow_exact)
+        _asof_merge_rows_<true>(left_idx, lrows, begin, end,
+                                right_idx, rrows, right_s, tolerance, matches);
+    else
+        _asof_merge_rows_<false>(left_idx, lrows, begin, end,
+                                 right_idx, rrows, right_s, tolerance,
+                                 matches);
+}
+
+template<typename DF>
+inline void _asof_check_sorted_(const DF &df)  {
+
+    const auto  &idx = df.get_index();
+
+    if (! std::is_sorted(idx.begin(), idx.end()))
+        throw NotFeasible("join_asof(): Index is not sorted");
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename LDF, typename RDF>
+[[nodiscard]] inline AsOfJoinedFrame<LDF, RDF>
+join_asof(const LDF &left,
+          const RDF &right,
+          typename LDF::IndexType tolerance =
+              std::numeric_limits<typename LDF::IndexType>::max(),
+          bool allow_exact = true,
+          WorkStealingPool &pool = default_thread_pool())  {
+
+    static_assert(std::is_same_v<typename LDF::IndexType,
+                                 typename RDF::IndexType>,
+                  "join_asof(): The frames' index types differ");
+
+    HMDF_INSTRUMENT_OP(scope, "join_asof");
+
+    scope.add_rows(left.get_index().size());
+    _asof_check_sorted_(left);
+    _asof_check_sorted_(right);
+
+    const auto          &lidx = left.get_index();
+    const auto          &ridx = right.get_index();
+    const std::size_t   left_s = lidx.size();
+    const std::size_t   chunks =
+        (left_s + _asof_chunk_rows_ - 1) / _asof_chunk_rows_;
+    RowSelection        matches (left_s);
+
+    pool.run_chunks(chunks, [&](std::size_t c)  {
+        _asof_merge_(lidx.data(), _AsOfAllRows_ { },
+                     c * _asof_chunk_rows_,
+                     std::min(left_s, (c + 1) * _asof_chunk_rows_),
+                     ridx.data(), _AsOfAllRows_ { }, ridx.size(),
+                     tolerance, allow_exact, matches.data());
+    });
+    return (AsOfJoinedFrame<LDF, RDF>(left, right, std::move(matches)));
+}
+
+// By key, with the keys' rows given as hash indices, e.g. the ones an
+// IndexedFrame keeps. Left rows whose key the right side does not have, or
+// whose key is NaN, are unmatched.
+//
+template<typename K, typename LDF, typename RDF>
+[[nodiscard]] inline AsOfJoinedFrame<LDF, RDF>
+join_asof_by(const LDF &left,
+             const RDF &right,
+             const HashColumnIndex<K> &left_keys,
+             const HashColumnIndex<K> &right_keys,
+             typename LDF::IndexType tolerance =
+                 std::numeric_limits<typename LDF::IndexType>::max(),
+             bool allow_exact = true,
+             WorkStealingPool &pool = default_thread_pool())  {
+
+    using row_type = RowSelection::value_type;
+
+    static_assert(std::is_same_v<typename LDF::IndexType,
+                                 typename RDF::IndexType>,
+                  "join_asof_by(): The frames' index types differ");
+
+    HMDF_INSTRUMENT_OP(scope, "join_asof_by");
+
+    scope.add_rows(left.get_index().size());
+    _asof_check_sorted_(left);
+    _asof_check_sorted_(right);
+
+    const auto  &lidx = left.get_index();
+    const auto  &ridx = right.get_index();
+
+    if (left_keys.column_size() > lidx.size() ||
+        right_keys.column_size() > ridx.size())
+        throw NotFeasible("join_asof_by(): Key column is longer than index");
+
+    // One piece per key, or per chunk of a key with many left rows
+    //
+    struct  Piece_  {
+
+        std::span<const row_type>   lrows;
+        std::size_t                 begin;
+        std::size_t                 end;
+        std::span<const row_type>   rrows;
+    };
+
+    std::vector<Piece_> pieces;
+    RowSelection        matches (lidx.size(),
+                                 AsOfJoinedFrame<LDF, RDF>::no_match);
+
+    pieces.reserve(left_keys.distinct_count());
+    left_keys.for_each([&](const K &key, std::span<const row_type> lrows)  {
+        const auto  rrows = right_keys.find(key);
+
+        if (rrows.empty())  return;
+        for (std::size_t b = 0; b < lrows.size(); b += _asof_chunk_rows_)
+            pieces.push_back({ lrows, b,
+                               std::min(lrows.size(), b + _asof_chunk_rows_),
+                               rrows });
+    });
+
+    // Bigger pieces first, so a large key does not start last
+    //
+    std::sort(pieces.begin(), pieces.end(),
+              [](const Piece_ &lhs, const Piece_ &rhs)  {
+                  return (lhs.end - lhs.begin > rhs.end - rhs.begin);
+              });
+    pool.run_chunks(pieces.size(), [&](std::size_t p)  {
+        const Piece_    &piece = pieces[p];
+
+        _asof_merge_(lidx.data(), piece.lrows, piece.begin, piece.end,
+                     ridx.data(), piece.rrows, piece.rrows.size(),
+                     tolerance, allow_exact, matches.data());
+    });
+    return (AsOfJoinedFrame<LDF, RDF>(left, right, std::move(matches)));
+}
+
+// By key, with the keys in column left_key of left and right_key of right
+//
+template<typename K, typename LDF, typename RDF>
+[[nodiscard]] inline AsOfJoinedFrame<LDF, RDF>
+join_asof_by(const LDF &left,
+             const RDF &right,
+             const char *left_key,
+             const char *right_key,
+             typename LDF::IndexType tolerance =
+                 std::numeric_limits<typename LDF::IndexType>::max(),
+             bool allow_exact = true,
+             WorkStealingPool &pool = default_thread_pool())  {
+
+    const HashColumnIndex<K>    left_keys (
+        left.template get_column<K>(left_key));
+    const HashColumnIndex<K>    right_keys (
+        right.template get_column<K>(right_key));
+
+    return (join_asof_by(left, right, left_keys, right_keys,
+                         tolerance, allow_exact, pool));
+}
+
+}
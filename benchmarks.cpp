@@ -0,0 +1,2251 @@
+// Every operator new in this program reports to the instrumentation, so a
+// benchmark's allocations are the change in instrument_alloc_totals()
+// across it.
+//
+#define HMDF_INSTRUMENT_DEFINE_NEW
+
+#include <DataFrame/AlignColumnAppender.h>
+#include <DataFrame/AsOfJoin.h>
+#include <DataFrame/CategoryColumn.h>
+#include <DataFrame/ColumnIndex.h>
+#include <DataFrame/ColumnarFile.h>
+#include <DataFrame/CompressedColumn.h>
+#include <DataFrame/CowFrame.h>
+#include <DataFrame/CsvIngest.h>
+#include <DataFrame/DataFrame.h>
+#include <DataFrame/DataFrameIncrementalVisitors.h>
+#include <DataFrame/DataFrameSIMDKernels.h>
+#include <DataFrame/LazyQuery.h>
+#include <DataFrame/LazyReindex.h>
+#include <DataFrame/LiveFrame.h>
+#include <DataFrame/MonteCarlo.h>
+#include <DataFrame/ParallelVisit.h>
+#include <DataFrame/ParallelRandGen.h>
+#include <DataFrame/RetypeEngine.h>
+#include <DataFrame/Utils/ArenaAllocator.h>
+#include <DataFrame/Utils/FixedSizePriorityQueue.h>
+#include <DataFrame/Utils/Instrumentation.h>
+#include <DataFrame/Vectors/VectorSelectView.h>
+#include <DataFrame/Vectors/VectorView.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <limits>
+#include <new>
+#include <numeric>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace hmdf;
+
+// ----------------------------------------------------------------------------
+
+using bench_clock = std::chrono::steady_clock;
+
+struct  BenchSample  {
+
+    double      elapsed_ns { 0 };
+    std::size_t allocs { 0 };
+    std::size_t alloc_bytes { 0 };
+};
+
+template<typename F>
+static BenchSample time_it_ns(F &&func) {
+
+    const InstrumentAllocTotals &totals = instrument_alloc_totals();
+    const std::size_t           count_before = totals.count.load();
+    const std::size_t           bytes_before = totals.bytes.load();
+    const auto          start = bench_clock::now();
+
+    func();
+
+    BenchSample result;
+
+    result.elapsed_ns = std::chrono::duration<double, std::nano>
+                            (bench_clock::now() - start).count();
+    result.allocs = totals.count.load() - count_before;
+    result.alloc_bytes = totals.bytes.load() - bytes_before;
+    return (result);
+}
+
+struct  BenchResult  {
+
+    std::string     group;
+    std::string     name;
+    std::size_t     n;
+    unsigned int    threads;
+    BenchSample     sample;
+    std::size_t     bytes_per_item;
+};
+
+static std::vector<BenchResult> bench_results;
+static std::string              bench_group;
+
+// Prints one measurement and keeps it for the JSON output. bytes_per_item
+// is the data each item moves, for the bytes/sec figure. 0 leaves it out.
+//
+static void report(const std::string &name,
+                   std::size_t n,
+                   const BenchSample &sample,
+                   std::size_t bytes_per_item = 0,
+                   unsigned int threads = 1) {
+
+    const double    ns = sample.elapsed_ns / double(n);
+
+    std::cout << name << " N=" << n;
+    if (threads != 1)
+        std::cout << " threads=" << threads;
+    std::cout << ": " << ns << " ns/item";
+    if (bytes_per_item)
+        std::cout << ", " << double(bytes_per_item) / ns << " GB/sec";
+    std::cout << ", " << sample.allocs << " allocs\n";
+    bench_results.push_back({ bench_group, name, n, threads, sample,
+                              bytes_per_item });
+}
+
+static std::string json_escape(const std::string &str) {
+
+    std::string result;
+
+    for (const char c : str) {
+        if (c == '"' || c == '\\')  result += '\\';
+        result += c;
+    }
+    return (result);
+}
+
+static void write_json(std::ostream &stream) {
+
+    stream << "[\n";
+    for (std::size_t i = 0; i < bench_results.size(); ++i) {
+        const BenchResult   &res = bench_results[i];
+        const double        secs = res.sample.elapsed_ns * 1e-9;
+
+        stream << "  { \"group\": \"" << json_escape(res.group)
+               << "\", \"name\": \"" << json_escape(res.name)
+               << "\", \"n\": " << res.n
+               << ", \"threads\": " << res.threads
+               << ", \"ns_per_item\": " << res.sample.elapsed_ns / double(res.n)
+               << ", \"items_per_sec\": " << double(res.n) / secs
+               << ", \"bytes_per_sec\": "
+               << double(res.n * res.bytes_per_item) / secs
+               << ", \"allocs\": " << res.sample.allocs
+               << ", \"alloc_bytes\": " << res.sample.alloc_bytes << " }"
+               << (i + 1 < bench_results.size() ? ",\n" : "\n");
+    }
+    stream << "]\n";
+}
+
+static unsigned int max_bench_threads() {
+
+    return (std::max(std::thread::hardware_concurrency(), 1U));
+}
+
+// The benchmarks on a WorkStealingPool count the calling thread, and a
+// pool has at least one worker. So they start at 2 threads, and still run
+// there on one core.
+//
+static unsigned int max_pool_bench_threads() {
+
+    return (std::max(max_bench_threads(), 2U));
+}
+
+// ----------------------------------------------------------------------------
+
+// The push() FixedSizePriorityQueue had before the min-max heap. It is
+// kept here only as a baseline.
+//
+template <typename T, std::size_t N, typename Cmp = std::less<T>>
+class LegacyFixedSizePriorityQueue {
+
+public:
+
+    void push(T &&item) {
+
+        if (data_end_ != array_.end()) {
+            *data_end_++ = std::move(item);
+            std::push_heap(array_.begin(), data_end_, cmp_);
+        }
+        else {
+            std::sort_heap(array_.begin(), array_.end(), cmp_);
+            if (cmp_(array_.front(), item))
+                array_[0] = std::move(item);
+            std::make_heap(array_.begin(), array_.end(), cmp_);
+        }
+    }
+
+    [[nodiscard]] std::vector<T> data() const {
+
+        std::vector<T>  result (array_.begin(),
+                                typename std::array<T, N>::const_iterator
+                                    (data_end_));
+
+        std::sort(result.begin(), result.end(), cmp_);
+        return (result);
+    }
+
+private:
+
+    std::array<T, N> array_ { };
+    typename std::array<T, N>::iterator data_end_ { array_.begin() };
+    Cmp cmp_ { };
+};
+
+// ----------------------------------------------------------------------------
+
+template<std::size_t K>
+static void bench_priority_queue(const std::vector<double> &notionals) {
+
+    const std::size_t   n = notionals.size();
+    const std::string   k_str = " K=" + std::to_string(K);
+    std::vector<double> legacy_res;
+    std::vector<double> push_res;
+    std::vector<double> batch_res;
+
+    if (K * n <= 200000000UL)  {  // The legacy path is O(K log K) a push
+        LegacyFixedSizePriorityQueue<double, K> legacy;
+
+        report("FixedSizePriorityQueue legacy push" + k_str, n,
+               time_it_ns([&]() {
+                   for (const double v : notionals)
+                       legacy.push(double(v));
+               }),
+               sizeof(double));
+        legacy_res = legacy.data();
+    }
+
+    {
+        FixedSizePriorityQueue<double, K>   fspq;
+
+        report("FixedSizePriorityQueue push" + k_str, n,
+               time_it_ns([&]() {
+                   for (const double v : notionals)
+                       fspq.push(double(v));
+               }),
+               sizeof(double));
+        push_res = fspq.data();
+    }
+
+    {
+        FixedSizePriorityQueue<double, K>   fspq;
+        std::array<double, K>               buffer;
+        std::size_t                         written { 0 };
+
+        report("FixedSizePriorityQueue push_batch" + k_str, n,
+               time_it_ns([&]() {
+                   fspq.push_batch(notionals);
+                   written = fspq.data(buffer);
+               }),
+               sizeof(double));
+        batch_res.assign(buffer.begin(), buffer.begin() + written);
+    }
+
+    assert(legacy_res.empty() || legacy_res == push_res);
+    assert(push_res == batch_res);
+}
+
+// ----------------------------------------------------------------------------
+
+// Indicators after each appended tick: SMA, rolling std, volatility, EWMA,
+// drawdown and RSI updated in place vs. recomputed over the history
+//
+static void bench_incremental_visitors(std::size_t n) {
+
+    constexpr std::size_t   roll { 50 };
+    constexpr std::size_t   recomputes { 20 };
+    std::mt19937_64                     gen { 99 };
+    std::normal_distribution<double>    dist { 0.0, 0.001 };
+    std::vector<double>                 prices (n);
+    double                              sink { 0 };
+
+    prices[0] = 100;
+    for (std::size_t i = 1; i < n; ++i)
+        prices[i] = prices[i - 1] * std::exp(dist(gen));
+
+    IncrementalRollingMean<double>  sma (roll);
+    IncrementalRollingStd<double>   rstd (roll);
+    IncrementalVolatility<double>   vol (roll);
+    IncrementalEWMA<double>         ewma (0.05);
+    IncrementalDrawdown<double>     drawdown;
+    IncrementalRSI<double>          rsi (return_policy::log, 14);
+
+    const auto  update_all = [&](double p) {
+        sma.update(p);
+        rstd.update(p);
+        vol.update(p);
+        ewma.update(p);
+        drawdown.update(p);
+        rsi.update(p);
+    };
+
+    for (std::size_t i = 0; i <= roll; ++i)  // Warm up, past the NaNs
+        update_all(prices[i]);
+    report("incremental 6 indicators per tick", n - roll - 1,
+           time_it_ns([&]() {
+               for (std::size_t i = roll + 1; i < n; ++i) {
+                   update_all(prices[i]);
+                   sink += sma.current() + rstd.current() + vol.current() +
+                           ewma.current() + drawdown.current() +
+                           rsi.current();
+               }
+           }),
+           sizeof(double));
+
+    // The same visitors walking the whole history, as a batch visitor does
+    //
+    const auto  recompute = [&prices](auto &visitor) {
+        visitor.pre();
+        visitor(prices.begin(), prices.end(), prices.begin(), prices.end());
+        visitor.post();
+        return (visitor.get_result());
+    };
+
+    report("batch recompute per tick, history " + std::to_string(n),
+           recomputes,
+           time_it_ns([&]() {
+               for (std::size_t r = 0; r < recomputes; ++r)
+                   sink += recompute(sma) + recompute(rstd) +
+                           recompute(vol) + recompute(ewma) +
+                           recompute(drawdown) + recompute(rsi);
+           }));
+    std::cout << "(checksum " << sink << ")\n";
+}
+
+// ----------------------------------------------------------------------------
+
+// Each SIMD kernel at each level the CPU supports, then a table of the
+// speedups over the scalar path. Best of 3 runs.
+//
+static void bench_simd_kernels(std::size_t n) {
+
+    constexpr std::size_t   roll { 50 };
+    const char              *level_names[] = { "scalar", "avx2", "avx512" };
+    std::mt19937_64                     gen { 5 };
+    std::normal_distribution<double>    dist { 0.0, 0.001 };
+    std::vector<double>                 prices (n);
+    std::vector<double>                 padded (
+        n, std::numeric_limits<double>::quiet_NaN());
+    std::vector<double>                 out (n);
+    double                              sink { 0 };
+
+    prices[0] = 100;
+    for (std::size_t i = 1; i < n; ++i)
+        prices[i] = prices[i - 1] * std::exp(dist(gen));
+    for (std::size_t i = 0; i < n; i += 5)  // As load_align_column() pads
+        padded[i] = prices[i];
+
+    using kernel_t = std::function<void()>;
+
+    const std::vector<std::pair<std::string, kernel_t>>    kernels {
+        { "returns", [&]() { simd_returns(prices, out); } },
+        { "log_returns", [&]() { simd_log_returns(prices, out); } },
+        { "rolling_mean", [&]() { simd_rolling_mean(prices, out, roll); } },
+        { "rolling_var", [&]() { simd_rolling_var(prices, out, roll); } },
+        { "rolling_var NaN padded",
+          [&]() { simd_rolling_var(padded, out, roll, 2); } },
+        { "ewma", [&]() { simd_ewma(prices, out, 0.05); } },
+        { "zscore", [&]() { simd_zscore(prices, out); } },
+    };
+    const int                   top = int(simd_level_supported());
+    std::vector<std::vector<double>>    ns (kernels.size());
+
+    for (int level = 0; level <= top; ++level) {
+        set_simd_level(SIMDLevel(level));
+        for (std::size_t k = 0; k < kernels.size(); ++k) {
+            BenchSample best;
+
+            kernels[k].second();  // Warm up
+            for (int run = 0; run < 3; ++run) {
+                const BenchSample   sample = time_it_ns(kernels[k].second);
+
+                if (run == 0 || sample.elapsed_ns < best.elapsed_ns)
+                    best = sample;
+                sink += out[n - 1];
+            }
+            report("simd " + kernels[k].first + " " + level_names[level],
+                   n, best, 2 * sizeof(double));
+            ns[k].push_back(best.elapsed_ns / double(n));
+        }
+    }
+    set_simd_level(SIMDLevel::avx512);
+
+    std::printf("\n%-24s %12s", "kernel", "scalar ns");
+    for (int level = 1; level <= top; ++level)
+        std::printf(" %10s", level_names[level]);
+    std::printf("\n");
+    for (std::size_t k = 0; k < kernels.size(); ++k) {
+        std::printf("%-24s %12.3f", kernels[k].first.c_str(), ns[k][0]);
+        for (int level = 1; level <= top; ++level)
+            std::printf(" %9.2fx", ns[k][0] / ns[k][level]);
+        std::printf("\n");
+    }
+    std::cout << "(N=" << n << ", checksum " << sink << ")\n";
+}
+
+// ----------------------------------------------------------------------------
+
+// Top-K over tc producer threads, each scanning its own slice: one queue
+// behind a mutex vs. ShardedTopK
+//
+template<std::size_t K>
+static void bench_sharded_top_k(const std::vector<double> &notionals) {
+
+    const std::size_t   n = notionals.size();
+    const std::string   k_str = " K=" + std::to_string(K);
+
+    const auto  run_threads = [n](unsigned int tc, const auto &func) {
+        std::vector<std::thread>    threads;
+        const std::size_t           slice = n / tc;
+
+        for (unsigned int t = 1; t < tc; ++t)
+            threads.emplace_back(func, t, t * slice, (t + 1) * slice);
+        func(0U, std::size_t(0), tc == 1 ? n : slice);
+        for (auto &thr : threads)  thr.join();
+    };
+
+    for (unsigned int tc = 1; tc <= max_bench_threads(); tc *= 2) {
+        const std::size_t   n_used = n / tc * tc;
+        std::vector<double> locked_res;
+
+        {
+            FixedSizePriorityQueue<double, K>   fspq;
+            std::mutex                          mutex;
+
+            report("FixedSizePriorityQueue behind a mutex" + k_str, n_used,
+                   time_it_ns([&]() {
+                       run_threads(tc, [&](unsigned int,
+                                           std::size_t begin,
+                                           std::size_t end) {
+                           for (std::size_t i = begin; i < end; ++i) {
+                               std::lock_guard<std::mutex> guard (mutex);
+
+                               fspq.push(notionals[i]);
+                           }
+                       });
+                   }),
+                   sizeof(double), tc);
+            locked_res = fspq.data();
+        }
+        {
+            ShardedTopK<double, K>  top_k (tc);
+
+            report("ShardedTopK push" + k_str, n_used,
+                   time_it_ns([&]() {
+                       run_threads(tc, [&](unsigned int t,
+                                           std::size_t begin,
+                                           std::size_t end) {
+                           auto    &shard = top_k.shard(t);
+
+                           for (std::size_t i = begin; i < end; ++i)
+                               shard.push(notionals[i]);
+                       });
+                       (void) top_k.merge();
+                   }),
+                   sizeof(double), tc);
+            assert(top_k.data() == locked_res);
+        }
+        {
+            ShardedTopK<double, K>  top_k (tc);
+
+            report("ShardedTopK push_batch + merge" + k_str, n_used,
+                   time_it_ns([&]() {
+                       run_threads(tc, [&](unsigned int t,
+                                           std::size_t begin,
+                                           std::size_t end) {
+                           top_k.shard(t).push_batch(std::span<const double>(
+                               notionals.data() + begin, end - begin));
+                       });
+                       (void) top_k.merge();
+                   }),
+                   sizeof(double), tc);
+            assert(top_k.data() == locked_res);
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+static void bench_vector_view(const std::vector<double> &data) {
+
+    const std::size_t   n = data.size();
+    std::vector<double> keys (data.begin(), data.begin() + n / 16);
+    double              sink { 0 };
+
+    {
+        std::vector<double> vec = data;
+
+        report("std::vector sort", n,
+               time_it_ns([&]() { std::sort(vec.begin(), vec.end()); }),
+               sizeof(double));
+        report("std::vector lower_bound", keys.size(),
+               time_it_ns([&]() {
+                   for (const double k : keys)
+                       sink += *std::lower_bound(vec.begin(), vec.end(), k);
+               }));
+    }
+    {
+        std::vector<double> vec = data;
+        VectorView<double>  vw;
+
+        vw = vec;
+        report("VectorView sort", n,
+               time_it_ns([&]() { std::sort(vw.begin(), vw.end()); }),
+               sizeof(double));
+
+        const VectorConstView<double>   cvw (vw.data(), vw.data() + vw.size());
+
+        report("VectorConstView lower_bound", keys.size(),
+               time_it_ns([&]() {
+                   for (const double k : keys)
+                       sink += *std::lower_bound(cvw.begin(), cvw.end(), k);
+               }));
+
+        std::vector<double> out (n);
+
+        report("VectorConstView iterate", n,
+               time_it_ns([&]() {
+                   for (const double v : cvw)  sink += v;
+               }),
+               sizeof(double));
+        report("VectorConstView copy", n,
+               time_it_ns([&]() {
+                   std::copy(cvw.begin(), cvw.end(), out.begin());
+               }),
+               2 * sizeof(double));
+        sink += std::accumulate(out.begin(), out.end(), 0.0);
+    }
+    std::cout << "(checksum " << sink << ")\n";
+}
+
+// ----------------------------------------------------------------------------
+
+// Filtering a frame of three columns: copying the selected rows vs. building
+// indexed views on them, and then scanning the result.
+//
+static void bench_select_views(const std::vector<double> &prices) {
+
+    const std::size_t           n = prices.size();
+    std::vector<unsigned long>  index (n);
+    std::vector<double>         volumes (n);
+
+    std::iota(index.begin(), index.end(), 0UL);
+    for (std::size_t i = 0; i < n; ++i)
+        volumes[i] = double(i % 1000);
+
+    const double        cutoff = prices[n / 2];
+    double              sink { 0 };
+    std::vector<bool>   mask (n);
+
+    for (std::size_t i = 0; i < n; ++i)
+        mask[i] = prices[i] > cutoff;
+
+    {
+        std::vector<unsigned long>  idx_copy;
+        std::vector<double>         price_copy;
+        std::vector<double>         vol_copy;
+
+        report("filter by copy", n,
+               time_it_ns([&]() {
+                   for (std::size_t i = 0; i < n; ++i)
+                       if (mask[i]) {
+                           idx_copy.push_back(index[i]);
+                           price_copy.push_back(prices[i]);
+                           vol_copy.push_back(volumes[i]);
+                       }
+               }));
+        report("scan filtered copy", price_copy.size(),
+               time_it_ns([&]() {
+                   for (std::size_t i = 0; i < price_copy.size(); ++i)
+                       sink += price_copy[i] * vol_copy[i];
+               }));
+    }
+    {
+        RowSelectionPtr rows;
+
+        report("filter by indexed view", n,
+               time_it_ns([&]() { rows = make_row_selection(mask); }));
+
+        const auto  idx_view = make_indexed_view(index, rows);
+        const auto  price_view = make_indexed_view(prices, rows);
+        const auto  vol_view = make_indexed_view(volumes, rows);
+
+        report("scan indexed view", price_view.size(),
+               time_it_ns([&]() {
+                   for (std::size_t i = 0; i < price_view.size(); ++i)
+                       sink += price_view[i] * vol_view[i];
+               }));
+        sink += double(idx_view.back());
+    }
+    {
+        std::vector<double> down_copy;
+
+        report("downsample 1/10 by copy", n,
+               time_it_ns([&]() {
+                   down_copy.reserve(n / 10 + 1);
+                   for (std::size_t i = 0; i < n; i += 10)
+                       down_copy.push_back(prices[i]);
+               }));
+
+        VectorStridedConstView<double>  down_view;
+
+        report("downsample 1/10 by strided view", n,
+               time_it_ns([&]() {
+                   down_view = make_strided_view(prices, 0, 10);
+               }));
+        sink += std::accumulate(down_view.begin(), down_view.end(), 0.0) -
+                std::accumulate(down_copy.begin(), down_copy.end(), 0.0);
+    }
+    std::cout << "(checksum " << sink << ")\n";
+}
+
+// ----------------------------------------------------------------------------
+
+// The gen_*_dist() generators, then their par_gen_*_dist() counterparts
+// at each thread count, with par_fill_normal_dist() into a buffer that
+// already exists. The calling thread works too, so tc threads is a pool of
+// tc - 1.
+//
+static void bench_rand_gen(std::size_t n) {
+
+    RandGenParams<double>   pd;
+    RandGenParams<long>     pl;
+    std::vector<double>     filled (n);
+    double                  sink { 0 };
+
+    pd.min_value = 0;
+    pd.max_value = 1.0;
+    pd.mean = 0;
+    pd.std = 1.0;
+    pd.seed = 17;
+    pl.min_value = 0;
+    pl.max_value = 1000000;
+    pl.seed = 17;
+
+    report("gen_uniform_real_dist", n,
+           time_it_ns([&]() {
+               sink += gen_uniform_real_dist<double>(n, pd).back();
+           }),
+           sizeof(double));
+    report("gen_normal_dist", n,
+           time_it_ns([&]() {
+               sink += gen_normal_dist<double>(n, pd).back();
+           }),
+           sizeof(double));
+    report("gen_uniform_int_dist", n,
+           time_it_ns([&]() {
+               sink += double(gen_uniform_int_dist<long>(n, pl).back());
+           }),
+           sizeof(long));
+    for (unsigned int tc = 2; tc <= max_pool_bench_threads(); tc *= 2) {
+        WorkStealingPool    pool (tc - 1);
+
+        report("par_gen_uniform_real_dist", n,
+               time_it_ns([&]() {
+                   sink += par_gen_uniform_real_dist(n, pd, pool).back();
+               }),
+               sizeof(double), tc);
+        report("par_gen_normal_dist", n,
+               time_it_ns([&]() {
+                   sink += par_gen_normal_dist(n, pd, pool).back();
+               }),
+               sizeof(double), tc);
+        report("par_fill_normal_dist in place", n,
+               time_it_ns([&]() {
+                   par_fill_normal_dist(filled, pd, pool);
+                   sink += filled.back();
+               }),
+               sizeof(double), tc);
+        report("par_gen_uniform_int_dist", n,
+               time_it_ns([&]() {
+                   sink +=
+                       double(par_gen_uniform_int_dist(n, pl, pool).back());
+               }),
+               sizeof(long), tc);
+    }
+    std::cout << "(checksum " << sink << ")\n";
+}
+
+// Price paths, 64 steps of n / 65 paths. The fused generator, at each SIMD
+// level on the default pool and then at each thread count, against drawing
+// the normals with par_gen_normal_dist() and stepping the paths over them
+// in a second pass.
+//
+static void bench_mc_paths(std::size_t n) {
+
+    constexpr std::size_t   steps { 64 };
+    constexpr std::size_t   chunk { 1024 };
+    const unsigned int      threads =
+        default_thread_pool().thread_count() + 1;
+    const std::size_t       paths = std::max<std::size_t>(n / (steps + 1), 1);
+    const std::size_t       cells = paths * (steps + 1);
+    const char              *level_names[] = { "scalar", "avx2", "avx512" };
+    PathGenParams<double>   p;
+    std::vector<double>     out (cells);
+    double                  sink { 0 };
+    const auto              per_sec = [paths](const BenchSample &sample) {
+        std::cout << "    paths/sec: "
+                  << double(paths) / sample.elapsed_ns * 1e9 << '\n';
+    };
+
+    p.drift = 0.05;
+    p.seed = 17;
+
+    RandGenParams<double>   pd;
+    const double            step_drift =
+        (p.drift - 0.5 * p.volatility * p.volatility) * p.dt;
+    const double            step_vol = p.volatility * std::sqrt(p.dt);
+
+    pd.mean = 0;
+    pd.std = 1.0;
+    pd.seed = 17;
+
+    const BenchSample   two_pass = time_it_ns([&]() {
+        const auto          z = par_gen_normal_dist(paths * steps, pd);
+        std::vector<double> x (paths, 0.0);
+
+        std::fill(out.begin(), out.begin() + paths, p.s0);
+        default_thread_pool().run_chunks(
+            (paths + chunk - 1) / chunk, [&](std::size_t c)  {
+                const std::size_t   end = std::min(paths, (c + 1) * chunk);
+
+                for (std::size_t t = 0; t < steps; ++t)
+                    for (std::size_t path = c * chunk; path < end; ++path)  {
+                        x[path] += step_drift + step_vol * z[t * paths + path];
+                        out[(t + 1) * paths + path] =
+                            p.s0 * std::exp(x[path]);
+                    }
+            });
+        sink += out.back();
+    });
+
+    report("price paths, normals then steps", cells, two_pass,
+           sizeof(double), threads);
+    per_sec(two_pass);
+
+    const int   top = int(simd_level_supported());
+
+    for (int level = 0; level <= top; ++level) {
+        set_simd_level(SIMDLevel(level));
+
+        const BenchSample   sample = time_it_ns([&]() {
+            gen_price_paths(out.data(), paths, steps, p);
+            sink += out.back();
+        });
+
+        report(std::string("gen_price_paths ") + level_names[level], cells,
+               sample, sizeof(double), threads);
+        per_sec(sample);
+    }
+    set_simd_level(SIMDLevel::avx512);
+
+    p.jump_intensity = 5;
+    p.jump_mean = -0.02;
+    p.jump_std = 0.05;
+
+    const BenchSample   jumps = time_it_ns([&]() {
+        gen_price_paths(out.data(), paths, steps, p);
+        sink += out.back();
+    });
+
+    report("gen_price_paths with jumps", cells, jumps, sizeof(double),
+           threads);
+    per_sec(jumps);
+    p.jump_intensity = 0;
+
+    // The calling thread works too, so tc threads is a pool of tc - 1
+    //
+    for (unsigned int tc = 2; tc <= max_pool_bench_threads(); tc *= 2) {
+        WorkStealingPool    pool (tc - 1);
+        const BenchSample   sample = time_it_ns([&]() {
+            gen_price_paths(out.data(), paths, steps, p, pool);
+            sink += out.back();
+        });
+
+        report("gen_price_paths", cells, sample, sizeof(double), tc);
+        per_sec(sample);
+    }
+    std::cout << "(checksum " << sink << ")\n";
+}
+
+// ----------------------------------------------------------------------------
+
+using MyDataFrame = StdDataFrame64<unsigned long>;
+
+// A frame with one key column, wide_cols double columns and one string
+// column
+//
+static MyDataFrame
+gen_wide_frame(const std::vector<double> &keys, std::size_t wide_cols) {
+
+    const std::size_t           n = keys.size();
+    MyDataFrame                 df;
+    std::vector<unsigned long>  index (n);
+    std::vector<std::string>    symbols (n);
+
+    std::iota(index.begin(), index.end(), 0UL);
+    for (std::size_t i = 0; i < n; ++i)
+        symbols[i] = "SYM" + std::to_string(i % 5000);
+    df.load_data(std::move(index),
+                 std::make_pair("key", keys),
+                 std::make_pair("symbol", symbols));
+    for (std::size_t c = 0; c < wide_cols; ++c) {
+        std::vector<double> col (keys.begin(), keys.end());
+
+        for (auto &v : col)  v += double(c);
+        df.load_column(("col_" + std::to_string(c)).c_str(), std::move(col));
+    }
+    return (df);
+}
+
+// Stats and correlation over a frame, serial vs. parallel_visit() on 2, 4,
+// ... threads
+//
+static void bench_parallel_visit(const std::vector<double> &notionals) {
+
+    const std::size_t           n = notionals.size();
+    MyDataFrame                 df;
+    std::vector<unsigned long>  idx (n);
+    std::vector<double>         ys (n);
+
+    for (std::size_t i = 0; i < n; ++i) {
+        idx[i] = i;
+        ys[i] = notionals[i] * 0.5 + double(i % 97);
+    }
+    df.load_index(std::move(idx));
+    df.load_column("x", std::vector<double>(notionals));
+    df.load_column("y", std::move(ys));
+
+    const auto  &index = df.get_index();
+    const auto  &x = df.get_column<double>("x");
+    const auto  &y = df.get_column<double>("y");
+    double      sink { 0 };
+    double      serial_stats { 0 };
+    double      serial_corr { 0 };
+
+    {
+        MergeableStatsVisitor<double>   stats;
+        MergeableCorrVisitor<double>    corr;
+        BenchSample                     sample;
+
+        sample = time_it_ns([&]() {
+            stats.pre();
+            stats(index.begin(), index.end(), x.begin(), x.end());
+            stats.post();
+            sink += stats.get_std();
+        });
+        report("serial stats visit", n, sample, sizeof(double));
+        serial_stats = sample.elapsed_ns;
+        sample = time_it_ns([&]() {
+            corr.pre();
+            corr(index.begin(), index.end(),
+                 x.begin(), x.end(), y.begin(), y.end());
+            corr.post();
+            sink += corr.get_result();
+        });
+        report("serial corr visit", n, sample, 2 * sizeof(double));
+        serial_corr = sample.elapsed_ns;
+    }
+
+    // The calling thread works too, so tc threads is a pool of tc - 1
+    //
+    for (unsigned int tc = 2; tc <= max_pool_bench_threads(); tc *= 2) {
+        WorkStealingPool                pool (tc - 1);
+        MergeableStatsVisitor<double>   stats;
+        MergeableCorrVisitor<double>    corr;
+        BenchSample                     sample;
+
+        parallel_visit<double>(df, "x", stats, pool);  // Warm up
+        sample = time_it_ns([&]() {
+            parallel_visit<double>(df, "x", stats, pool);
+            sink += stats.get_std();
+        });
+        report("parallel_visit stats", n, sample, sizeof(double), tc);
+        std::cout << "  speedup " << serial_stats / sample.elapsed_ns
+                  << "x\n";
+        sample = time_it_ns([&]() {
+            parallel_visit<double, double>(df, "x", "y", corr, pool);
+            sink += corr.get_result();
+        });
+        report("parallel_visit corr", n, sample, 2 * sizeof(double), tc);
+        std::cout << "  speedup " << serial_corr / sample.elapsed_ns
+                  << "x\n";
+    }
+    std::cout << "(checksum " << sink << ")\n";
+}
+
+// Point and range lookups by value: hash index, sorted index and no index
+// (a column scan)
+//
+static void bench_column_index(const std::vector<double> &notionals) {
+
+    const std::size_t           n = notionals.size();
+    constexpr std::size_t       lookups { 100000 };
+    constexpr std::size_t       scans { 20 };
+    std::mt19937_64             gen { 17 };
+    std::vector<unsigned long>  stamps (n);
+    std::vector<unsigned long>  order_ids (n);
+    std::size_t                 sink { 0 };
+
+    // Timestamps with bursts of equal values, order IDs with about 4 rows
+    // (fills) each
+    //
+    for (std::size_t i = 0; i < n; ++i) {
+        stamps[i] = i / 3 * 1000 + gen() % 3;
+        order_ids[i] = gen() % (n / 4 + 1);
+    }
+
+    std::vector<unsigned long>  keys (lookups);
+
+    for (auto &key : keys)  key = order_ids[gen() % n];
+
+    const auto  make_frame = [&]() {
+        MyDataFrame df;
+
+        df.load_index(std::vector<unsigned long>(stamps));
+        df.load_column("order_id", std::vector<unsigned long>(order_ids));
+        df.load_column("notional", std::vector<double>(notionals));
+        return (IndexedFrame<MyDataFrame>(std::move(df)));
+    };
+
+    auto    plain = make_frame();
+    auto    hashed = make_frame();
+    auto    sorted = make_frame();
+
+    report("build hash index", n, time_it_ns([&]() {
+        hashed.index_on_column<unsigned long>("order_id");
+        hashed.index_on_index();
+    }));
+    report("build sorted index", n, time_it_ns([&]() {
+        sorted.index_on_column<unsigned long>("order_id",
+                                              column_index_type::sorted);
+        sorted.index_on_index(column_index_type::sorted);
+    }));
+    std::cout << "  index bytes: hash "
+              << hashed.get_hash_index<unsigned long>("order_id")
+                     .memory_bytes()
+              << ", sorted "
+              << sorted.get_sorted_index<unsigned long>("order_id")
+                     .memory_bytes()
+              << "\n";
+
+    // Point lookups, by RowSelection and straight from the index
+    //
+    report("point lookup, no index", scans, time_it_ns([&]() {
+        for (std::size_t i = 0; i < scans; ++i)
+            sink += plain.find_rows<unsigned long>("order_id",
+                                                   keys[i])->size();
+    }));
+    report("point lookup, hash", lookups, time_it_ns([&]() {
+        for (const auto key : keys)
+            sink += hashed.find_rows<unsigned long>("order_id", key)->size();
+    }));
+    report("point lookup, sorted", lookups, time_it_ns([&]() {
+        for (const auto key : keys)
+            sink += sorted.find_rows<unsigned long>("order_id", key)->size();
+    }));
+
+    const auto  &hash_index =
+        hashed.get_hash_index<unsigned long>("order_id");
+    const auto  &sorted_index =
+        sorted.get_sorted_index<unsigned long>("order_id");
+
+    report("point lookup, hash span", lookups, time_it_ns([&]() {
+        for (const auto key : keys)
+            sink += hash_index.find(key).size();
+    }));
+    report("point lookup, sorted span", lookups, time_it_ns([&]() {
+        for (const auto key : keys)
+            sink += sorted_index.find(key).size();
+    }));
+
+    // Time windows of about 300 rows on the index
+    //
+    const unsigned long window { 100 * 1000 };
+
+    report("index range lookup, no index", scans, time_it_ns([&]() {
+        for (std::size_t i = 0; i < scans; ++i)
+            sink += plain.find_rows_in_range_by_index(
+                stamps[keys[i]], stamps[keys[i]] + window)->size();
+    }));
+    report("index range lookup, sorted", lookups, time_it_ns([&]() {
+        for (const auto key : keys)
+            sink += sorted.find_rows_in_range_by_index(
+                stamps[key], stamps[key] + window)->size();
+    }));
+
+    // Join of 10000 order IDs against the frame
+    //
+    const std::vector<unsigned long>    probe (keys.begin(),
+                                               keys.begin() + 10000);
+
+    report("join 10000, no index", probe.size(), time_it_ns([&]() {
+        sink += plain.join_rows<unsigned long>("order_id", probe)
+                    .first.size();
+    }));
+    report("join 10000, hash", probe.size(), time_it_ns([&]() {
+        sink += hashed.join_rows<unsigned long>("order_id", probe)
+                    .first.size();
+    }));
+    std::cout << "(checksum " << sink << ")\n";
+}
+
+// Tick data: nanosecond timestamps about a microsecond apart and prices
+// that move a cent or so a tick. Scans are reported against the raw bytes,
+// so GB/sec compares with the uncompressed columns directly.
+//
+static void bench_compressed_columns(std::size_t n) {
+
+    std::mt19937_64                     gen { 17 };
+    std::normal_distribution<double>    move { 0, 0.01 };
+    std::vector<unsigned long>          stamps (n);
+    std::vector<double>                 prices (n);
+    double                              sink { 0 };
+
+    stamps[0] = 1700000000000000000UL;
+    prices[0] = 100;
+    for (std::size_t i = 1; i < n; ++i) {
+        stamps[i] = stamps[i - 1] + 900 + gen() % 200;
+        prices[i] = std::round((prices[i - 1] + move(gen)) * 100) / 100;
+    }
+
+    MyDataFrame df;
+
+    df.load_index(std::vector<unsigned long>(stamps));
+    df.load_column("price", std::vector<double>(prices));
+
+    CompressedFrame<unsigned long>  cframe;
+
+    report("compress_frame", n, time_it_ns([&]() {
+        cframe = compress_frame<double>(df);
+    }), 2 * sizeof(double));
+
+    const auto  &cstamps = cframe.get_compressed_index();
+    const auto  &cprices = cframe.get_compressed_column<double>("price");
+
+    std::cout << "  compression ratio: index "
+              << double(n * sizeof(unsigned long)) /
+                 double(cstamps.memory_bytes())
+              << "x, price "
+              << double(n * sizeof(double)) / double(cprices.memory_bytes())
+              << "x, frame "
+              << double(cframe.raw_bytes()) / double(cframe.memory_bytes())
+              << "x\n";
+
+    report("raw index get_index copy", n, time_it_ns([&]() {
+        const std::vector<unsigned long>    copy (df.get_index());
+
+        sink += double(copy[n / 2]);
+    }), sizeof(unsigned long));
+    report("compressed get_index", n, time_it_ns([&]() {
+        sink += double(cframe.get_index()[n / 2]);
+    }), sizeof(unsigned long));
+    report("compressed get_column price", n, time_it_ns([&]() {
+        sink += cframe.get_column<double>("price")[n / 2];
+    }), sizeof(double));
+
+    report("raw price sum", n, time_it_ns([&]() {
+        sink += std::accumulate(prices.begin(), prices.end(), 0.0);
+    }), sizeof(double));
+    report("compressed price scan sum", n, time_it_ns([&]() {
+        cframe.scan<double>("price", [&](const double *begin,
+                                         const double *end,
+                                         std::size_t) {
+            sink += std::accumulate(begin, end, 0.0);
+        });
+    }), sizeof(double));
+
+    MergeableStatsVisitor<double>   stats;
+
+    report("raw stats visit", n, time_it_ns([&]() {
+        stats.pre();
+        stats(stamps.begin(), stamps.end(), prices.begin(), prices.end());
+        stats.post();
+        sink += stats.get_std();
+    }), 2 * sizeof(double));
+    report("compressed stats visit", n, time_it_ns([&]() {
+        cframe.visit<double>("price", stats);
+        sink += stats.get_std();
+    }), 2 * sizeof(double));
+    std::cout << "(checksum " << sink << ")\n";
+}
+
+// Trades against quotes, 10 quotes a trade over 500 symbols, so
+// --sizes 100000000 is 100M trades joined to 1B quotes (about 40 GB). The
+// baselines are the hand loops the joins replace: a binary search per
+// trade, and one pass over both frames keeping the last quote of each
+// symbol in an array. Both copy the bids out, as get_right_column() does.
+//
+static void bench_asof_join(std::size_t n) {
+
+    constexpr int       symbols { 500 };
+    const std::size_t   quotes_s = 10 * n;
+    const unsigned int  threads = default_thread_pool().thread_count() + 1;
+    std::mt19937_64     gen { 17 };
+    MyDataFrame         quotes;
+    MyDataFrame         trades;
+    double              sink { 0 };
+
+    {
+        std::vector<unsigned long>  stamps (quotes_s);
+        std::vector<double>         bids (quotes_s);
+        std::vector<int>            syms (quotes_s);
+        unsigned long               stamp { 0 };
+
+        for (std::size_t i = 0; i < quotes_s; ++i) {
+            stamp += gen() % 4;
+            stamps[i] = stamp;
+            bids[i] = 100.0 + double(gen() % 1000) / 100.0;
+            syms[i] = int(gen() % symbols);
+        }
+        quotes.load_index(std::move(stamps));
+        quotes.load_column("bid", std::move(bids));
+        quotes.load_column("sym", std::move(syms));
+    }
+    {
+        std::vector<unsigned long>  stamps (n);
+        std::vector<int>            syms (n);
+        unsigned long               stamp { 0 };
+
+        for (std::size_t i = 0; i < n; ++i) {
+            stamp += gen() % 40;
+            stamps[i] = stamp;
+            syms[i] = int(gen() % symbols);
+        }
+        trades.load_index(std::move(stamps));
+        trades.load_column("sym", std::move(syms));
+    }
+
+    const auto  &q_idx = quotes.get_index();
+    const auto  &t_idx = trades.get_index();
+    const auto  &q_bid = quotes.get_column<double>("bid");
+    const auto  &q_sym = quotes.get_column<int>("sym");
+    const auto  &t_sym = trades.get_column<int>("sym");
+
+    report("as-of loop, binary search per trade", n, time_it_ns([&]() {
+        std::vector<double> bids (n);
+
+        for (std::size_t t = 0; t < n; ++t) {
+            const auto  iter =
+                std::upper_bound(q_idx.begin(), q_idx.end(), t_idx[t]);
+
+            bids[t] = iter == q_idx.begin()
+                          ? std::numeric_limits<double>::quiet_NaN()
+                          : q_bid[iter - q_idx.begin() - 1];
+        }
+        sink += bids[n / 2];
+    }));
+    report("join_asof + get_right_column", n, time_it_ns([&]() {
+        const auto  joined = join_asof(trades, quotes);
+        const auto  bids = joined.get_right_column<double>("bid");
+
+        sink += bids[n / 2];
+    }), 0, threads);
+    report("join_asof, bid view summed", n, time_it_ns([&]() {
+        const auto  joined = join_asof(trades, quotes);
+        const auto  bids = joined.get_right_column_view<double>("bid");
+
+        sink += std::accumulate(bids.begin(), bids.end(), 0.0);
+    }), 0, threads);
+
+    report("as-of by symbol loop, last quote per symbol", n,
+           time_it_ns([&]() {
+               std::vector<long>   last (symbols, -1);
+               std::vector<double> bids (n);
+               std::size_t         q = 0;
+
+               for (std::size_t t = 0; t < n; ++t) {
+                   for (; q < quotes_s && q_idx[q] <= t_idx[t]; ++q)
+                       last[q_sym[q]] = long(q);
+                   bids[t] = last[t_sym[t]] < 0
+                                 ? std::numeric_limits<double>::quiet_NaN()
+                                 : q_bid[last[t_sym[t]]];
+               }
+               sink += bids[n / 2];
+           }));
+
+    const HashColumnIndex<int>  t_keys (t_sym);
+    const HashColumnIndex<int>  q_keys (q_sym);
+
+    report("join_asof_by<int> + get_right_column", n, time_it_ns([&]() {
+        const auto  joined =
+            join_asof_by<int>(trades, quotes, "sym", "sym");
+        const auto  bids = joined.get_right_column<double>("bid");
+
+        sink += bids[n / 2];
+    }), 0, threads);
+    report("join_asof_by<int>, prebuilt key indices", n, time_it_ns([&]() {
+        const auto  joined = join_asof_by(trades, quotes, t_keys, q_keys);
+        const auto  bids = joined.get_right_column<double>("bid");
+
+        sink += bids[n / 2];
+    }), 0, threads);
+    std::cout << "(checksum " << sink << ")\n";
+}
+
+// filter -> select -> reindex -> visit, step by step through whole frames
+// against one lazy_query() pass. The filter keeps about half the rows.
+// The allocated bytes stand in for the memory traffic of the copies.
+//
+static void bench_lazy_query(const std::vector<double> &prices) {
+
+    const std::size_t           n = prices.size();
+    std::vector<unsigned long>  idx (n);
+    std::vector<int>            sizes (n);
+    std::vector<double>         bids (n);
+    std::vector<std::string>    venues (n);
+    double                      sink { 0 };
+    MyDataFrame                 df;
+
+    std::iota(idx.begin(), idx.end(), 0UL);
+    for (std::size_t i = 0; i < n; ++i) {
+        sizes[i] = int(i % 1000);
+        bids[i] = prices[i] - 0.01;
+        venues[i] = i % 3 ? "XNYS" : "BATS";
+    }
+
+    const double    median = [&prices]() {
+        std::vector<double> sorted = prices;
+
+        std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2,
+                         sorted.end());
+        return (sorted[sorted.size() / 2]);
+    }();
+
+    df.load_data(std::move(idx),
+                 std::make_pair("price", prices),
+                 std::make_pair("size", sizes),
+                 std::make_pair("bid", bids),
+                 std::make_pair("venue", venues));
+
+    const auto  print_traffic = [](const BenchSample &sample) {
+        std::cout << "    allocated MB: "
+                  << double(sample.alloc_bytes) / (1 << 20) << '\n';
+    };
+    auto        sel = [median](const unsigned long &, const double &p) {
+        return (p > median);
+    };
+    using StatsType = MergeableStatsVisitor<double, double>;
+
+    BenchSample sample = time_it_ns([&]() {
+        const auto  filtered =
+            df.get_data_by_sel<double, decltype(sel),
+                               double, int, std::string>("price", sel);
+        const auto  reindexed =
+            filtered.get_reindexed<double, int, double, std::string>(
+                "price", "OLD_IDX");
+        const auto  &col = reindexed.get_column<double>("bid");
+        StatsType   stats;
+
+        stats.pre();
+        stats(reindexed.get_index().begin(), reindexed.get_index().end(),
+              col.begin(), col.end());
+        stats.post();
+        sink += stats.get_mean();
+    });
+
+    report("filter/reindex/visit step by step", n, sample,
+           2 * sizeof(double));
+    print_traffic(sample);
+
+    sample = time_it_ns([&]() {
+        StatsType   stats;
+
+        lazy_query(df).filter<double>("price",
+                                      [median](double p) {
+                                          return (p > median);
+                                      })
+                      .select({ "bid", "size" })
+                      .reindex<double>("price", "OLD_IDX")
+                      .visit<double>("bid", stats);
+        sink += stats.get_mean();
+    });
+    report("filter/reindex/visit lazy_query", n, sample, 2 * sizeof(double));
+    print_traffic(sample);
+
+    sample = time_it_ns([&]() {
+        const auto  filtered =
+            df.get_data_by_sel<double, decltype(sel),
+                               double, int, std::string>("price", sel);
+        const auto  reindexed =
+            filtered.get_reindexed<double, int, double, std::string>(
+                "price", "OLD_IDX");
+
+        sink += double(reindexed.get_column<int>("size").size());
+    });
+    report("filter/select/reindex into a frame step by step", n, sample);
+    print_traffic(sample);
+
+    sample = time_it_ns([&]() {
+        StdDataFrame64<double>  result;
+
+        lazy_query(df).filter<double>("price",
+                                      [median](double p) {
+                                          return (p > median);
+                                      })
+                      .select({ "bid", "size" })
+                      .reindex<double>("price", "OLD_IDX")
+                      .load_into<int, double, std::string>(result);
+        sink += double(result.get_column<int>("size").size());
+    });
+    report("filter/select/reindex into a frame lazy_query", n, sample);
+    print_traffic(sample);
+    std::cout << "(checksum " << sink << ")\n";
+}
+
+// The cost an instrumented operation pays per call, on a small operation
+// (a sum of 64 values) where it would show the most
+//
+static void bench_instrumentation(std::size_t n) {
+
+    constexpr std::size_t   width = 64;
+    std::vector<double>     values (width);
+    double                  sink { 0 };
+
+    std::iota(values.begin(), values.end(), 1.0);
+
+    const auto  sum = [&values]() {
+        return (std::accumulate(values.begin(), values.end(), 0.0));
+    };
+
+    report("64-value sum, not instrumented", n, time_it_ns([&]() {
+        for (std::size_t i = 0; i < n; ++i)  {
+            NullOpScope scope;
+
+            scope.add_rows(width);
+            sink += sum();
+        }
+    }));
+
+    OpCounters  &counters = instrument_registry().counters("bench_sum");
+
+    report("64-value sum, instrumented", n, time_it_ns([&]() {
+        for (std::size_t i = 0; i < n; ++i)  {
+            OpScope scope { counters };
+
+            scope.add_rows(width);
+            sink += sum();
+        }
+    }));
+    std::cout << instrument_registry().to_text()
+              << "(checksum " << sink << ")\n";
+    instrument_registry().reset();
+}
+
+static void bench_lazy_reindex(const std::vector<double> &keys) {
+
+    const std::size_t   n = keys.size();
+    const MyDataFrame   df = gen_wide_frame(keys, 32);
+    double              sink { 0 };
+
+    report("get_reindexed 32 wide", n,
+           time_it_ns([&]() {
+               const auto  result =
+                   df.get_reindexed<double, double, std::string>
+                       ("key", "OLD_IDX");
+
+               sink += result.get_column<double>("col_3")[n / 2];
+           }),
+           33 * sizeof(double));
+    report("get_reindexed_view 32 wide", n,
+           time_it_ns([&]() {
+               const auto  result =
+                   df.get_reindexed_view<double, double, std::string>
+                       ("key", "OLD_IDX");
+
+               sink += result.get_column<double>("col_3")[n / 2];
+           }));
+    report("get_lazy_reindexed 32 wide, 2 columns read", n,
+           time_it_ns([&]() {
+               auto    result =
+                   get_lazy_reindexed<double>(df, "key", "OLD_IDX");
+
+               sink += result.get_column_view<double>("col_3")[n / 2];
+               sink += double(result.get_column_view<std::string>("symbol")
+                                  [n / 2].size());
+           }));
+    // The calling thread works too, so tc threads is a pool of tc - 1
+    //
+    for (unsigned int tc = 2; tc <= max_pool_bench_threads(); tc *= 2) {
+        WorkStealingPool    pool (tc - 1);
+
+        report("get_lazy_reindexed sorted, 2 columns gathered", n,
+               time_it_ns([&]() {
+                   auto    result =
+                       get_lazy_reindexed<double>(df, "key", "OLD_IDX", true);
+
+                   result.materialize<double>({ "col_3", "col_4" }, pool);
+                   sink += result.get_column<double>("col_4")[n / 2];
+               }),
+               2 * sizeof(double), tc);
+    }
+    std::cout << "(checksum " << sink << ")\n";
+}
+
+// ----------------------------------------------------------------------------
+
+static void bench_retype(std::size_t n) {
+
+    std::vector<std::string>    strs (n);
+    std::vector<int>            ints (n);
+
+    for (std::size_t i = 0; i < n; ++i) {
+        ints[i] = int(i * 2654435761UL) >> 8;
+        strs[i] = std::to_string(ints[i]);
+    }
+
+    RetypeErrorMask errors;
+    long            sink { 0 };
+
+    {
+        MyDataFrame df;
+
+        df.load_data(std::vector<unsigned long>(n),
+                     std::make_pair("int_col", ints),
+                     std::make_pair("str_col", strs));
+        report("retype_column int->unsigned int", n,
+               time_it_ns([&]() {
+                   df.retype_column<int, unsigned int>("int_col");
+               }),
+               sizeof(int) + sizeof(unsigned int));
+        report("retype_column string->int std::stoi", n,
+               time_it_ns([&]() {
+                   df.retype_column<std::string, int>(
+                       "str_col",
+                       [](const std::string &str) -> int  {
+                           return (std::stoi(str));
+                       });
+               }));
+        sink += df.get_column<int>("str_col").back();
+    }
+    // The calling thread works too, so tc threads is a pool of tc - 1
+    //
+    for (unsigned int tc = 2; tc <= max_pool_bench_threads(); tc *= 2) {
+        WorkStealingPool    pool (tc - 1);
+
+        report("bulk_convert string->int", n,
+               time_it_ns([&]() {
+                   sink += bulk_convert<std::string, int>(strs, errors, pool)
+                               .back();
+               }),
+               0, tc);
+        report("bulk_convert string->double", n,
+               time_it_ns([&]() {
+                   sink += long(bulk_convert<std::string, double>
+                                    (strs, errors, pool).back());
+               }),
+               0, tc);
+        report("bulk_convert int->unsigned int", n,
+               time_it_ns([&]() {
+                   sink += bulk_convert<int, unsigned int>(ints, errors, pool)
+                               .back();
+               }),
+               sizeof(int) + sizeof(unsigned int), tc);
+        report("bulk_convert int->double", n,
+               time_it_ns([&]() {
+                   sink += long(bulk_convert<int, double>(ints, errors, pool)
+                                    .back());
+               }),
+               sizeof(int) + sizeof(double), tc);
+    }
+    std::cout << "(checksum " << sink << ")\n";
+}
+
+// ----------------------------------------------------------------------------
+
+// Evicts a file from the page cache, so the next read comes from disk
+//
+static void drop_page_cache(const char *path) {
+
+    const int   fd = ::open(path, O_RDONLY);
+
+    if (fd < 0)  return;
+    ::fdatasync(fd);
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+}
+
+// The load path without mmap: read() every numeric column of a columnar
+// file into its own vector and hand it to load_data()/load_column()
+//
+static MyDataFrame read_columnar_by_copy(const char *path) {
+
+    std::ifstream       stream (path, std::ios::binary);
+    ColumnarFileHeader  header;
+
+    stream.read(reinterpret_cast<char *>(&header), sizeof(header));
+
+    std::vector<ColumnarColumnMeta> metas (header.column_count);
+    MyDataFrame                     df;
+
+    stream.read(reinterpret_cast<char *>(metas.data()),
+                metas.size() * sizeof(ColumnarColumnMeta));
+    for (const auto &meta : metas) {
+        if (meta.type != ColumnarType::float64 &&
+            meta.type != ColumnarType::uint64)
+            continue;
+
+        std::vector<double> col (meta.count);
+
+        stream.seekg(std::streamoff(meta.offset));
+        stream.read(reinterpret_cast<char *>(col.data()),
+                    std::streamsize(meta.bytes));
+        if (! std::strcmp(meta.name, columnar_index_name))
+            df.load_index(std::vector<unsigned long>(
+                reinterpret_cast<const unsigned long *>(col.data()),
+                reinterpret_cast<const unsigned long *>(col.data()) +
+                    meta.count));
+        else
+            df.load_column(meta.name, std::move(col));
+    }
+    return (df);
+}
+
+static void bench_columnar_file(const std::vector<double> &keys) {
+
+    constexpr std::size_t   wide { 8 };
+    const char              *path = "bench_columnar_file.hmdf";
+    const std::size_t       n = keys.size();
+    double                  sink { 0 };
+
+    {
+        const MyDataFrame   df = gen_wide_frame(keys, wide);
+
+        report("write_columnar_file 8 wide", n,
+               time_it_ns([&]() {
+                   write_columnar_file<double, std::string>(df, path);
+               }));
+    }
+
+    const auto  sum_column = [](const VectorConstView<double> &col) {
+        return (std::accumulate(col.begin(), col.end(), 0.0));
+    };
+
+    for (const bool cold : { true, false }) {
+        const std::string   start = cold ? "cold " : "warm ";
+
+        if (cold)  drop_page_cache(path);
+        report("columnar " + start + "read() + load_column, 8 wide", n,
+               time_it_ns([&]() {
+                   const MyDataFrame   df = read_columnar_by_copy(path);
+
+                   sink += df.get_column<double>("col_3")[n / 2];
+               }),
+               (wide + 2) * sizeof(double));
+        if (cold)  drop_page_cache(path);
+        report("columnar " + start + "open, 1 column summed", n,
+               time_it_ns([&]() {
+                   const ColumnarFile  file (path);
+
+                   sink += sum_column(file.get_column_view<double>("col_3"));
+               }),
+               sizeof(double));
+        if (cold)  drop_page_cache(path);
+        report("columnar " + start + "open, 8 columns summed", n,
+               time_it_ns([&]() {
+                   const ColumnarFile  file (path);
+
+                   for (std::size_t c = 0; c < wide; ++c)
+                       sink += sum_column(file.get_column_view<double>
+                                              (("col_" +
+                                                std::to_string(c)).c_str()));
+               }),
+               wide * sizeof(double));
+    }
+    std::remove(path);
+    std::cout << "(checksum " << sink << ")\n";
+}
+
+// ----------------------------------------------------------------------------
+
+// A vendor style file: index, 4 prices, a quantity and a ticker per row.
+// Returns its size in bytes.
+//
+static std::size_t write_csv_file(const char *path, std::size_t rows) {
+
+    std::mt19937_64                     gen { 17 };
+    std::uniform_real_distribution<>    price { 10.0, 500.0 };
+    std::uniform_int_distribution<>     qty { 1, 100000 };
+    std::FILE                           *file = std::fopen(path, "w");
+
+    std::fputs("INDEX,open,high,low,close,volume,ticker\n", file);
+    for (std::size_t r = 0; r < rows; ++r)
+        std::fprintf(file, "%zu,%.4f,%.4f,%.4f,%.4f,%d,T%zu\n",
+                     r, price(gen), price(gen), price(gen), price(gen),
+                     qty(gen), r % 500);
+
+    const long  bytes = std::ftell(file);
+
+    std::fclose(file);
+    return (std::size_t(bytes));
+}
+
+// The serial path ingest_csv() replaces: getline() and strtod() a row at a
+// time, then load_index()/load_column()
+//
+static MyDataFrame read_csv_serially(const char *path) {
+
+    std::ifstream               stream (path);
+    std::string                 line;
+    std::vector<unsigned long>  index;
+    std::vector<double>         cols[4];
+    std::vector<int>            volume;
+    std::vector<std::string>    ticker;
+
+    std::getline(stream, line);
+    while (std::getline(stream, line)) {
+        char    *pos = line.data();
+
+        index.push_back(std::strtoul(pos, &pos, 10));
+        for (auto &col : cols)
+            col.push_back(std::strtod(pos + 1, &pos));
+        volume.push_back(int(std::strtol(pos + 1, &pos, 10)));
+        ticker.emplace_back(pos + 1);
+    }
+
+    MyDataFrame df;
+
+    df.load_index(std::move(index));
+    df.load_column("open", std::move(cols[0]));
+    df.load_column("high", std::move(cols[1]));
+    df.load_column("low", std::move(cols[2]));
+    df.load_column("close", std::move(cols[3]));
+    df.load_column("volume", std::move(volume));
+    df.load_column("ticker", std::move(ticker));
+    return (df);
+}
+
+// Throughput against file size, from n / 16 to n rows. The files are read
+// warm, so this is the parse and load cost, not the disk's.
+//
+static void bench_csv_ingest(std::size_t n) {
+
+    const char          *path = "bench_csv_ingest.csv";
+    const unsigned int  parsers = std::max(max_bench_threads() - 1, 1U);
+    double              sink { 0 };
+
+    for (const std::size_t rows : { n / 16, n / 4, n }) {
+        if (rows == 0)  continue;
+
+        const std::size_t   bytes = write_csv_file(path, rows);
+        const std::string   size =
+            " " + std::to_string(bytes >> 20) + " MB";
+
+        std::cout << "csv file of " << rows << " rows, " << bytes
+                  << " bytes\n";
+        report("csv getline() + strtod()" + size, rows,
+               time_it_ns([&]() {
+                   const MyDataFrame   df = read_csv_serially(path);
+
+                   sink += df.get_column<double>("close")[rows / 2];
+               }),
+               bytes / rows);
+        for (const bool use_mmap : { false, true }) {
+            for (const unsigned int tc : { 1U, parsers }) {
+                CsvIngestOptions    options;
+
+                options.use_mmap = use_mmap;
+                options.thread_count = tc;
+                report(std::string("ingest_csv ") +
+                           (use_mmap ? "mmap" : "read()") + size,
+                       rows,
+                       time_it_ns([&]() {
+                           MyDataFrame df;
+
+                           ingest_csv<double, double, double, double,
+                                      int, std::string>(df, path, options);
+                           sink += df.get_column<double>("close")[rows / 2];
+                       }),
+                       bytes / rows, tc);
+                if (tc == parsers)  break;
+            }
+        }
+    }
+    std::remove(path);
+    std::cout << "(checksum " << sink << ")\n";
+}
+
+// ----------------------------------------------------------------------------
+
+// A frame that grows one row at a time, with a summary value every 64 rows.
+// The appender is timed over every row. Re-running load_align_column() is
+// O(frame) per update, so it is timed only at 1000 evenly spaced updates.
+//
+static void bench_align_column(std::size_t n) {
+
+    constexpr std::size_t   interval { 64 };
+    constexpr std::size_t   reruns { 1000 };
+    const double            nan = std::numeric_limits<double>::quiet_NaN();
+    double                  sink { 0 };
+
+    {
+        MyDataFrame df;
+
+        df.load_index(std::vector<unsigned long> { });
+
+        auto    appender =
+            make_align_column_appender(df, "summary",
+                                       std::vector<double> { },
+                                       interval, true, nan);
+
+        report("AlignColumnAppender per update", n,
+               time_it_ns([&]() {
+                   for (std::size_t i = 0; i < n; ++i) {
+                       appender.append_index(i);
+                       if (i % interval == 0)
+                           appender.append_summary(double(i));
+                   }
+               }));
+        sink += df.get_column<double>("summary")[(n - 1) / interval * interval];
+    }
+
+    MyDataFrame         df;
+    std::vector<double> summaries;
+
+    df.load_index(std::vector<unsigned long>(n));
+    report("load_align_column", n,
+           time_it_ns([&]() {
+               df.load_align_column("summary",
+                                    std::vector<double>(n / interval, 1.0),
+                                    interval, true, nan);
+           }),
+           sizeof(double));
+    df.get_index().clear();
+    report("load_align_column rerun per update", reruns,
+           time_it_ns([&]() {
+               auto    &index = df.get_index();
+
+               for (std::size_t i = 0; i < n; ++i) {
+                   index.push_back(i);
+                   if (i % interval == 0)
+                       summaries.push_back(double(i));
+                   if ((i + 1) % (n / reruns) == 0) {
+                       df.load_align_column("summary",
+                                            std::vector<double>(summaries),
+                                            interval, true, nan);
+                       sink += df.get_column<double>("summary")
+                                   [i / interval * interval];
+                   }
+               }
+           }));
+    std::cout << "(checksum " << sink << ")\n";
+}
+
+// ----------------------------------------------------------------------------
+
+// A symbol column of 5000 distinct values as std::string vs. CategoryCode:
+// heap footprint, reindexing and an equality scan
+//
+static void bench_category_column(const std::vector<double> &keys) {
+
+    const std::size_t           n = keys.size();
+    std::vector<std::string>    symbols (n);
+    double                      sink { 0 };
+
+    for (std::size_t i = 0; i < n; ++i)
+        symbols[i] = "SYMBOL_" + std::to_string((i * 7919) % 5000);
+
+    MyDataFrame         str_df;
+    MyDataFrame         cat_df;
+    StringDictionary    dict;
+    const BenchSample   str_mem = time_it_ns([&]() {
+        str_df.load_data(std::vector<unsigned long>(n),
+                         std::make_pair("key", keys),
+                         std::make_pair("symbol", symbols));
+    });
+    const BenchSample   cat_mem = time_it_ns([&]() {
+        cat_df.load_data(std::vector<unsigned long>(n),
+                         std::make_pair("key", keys));
+        load_category_column(cat_df, "symbol", symbols, dict);
+    });
+
+    std::cout << "frame footprint, std::string symbols N=" << n << ": "
+              << str_mem.alloc_bytes << " bytes\n"
+              << "frame footprint, CategoryCode symbols N=" << n << ": "
+              << cat_mem.alloc_bytes << " bytes (dictionary "
+              << dict.memory_bytes() << ")\n";
+    report("get_reindexed std::string column", n,
+           time_it_ns([&]() {
+               const auto  result =
+                   str_df.get_reindexed<double, double, std::string>
+                       ("key", "OLD_IDX");
+
+               sink += double(result.get_column<std::string>("symbol")
+                                  [n / 2].size());
+           }),
+           sizeof(std::string));
+    report("get_reindexed CategoryCode column", n,
+           time_it_ns([&]() {
+               const auto  result =
+                   cat_df.get_reindexed<double, double, CategoryCode>
+                       ("key", "OLD_IDX");
+
+               sink += double(result.get_column<CategoryCode>("symbol")
+                                  [n / 2].code);
+           }),
+           sizeof(CategoryCode));
+
+    const std::string   &target = symbols[n / 3];
+
+    report("count equal std::string", n,
+           time_it_ns([&]() {
+               const auto  &col = str_df.get_column<std::string>("symbol");
+
+               sink += double(std::count(col.begin(), col.end(), target));
+           }),
+           sizeof(std::string));
+    report("count equal CategoryCode", n,
+           time_it_ns([&]() {
+               const auto  &col = cat_df.get_column<CategoryCode>("symbol");
+
+               sink += double(std::count(col.begin(), col.end(),
+                                         dict.find(target)));
+           }),
+           sizeof(CategoryCode));
+    std::cout << "(checksum " << sink << ")\n";
+}
+
+// ----------------------------------------------------------------------------
+
+// One query of a request-per-query service: filter a window of rows, gather
+// two columns through the selection, sort a copy for the median and return
+// a VWAP-ish figure. Every temporary is a V or R, so the same query runs on
+// the heap and in an arena.
+//
+template<typename V, typename R>
+static double run_query(const std::vector<double> &prices,
+                        std::size_t begin,
+                        std::size_t end) {
+
+    const double    cutoff = prices[begin];
+    R               rows;
+
+    for (std::size_t i = begin; i < end; ++i)
+        if (prices[i] > cutoff)  rows.push_back(i);
+
+    V   px;
+    V   vol;
+
+    for (const auto r : rows) {
+        px.push_back(prices[r]);
+        vol.push_back(double(r % 1000));
+    }
+
+    V   sorted (px.begin(), px.end());
+
+    std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2,
+                     sorted.end());
+
+    double  pv { 0 };
+    double  v { 0 };
+
+    for (std::size_t i = 0; i < px.size(); ++i) {
+        pv += px[i] * vol[i];
+        v += vol[i];
+    }
+    return (pv / (v + 1.0) + (sorted.empty() ? 0 : sorted[sorted.size() / 2]));
+}
+
+static void report_latencies(std::vector<double> &latencies) {
+
+    std::sort(latencies.begin(), latencies.end());
+
+    const auto  pct = [&latencies](double p) {
+        return (latencies[std::size_t(p * double(latencies.size() - 1))]);
+    };
+
+    std::cout << "    latency ns: p50=" << pct(0.5) << " p90=" << pct(0.9)
+              << " p99=" << pct(0.99) << " max=" << latencies.back() << '\n';
+}
+
+// Reader latency while a writer keeps changing the column: a consistent
+// copy taken under the writer's lock against a copy-on-write snapshot.
+// The writer changes 64 random rows, then publishes, over and over.
+//
+static void bench_cow_frame(const std::vector<double> &prices) {
+
+    constexpr std::size_t   reads { 200 };
+    constexpr std::size_t   batch { 64 };
+    const std::size_t       n = prices.size();
+    double                  sink { 0 };
+
+    for (const bool use_cow : { false, true }) {
+        std::vector<double>     locked = prices;
+        std::mutex              lock;
+        CowFrame<std::size_t>   frame;
+        std::atomic<bool>       done { false };
+        std::size_t             publishes { 0 };
+        std::vector<double>     latencies;
+
+        if (use_cow) {
+            frame.load_index(std::vector<std::size_t>(n));
+            frame.load_column("price", prices);
+            frame.publish();
+        }
+
+        std::thread writer ([&]() {
+            std::mt19937_64 gen (7);
+
+            while (! done.load(std::memory_order_relaxed)) {
+                if (use_cow) {
+                    for (std::size_t i = 0; i < batch; ++i)
+                        frame.set<double>("price", gen() % n, 1.0);
+                    frame.publish();
+                }
+                else {
+                    const std::lock_guard<std::mutex>   guard { lock };
+
+                    for (std::size_t i = 0; i < batch; ++i)
+                        locked[gen() % n] = 1.0;
+                }
+                publishes += 1;
+                std::this_thread::yield();
+            }
+        });
+
+        latencies.reserve(reads);
+        report(use_cow ? "CowFrame snapshot + scan, writer running"
+                       : "locked deep copy + scan, writer running",
+               reads,
+               time_it_ns([&]() {
+                   for (std::size_t r = 0; r < reads; ++r) {
+                       const auto  start = bench_clock::now();
+
+                       if (use_cow) {
+                           const auto  snap = frame.snapshot();
+
+                           snap.get_column<double>("price").for_each_block(
+                               [&sink](const double *begin,
+                                       const double *end,
+                                       std::size_t) {
+                                   sink += std::accumulate(begin, end, 0.0);
+                               });
+                       }
+                       else {
+                           std::vector<double> copy;
+
+                           {
+                               const std::lock_guard<std::mutex>   guard {
+                                   lock };
+
+                               copy = locked;
+                           }
+                           sink += std::accumulate(copy.begin(), copy.end(),
+                                                   0.0);
+                       }
+                       latencies.push_back(
+                           std::chrono::duration<double, std::nano>
+                               (bench_clock::now() - start).count());
+                   }
+               }),
+               n * sizeof(double));
+        done = true;
+        writer.join();
+        report_latencies(latencies);
+        if (use_cow)
+            std::cout << "    " << publishes << " publishes, "
+                      << frame.copied_blocks() << " blocks copied\n";
+    }
+    std::cout << "(checksum " << sink << ")\n";
+}
+
+// A feed thread appends rows in batches of 1000 while query threads visit
+// the whole column: a frame behind one lock against a LiveFrame read
+// through snapshots. Reports the feed's rate and how many queries ran.
+//
+static void bench_live_frame(const std::vector<double> &prices) {
+
+    constexpr std::size_t   batch { 1000 };
+    const std::size_t       n = prices.size();
+    std::vector<std::size_t>    stamps (n);
+    double                  sink { 0 };
+
+    std::iota(stamps.begin(), stamps.end(), std::size_t(0));
+    for (unsigned int tc = 1; tc <= max_bench_threads(); tc *= 2)
+        for (const bool use_live : { false, true }) {
+            using LiveType = LiveFrame<std::size_t, double>;
+
+            LiveType                    live ({ "price" }, n);
+            std::vector<std::size_t>    locked_idx;
+            std::vector<double>         locked_col;
+            std::mutex                  lock;
+            std::atomic<bool>           done { false };
+            std::vector<std::size_t>    queries (tc);
+            std::vector<double>         sinks (tc);
+            const auto                  reader = [&](unsigned int t) {
+                using StatsType =
+                    MergeableStatsVisitor<double, std::size_t>;
+
+                while (! done.load(std::memory_order_relaxed)) {
+                    StatsType   stats;
+
+                    if (use_live)
+                        live.snapshot().visit<double>("price", stats);
+                    else {
+                        const std::lock_guard<std::mutex>   guard { lock };
+
+                        stats.pre();
+                        stats(locked_idx.begin(), locked_idx.end(),
+                              locked_col.begin(), locked_col.end());
+                        stats.post();
+                    }
+                    sinks[t] += double(stats.get_count());
+                    queries[t] += 1;
+                }
+            };
+            std::vector<std::thread>    readers;
+
+            for (unsigned int t = 0; t < tc; ++t)
+                readers.emplace_back(reader, t);
+            const auto  sample = time_it_ns([&]() {
+                for (std::size_t row = 0; row < n; row += batch) {
+                    const std::size_t   m = std::min(batch, n - row);
+
+                    if (use_live)
+                        live.append_rows(m, stamps.data() + row,
+                                         prices.data() + row);
+                    else {
+                        const std::lock_guard<std::mutex>   guard { lock };
+
+                        locked_idx.insert(locked_idx.end(),
+                                          stamps.data() + row,
+                                          stamps.data() + row + m);
+                        locked_col.insert(locked_col.end(),
+                                          prices.data() + row,
+                                          prices.data() + row + m);
+                    }
+                }
+            });
+
+            done = true;
+            for (auto &thr : readers)  thr.join();
+            report(std::string(use_live ? "LiveFrame" : "locked frame") +
+                       " appends, " + std::to_string(tc) +
+                       " reader thread(s)",
+                   n, sample, sizeof(std::size_t) + sizeof(double), tc + 1);
+            std::cout << "    queries/sec: "
+                      << double(std::accumulate(queries.begin(),
+                                                queries.end(),
+                                                std::size_t(0))) /
+                             sample.elapsed_ns * 1e9
+                      << '\n';
+            sink += std::accumulate(sinks.begin(), sinks.end(), 0.0);
+        }
+    std::cout << "(checksum " << sink << ")\n";
+}
+
+static void bench_arena(const std::vector<double> &prices) {
+
+    constexpr std::size_t   queries { 2000 };
+    const std::size_t       window = std::min<std::size_t>(prices.size(),
+                                                           4096);
+    const std::size_t       stride = (prices.size() - window) / queries + 1;
+    double                  sink { 0 };
+
+    for (unsigned int tc = 1; tc <= max_bench_threads(); tc *= 2)
+        for (const bool use_arena : { false, true }) {
+            std::vector<std::vector<double>>    latencies (tc);
+            std::vector<double>                 sinks (tc);
+            const auto                          worker = [&](unsigned int t) {
+                MonotonicArena  arena;
+
+                latencies[t].reserve(queries / tc);
+                for (std::size_t q = t; q < queries; q += tc) {
+                    const std::size_t   begin = q * stride;
+                    const auto          start = bench_clock::now();
+
+                    if (use_arena) {
+                        ArenaScope  scope (arena);
+
+                        sinks[t] += run_query<ArenaVector<double>,
+                                              ArenaVector<std::size_t>>
+                                        (prices, begin, begin + window);
+                    }
+                    else
+                        sinks[t] += run_query<std::vector<double>,
+                                              std::vector<std::size_t>>
+                                        (prices, begin, begin + window);
+                    latencies[t].push_back(
+                        std::chrono::duration<double, std::nano>
+                            (bench_clock::now() - start).count());
+                }
+            };
+
+            report(use_arena ? "query temporaries in a MonotonicArena"
+                             : "query temporaries on the heap",
+                   queries,
+                   time_it_ns([&]() {
+                       std::vector<std::thread>    threads;
+
+                       for (unsigned int t = 1; t < tc; ++t)
+                           threads.emplace_back(worker, t);
+                       worker(0);
+                       for (auto &thr : threads)  thr.join();
+                   }),
+                   0, tc);
+
+            std::vector<double> all;
+
+            for (unsigned int t = 0; t < tc; ++t) {
+                all.insert(all.end(), latencies[t].begin(),
+                           latencies[t].end());
+                sink += sinks[t];
+            }
+            report_latencies(all);
+        }
+    std::cout << "(checksum " << sink << ")\n";
+}
+
+// ----------------------------------------------------------------------------
+
+static std::vector<double> gen_notionals(std::size_t n) {
+
+    std::mt19937_64                         gen { 123 };
+    std::lognormal_distribution<double>     dist { 10.0, 2.0 };
+    std::vector<double>                     result (n);
+
+    for (auto &v : result)  v = dist(gen);
+    return (result);
+}
+
+// ----------------------------------------------------------------------------
+
+// Runs group(n) for every size, unless a --filter is given that does not
+// match its name
+//
+struct  BenchOptions  {
+
+    std::vector<std::size_t>    sizes { 100000, 1000000, 10000000 };
+    std::string                 filter { };
+    std::string                 json_path { };
+};
+
+template<typename F>
+static void run_group(const BenchOptions &opts, const char *name, F &&group) {
+
+    if (! opts.filter.empty() &&
+        std::string(name).find(opts.filter) == std::string::npos)
+        return;
+    bench_group = name;
+    std::cout << "\n[" << name << "]\n";
+    group();
+}
+
+static BenchOptions parse_options(int argc, char *argv[]) {
+
+    BenchOptions    opts;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string   flag = argv[i];
+
+        if (flag == "--json")
+            opts.json_path = argv[i + 1];
+        else if (flag == "--filter")
+            opts.filter = argv[i + 1];
+        else if (flag == "--sizes") {
+            std::string         list = argv[i + 1];
+            std::size_t         pos { 0 };
+
+            opts.sizes.clear();
+            while (pos < list.size()) {
+                const std::size_t   comma =
+                    std::min(list.find(',', pos), list.size());
+
+                opts.sizes.push_back(
+                    std::stoul(list.substr(pos, comma - pos)));
+                pos = comma + 1;
+            }
+        }
+        else
+            throw std::invalid_argument("Unknown option " + flag);
+    }
+    return (opts);
+}
+
+// ----------------------------------------------------------------------------
+
+// Usage: benchmarks [--sizes 100000,1000000] [--filter group]
+//                   [--json results.json]
+//
+// Every measurement is printed as it is taken. With --json, they are also
+// written to a file, one object per measurement, so two runs can be
+// compared.
+//
+int main(int argc, char *argv[]) {
+
+    const BenchOptions  opts = parse_options(argc, argv);
+
+    for (const std::size_t n : opts.sizes) {
+        const auto  notionals = gen_notionals(n);
+
+        run_group(opts, "priority_queue", [&]() {
+            bench_priority_queue<10>(notionals);
+            bench_priority_queue<100>(notionals);
+            bench_priority_queue<1000>(notionals);
+            bench_priority_queue<10000>(notionals);
+        });
+        run_group(opts, "sharded_top_k", [&]() {
+            bench_sharded_top_k<100>(notionals);
+            bench_sharded_top_k<1000>(notionals);
+        });
+        run_group(opts, "vector_view",
+                  [&]() { bench_vector_view(notionals); });
+        run_group(opts, "select_views",
+                  [&]() { bench_select_views(notionals); });
+        run_group(opts, "rand_gen", [&]() { bench_rand_gen(n); });
+        run_group(opts, "mc_paths", [&]() { bench_mc_paths(n); });
+        run_group(opts, "incremental_visitors",
+                  [&]() { bench_incremental_visitors(n); });
+        run_group(opts, "simd_kernels", [&]() { bench_simd_kernels(n); });
+        run_group(opts, "parallel_visit",
+                  [&]() { bench_parallel_visit(notionals); });
+        run_group(opts, "column_index",
+                  [&]() { bench_column_index(notionals); });
+        run_group(opts, "asof_join", [&]() { bench_asof_join(n); });
+        run_group(opts, "compressed_columns",
+                  [&]() { bench_compressed_columns(n); });
+        run_group(opts, "lazy_query",
+                  [&]() { bench_lazy_query(notionals); });
+        run_group(opts, "instrumentation",
+                  [&]() { bench_instrumentation(n); });
+        run_group(opts, "retype", [&]() { bench_retype(n); });
+        run_group(opts, "align_column", [&]() { bench_align_column(n); });
+        run_group(opts, "arena", [&]() { bench_arena(notionals); });
+        run_group(opts, "cow_frame",
+                  [&]() { bench_cow_frame(notionals); });
+        run_group(opts, "live_frame",
+                  [&]() { bench_live_frame(notionals); });
+        run_group(opts, "category_column",
+                  [&]() { bench_category_column(notionals); });
+        run_group(opts, "columnar_file",
+                  [&]() { bench_columnar_file(notionals); });
+        run_group(opts, "csv_ingest", [&]() { bench_csv_ingest(n); });
+        if (n <= 1000000)  // 32 columns, copied, of more rows won't fit
+            run_group(opts, "reindex",
+                      [&]() { bench_lazy_reindex(notionals); });
+    }
+    if (! opts.json_path.empty()) {
+        std::ofstream   stream (opts.json_path);
+
+        write_json(stream);
+    }
+    return (0);
+}
\ No newline at end of file
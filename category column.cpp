@@ -0,0 +1,229 @@
+#pragma once
+
+#include <DataFrame/DataFrame.h>
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace hmdf
+{
+
+// Dictionary-encoded (categorical) string columns.
+//
+// A column of symbols or venue codes has a few thousand distinct values
+// over many rows. Stored as std::vector<CategoryCode>, each row is a 4 byte
+// code into a StringDictionary that the columns share, instead of a 32 byte
+// std::string. Reindexing, copying, equality and hashing work on the codes
+// and never touch the strings.
+//
+// CategoryCode orders by code, which is the order the strings were first
+// seen. StringDictionary::lexical_less() gives the string order.
+//
+// A default constructed CategoryCode is null. It is what padding fills a
+// column with, and it decodes to an empty string.
+//
+struct  CategoryCode  {
+
+    using code_type = std::uint32_t;
+
+    static constexpr code_type  null_code { ~code_type(0) };
+
+    code_type   code { null_code };
+
+    [[nodiscard]] inline bool
+    is_null() const noexcept  { return (code == null_code); }
+
+    friend auto
+    operator <=> (const CategoryCode &, const CategoryCode &) = default;
+};
+
+inline std::ostream &
+operator << (std::ostream &stream, const CategoryCode &value)  {
+
+    return (stream << value.code);
+}
+
+// ----------------------------------------------------------------------------
+
+// Distinct strings and their codes. Codes are handed out in order, from 0.
+// Interning is not thread-safe. Lookups are, while nothing is interned.
+//
+class   StringDictionary  {
+
+public:
+
+    using size_type = std::size_t;
+    using code_type = CategoryCode::code_type;
+
+    // The code for str, adding it if it is new
+    //
+    CategoryCode intern(std::string_view str)  {
+
+        const auto  iter = codes_.find(str);
+
+        if (iter != codes_.end())  return (CategoryCode { iter->second });
+        if (strings_.size() >= CategoryCode::null_code)
+            throw NotFeasible("StringDictionary::intern(): "
+                              "Too many distinct strings");
+
+        const code_type code = code_type(strings_.size());
+
+        strings_.emplace_back(str);
+        codes_.emplace(strings_.back(), code);
+        return (CategoryCode { code });
+    }
+
+    // The code for str, or null if it was never interned
+    //
+    [[nodiscard]] CategoryCode find(std::string_view str) const  {
+
+        const auto  iter = codes_.find(str);
+
+        return (iter != codes_.end() ? CategoryCode { iter->second }
+                                     : CategoryCode { });
+    }
+
+    [[nodiscard]] const std::string &decode(CategoryCode value) const  {
+
+        static const std::string    null_str { };
+
+        return (value.is_null() ? null_str : strings_.at(value.code));
+    }
+
+    [[nodiscard]] size_type
+    size() const noexcept  { return (strings_.size()); }
+
+    // Heap bytes held, for footprint reports
+    //
+    [[nodiscard]] size_type memory_bytes() const noexcept  {
+
+        size_type   bytes = strings_.size() * sizeof(std::string) +
+                            codes_.size() * (sizeof(std::string_view) +
+                                             sizeof(code_type) +
+                                             2 * sizeof(void *)) +
+                            codes_.bucket_count() * sizeof(void *);
+
+        for (const auto &str : strings_)
+            if (str.capacity() > std::string().capacity())
+                bytes += str.capacity() + 1;
+        return (bytes);
+    }
+
+    // A comparator that orders codes by their strings. Null comes first.
+    // It holds a snapshot of the ranks, so intern after making it is not
+    // reflected.
+    //
+    [[nodiscard]] auto lexical_less() const  {
+
+        std::vector<code_type>  order (strings_.size());
+        std::vector<code_type>  ranks (strings_.size());
+
+        std::iota(order.begin(), order.end(), code_type(0));
+        std::sort(order.begin(), order.end(),
+                  [this](code_type lhs, code_type rhs)  {
+                      return (strings_[lhs] < strings_[rhs]);
+                  });
+        for (code_type r = 0; r < order.size(); ++r)
+            ranks[order[r]] = r;
+
+        return ([ranks = std::move(ranks)](CategoryCode lhs,
+                                           CategoryCode rhs)  {
+            if (lhs.is_null() || rhs.is_null())
+                return (lhs.is_null() && ! rhs.is_null());
+            return (ranks[lhs.code] < ranks[rhs.code]);
+        });
+    }
+
+private:
+
+    // std::deque keeps the strings in place, so the keys can view them
+    //
+    std::deque<std::string>                             strings_ { };
+    std::unordered_map<std::string_view, code_type>     codes_ { };
+};
+
+using StringDictionaryPtr = std::shared_ptr<StringDictionary>;
+
+// ----------------------------------------------------------------------------
+
+template<typename V>
+[[nodiscard]] inline std::vector<CategoryCode>
+encode_column(const V &strings, StringDictionary &dict)  {
+
+    std::vector<CategoryCode>   result;
+
+    result.reserve(strings.size());
+    for (const auto &str : strings)
+        result.push_back(dict.intern(str));
+    return (result);
+}
+
+template<typename V>
+[[nodiscard]] inline std::vector<std::string>
+decode_column(const V &codes, const StringDictionary &dict)  {
+
+    std::vector<std::string>    result;
+
+    result.reserve(codes.size());
+    for (const auto code : codes)
+        result.push_back(dict.decode(code));
+    return (result);
+}
+
+// Converters for df.retype_column<std::string, CategoryCode>(name,
+// category_encoder(dict)) and back with category_decoder(dict)
+//
+[[nodiscard]] inline std::function<CategoryCode(const std::string &)>
+category_encoder(StringDictionaryPtr dict)  {
+
+    return ([dict = std::move(dict)](const std::string &str)  {
+        return (dict->intern(str));
+    });
+}
+
+[[nodiscard]] inline std::function<std::string(const CategoryCode &)>
+category_decoder(StringDictionaryPtr dict)  {
+
+    return ([dict = std::move(dict)](const CategoryCode &value)  {
+        return (dict->decode(value));
+    });
+}
+
+// Loads strings into df as a dictionary-encoded column named name
+//
+template<typename DF, typename V>
+inline void
+load_category_column(DF &df,
+                     const char *name,
+                     const V &strings,
+                     StringDictionary &dict,
+                     nan_policy padding = nan_policy::pad_with_nans)  {
+
+    df.load_column(name, encode_column(strings, dict), padding);
+}
+
+}
+
+// ----------------------------------------------------------------------------
+
+template<>
+struct  std::hash<hmdf::CategoryCode>  {
+
+    [[nodiscard]] inline std::size_t
+    operator () (const hmdf::CategoryCode &value) const noexcept  {
+
+        return (std::hash<hmdf::CategoryCode::code_type> { }(value.code));
+    }
+};
@@ -0,0 +1,655 @@
+#pragma once
+
+#include <DataFrame/DataFrame.h>
+#include <DataFrame/Utils/Instrumentation.h>
+#include <DataFrame/Vectors/VectorSelectView.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace hmdf
+{
+
+// Secondary indices for looking up rows by value.
+//
+// A DataFrame index is not required to be sorted or unique, so finding the
+// rows with a given timestamp or order ID is a scan of the whole column.
+// These answer the same questions from a structure built once:
+//
+//   HashColumnIndex:   value -> rows, O(1) point lookups
+//   SortedColumnIndex: the rows sorted by value, O(log n) point and range
+//                      lookups
+//
+// Lookups return row positions, in increasing order, that can be handed to
+// make_indexed_view() to read any column of the frame at those rows.
+//
+// An index is a snapshot of the column it was built on. IndexedFrame owns a
+// frame and its indices and keeps them in step: load_data(), load_index(),
+// load_column() and remove_column() rebuild or drop the indices they
+// affect, and get_reindexed() carries them over to the new frame.
+//
+// NaN rows of floating point columns are not indexed, since NaN never
+// equals anything.
+//
+using column_row_type = RowSelection::value_type;
+
+enum class  column_index_type : unsigned char  {
+    hash = 1,
+    sorted = 2,
+};
+
+template<typename T>
+[[nodiscard]] inline bool _index_skips_(const T &value) noexcept  {
+
+    if constexpr (std::is_floating_point_v<T>)
+        return (value != value);
+    else
+        return (false);
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+class   HashColumnIndex  {
+
+public:
+
+    using value_type = T;
+    using row_type = column_row_type;
+    using size_type = std::size_t;
+
+    HashColumnIndex() = default;
+    template<typename V>
+    explicit HashColumnIndex(const V &column)  { build(column); }
+
+    // The rows of each value are stored back to back, in row order, in one
+    // array. The map holds where each value's rows start and end.
+    //
+    template<typename V>
+    void build(const V &column)  {
+
+        const size_type col_s = column.size();
+
+        slots_.clear();
+        for (size_type r = 0; r < col_s; ++r)
+            if (! _index_skips_(column[r]))
+                slots_[column[r]].second += 1;
+
+        row_type    offset { 0 };
+
+        for (auto &[value, slot] : slots_)  {
+            slot.first = offset;
+            offset += slot.second;
+            slot.second = slot.first;
+        }
+        rows_.resize(offset);
+        for (size_type r = 0; r < col_s; ++r)
+            if (! _index_skips_(column[r]))
+                rows_[slots_.find(column[r])->second.second++] = r;
+        column_size_ = col_s;
+    }
+
+    [[nodiscard]] std::span<const row_type>
+    find(const T &value) const  {
+
+        const auto  iter = slots_.find(value);
+
+        if (iter == slots_.end())  return { };
+        return (std::span<const row_type>(rows_.data() + iter->second.first,
+                                          iter->second.second -
+                                              iter->second.first));
+    }
+
+    [[nodiscard]] size_type
+    count(const T &value) const  { return (find(value).size()); }
+    [[nodiscard]] bool
+    contains(const T &value) const  { return (slots_.contains(value)); }
+
+    // Calls func(value, rows) for each distinct value, in no set order
+    //
+    template<typename F>
+    void for_each(F &&func) const  {
+
+        for (const auto &[value, slot] : slots_)
+            func(value,
+                 std::span<const row_type>(rows_.data() + slot.first,
+                                           slot.second - slot.first));
+    }
+
+    // Distinct values and rows indexed, and the rows of the column
+    //
+    [[nodiscard]] size_type
+    distinct_count() const noexcept  { return (slots_.size()); }
+    [[nodiscard]] size_type
+    size() const noexcept  { return (rows_.size()); }
+    [[nodiscard]] size_type
+    column_size() const noexcept  { return (column_size_); }
+
+    [[nodiscard]] size_type memory_bytes() const noexcept  {
+
+        return (rows_.capacity() * sizeof(row_type) +
+                slots_.size() * (sizeof(T) + 2 * sizeof(row_type) +
+                                 2 * sizeof(void *)) +
+                slots_.bucket_count() * sizeof(void *));
+    }
+
+private:
+
+    using slot_map_ = std::unordered_map<T, std::pair<row_type, row_type>>;
+
+    slot_map_               slots_ { };
+    std::vector<row_type>   rows_ { };
+    size_type               column_size_ { 0 };
+};
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+class   SortedColumnIndex  {
+
+public:
+
+    using value_type = T;
+    using row_type = column_row_type;
+    using size_type = std::size_t;
+
+    SortedColumnIndex() = default;
+    template<typename V>
+    explicit SortedColumnIndex(const V &column)  { build(column); }
+
+    // A stable sort of the rows by value, so equal values keep their row
+    // order. The sorted values are kept next to it for the binary search.
+    //
+    template<typename V>
+    void build(const V &column)  {
+
+        const size_type col_s = column.size();
+
+        rows_.clear();
+        rows_.reserve(col_s);
+        for (size_type r = 0; r < col_s; ++r)
+            if (! _index_skips_(column[r]))
+                rows_.push_back(r);
+        std::stable_sort(rows_.begin(), rows_.end(),
+                         [&column](row_type lhs, row_type rhs)  {
+                             return (column[lhs] < column[rhs]);
+                         });
+        values_.clear();
+        values_.reserve(rows_.size());
+        for (const auto r : rows_)
+            values_.push_back(column[r]);
+        column_size_ = col_s;
+    }
+
+    [[nodiscard]] std::span<const row_type>
+    find(const T &value) const  {
+
+        const auto  [first, last] =
+            std::equal_range(values_.begin(), values_.end(), value);
+
+        return (span_(first, last));
+    }
+
+    // Rows with lo <= value < hi, in value order. select_range() gives them
+    // in row order.
+    //
+    [[nodiscard]] std::span<const row_type>
+    range(const T &lo, const T &hi) const  {
+
+        const auto  first =
+            std::lower_bound(values_.begin(), values_.end(), lo);
+        const auto  last = std::lower_bound(first, values_.end(), hi);
+
+        return (span_(first, last));
+    }
+
+    [[nodiscard]] RowSelectionPtr
+    select_range(const T &lo, const T &hi) const  {
+
+        const auto  rows = range(lo, hi);
+        auto        result =
+            std::make_shared<RowSelection>(rows.begin(), rows.end());
+
+        std::sort(result->begin(), result->end());
+        return (result);
+    }
+
+    [[nodiscard]] size_type
+    count(const T &value) const  { return (find(value).size()); }
+    [[nodiscard]] bool
+    contains(const T &value) const  { return (! find(value).empty()); }
+
+    // The smallest and largest values indexed. The index must not be empty.
+    //
+    [[nodiscard]] const T &
+    min_value() const  { return (values_.front()); }
+    [[nodiscard]] const T &
+    max_value() const  { return (values_.back()); }
+
+    [[nodiscard]] size_type
+    size() const noexcept  { return (rows_.size()); }
+    [[nodiscard]] size_type
+    column_size() const noexcept  { return (column_size_); }
+
+    [[nodiscard]] size_type memory_bytes() const noexcept  {
+
+        return (rows_.capacity() * sizeof(row_type) +
+                values_.capacity() * sizeof(T));
+    }
+
+private:
+
+    using citer_ = typename std::vector<T>::const_iterator;
+
+    [[nodiscard]] std::span<const row_type>
+    span_(citer_ first, citer_ last) const noexcept  {
+
+        return (std::span<const row_type>(
+                    rows_.data() + (first - values_.begin()),
+                    size_type(last - first)));
+    }
+
+    std::vector<row_type>   rows_ { };
+    std::vector<T>          values_ { };
+    size_type               column_size_ { 0 };
+};
+
+// ----------------------------------------------------------------------------
+
+// A frame and the secondary indices on it. The frame is only handed out as
+// const, so it cannot change behind the indices' back.
+//
+template<typename DF>
+class   IndexedFrame  {
+
+public:
+
+    using DataFrameType = DF;
+    using IndexType = typename DF::IndexType;
+    using row_type = column_row_type;
+    using size_type = std::size_t;
+
+    IndexedFrame() = default;
+    explicit IndexedFrame(DF &&df) : df_(std::move(df))  {   }
+
+    [[nodiscard]] const DF &frame() const noexcept  { return (df_); }
+
+    // Gives the frame up, with its indices dropped
+    //
+    [[nodiscard]] DF release()  {
+
+        indices_.clear();
+        index_on_index_.reset();
+        return (std::move(df_));
+    }
+
+    // Indexing
+    //
+    void index_on_index(column_index_type type = column_index_type::hash)  {
+
+        index_on_index_ = make_entry_<IndexType>(type);
+        index_on_index_->build(df_.get_index());
+    }
+
+    template<typename T>
+    void index_on_column(const char *name,
+                         column_index_type type = column_index_type::hash)  {
+
+        Entry_  entry = make_entry_<T>(type);
+
+        entry.build(df_.template get_column<T>(name));
+        indices_.insert_or_assign(name, std::move(entry));
+    }
+
+    void drop_index_on_index() noexcept  { index_on_index_.reset(); }
+    void drop_index(const char *name)  { indices_.erase(name); }
+
+    [[nodiscard]] bool
+    has_index_on_index() const noexcept  { return (bool(index_on_index_)); }
+    [[nodiscard]] bool has_index(const char *name) const  {
+
+        return (indices_.contains(name));
+    }
+
+    // Loading keeps the indices current
+    //
+    template<typename ... Ts>
+    void load_data(typename DF::IndexVecType &&idx, Ts ... columns)  {
+
+        df_.load_data(std::move(idx), std::move(columns) ...);
+        if (index_on_index_)  index_on_index_->build(df_.get_index());
+        for (auto &[name, entry] : indices_)
+            entry.rebuild(df_, name.c_str());
+    }
+
+    void load_index(typename DF::IndexVecType &&idx)  {
+
+        df_.load_index(std::move(idx));
+        if (index_on_index_)  index_on_index_->build(df_.get_index());
+    }
+
+    template<typename T>
+    void load_column(const char *name,
+                     std::vector<T> &&column,
+                     nan_policy padding = nan_policy::pad_with_nans)  {
+
+        df_.load_column(name, std::move(column), padding);
+
+        const auto  iter = indices_.find(name);
+
+        if (iter != indices_.end())
+            iter->second.rebuild(df_, name);
+    }
+
+    template<typename T>
+    void remove_column(const char *name)  {
+
+        df_.template remove_column<T>(name);
+        indices_.erase(name);
+    }
+
+    // get_reindexed() of the frame, with the indices carried over. The old
+    // index's index moves to column old_index_name, unless that is null,
+    // and the index of col_to_be_index, if any, becomes the new frame's
+    // index on index.
+    //
+    template<typename I2, typename ... Ts>
+    [[nodiscard]] auto get_reindexed(const char *col_to_be_index,
+                                     const char *old_index_name) const  {
+
+        using NewFrame = decltype(df_.template get_reindexed<I2, Ts ...>(
+                                      col_to_be_index, old_index_name));
+
+        HMDF_INSTRUMENT_OP(scope, "indexed_get_reindexed");
+
+        scope.add_rows(df_.get_index().size());
+
+        IndexedFrame<NewFrame>  result (
+            df_.template get_reindexed<I2, Ts ...>(col_to_be_index,
+                                                    old_index_name));
+
+        if (index_on_index_ && old_index_name)
+            result.template index_on_column<IndexType>(
+                old_index_name, index_on_index_->type);
+        for (const auto &[name, entry] : indices_)  {
+            if (name == col_to_be_index)
+                result.index_on_index(entry.type);
+            else
+                (entry.template carry_over<Ts>(result, name.c_str()) || ...);
+        }
+        return (result);
+    }
+
+    // Lookups. Without an index they scan the column.
+    //
+    [[nodiscard]] RowSelectionPtr
+    find_rows_by_index(const IndexType &value) const  {
+
+        if (index_on_index_)
+            return (index_on_index_->template find<IndexType>(value));
+        return (scan_(df_.get_index(), value));
+    }
+
+    template<typename T>
+    [[nodiscard]] RowSelectionPtr
+    find_rows(const char *name, const T &value) const  {
+
+        const auto  iter = indices_.find(name);
+
+        if (iter != indices_.end())
+            return (iter->second.template find<T>(value));
+        return (scan_(df_.template get_column<T>(name), value));
+    }
+
+    // Rows with lo <= value < hi, in row order. Only a sorted index helps.
+    //
+    [[nodiscard]] RowSelectionPtr
+    find_rows_in_range_by_index(const IndexType &lo,
+                                const IndexType &hi) const  {
+
+        if (index_on_index_ &&
+            index_on_index_->type == column_index_type::sorted)
+            return (index_on_index_->template sorted<IndexType>()
+                        .select_range(lo, hi));
+        return (scan_range_(df_.get_index(), lo, hi));
+    }
+
+    template<typename T>
+    [[nodiscard]] RowSelectionPtr
+    find_rows_in_range(const char *name, const T &lo, const T &hi) const  {
+
+        const auto  iter = indices_.find(name);
+
+        if (iter != indices_.end() &&
+            iter->second.type == column_index_type::sorted)
+            return (iter->second.template sorted<T>().select_range(lo, hi));
+        return (scan_range_(df_.template get_column<T>(name), lo, hi));
+    }
+
+    // Column col of type U at the rows where column name equals value, as
+    // a view that does not copy
+    //
+    template<typename T, typename U>
+    [[nodiscard]] auto get_view_by_value(const char *name,
+                                         const T &value,
+                                         const char *col) const  {
+
+        return (make_indexed_view(df_.template get_column<U>(col),
+                                  find_rows<T>(name, value)));
+    }
+
+    // Inner join of probe against column name: the pairs of rows (probe
+    // row, frame row) with equal values, in probe order
+    //
+    template<typename T, typename V>
+    [[nodiscard]] std::pair<RowSelection, RowSelection>
+    join_rows(const char *name, const V &probe) const  {
+
+        std::pair<RowSelection, RowSelection>   result;
+        const auto                              iter = indices_.find(name);
+
+        if (iter != indices_.end())  {
+            for (size_type p = 0; p < probe.size(); ++p)
+                for (const auto r : iter->second.template span<T>(probe[p]))
+                    add_pair_(result, p, r);
+            return (result);
+        }
+
+        // Without an index, build a throwaway one on the smaller side
+        //
+        const auto  &column = df_.template get_column<T>(name);
+
+        if (probe.size() < column.size())  {
+            const HashColumnIndex<T>    probe_index (probe);
+
+            for (size_type r = 0; r < column.size(); ++r)
+                for (const auto p : probe_index.find(column[r]))
+                    add_pair_(result, p, r);
+            sort_pairs_(result);
+        }
+        else  {
+            const HashColumnIndex<T>    column_index (column);
+
+            for (size_type p = 0; p < probe.size(); ++p)
+                for (const auto r : column_index.find(probe[p]))
+                    add_pair_(result, p, r);
+        }
+        return (result);
+    }
+
+    // The index on a column, to use directly
+    //
+    template<typename T>
+    [[nodiscard]] const HashColumnIndex<T> &
+    get_hash_index(const char *name) const  {
+
+        return (entry_(name).template hash<T>());
+    }
+    template<typename T>
+    [[nodiscard]] const SortedColumnIndex<T> &
+    get_sorted_index(const char *name) const  {
+
+        return (entry_(name).template sorted<T>());
+    }
+
+private:
+
+    // One index, with its type erased. rebuild() rebuilds it from the frame
+    // column of the same name.
+    //
+    struct  Entry_  {
+
+        column_index_type       type;
+        std::type_index         value_type;
+        std::shared_ptr<void>   index;
+        void                    (*rebuild_)(Entry_ &, const DF &,
+                                            const char *);
+
+        template<typename V>
+        void build(const V &column)  {
+
+            using T = typename V::value_type;
+
+            if (type == column_index_type::hash)
+                index = std::make_shared<HashColumnIndex<T>>(column);
+            else
+                index = std::make_shared<SortedColumnIndex<T>>(column);
+        }
+
+        void rebuild(const DF &df, const char *name)  {
+
+            rebuild_(*this, df, name);
+        }
+
+        template<typename T>
+        [[nodiscard]] const HashColumnIndex<T> &hash() const  {
+
+            check_<T>(column_index_type::hash);
+            return (*static_cast<const HashColumnIndex<T> *>(index.get()));
+        }
+        template<typename T>
+        [[nodiscard]] const SortedColumnIndex<T> &sorted() const  {
+
+            check_<T>(column_index_type::sorted);
+            return (*static_cast<const SortedColumnIndex<T> *>(index.get()));
+        }
+
+        template<typename T>
+        [[nodiscard]] std::span<const row_type> span(const T &value) const  {
+
+            return (type == column_index_type::hash
+                        ? hash<T>().find(value) : sorted<T>().find(value));
+        }
+        template<typename T>
+        [[nodiscard]] RowSelectionPtr find(const T &value) const  {
+
+            const auto  rows = span<T>(value);
+
+            return (std::make_shared<RowSelection>(rows.begin(), rows.end()));
+        }
+
+        template<typename T, typename F>
+        bool carry_over(F &result, const char *name) const  {
+
+            if (value_type != std::type_index(typeid(T)))  return (false);
+            result.template index_on_column<T>(name, type);
+            return (true);
+        }
+
+        template<typename T>
+        void check_(column_index_type expected) const  {
+
+            if (type != expected || value_type != std::type_index(typeid(T)))
+                throw DataFrameError("IndexedFrame: Index type mismatch");
+        }
+    };
+
+    template<typename T>
+    [[nodiscard]] static Entry_ make_entry_(column_index_type type)  {
+
+        return (Entry_ {
+            type, std::type_index(typeid(T)), nullptr,
+            [](Entry_ &entry, const DF &df, const char *name)  {
+                entry.build(df.template get_column<T>(name));
+            }
+        });
+    }
+
+    [[nodiscard]] const Entry_ &entry_(const char *name) const  {
+
+        const auto  iter = indices_.find(name);
+
+        if (iter == indices_.end())
+            throw ColNotFound(std::string("IndexedFrame: No index on ") +
+                              name);
+        return (iter->second);
+    }
+
+    template<typename V, typename T>
+    [[nodiscard]] static RowSelectionPtr
+    scan_(const V &column, const T &value)  {
+
+        auto    rows = std::make_shared<RowSelection>();
+
+        for (size_type r = 0; r < column.size(); ++r)
+            if (column[r] == value)  rows->push_back(r);
+        return (rows);
+    }
+
+    template<typename V, typename T>
+    [[nodiscard]] static RowSelectionPtr
+    scan_range_(const V &column, const T &lo, const T &hi)  {
+
+        auto    rows = std::make_shared<RowSelection>();
+
+        for (size_type r = 0; r < column.size(); ++r)
+            if (! (column[r] < lo) && column[r] < hi)
+                rows->push_back(r);
+        return (rows);
+    }
+
+    static void add_pair_(std::pair<RowSelection, RowSelection> &pairs,
+                          row_type probe_row,
+                          row_type frame_row)  {
+
+        pairs.first.push_back(probe_row);
+        pairs.second.push_back(frame_row);
+    }
+
+    static void sort_pairs_(std::pair<RowSelection, RowSelection> &pairs)  {
+
+        std::vector<size_type>  order (pairs.first.size());
+        RowSelection            first (order.size());
+        RowSelection            second (order.size());
+
+        std::iota(order.begin(), order.end(), size_type(0));
+        std::stable_sort(order.begin(), order.end(),
+                         [&pairs](size_type lhs, size_type rhs)  {
+                             return (pairs.first[lhs] < pairs.first[rhs]);
+                         });
+        for (size_type i = 0; i < order.size(); ++i)  {
+            first[i] = pairs.first[order[i]];
+            second[i] = pairs.second[order[i]];
+        }
+        pairs.first = std::move(first);
+        pairs.second = std::move(second);
+    }
+
+    DF                                          df_ { };
+    std::map<std::string, Entry_, std::less<>>  indices_ { };
+    std::optional<Entry_>                       index_on_index_ { };
+};
+
+}
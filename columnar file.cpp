@@ -0,0 +1,599 @@
+#pragma once
+
+#include <DataFrame/DataFrame.h>
+#include <DataFrame/Utils/Instrumentation.h>
+#include <DataFrame/Vectors/VectorView.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace hmdf
+{
+
+// A binary columnar file a frame can be saved to and opened from without
+// parsing or copying.
+//
+// Layout, all in native byte order:
+//
+//   - A 32 byte header: magic, version, byte order mark, column count and
+//     file size.
+//   - One 80 byte ColumnarColumnMeta per column: name, type, element size,
+//     element count, block offset and block size. The first column is the
+//     index, under the name "INDEX".
+//   - The column blocks, each starting on a columnar_block_align boundary.
+//     An arithmetic column is its elements back to back. A std::string
+//     column is count + 1 uint64_t offsets into the characters that follow
+//     them.
+//
+// ColumnarFile maps the file read-only. Arithmetic columns come back as
+// VectorConstView over the mapping, so opening costs O(columns) and a page
+// is only read from disk when it is first touched. std::string columns are
+// copied out.
+//
+// POSIX only (mmap).
+//
+enum class  ColumnarType : std::uint32_t  {
+    unknown = 0,
+    int8 = 1,
+    int16 = 2,
+    int32 = 3,
+    int64 = 4,
+    uint8 = 5,
+    uint16 = 6,
+    uint32 = 7,
+    uint64 = 8,
+    float32 = 9,
+    float64 = 10,
+    string = 11,
+};
+
+struct  ColumnarFileHeader  {
+
+    char            magic[8];
+    std::uint32_t   version;
+    std::uint32_t   byte_order;
+    std::uint64_t   column_count;
+    std::uint64_t   file_size;
+};
+
+struct  ColumnarColumnMeta  {
+
+    char            name[48];
+    ColumnarType    type;
+    std::uint32_t   elem_size;
+    std::uint64_t   count;
+    std::uint64_t   offset;
+    std::uint64_t   bytes;
+};
+
+static_assert(sizeof(ColumnarFileHeader) == 32);
+static_assert(sizeof(ColumnarColumnMeta) == 80);
+
+inline constexpr char           columnar_magic[8] =
+    { 'H', 'M', 'D', 'F', 'C', 'O', 'L', '\0' };
+inline constexpr std::uint32_t  columnar_version { 1 };
+inline constexpr std::uint32_t  columnar_byte_order { 0x01020304 };
+inline constexpr std::size_t    columnar_block_align { 64 };
+inline constexpr const char     *columnar_index_name { "INDEX" };
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+inline constexpr ColumnarType _columnar_type_() noexcept  {
+
+    if constexpr (std::is_same_v<T, std::string>)
+        return (ColumnarType::string);
+    else if constexpr (std::is_same_v<T, bool>)
+        return (ColumnarType::unknown);
+    else if constexpr (std::is_floating_point_v<T>)
+        return (sizeof(T) == 4 ? ColumnarType::float32
+                : sizeof(T) == 8 ? ColumnarType::float64
+                : ColumnarType::unknown);
+    else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+        return (sizeof(T) == 1 ? ColumnarType::int8
+                : sizeof(T) == 2 ? ColumnarType::int16
+                : sizeof(T) == 4 ? ColumnarType::int32
+                : ColumnarType::int64);
+    else if constexpr (std::is_integral_v<T>)
+        return (sizeof(T) == 1 ? ColumnarType::uint8
+                : sizeof(T) == 2 ? ColumnarType::uint16
+                : sizeof(T) == 4 ? ColumnarType::uint32
+                : ColumnarType::uint64);
+    else
+        return (ColumnarType::unknown);
+}
+
+// Bytes per element of type, 0 for a std::string or an unknown type
+//
+inline constexpr std::uint32_t
+_columnar_elem_size_(ColumnarType type) noexcept  {
+
+    switch (type)  {
+    case ColumnarType::int8: case ColumnarType::uint8:
+        return (1);
+    case ColumnarType::int16: case ColumnarType::uint16:
+        return (2);
+    case ColumnarType::int32: case ColumnarType::uint32:
+    case ColumnarType::float32:
+        return (4);
+    case ColumnarType::int64: case ColumnarType::uint64:
+    case ColumnarType::float64:
+        return (8);
+    default:
+        return (0);
+    }
+}
+
+inline constexpr std::uint64_t
+_columnar_align_up_(std::uint64_t offset) noexcept  {
+
+    return ((offset + columnar_block_align - 1) &
+            ~std::uint64_t(columnar_block_align - 1));
+}
+
+// ----------------------------------------------------------------------------
+
+// Collects columns and writes them out as one columnar file. It only keeps
+// pointers to the added vectors, so they must stay alive and unchanged
+// until write() returns.
+//
+class   ColumnarFileWriter  {
+
+public:
+
+    template<typename I>
+    void add_index(const std::vector<I> &index)  {
+
+        add_column_(columnar_index_name, index);
+    }
+
+    template<typename T>
+    void add_column(const char *name, const std::vector<T> &column)  {
+
+        if (! std::strcmp(name, columnar_index_name))
+            throw NotFeasible("ColumnarFileWriter::add_column(): "
+                              "INDEX is reserved for the index");
+        add_column_(name, column);
+    }
+
+    // Writes to path + ".tmp" first and renames it over path, so readers
+    // never see a half written file
+    //
+    void write(const char *path) const  {
+
+        if (blocks_.empty() ||
+            std::strcmp(blocks_.front().meta.name, columnar_index_name))
+            throw NotFeasible("ColumnarFileWriter::write(): "
+                              "add_index() must be called first");
+
+        std::vector<ColumnarColumnMeta> metas;
+        std::uint64_t                   offset =
+            _columnar_align_up_(sizeof(ColumnarFileHeader) +
+                                blocks_.size() * sizeof(ColumnarColumnMeta));
+
+        metas.reserve(blocks_.size());
+        for (const auto &block : blocks_)  {
+            metas.push_back(block.meta);
+            metas.back().offset = offset;
+            offset = _columnar_align_up_(offset + block.meta.bytes);
+        }
+
+        ColumnarFileHeader  header { };
+
+        std::memcpy(header.magic, columnar_magic, sizeof(header.magic));
+        header.version = columnar_version;
+        header.byte_order = columnar_byte_order;
+        header.column_count = metas.size();
+        header.file_size = offset;
+
+        const std::string   tmp_path = std::string(path) + ".tmp";
+        std::ofstream       stream (tmp_path,
+                                    std::ios::binary | std::ios::trunc);
+
+        if (! stream.good())
+            throw DataFrameError("ColumnarFileWriter::write(): "
+                                 "Unable to open file");
+        stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        stream.write(reinterpret_cast<const char *>(metas.data()),
+                     metas.size() * sizeof(ColumnarColumnMeta));
+        for (std::size_t i = 0; i < blocks_.size(); ++i)  {
+            pad_to_(stream, metas[i].offset);
+            blocks_[i].write(stream);
+        }
+        pad_to_(stream, header.file_size);
+        stream.close();
+        if (! stream.good() || std::rename(tmp_path.c_str(), path))
+            throw DataFrameError("ColumnarFileWriter::write(): "
+                                 "Unable to write file");
+    }
+
+private:
+
+    template<typename T>
+    void add_column_(const char *name, const std::vector<T> &column)  {
+
+        static_assert(_columnar_type_<T>() != ColumnarType::unknown,
+                      "ColumnarFileWriter stores arithmetic and std::string "
+                      "columns only");
+
+        ColumnarColumnMeta  meta { };
+
+        if (std::strlen(name) >= sizeof(meta.name))
+            throw NotFeasible("ColumnarFileWriter: Column name is too long");
+        for (const auto &block : blocks_)
+            if (! std::strcmp(block.meta.name, name))
+                throw NotFeasible("ColumnarFileWriter: Duplicate column");
+
+        std::strcpy(meta.name, name);
+        meta.type = _columnar_type_<T>();
+        meta.count = column.size();
+
+        if constexpr (std::is_same_v<T, std::string>)  {
+            std::uint64_t   chars { 0 };
+
+            for (const auto &str : column)  chars += str.size();
+            meta.elem_size = 0;
+            meta.bytes = (column.size() + 1) * sizeof(std::uint64_t) + chars;
+            blocks_.push_back({ meta, [&column](std::ostream &stream)  {
+                std::vector<std::uint64_t>  offsets;
+                std::uint64_t               pos { 0 };
+
+                offsets.reserve(column.size() + 1);
+                for (const auto &str : column)  {
+                    offsets.push_back(pos);
+                    pos += str.size();
+                }
+                offsets.push_back(pos);
+                stream.write(reinterpret_cast<const char *>(offsets.data()),
+                             offsets.size() * sizeof(std::uint64_t));
+                for (const auto &str : column)
+                    stream.write(str.data(), str.size());
+            } });
+        }
+        else  {
+            meta.elem_size = sizeof(T);
+            meta.bytes = column.size() * sizeof(T);
+            blocks_.push_back({ meta, [&column](std::ostream &stream)  {
+                stream.write(reinterpret_cast<const char *>(column.data()),
+                             column.size() * sizeof(T));
+            } });
+        }
+    }
+
+    static void pad_to_(std::ostream &stream, std::uint64_t offset)  {
+
+        static constexpr char   zeros[columnar_block_align] = { };
+        const std::uint64_t     pos = std::uint64_t(stream.tellp());
+
+        stream.write(zeros, std::streamsize(offset - pos));
+    }
+
+    struct  Block_  {
+
+        ColumnarColumnMeta                  meta;
+        std::function<void(std::ostream &)> write;
+    };
+
+    std::vector<Block_> blocks_ { };
+};
+
+// ----------------------------------------------------------------------------
+
+// A columnar file mapped read-only into memory. Views handed out point into
+// the mapping and are valid as long as this object is.
+//
+class   ColumnarFile  {
+
+public:
+
+    using size_type = std::size_t;
+
+    ColumnarFile() = default;
+    ColumnarFile(const ColumnarFile &) = delete;
+    ColumnarFile &operator = (const ColumnarFile &) = delete;
+    ColumnarFile(ColumnarFile &&that) noexcept  { swap_(that); }
+    ColumnarFile &operator = (ColumnarFile &&that) noexcept  {
+
+        if (this != &that)  {
+            close();
+            swap_(that);
+        }
+        return (*this);
+    }
+    ~ColumnarFile()  { close(); }
+
+    explicit ColumnarFile(const char *path)  { open(path); }
+
+    // Maps the file and checks its header and column metadata. No column
+    // data is read.
+    //
+    void open(const char *path)  {
+
+        close();
+
+        const int   fd = ::open(path, O_RDONLY);
+
+        if (fd < 0)
+            throw DataFrameError("ColumnarFile::open(): Unable to open file");
+
+        struct stat st;
+
+        if (::fstat(fd, &st) ||
+            size_type(st.st_size) < sizeof(ColumnarFileHeader))  {
+            ::close(fd);
+            throw DataFrameError("ColumnarFile::open(): Not a columnar file");
+        }
+
+        void    *base =
+            ::mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+        ::close(fd);
+        if (base == MAP_FAILED)
+            throw DataFrameError("ColumnarFile::open(): Unable to map file");
+        base_ = static_cast<const char *>(base);
+        size_ = size_type(st.st_size);
+
+        try  { read_schema_(); }
+        catch (...)  {
+            close();
+            throw;
+        }
+    }
+
+    void close() noexcept  {
+
+        if (base_)
+            ::munmap(const_cast<char *>(base_), size_);
+        base_ = nullptr;
+        size_ = 0;
+        metas_ = nullptr;
+        columns_.clear();
+    }
+
+    [[nodiscard]] bool
+    is_open() const noexcept  { return (base_ != nullptr); }
+    [[nodiscard]] size_type
+    shape_rows() const noexcept  { return (metas_ ? metas_[0].count : 0); }
+
+    // Number of columns, the index not counted
+    //
+    [[nodiscard]] size_type
+    column_count() const noexcept  { return (columns_.size()); }
+    [[nodiscard]] bool
+    has_column(const char *name) const  {
+
+        return (columns_.find(name) != columns_.end());
+    }
+    [[nodiscard]] const ColumnarColumnMeta &
+    column_meta(const char *name) const  { return (*find_(name)); }
+
+    template<typename I>
+    [[nodiscard]] VectorConstView<I>
+    get_index_view() const  { return (view_<I>(metas_[0])); }
+
+    template<typename T>
+    [[nodiscard]] VectorConstView<T>
+    get_column_view(const char *name) const  {
+
+        return (view_<T>(*find_(name)));
+    }
+
+    // std::string columns cannot be viewed in place, so they are copied out
+    //
+    [[nodiscard]] std::vector<std::string>
+    get_string_column(const char *name) const  {
+
+        const ColumnarColumnMeta    &meta = *find_(name);
+
+        if (meta.type != ColumnarType::string)
+            throw NotFeasible("ColumnarFile::get_string_column(): "
+                              "Not a std::string column");
+
+        const auto  *offsets =
+            reinterpret_cast<const std::uint64_t *>(base_ + meta.offset);
+        const char  *chars =
+            base_ + meta.offset + (meta.count + 1) * sizeof(std::uint64_t);
+        std::vector<std::string>    result;
+
+        result.reserve(meta.count);
+        for (size_type i = 0; i < meta.count; ++i)
+            result.emplace_back(chars + offsets[i],
+                                offsets[i + 1] - offsets[i]);
+        return (result);
+    }
+
+    // Asks the kernel to start reading a column's pages ahead of use
+    //
+    void will_need(const char *name) const  {
+
+        const ColumnarColumnMeta    &meta = *find_(name);
+        const size_type             page = size_type(::sysconf(_SC_PAGESIZE));
+        const size_type             begin = meta.offset & ~(page - 1);
+
+        ::madvise(const_cast<char *>(base_) + begin,
+                  meta.offset + meta.bytes - begin,
+                  MADV_WILLNEED);
+    }
+
+    // Copies the file into df, for code that needs a real frame. Columns
+    // whose type is not among Ts are skipped.
+    //
+    template<typename ... Ts, typename DF>
+    void load_into(DF &df) const  {
+
+        using IndexType = typename DF::IndexType;
+
+        HMDF_INSTRUMENT_OP(scope, "columnar_load_into");
+
+        const auto  idx = get_index_view<IndexType>();
+
+        df.load_index(std::vector<IndexType>(idx.begin(), idx.end()));
+        scope.add_rows(idx.size());
+        scope.add_bytes(idx.size() * sizeof(IndexType));
+        for (const auto &[name, meta] : columns_)
+            if ((load_if_<Ts>(df, name.c_str(), *meta) || ...))
+                scope.add_bytes(meta->bytes);
+    }
+
+private:
+
+    void read_schema_()  {
+
+        ColumnarFileHeader  header;
+
+        std::memcpy(&header, base_, sizeof(header));
+        if (std::memcmp(header.magic, columnar_magic, sizeof(header.magic)))
+            throw DataFrameError("ColumnarFile::open(): Not a columnar file");
+        if (header.version != columnar_version ||
+            header.byte_order != columnar_byte_order)
+            throw DataFrameError("ColumnarFile::open(): "
+                                 "Unsupported version or byte order");
+        if (header.file_size != size_ || header.column_count == 0 ||
+            header.column_count > (size_ - sizeof(header)) /
+                                  sizeof(ColumnarColumnMeta))
+            throw DataFrameError("ColumnarFile::open(): Truncated file");
+
+        metas_ = reinterpret_cast<const ColumnarColumnMeta *>(
+                     base_ + sizeof(header));
+        for (std::uint64_t c = 0; c < header.column_count; ++c)  {
+            const ColumnarColumnMeta    &meta = metas_[c];
+
+            if (meta.name[sizeof(meta.name) - 1] != '\0' ||
+                meta.offset % columnar_block_align ||
+                meta.offset > size_ || meta.bytes > size_ - meta.offset ||
+                ! good_block_(meta))
+                throw DataFrameError("ColumnarFile::open(): "
+                                     "Bad column metadata");
+            if (c == 0)  {
+                if (std::strcmp(meta.name, columnar_index_name))
+                    throw DataFrameError("ColumnarFile::open(): "
+                                         "The index is missing");
+                continue;
+            }
+            columns_.emplace(meta.name, &meta);
+        }
+    }
+
+    // Whether meta's type is known and its count fits in its block. For a
+    // std::string column, also whether the offsets go up and stay within
+    // the characters, so the views and copies never leave the mapping.
+    //
+    bool good_block_(const ColumnarColumnMeta &meta) const noexcept  {
+
+        if (meta.type == ColumnarType::string)  {
+            if (meta.elem_size != 0 ||
+                meta.count >= meta.bytes / sizeof(std::uint64_t))
+                return (false);
+
+            const auto          *offsets =
+                reinterpret_cast<const std::uint64_t *>(base_ + meta.offset);
+            const std::uint64_t chars =
+                meta.bytes - (meta.count + 1) * sizeof(std::uint64_t);
+
+            for (std::uint64_t i = 0; i < meta.count; ++i)
+                if (offsets[i] > offsets[i + 1])  return (false);
+            return (offsets[meta.count] <= chars);
+        }
+
+        const std::uint32_t elem_size = _columnar_elem_size_(meta.type);
+
+        return (elem_size != 0 && meta.elem_size == elem_size &&
+                meta.count <= meta.bytes / elem_size);
+    }
+
+    const ColumnarColumnMeta *find_(const char *name) const  {
+
+        const auto  iter = columns_.find(name);
+
+        if (iter == columns_.end())
+            throw ColNotFound(std::string("ColumnarFile: ") + name);
+        return (iter->second);
+    }
+
+    template<typename T>
+    VectorConstView<T> view_(const ColumnarColumnMeta &meta) const  {
+
+        if (meta.type != _columnar_type_<T>() ||
+            meta.type == ColumnarType::string)
+            throw NotFeasible("ColumnarFile: Column type does not match");
+
+        const T *data = reinterpret_cast<const T *>(base_ + meta.offset);
+
+        return (VectorConstView<T>(data, data + meta.count));
+    }
+
+    template<typename T, typename DF>
+    bool load_if_(DF &df,
+                  const char *name,
+                  const ColumnarColumnMeta &meta) const  {
+
+        if (meta.type != _columnar_type_<T>())  return (false);
+        if constexpr (std::is_same_v<T, std::string>)
+            df.load_column(name, get_string_column(name),
+                           nan_policy::dont_pad_with_nans);
+        else  {
+            const auto  col = view_<T>(meta);
+
+            df.load_column(name, std::vector<T>(col.begin(), col.end()),
+                           nan_policy::dont_pad_with_nans);
+        }
+        return (true);
+    }
+
+    void swap_(ColumnarFile &that) noexcept  {
+
+        std::swap(base_, that.base_);
+        std::swap(size_, that.size_);
+        std::swap(metas_, that.metas_);
+        columns_.swap(that.columns_);
+    }
+
+    using ColumnMap =
+        std::unordered_map<std::string, const ColumnarColumnMeta *>;
+
+    const char                  *base_ { nullptr };
+    size_type                   size_ { 0 };
+    const ColumnarColumnMeta    *metas_ { nullptr };
+    ColumnMap                   columns_ { };
+};
+
+// ----------------------------------------------------------------------------
+
+// Saves df's index and every column whose type is among Ts
+//
+template<typename ... Ts, typename DF>
+inline void
+write_columnar_file(const DF &df, const char *path)  {
+
+    ColumnarFileWriter  writer;
+
+    writer.add_index(df.get_index());
+    for (const auto &info : df.template get_columns_info<Ts...>())  {
+        const char  *name = std::get<0>(info).c_str();
+        const auto  &type = std::get<2>(info);
+
+        (void) ((type == std::type_index(typeid(Ts)) &&
+                 (writer.add_column(name,
+                                    df.template get_column<Ts>(name)),
+                  true)) || ...);
+    }
+    writer.write(path);
+}
+
+}
@@ -0,0 +1,648 @@
+#pragma once
+
+#include <DataFrame/DataFrame.h>
+#include <DataFrame/ParallelVisit.h>
+#include <DataFrame/Utils/Instrumentation.h>
+
+#include <algorithm>
+#include <any>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace hmdf
+{
+
+// Compressed in-memory columns, for keeping more days of ticks in RAM.
+//
+//   DeltaForColumn<T>: integral columns such as timestamps. Each block
+//                      keeps its first value and the deltas after it,
+//                      less the block's smallest delta (frame of
+//                      reference), bit packed at the width of the largest.
+//                      A monotonic index with even spacing packs to a few
+//                      bits a row.
+//   GorillaColumn:     double columns. Each value is XOR-ed with the one
+//                      before it and only the bits that differ are kept,
+//                      as in Facebook's Gorilla. Slowly moving prices
+//                      share their sign, exponent and top mantissa bits.
+//
+// Both cut the column into blocks of compressed_block_rows rows that decode
+// on their own, so a scan holds one block at a time in a small buffer and
+// the row at any position is one block decode away.
+//
+// CompressedFrame keeps an index and named columns this way. get_column()
+// decodes a whole column, visit() streams blocks through a visitor and
+// scan() hands out the decoded blocks. Decoding is exact.
+//
+inline constexpr std::size_t    compressed_block_rows { 1024 };
+
+// ----------------------------------------------------------------------------
+
+// Appends and reads back fields of 0 to 64 bits, low bit first
+//
+class   _BitWriter_  {
+
+public:
+
+    explicit _BitWriter_(std::vector<std::uint64_t> &words) : words_(words)  {
+
+        bits_ = words_.size() * 64;
+    }
+
+    [[nodiscard]] std::size_t position() const noexcept  { return (bits_); }
+
+    void write(std::uint64_t value, unsigned int width)  {
+
+        if (width == 0)  return;
+        if (width < 64)  value &= (std::uint64_t(1) << width) - 1;
+
+        const unsigned int  shift = unsigned(bits_ & 63);
+
+        if (shift == 0)  words_.push_back(value);
+        else  {
+            words_.back() |= value << shift;
+            if (shift + width > 64)  words_.push_back(value >> (64 - shift));
+        }
+        bits_ += width;
+    }
+
+private:
+
+    std::vector<std::uint64_t>  &words_;
+    std::size_t                 bits_;
+};
+
+class   _BitReader_  {
+
+public:
+
+    _BitReader_(const std::uint64_t *words, std::size_t position) noexcept
+        : words_(words), bits_(position)  {   }
+
+    [[nodiscard]] inline std::uint64_t read(unsigned int width) noexcept  {
+
+        if (width == 0)  return (0);
+
+        const std::size_t   word = bits_ >> 6;
+        const unsigned int  shift = unsigned(bits_ & 63);
+        std::uint64_t       value = words_[word] >> shift;
+
+        if (shift + width > 64)  value |= words_[word + 1] << (64 - shift);
+        bits_ += width;
+        return (width < 64 ? value & ((std::uint64_t(1) << width) - 1)
+                           : value);
+    }
+    // The next 64 bits, without moving past them
+    //
+    [[nodiscard]] inline std::uint64_t peek() const noexcept  {
+
+        const std::size_t   word = bits_ >> 6;
+        const unsigned int  shift = unsigned(bits_ & 63);
+
+        // Shifting by 1 and then 63 - shift works for shift 0 too
+        //
+        return ((words_[word] >> shift) |
+                ((words_[word + 1] << 1) << (63 - shift)));
+    }
+    inline void skip(unsigned int width) noexcept  { bits_ += width; }
+
+private:
+
+    const std::uint64_t *words_;
+    std::size_t         bits_;
+};
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+class   DeltaForColumn  {
+
+    static_assert(std::is_integral_v<T> && sizeof(T) <= 8,
+                  "DeltaForColumn: T must be integral");
+
+public:
+
+    using value_type = T;
+    using size_type = std::size_t;
+
+    DeltaForColumn() = default;
+    template<typename V>
+    explicit DeltaForColumn(const V &column)  { encode(column); }
+
+    template<typename V>
+    void encode(const V &column)  {
+
+        const size_type col_s = column.size();
+
+        blocks_.clear();
+        words_.clear();
+        size_ = col_s;
+        blocks_.reserve((col_s + compressed_block_rows - 1) /
+                        compressed_block_rows);
+
+        _BitWriter_ writer { words_ };
+
+        for (size_type begin = 0; begin < col_s;
+             begin += compressed_block_rows)  {
+            const size_type end =
+                std::min(col_s, begin + compressed_block_rows);
+            Block_          block { };
+
+            block.first = widen_(column[begin]);
+            block.bit_offset = writer.position();
+
+            std::int64_t    min_delta { 0 };
+            std::uint64_t   max_packed { 0 };
+
+            for (size_type i = begin + 1; i < end; ++i)  {
+                const auto  delta = std::int64_t(widen_(column[i]) -
+                                                 widen_(column[i - 1]));
+
+                if (i == begin + 1 || delta < min_delta)  min_delta = delta;
+            }
+            for (size_type i = begin + 1; i < end; ++i)
+                max_packed = std::max(max_packed,
+                                      widen_(column[i]) -
+                                      widen_(column[i - 1]) -
+                                      std::uint64_t(min_delta));
+            block.min_delta = min_delta;
+            block.width = std::uint8_t(std::bit_width(max_packed));
+            for (size_type i = begin + 1; i < end; ++i)
+                writer.write(widen_(column[i]) - widen_(column[i - 1]) -
+                             std::uint64_t(min_delta),
+                             block.width);
+            blocks_.push_back(block);
+        }
+        // A spare word, so a read never runs off the end
+        //
+        words_.push_back(0);
+        words_.shrink_to_fit();
+    }
+
+    [[nodiscard]] size_type size() const noexcept  { return (size_); }
+    [[nodiscard]] size_type
+    block_count() const noexcept  { return (blocks_.size()); }
+    [[nodiscard]] size_type memory_bytes() const noexcept  {
+
+        return (blocks_.capacity() * sizeof(Block_) +
+                words_.capacity() * sizeof(std::uint64_t));
+    }
+
+    // Decodes block b into out, which must have room for
+    // compressed_block_rows values. Returns the number of rows.
+    //
+    size_type decode_block(size_type b, T *out) const noexcept  {
+
+        const Block_        &block = blocks_[b];
+        const size_type     rows =
+            std::min(compressed_block_rows, size_ - b * compressed_block_rows);
+        const std::uint64_t step = std::uint64_t(block.min_delta);
+        std::uint64_t       value = block.first;
+        _BitReader_         reader { words_.data(), block.bit_offset };
+
+        out[0] = T(value);
+        if (block.width == 0)
+            for (size_type i = 1; i < rows; ++i)  {
+                value += step;
+                out[i] = T(value);
+            }
+        else
+            for (size_type i = 1; i < rows; ++i)  {
+                value += step + reader.read(block.width);
+                out[i] = T(value);
+            }
+        return (rows);
+    }
+
+    [[nodiscard]] T value(size_type row) const  {
+
+        T   buffer[compressed_block_rows];
+
+        if (row >= size_)
+            throw NotFeasible("DeltaForColumn::value(): Row out of range");
+        decode_block(row / compressed_block_rows, buffer);
+        return (buffer[row % compressed_block_rows]);
+    }
+
+private:
+
+    struct  Block_  {
+
+        std::uint64_t   first;
+        std::int64_t    min_delta;
+        std::uint64_t   bit_offset;
+        std::uint8_t    width;
+    };
+
+    // Signed values are sign extended, so the deltas wrap the same way
+    // they do for unsigned ones
+    //
+    static inline std::uint64_t widen_(T value) noexcept  {
+
+        if constexpr (std::is_signed_v<T>)
+            return (std::uint64_t(std::int64_t(value)));
+        else
+            return (std::uint64_t(value));
+    }
+
+    std::vector<Block_>         blocks_ { };
+    std::vector<std::uint64_t>  words_ { };
+    size_type                   size_ { 0 };
+};
+
+// ----------------------------------------------------------------------------
+
+class   GorillaColumn  {
+
+public:
+
+    using value_type = double;
+    using size_type = std::size_t;
+
+    GorillaColumn() = default;
+    template<typename V>
+    explicit GorillaColumn(const V &column)  { encode(column); }
+
+    // After a control bit of 1, a 0 reuses the leading and trailing zero
+    // counts of the last value that changed. A 1 gives new ones: 5 bits of
+    // leading zeros (at most 31) and 6 bits of meaningful bits (64 as 0).
+    //
+    template<typename V>
+    void encode(const V &column)  {
+
+        const size_type col_s = column.size();
+
+        blocks_.clear();
+        words_.clear();
+        size_ = col_s;
+        blocks_.reserve((col_s + compressed_block_rows - 1) /
+                        compressed_block_rows);
+
+        _BitWriter_ writer { words_ };
+
+        for (size_type begin = 0; begin < col_s;
+             begin += compressed_block_rows)  {
+            const size_type end =
+                std::min(col_s, begin + compressed_block_rows);
+            std::uint64_t   prev = std::bit_cast<std::uint64_t>(
+                                       double(column[begin]));
+            unsigned int    lead = 65;  // Nothing to reuse yet
+            unsigned int    trail = 0;
+
+            blocks_.push_back({ prev, writer.position() });
+            for (size_type i = begin + 1; i < end; ++i)  {
+                const std::uint64_t bits =
+                    std::bit_cast<std::uint64_t>(double(column[i]));
+                const std::uint64_t diff = bits ^ prev;
+
+                prev = bits;
+                if (diff == 0)  {
+                    writer.write(0, 1);
+                    continue;
+                }
+
+                const unsigned int  new_lead =
+                    std::min(unsigned(std::countl_zero(diff)), 31U);
+                const unsigned int  new_trail =
+                    unsigned(std::countr_zero(diff));
+
+                if (lead <= 64 && new_lead >= lead && new_trail >= trail)  {
+                    writer.write(0b01, 2);
+                    writer.write(diff >> trail, 64 - lead - trail);
+                }
+                else  {
+                    const unsigned int  meaningful = 64 - new_lead - new_trail;
+
+                    lead = new_lead;
+                    trail = new_trail;
+                    writer.write(0b11, 2);
+                    writer.write(lead, 5);
+                    writer.write(meaningful & 63, 6);
+                    writer.write(diff >> trail, meaningful);
+                }
+            }
+        }
+        // Spare words, since decode peeks a word past the one it is in even
+        // at the very end
+        //
+        words_.push_back(0);
+        words_.push_back(0);
+        words_.shrink_to_fit();
+    }
+
+    [[nodiscard]] size_type size() const noexcept  { return (size_); }
+    [[nodiscard]] size_type
+    block_count() const noexcept  { return (blocks_.size()); }
+    [[nodiscard]] size_type memory_bytes() const noexcept  {
+
+        return (blocks_.capacity() * sizeof(Block_) +
+                words_.capacity() * sizeof(std::uint64_t));
+    }
+
+    size_type decode_block(size_type b, double *out) const noexcept  {
+
+        const Block_    &block = blocks_[b];
+        const size_type rows =
+            std::min(compressed_block_rows, size_ - b * compressed_block_rows);
+        std::uint64_t   value = block.first;
+        unsigned int    lead = 0;
+        unsigned int    trail = 0;
+        _BitReader_     reader { words_.data(), block.bit_offset };
+
+        out[0] = std::bit_cast<double>(value);
+        // The control bits and any new zero counts fit in the 13 bits
+        // peeked. Whether a value changed is close to random for prices,
+        // so the cases are picked without branches.
+        //
+        for (size_type i = 1; i < rows; ++i)  {
+            const std::uint64_t head = reader.peek();
+            const bool          changed = head & 1;
+            const bool          fresh = (head & 3) == 3;
+            const unsigned int  new_lead = unsigned(head >> 2) & 31;
+            unsigned int        meaningful = unsigned(head >> 7) & 63;
+
+            meaningful = meaningful ? meaningful : 64;
+            lead = fresh ? new_lead : lead;
+            trail = fresh ? 64 - new_lead - meaningful : trail;
+            reader.skip(fresh ? 13 : changed ? 2 : 1);
+
+            const unsigned int  width = changed ? 64 - lead - trail : 0;
+            const std::uint64_t mask =
+                width ? ~std::uint64_t(0) >> (64 - width) : 0;
+
+            value ^= (reader.peek() & mask) << trail;
+            reader.skip(width);
+            out[i] = std::bit_cast<double>(value);
+        }
+        return (rows);
+    }
+
+    [[nodiscard]] double value(size_type row) const  {
+
+        double  buffer[compressed_block_rows];
+
+        if (row >= size_)
+            throw NotFeasible("GorillaColumn::value(): Row out of range");
+        decode_block(row / compressed_block_rows, buffer);
+        return (buffer[row % compressed_block_rows]);
+    }
+
+private:
+
+    struct  Block_  {
+
+        std::uint64_t   first;
+        std::uint64_t   bit_offset;
+    };
+
+    std::vector<Block_>         blocks_ { };
+    std::vector<std::uint64_t>  words_ { };
+    size_type                   size_ { 0 };
+};
+
+// ----------------------------------------------------------------------------
+
+// The encoding a column of T is kept in
+//
+template<typename T>
+struct  _compressed_column_  {
+
+    static_assert(std::is_integral_v<T> || std::is_same_v<T, double>,
+                  "Only integral and double columns can be compressed");
+
+    using type = std::conditional_t<std::is_same_v<T, double>,
+                                    GorillaColumn,
+                                    DeltaForColumn<T>>;
+};
+
+template<typename T>
+using compressed_column_t = typename _compressed_column_<T>::type;
+
+// Calls func(begin, end, first_row) for each block of col, decoded into a
+// buffer on the stack
+//
+template<typename C, typename F>
+inline void for_each_block(const C &col, F &&func)  {
+
+    using T = typename C::value_type;
+
+    T   buffer[compressed_block_rows];
+
+    for (std::size_t b = 0; b < col.block_count(); ++b)  {
+        const std::size_t   rows = col.decode_block(b, buffer);
+
+        func(static_cast<const T *>(buffer),
+             static_cast<const T *>(buffer + rows),
+             b * compressed_block_rows);
+    }
+}
+
+template<typename C>
+[[nodiscard]] inline std::vector<typename C::value_type>
+decode_column(const C &col)  {
+
+    std::vector<typename C::value_type> result (col.size());
+
+    for (std::size_t b = 0; b < col.block_count(); ++b)
+        col.decode_block(b, result.data() + b * compressed_block_rows);
+    return (result);
+}
+
+// ----------------------------------------------------------------------------
+
+// A frame whose index and columns are compressed. I and the column types
+// must be integral or double.
+//
+template<typename I>
+class   CompressedFrame  {
+
+public:
+
+    using IndexType = I;
+    using size_type = std::size_t;
+
+    template<typename V>
+    void load_index(const V &index)  { index_.encode(index); }
+
+    template<typename T, typename V>
+    void load_column(const char *name, const V &column)  {
+
+        compressed_column_t<T>  col (column);
+
+        columns_.insert_or_assign(
+            name,
+            Column_ { std::type_index(typeid(T)), col.memory_bytes(),
+                      col.size() * sizeof(T), std::any(std::move(col)) });
+    }
+
+    void remove_column(const char *name)  { columns_.erase(name); }
+
+    [[nodiscard]] bool has_column(const char *name) const  {
+
+        return (columns_.find(name) != columns_.end());
+    }
+    [[nodiscard]] size_type
+    shape_rows() const noexcept  { return (index_.size()); }
+
+    [[nodiscard]] const compressed_column_t<I> &
+    get_compressed_index() const noexcept  { return (index_); }
+    template<typename T>
+    [[nodiscard]] const compressed_column_t<T> &
+    get_compressed_column(const char *name) const  {
+
+        const Column_   &col = find_(name);
+
+        if (col.type != std::type_index(typeid(T)))
+            throw NotFeasible("CompressedFrame: Column type does not match");
+        return (std::any_cast<const compressed_column_t<T> &>(col.data));
+    }
+
+    // Decoded copies, block by block
+    //
+    [[nodiscard]] std::vector<I>
+    get_index() const  { return (decode_column(index_)); }
+    template<typename T>
+    [[nodiscard]] std::vector<T> get_column(const char *name) const  {
+
+        return (decode_column(get_compressed_column<T>(name)));
+    }
+
+    // Calls func(begin, end, first_row) on each decoded block of column
+    // name
+    //
+    template<typename T, typename F>
+    void scan(const char *name, F &&func) const  {
+
+        for_each_block(get_compressed_column<T>(name),
+                       std::forward<F>(func));
+    }
+
+    // Visits column name as df.visit<T>() would. A mergeable visitor (see
+    // ParallelVisit.h) sees one block at a time, through a copy merged
+    // back after each, so only two blocks are ever decoded. Any other is
+    // given the whole column decoded.
+    //
+    template<typename T, typename V>
+    V &visit(const char *name, V &visitor) const  {
+
+        const auto  &col = get_compressed_column<T>(name);
+        const auto  rows = std::min(index_.size(), col.size());
+
+        if constexpr (mergeable_visitor<V>)  {
+            _visit_blocks_(visitor, [this, &col, rows](auto &&visit_block)  {
+                I           idx_block[compressed_block_rows];
+                T           col_block[compressed_block_rows];
+                const I     *idx_buf = idx_block;
+                const T     *col_buf = col_block;
+                size_type   done { 0 };
+
+                for (size_type b = 0; done < rows; ++b)  {
+                    const size_type n =
+                        std::min(index_.decode_block(b, idx_block),
+                                 col.decode_block(b, col_block));
+                    const size_type use = std::min(n, rows - done);
+
+                    visit_block(idx_buf, idx_buf + use,
+                                col_buf, col_buf + use);
+                    done += use;
+                }
+            });
+        }
+        else  {
+            const auto  idx = get_index();
+            const auto  vals = decode_column(col);
+
+            visitor.pre();
+            visitor(idx.begin(), idx.begin() + rows,
+                    vals.begin(), vals.begin() + rows);
+            visitor.post();
+        }
+        return (visitor);
+    }
+
+    // Compressed and uncompressed footprints, index included
+    //
+    [[nodiscard]] size_type memory_bytes() const noexcept  {
+
+        size_type   bytes = index_.memory_bytes();
+
+        for (const auto &[name, col] : columns_)  bytes += col.bytes;
+        return (bytes);
+    }
+    [[nodiscard]] size_type raw_bytes() const noexcept  {
+
+        size_type   bytes = index_.size() * sizeof(I);
+
+        for (const auto &[name, col] : columns_)  bytes += col.raw_bytes;
+        return (bytes);
+    }
+
+    // Decodes into df the index and every column whose type is among Ts
+    //
+    template<typename ... Ts, typename DF>
+    void load_into(DF &df) const  {
+
+        df.load_index(get_index());
+        for (const auto &[name, col] : columns_)
+            (void) ((col.type == std::type_index(typeid(Ts)) &&
+                     (df.load_column(name.c_str(),
+                                     get_column<Ts>(name.c_str()),
+                                     nan_policy::dont_pad_with_nans),
+                      true)) || ...);
+    }
+
+private:
+
+    struct  Column_  {
+
+        std::type_index type;
+        size_type       bytes;
+        size_type       raw_bytes;
+        std::any        data;
+    };
+
+    const Column_ &find_(const char *name) const  {
+
+        const auto  iter = columns_.find(name);
+
+        if (iter == columns_.end())
+            throw ColNotFound(std::string("CompressedFrame: ") + name);
+        return (iter->second);
+    }
+
+    compressed_column_t<I>                      index_ { };
+    std::unordered_map<std::string, Column_>    columns_ { };
+};
+
+// Compresses df's index and every column whose type is among Ts
+//
+template<typename ... Ts, typename DF>
+[[nodiscard]] inline CompressedFrame<typename DF::IndexType>
+compress_frame(const DF &df)  {
+
+    HMDF_INSTRUMENT_OP(scope, "compress_frame");
+
+    CompressedFrame<typename DF::IndexType> result;
+
+    result.load_index(df.get_index());
+    for (const auto &info : df.template get_columns_info<Ts...>())  {
+        const char  *name = std::get<0>(info).c_str();
+        const auto  &type = std::get<2>(info);
+
+        (void) ((type == std::type_index(typeid(Ts)) &&
+                 (result.template load_column<Ts>(
+                      name, df.template get_column<Ts>(name)),
+                  true)) || ...);
+    }
+    scope.add_rows(result.shape_rows());
+    scope.add_bytes(result.memory_bytes());
+    return (result);
+}
+
+}
@@ -0,0 +1,469 @@
+#pragma once
+
+#include <DataFrame/DataFrame.h>
+#include <DataFrame/Utils/Instrumentation.h>
+
+#include <algorithm>
+#include <any>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace hmdf
+{
+
+// A frame that hands out copy-on-write snapshots, for readers on other
+// threads while one writer keeps changing it.
+//
+// get_reindexed_view() and the other views write through to the frame
+// they came from, so a reader on another thread sees the writer's changes
+// mid-flight, and the only safe alternative has been a deep copy. Here
+// the index and every column are cut into blocks of cow_block_rows rows,
+// held by shared pointers:
+//
+//   - The writer (CowFrame) changes its working copy with set(),
+//     modify(), append() and load_column(). The first write to a block
+//     since the last publish() copies that block. Later writes to it go
+//     in place.
+//   - publish() makes the working copy the current version. It copies
+//     the block pointers, never the blocks.
+//   - snapshot() returns the current version as a CowSnapshot. It copies
+//     one pointer under a lock, so it is O(1) and safe from any thread.
+//     The snapshot keeps seeing that version, whatever the writer does
+//     later, and frees its blocks when the last holder lets go.
+//
+// The writer side is not thread-safe, like the frame. snapshot() and the
+// snapshots themselves are.
+//
+inline constexpr std::size_t    cow_block_rows { 4096 };
+
+// ----------------------------------------------------------------------------
+
+// A column of T in shared blocks. Read only. CowFrame does the writing.
+//
+template<typename T>
+class   CowColumn  {
+
+public:
+
+    using value_type = T;
+    using size_type = std::size_t;
+
+    CowColumn() = default;
+
+    [[nodiscard]] size_type size() const noexcept  { return (size_); }
+    [[nodiscard]] bool empty() const noexcept  { return (size_ == 0); }
+    [[nodiscard]] size_type
+    block_count() const noexcept  { return (blocks_.size()); }
+
+    [[nodiscard]] const T &operator [] (size_type row) const noexcept  {
+
+        return (blocks_[row / cow_block_rows]->values[row % cow_block_rows]);
+    }
+
+    // Rows [b * cow_block_rows, ...) of block b
+    //
+    [[nodiscard]] const T *block_data(size_type b) const noexcept  {
+
+        return (blocks_[b]->values.data());
+    }
+    [[nodiscard]] size_type block_size(size_type b) const noexcept  {
+
+        return (blocks_[b]->values.size());
+    }
+
+    // Calls func(begin, end, first_row) on each block
+    //
+    template<typename F>
+    void for_each_block(F &&func) const  {
+
+        for (size_type b = 0; b < blocks_.size(); ++b)  {
+            const auto  &values = blocks_[b]->values;
+
+            func(values.data(), values.data() + values.size(),
+                 b * cow_block_rows);
+        }
+    }
+
+    [[nodiscard]] std::vector<T> to_vector() const  {
+
+        std::vector<T>  result;
+
+        result.reserve(size_);
+        for (const auto &block : blocks_)
+            result.insert(result.end(),
+                          block->values.begin(), block->values.end());
+        return (result);
+    }
+
+    // True if block b of both columns is the same memory. Two versions of
+    // a column share every block the writer has not touched in between.
+    //
+    [[nodiscard]] bool
+    shares_block(const CowColumn &other, size_type b) const noexcept  {
+
+        return (b < blocks_.size() && b < other.blocks_.size() &&
+                blocks_[b] == other.blocks_[b]);
+    }
+
+private:
+
+    template<typename>
+    friend class    CowFrame;
+
+    // generation is the publish count when the block was made. A block of
+    // the current generation is in no published version, so it is the
+    // writer's to change in place.
+    //
+    struct  Block_  {
+
+        std::vector<T>  values;
+        std::size_t     generation;
+    };
+
+    void assign_(const std::vector<T> &values, std::size_t generation)  {
+
+        blocks_.clear();
+        size_ = 0;
+        append_(values.data(), values.size(), generation);
+    }
+
+    // Copies block b first if an earlier version may hold it. Returns
+    // whether it did.
+    //
+    bool own_block_(size_type b, std::size_t generation)  {
+
+        if (blocks_[b]->generation == generation)  return (false);
+        blocks_[b] = std::make_shared<Block_>(
+                         Block_ { blocks_[b]->values, generation });
+        return (true);
+    }
+
+    size_type
+    append_(const T *values, size_type n, std::size_t generation)  {
+
+        size_type   copied { 0 };
+
+        while (n > 0)  {
+            if (blocks_.empty() ||
+                blocks_.back()->values.size() == cow_block_rows)  {
+                blocks_.push_back(
+                    std::make_shared<Block_>(Block_ { { }, generation }));
+                blocks_.back()->values.reserve(cow_block_rows);
+            }
+            else
+                copied += own_block_(blocks_.size() - 1, generation);
+
+            auto            &last = blocks_.back()->values;
+            const size_type take = std::min(n, cow_block_rows - last.size());
+
+            last.insert(last.end(), values, values + take);
+            values += take;
+            n -= take;
+            size_ += take;
+        }
+        return (copied);
+    }
+
+    std::vector<std::shared_ptr<Block_>>    blocks_ { };
+    size_type                               size_ { 0 };
+};
+
+// ----------------------------------------------------------------------------
+
+// One published version of a CowFrame: its index and columns as they were
+// at publish(). Copying a snapshot copies a pointer.
+//
+template<typename I>
+class   CowSnapshot  {
+
+public:
+
+    using IndexType = I;
+    using size_type = std::size_t;
+
+    CowSnapshot() = default;
+
+    [[nodiscard]] bool valid() const noexcept  { return (bool(version_)); }
+
+    // How many times the frame had been published when this was taken
+    //
+    [[nodiscard]] std::size_t
+    version() const noexcept  { return (version_ ? version_->number : 0); }
+    [[nodiscard]] size_type shape_rows() const noexcept  {
+
+        return (version_ ? version_->index.size() : 0);
+    }
+
+    [[nodiscard]] const CowColumn<I> &get_index() const  {
+
+        return (checked_version_().index);
+    }
+    template<typename T>
+    [[nodiscard]] const CowColumn<T> &get_column(const char *name) const  {
+
+        const auto  &columns = checked_version_().columns;
+        const auto  iter = columns.find(name);
+
+        if (iter == columns.end())
+            throw ColNotFound(std::string("CowSnapshot: ") + name);
+        if (iter->second.type != std::type_index(typeid(T)))
+            throw NotFeasible("CowSnapshot: Column type does not match");
+        return (std::any_cast<const CowColumn<T> &>(iter->second.data));
+    }
+    [[nodiscard]] bool has_column(const char *name) const  {
+
+        return (version_ &&
+                version_->columns.find(name) != version_->columns.end());
+    }
+
+    // Copies into df the index and every column whose type is among Ts
+    //
+    template<typename ... Ts, typename DF>
+    void load_into(DF &df) const  {
+
+        const auto  &version = checked_version_();
+
+        df.load_index(version.index.to_vector());
+        for (const auto &[name, col] : version.columns)
+            (void) ((col.type == std::type_index(typeid(Ts)) &&
+                     (df.load_column(
+                          name.c_str(),
+                          std::any_cast<const CowColumn<Ts> &>(
+                              col.data).to_vector(),
+                          nan_policy::dont_pad_with_nans),
+                      true)) || ...);
+    }
+
+private:
+
+    template<typename>
+    friend class    CowFrame;
+
+    struct  Column_  {
+
+        std::type_index type;
+        std::any        data;
+    };
+
+    struct  Version_  {
+
+        CowColumn<I>                                index { };
+        std::unordered_map<std::string, Column_>    columns { };
+        std::size_t                                 number { 0 };
+    };
+
+    explicit CowSnapshot(std::shared_ptr<const Version_> version) noexcept
+        : version_(std::move(version))  {   }
+
+    const Version_ &checked_version_() const  {
+
+        if (! version_)
+            throw NotFeasible("CowSnapshot: Nothing has been published");
+        return (*version_);
+    }
+
+    std::shared_ptr<const Version_> version_ { };
+};
+
+// ----------------------------------------------------------------------------
+
+template<typename I>
+class   CowFrame  {
+
+public:
+
+    using IndexType = I;
+    using size_type = std::size_t;
+    using SnapshotType = CowSnapshot<I>;
+
+    CowFrame() = default;
+    CowFrame(const CowFrame &) = delete;
+    CowFrame &operator = (const CowFrame &) = delete;
+
+    // The writer's working copy
+    //
+    [[nodiscard]] const CowColumn<I> &
+    get_index() const noexcept  { return (work_.index); }
+    template<typename T>
+    [[nodiscard]] const CowColumn<T> &get_column(const char *name) const  {
+
+        return (std::any_cast<const CowColumn<T> &>(
+                    find_<T>(work_.columns, name).data));
+    }
+    [[nodiscard]] bool has_column(const char *name) const  {
+
+        return (work_.columns.find(name) != work_.columns.end());
+    }
+    [[nodiscard]] size_type
+    shape_rows() const noexcept  { return (work_.index.size()); }
+
+    void load_index(const std::vector<I> &index)  {
+
+        work_.index.assign_(index, generation_);
+    }
+    template<typename T>
+    void load_column(const char *name, const std::vector<T> &column)  {
+
+        CowColumn<T>    col;
+
+        col.assign_(column, generation_);
+        work_.columns.insert_or_assign(
+            name, Column_ { std::type_index(typeid(T)),
+                            std::any(std::move(col)) });
+    }
+    void remove_column(const char *name)  { work_.columns.erase(name); }
+
+    // Appends n rows to the index or to column name
+    //
+    void append_index(const I *values, size_type n)  {
+
+        copied_blocks_ += work_.index.append_(values, n, generation_);
+    }
+    template<typename T>
+    void append(const char *name, const T *values, size_type n)  {
+
+        copied_blocks_ += column_<T>(name).append_(values, n, generation_);
+    }
+
+    template<typename T>
+    void set(const char *name, size_type row, const T &value)  {
+
+        modify<T>(name, row, row + 1, [&value](T &v) { v = value; });
+    }
+
+    // Calls func(T &) on rows [begin, end) of column name. Only the blocks
+    // those rows are in get copied.
+    //
+    template<typename T, typename F>
+    void modify(const char *name, size_type begin, size_type end, F &&func)  {
+
+        auto    &col = column_<T>(name);
+
+        if (begin > end || end > col.size())
+            throw NotFeasible("CowFrame::modify(): Rows out of range");
+        while (begin < end)  {
+            const size_type b = begin / cow_block_rows;
+            const size_type stop = std::min(end, (b + 1) * cow_block_rows);
+
+            copied_blocks_ += col.own_block_(b, generation_);
+
+            T   *values = col.blocks_[b]->values.data();
+
+            for (; begin < stop; ++begin)
+                func(values[begin - b * cow_block_rows]);
+        }
+    }
+
+    // Makes the working copy the version snapshot() returns. Copies the
+    // block pointers of every column, not the blocks.
+    //
+    void publish()  {
+
+        HMDF_INSTRUMENT_OP(scope, "cow_publish");
+
+        auto    version = std::make_shared<Version_>(work_);
+
+        version->number = ++published_;
+        {
+            const std::lock_guard<std::mutex>   guard { mutex_ };
+
+            current_ = std::move(version);
+        }
+
+        // Everything is in a published version now, so the next write to
+        // any block copies it
+        //
+        generation_ += 1;
+        scope.add_rows(work_.index.size());
+    }
+
+    // The last published version. O(1) and callable from any thread.
+    //
+    [[nodiscard]] SnapshotType snapshot() const  {
+
+        std::shared_ptr<const Version_> version;
+
+        {
+            const std::lock_guard<std::mutex>   guard { mutex_ };
+
+            version = current_;
+        }
+        return (SnapshotType(std::move(version)));
+    }
+
+    // Blocks copied by writes since construction, how many times the
+    // frame has been published
+    //
+    [[nodiscard]] size_type
+    copied_blocks() const noexcept  { return (copied_blocks_); }
+    [[nodiscard]] std::size_t
+    published() const noexcept  { return (published_); }
+
+private:
+
+    using Column_ = typename SnapshotType::Column_;
+    using Version_ = typename SnapshotType::Version_;
+
+    template<typename T, typename M>
+    static auto &find_(M &columns, const char *name)  {
+
+        const auto  iter = columns.find(name);
+
+        if (iter == columns.end())
+            throw ColNotFound(std::string("CowFrame: ") + name);
+        if (iter->second.type != std::type_index(typeid(T)))
+            throw NotFeasible("CowFrame: Column type does not match");
+        return (iter->second);
+    }
+    template<typename T>
+    CowColumn<T> &column_(const char *name)  {
+
+        return (std::any_cast<CowColumn<T> &>(
+                    find_<T>(work_.columns, name).data));
+    }
+
+    Version_                        work_ { };
+    std::size_t                     generation_ { 1 };
+    std::size_t                     published_ { 0 };
+    size_type                       copied_blocks_ { 0 };
+    std::shared_ptr<const Version_> current_ { };
+    mutable std::mutex              mutex_ { };
+};
+
+// ----------------------------------------------------------------------------
+
+// A CowFrame loaded with df's index and every column whose type is among
+// Ts, published once. The copy-on-write counterpart of get_reindexed_view()
+// when the view goes to other threads: readers take snapshots and the
+// writer changes the CowFrame instead of df.
+//
+template<typename ... Ts, typename DF>
+[[nodiscard]] inline std::unique_ptr<CowFrame<typename DF::IndexType>>
+make_cow_frame(const DF &df)  {
+
+    HMDF_INSTRUMENT_OP(scope, "make_cow_frame");
+
+    auto    result = std::make_unique<CowFrame<typename DF::IndexType>>();
+
+    result->load_index(df.get_index());
+    for (const auto &info : df.template get_columns_info<Ts...>())  {
+        const char  *name = std::get<0>(info).c_str();
+        const auto  &type = std::get<2>(info);
+
+        (void) ((type == std::type_index(typeid(Ts)) &&
+                 (result->template load_column<Ts>(
+                      name, df.template get_column<Ts>(name)),
+                  true)) || ...);
+    }
+    result->publish();
+    scope.add_rows(result->shape_rows());
+    return (result);
+}
+
+}
@@ -0,0 +1,690 @@
+#pragma once
+
+#include <DataFrame/DataFrame.h>
+#include <DataFrame/Utils/Instrumentation.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace hmdf
+{
+
+// Loading a delimited text file into a frame on all cores.
+//
+// ingest_csv<Ts ...>(df, path) reads a file whose first column is the index
+// and whose other columns have the types Ts, in order. It runs as three
+// stages joined by bounded queues:
+//
+//   - read: one thread reads the file in large sequential blocks, or walks
+//     an mmap of it, and cuts each block after its last newline, so that
+//     every block holds whole rows. The partial row left over starts the
+//     next block.
+//   - parse: worker threads each take a block and parse it straight into
+//     one typed vector per column, reserved from the block's newline count.
+//     Numbers are converted in place with std::from_chars, so there are no
+//     per-row allocations beyond the std::string values themselves.
+//   - load: the calling thread appends the parsed blocks to the columns in
+//     file order, then moves the columns into df with load_index() and
+//     load_column().
+//
+// Read buffers are recycled and the queues are bounded, so the memory in
+// flight does not grow with the file.
+//
+// Supported column types are the arithmetic ones and std::string. An empty
+// floating point field is NaN, an empty integral one is 0. A std::string
+// field may be in double quotes, with "" for a quote inside it, but must not
+// span lines. Blank lines are skipped and a trailing \r is dropped.
+//
+// Binary files do not need this. ColumnarFile maps them with no parsing.
+//
+// POSIX only (read, mmap).
+//
+struct  CsvIngestOptions  {
+
+    char            delimiter { ',' };
+    bool            has_header { true };
+    // Walk an mmap of the file instead of read()-ing it into buffers
+    bool            use_mmap { false };
+    // Parser threads. 0 means one per core, less one for the reader.
+    unsigned int    thread_count { 0 };
+    // Read size. A block grows past it only to fit a longer row.
+    std::size_t     block_size { std::size_t(4) << 20 };
+    // Column names when there is no header, the index's not included
+    std::vector<std::string>    column_names { };
+};
+
+// ----------------------------------------------------------------------------
+
+// A blocking FIFO of at most capacity items. close() wakes everyone up.
+// push() then fails and pop() fails once the queue is empty.
+//
+template<typename T>
+class   _CsvQueue_  {
+
+public:
+
+    explicit _CsvQueue_(std::size_t capacity) : capacity_(capacity)  {   }
+
+    bool push(T &&item)  {
+
+        {
+            std::unique_lock<std::mutex>    lock { mutex_ };
+
+            not_full_.wait(lock, [this]()  {
+                return (closed_ || items_.size() < capacity_);
+            });
+            if (closed_)  return (false);
+            items_.push_back(std::move(item));
+        }
+        not_empty_.notify_one();
+        return (true);
+    }
+
+    bool pop(T &item)  {
+
+        {
+            std::unique_lock<std::mutex>    lock { mutex_ };
+
+            not_empty_.wait(lock, [this]()  {
+                return (closed_ || ! items_.empty());
+            });
+            if (items_.empty())  return (false);
+            item = std::move(items_.front());
+            items_.pop_front();
+        }
+        not_full_.notify_one();
+        return (true);
+    }
+
+    void close()  {
+
+        {
+            const std::lock_guard<std::mutex>   guard { mutex_ };
+
+            closed_ = true;
+        }
+        not_full_.notify_all();
+        not_empty_.notify_all();
+    }
+
+private:
+
+    std::deque<T>           items_ { };
+    const std::size_t       capacity_;
+    bool                    closed_ { false };
+    std::mutex              mutex_ { };
+    std::condition_variable not_full_ { };
+    std::condition_variable not_empty_ { };
+};
+
+// A run of whole rows. buffer is null when the rows are in the mmap.
+//
+struct  _CsvBlock_  {
+
+    std::size_t                         seq { 0 };
+    const char                          *begin { nullptr };
+    const char                          *end { nullptr };
+    std::unique_ptr<std::vector<char>>  buffer { };
+};
+
+// The columns parsed from one block. error is empty if it parsed cleanly,
+// otherwise error_row is the block row it failed on.
+//
+template<typename ... Ts>
+struct  _CsvChunk_  {
+
+    std::size_t                     seq { 0 };
+    std::size_t                     rows { 0 };
+    std::size_t                     bytes { 0 };
+    std::tuple<std::vector<Ts> ...> columns { };
+    std::string                     error { };
+    std::size_t                     error_row { 0 };
+};
+
+// ----------------------------------------------------------------------------
+
+// Parses the field at pos into out. On success pos moves past the field
+// and its delimiter, or to line_end + 1 after the last field.
+//
+template<typename T>
+inline const char *
+_csv_parse_field_(const char *&pos,
+                  const char *line_end,
+                  char delimiter,
+                  std::vector<T> &out)  {
+
+    if (pos > line_end)  return ("Too few fields");
+
+    const char  *begin = pos;
+    const char  *end;
+
+    if constexpr (std::is_same_v<T, std::string>)  {
+        if (begin < line_end && *begin == '"')  {
+            std::string &value = out.emplace_back();
+            const char  *iter = begin + 1;
+
+            while (true)  {
+                const char  *quote = static_cast<const char *>(
+                    std::memchr(iter, '"', line_end - iter));
+
+                if (! quote)  return ("Unterminated quoted field");
+                value.append(iter, quote);
+                if (quote + 1 < line_end && quote[1] == '"')  {
+                    value.push_back('"');
+                    iter = quote + 2;
+                    continue;
+                }
+                end = quote + 1;
+                break;
+            }
+            if (end < line_end && *end != delimiter)
+                return ("Text after closing quote");
+        }
+        else  {
+            end = static_cast<const char *>(
+                std::memchr(begin, delimiter, line_end - begin));
+            if (! end)  end = line_end;
+            out.emplace_back(begin, end);
+        }
+    }
+    else  {
+        end = static_cast<const char *>(
+            std::memchr(begin, delimiter, line_end - begin));
+        if (! end)  end = line_end;
+        if (begin == end)  {
+            if constexpr (std::is_floating_point_v<T>)
+                out.push_back(std::numeric_limits<T>::quiet_NaN());
+            else
+                out.push_back(T { });
+        }
+        else  {
+            T   value { };
+
+            if constexpr (std::is_same_v<T, bool>)  {
+                if (end - begin == 1 && (*begin == '0' || *begin == '1'))
+                    value = *begin == '1';
+                else  return ("Not a bool");
+            }
+            else  {
+                // from_chars takes no leading '+'
+                //
+                if (*begin == '+' && end - begin > 1)  begin += 1;
+
+                const auto  result = std::from_chars(begin, end, value);
+
+                if (result.ec != std::errc { } || result.ptr != end)
+                    return ("Not a number");
+            }
+            out.push_back(value);
+        }
+    }
+    pos = end + 1;
+    return (nullptr);
+}
+
+template<typename ... Ts, std::size_t ... Is>
+inline const char *
+_csv_parse_row_(const char *pos,
+                const char *line_end,
+                char delimiter,
+                std::tuple<std::vector<Ts> ...> &columns,
+                std::index_sequence<Is ...>)  {
+
+    const char  *error = nullptr;
+
+    ((error = error ? error
+                    : _csv_parse_field_(pos, line_end, delimiter,
+                                        std::get<Is>(columns))), ...);
+    if (! error && pos <= line_end)  error = "Too many fields";
+    return (error);
+}
+
+template<typename ... Ts>
+inline void
+_csv_parse_block_(const char *begin,
+                  const char *end,
+                  char delimiter,
+                  _CsvChunk_<Ts ...> &chunk)  {
+
+    const std::size_t   lines = std::count(begin, end, '\n') + 1;
+
+    std::apply([lines](auto & ... cols)  { (cols.reserve(lines), ...); },
+               chunk.columns);
+
+    for (const char *pos = begin; pos < end; )  {
+        const char  *newline = static_cast<const char *>(
+            std::memchr(pos, '\n', end - pos));
+        const char  *line_end = newline ? newline : end;
+        const char  *next = newline ? newline + 1 : end;
+
+        if (line_end > pos && line_end[-1] == '\r')  line_end -= 1;
+        if (line_end == pos)  {
+            pos = next;
+            continue;
+        }
+
+        const char  *error =
+            _csv_parse_row_(pos, line_end, delimiter, chunk.columns,
+                            std::index_sequence_for<Ts ...> { });
+
+        if (error)  {
+            chunk.error = error;
+            chunk.error_row = chunk.rows;
+            return;
+        }
+        chunk.rows += 1;
+        pos = next;
+    }
+}
+
+// Moves a parsed block column onto the end of dst. An empty dst without
+// capacity takes src's buffer outright. Once dst has been reserved for the
+// whole file, the elements are moved instead so the reservation is kept.
+//
+template<typename T>
+inline void
+_csv_append_column_(std::vector<T> &dst, std::vector<T> &src)  {
+
+    if (dst.capacity() == 0)
+        dst.swap(src);
+    else
+        dst.insert(dst.end(),
+                   std::make_move_iterator(src.begin()),
+                   std::make_move_iterator(src.end()));
+}
+
+// Splits a header line into names
+//
+inline std::vector<std::string>
+_csv_split_header_(const char *begin, const char *end, char delimiter)  {
+
+    std::vector<std::string>    names;
+
+    if (end > begin && end[-1] == '\r')  end -= 1;
+    while (true)  {
+        const char  *field = static_cast<const char *>(
+            std::memchr(begin, delimiter, end - begin));
+        const char  *field_end = field ? field : end;
+        const char  *b = begin;
+        const char  *e = field_end;
+
+        if (e - b >= 2 && *b == '"' && e[-1] == '"')  {
+            b += 1;
+            e -= 1;
+        }
+        names.emplace_back(b, e);
+        if (! field)  break;
+        begin = field + 1;
+    }
+    return (names);
+}
+
+// ----------------------------------------------------------------------------
+
+// The source the read stage walks: either an open file descriptor, or the
+// whole file mapped
+//
+class   _CsvSource_  {
+
+public:
+
+    _CsvSource_(const char *path, bool use_mmap)  {
+
+        fd_ = ::open(path, O_RDONLY);
+        if (fd_ < 0)
+            throw DataFrameError("ingest_csv(): Unable to open file");
+
+        struct stat st;
+
+        if (::fstat(fd_, &st))  {
+            ::close(fd_);
+            throw DataFrameError("ingest_csv(): Unable to stat file");
+        }
+        size_ = std::size_t(st.st_size);
+        if (use_mmap && size_ > 0)  {
+            void    *base =
+                ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+
+            if (base == MAP_FAILED)  {
+                ::close(fd_);
+                throw DataFrameError("ingest_csv(): Unable to map file");
+            }
+            base_ = static_cast<const char *>(base);
+            ::madvise(base, size_, MADV_SEQUENTIAL);
+        }
+#ifdef POSIX_FADV_SEQUENTIAL
+        else
+            ::posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif // POSIX_FADV_SEQUENTIAL
+    }
+    _CsvSource_(const _CsvSource_ &) = delete;
+    _CsvSource_ &operator = (const _CsvSource_ &) = delete;
+    ~_CsvSource_()  {
+
+        if (base_)  ::munmap(const_cast<char *>(base_), size_);
+        ::close(fd_);
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept  { return (size_); }
+    [[nodiscard]] const char *base() const noexcept  { return (base_); }
+
+    void seek(std::size_t offset)  {
+
+        if (::lseek(fd_, ::off_t(offset), SEEK_SET) < 0)
+            throw DataFrameError("ingest_csv(): Unable to seek file");
+    }
+
+    // Reads until size bytes are in or the file ends. Returns the bytes
+    // read.
+    //
+    std::size_t read(char *buffer, std::size_t size)  {
+
+        std::size_t total = 0;
+
+        while (total < size)  {
+            const ::ssize_t got = ::read(fd_, buffer + total, size - total);
+
+            if (got == 0)  break;
+            if (got < 0)  {
+                if (errno == EINTR)  continue;
+                throw DataFrameError("ingest_csv(): Unable to read file");
+            }
+            total += std::size_t(got);
+        }
+        return (total);
+    }
+
+private:
+
+    int         fd_ { -1 };
+    std::size_t size_ { 0 };
+    const char  *base_ { nullptr };
+};
+
+// Reads the header line, if any, and returns the column names after the
+// index's. offset is set to where the rows start.
+//
+inline std::vector<std::string>
+_csv_read_header_(_CsvSource_ &source,
+                  const CsvIngestOptions &options,
+                  std::size_t &offset)  {
+
+    offset = 0;
+    if (! options.has_header)  return (options.column_names);
+
+    std::string line;
+    const char  *newline = nullptr;
+
+    if (source.base())  {
+        newline = static_cast<const char *>(
+            std::memchr(source.base(), '\n', source.size()));
+        line.assign(source.base(),
+                    newline ? newline : source.base() + source.size());
+    }
+    else  {
+        char    buffer[4096];
+
+        while (! newline)  {
+            const std::size_t   got = source.read(buffer, sizeof(buffer));
+
+            if (got == 0)  break;
+            newline = static_cast<const char *>(
+                std::memchr(buffer, '\n', got));
+            line.append(buffer, newline ? newline - buffer : got);
+        }
+    }
+    offset = line.size() + (newline ? 1 : 0);
+    if (! source.base())  source.seek(offset);
+
+    std::vector<std::string>    names =
+        _csv_split_header_(line.data(), line.data() + line.size(),
+                           options.delimiter);
+
+    names.erase(names.begin());
+    return (names);
+}
+
+// ----------------------------------------------------------------------------
+
+// Reads path into df as described above. Returns the number of rows
+// loaded. Throws DataFrameError with the 1-based row number (the header not
+// counted) of the first row that does not parse.
+//
+template<typename ... Ts, typename DF>
+inline std::size_t
+ingest_csv(DF &df,
+           const char *path,
+           const CsvIngestOptions &options = { })  {
+
+    using IndexType = typename DF::IndexType;
+    using Chunk = _CsvChunk_<IndexType, Ts ...>;
+
+    static_assert(((std::is_arithmetic_v<Ts> ||
+                    std::is_same_v<Ts, std::string>) && ...),
+                  "ingest_csv(): Columns must be arithmetic or std::string");
+
+    HMDF_INSTRUMENT_OP(scope, "ingest_csv");
+
+    _CsvSource_ source (path, options.use_mmap);
+    std::size_t offset = 0;
+    const auto  names = _csv_read_header_(source, options, offset);
+
+    if (names.size() != sizeof ... (Ts))
+        throw DataFrameError("ingest_csv(): "
+                             "The number of columns does not match Ts");
+
+    const unsigned int  parsers =
+        options.thread_count > 0
+            ? options.thread_count
+            : std::max(std::thread::hardware_concurrency(), 2U) - 1;
+    const std::size_t   block_size =
+        std::max<std::size_t>(options.block_size, 4096);
+    const std::size_t   in_flight = 2 * std::size_t(parsers) + 2;
+
+    _CsvQueue_<_CsvBlock_>                          blocks { parsers + 1 };
+    _CsvQueue_<std::unique_ptr<Chunk>>              chunks { in_flight };
+    _CsvQueue_<std::unique_ptr<std::vector<char>>>  free_buffers {
+        in_flight
+    };
+    std::exception_ptr                              read_error { };
+
+    if (! source.base())
+        for (std::size_t b = 0; b < in_flight; ++b)
+            free_buffers.push(std::make_unique<std::vector<char>>(block_size));
+
+    // Read stage
+    //
+    auto    read_mapped = [&]()  {
+        const char  *pos = source.base() + offset;
+        const char  *file_end = source.base() + source.size();
+
+        for (std::size_t seq = 0; pos < file_end; ++seq)  {
+            const char  *end = pos + std::min<std::size_t>(block_size,
+                                                          file_end - pos);
+
+            if (end < file_end)  {
+                const char  *newline = static_cast<const char *>(
+                    std::memchr(end, '\n', file_end - end));
+
+                end = newline ? newline + 1 : file_end;
+            }
+            if (! blocks.push(_CsvBlock_ { seq, pos, end, nullptr }))
+                return;
+            pos = end;
+        }
+    };
+    auto    read_blocks = [&]()  {
+        std::unique_ptr<std::vector<char>>  buffer;
+        std::size_t                         carry = 0;
+        bool                                eof = false;
+
+        if (! free_buffers.pop(buffer))  return;
+        for (std::size_t seq = 0; ! eof; )  {
+            if (buffer->size() < carry + block_size)
+                buffer->resize(carry + block_size);
+
+            const std::size_t   got =
+                source.read(buffer->data() + carry, block_size);
+            const std::size_t   filled = carry + got;
+            const char          *data = buffer->data();
+
+            eof = got < block_size;
+
+            const char  *last = data + filled;
+
+            if (! eof)  {
+                while (last > data && last[-1] != '\n')  last -= 1;
+                if (last == data)  {   // One row longer than the buffer
+                    carry = filled;
+                    continue;
+                }
+            }
+
+            std::unique_ptr<std::vector<char>>  next;
+
+            carry = std::size_t(data + filled - last);
+            if (! eof)  {
+                if (! free_buffers.pop(next))  return;
+                if (next->size() < carry + block_size)
+                    next->resize(carry + block_size);
+                std::memcpy(next->data(), last, carry);
+            }
+            if (last > data)  {
+                _CsvBlock_  block { seq++, data, last, std::move(buffer) };
+
+                if (! blocks.push(std::move(block)))  return;
+            }
+            buffer = std::move(next);
+        }
+    };
+    std::thread reader ([&]()  {
+        try  {
+            if (source.base())  read_mapped();
+            else  read_blocks();
+        }
+        catch (...)  { read_error = std::current_exception(); }
+        blocks.close();
+    });
+
+    // Parse stage
+    //
+    std::vector<std::thread>    workers;
+
+    workers.reserve(parsers);
+    for (unsigned int t = 0; t < parsers; ++t)
+        workers.emplace_back([&]()  {
+            _CsvBlock_  block;
+
+            while (blocks.pop(block))  {
+                auto    chunk = std::make_unique<Chunk>();
+
+                chunk->seq = block.seq;
+                chunk->bytes = std::size_t(block.end - block.begin);
+                _csv_parse_block_(block.begin, block.end, options.delimiter,
+                                  *chunk);
+                if (block.buffer)
+                    free_buffers.push(std::move(block.buffer));
+                if (! chunks.push(std::move(chunk)))  return;
+            }
+        });
+
+    std::thread closer ([&]()  {
+        for (auto &thr : workers)  thr.join();
+        chunks.close();
+    });
+
+    // Load stage. Chunks can finish out of order, so they wait in pending
+    // until it is their turn.
+    //
+    std::tuple<std::vector<IndexType>, std::vector<Ts> ...> columns;
+    std::vector<std::unique_ptr<Chunk>>                     pending;
+    std::unique_ptr<Chunk>                                  chunk;
+    std::size_t                                             next_seq = 0;
+    std::size_t                                             rows = 0;
+    std::string                                             error;
+
+    auto    append = [&columns](Chunk &done)  {
+        std::apply([&done](auto & ... dst)  {
+            std::apply([&dst ...](auto & ... src)  {
+                (_csv_append_column_(dst, src), ...);
+            }, done.columns);
+        }, columns);
+    };
+
+    while (error.empty() && chunks.pop(chunk))  {
+        const std::size_t   seq = chunk->seq;
+
+        if (pending.size() <= seq - next_seq)
+            pending.resize(seq - next_seq + 1);
+        pending[seq - next_seq] = std::move(chunk);
+        while (! pending.empty() && pending.front())  {
+            Chunk   &done = *pending.front();
+
+            if (! done.error.empty())  {
+                error = "ingest_csv(): Row " +
+                        std::to_string(rows + done.error_row + 1) + ": " +
+                        done.error;
+                break;
+            }
+            if (rows == 0 && done.rows > 0)  {
+                // Reserve for the whole file from the first block's density
+                //
+                const double    per_row =
+                    double(done.bytes) / double(done.rows);
+                const auto      expected =
+                    std::size_t(double(source.size()) / per_row * 1.05);
+
+                std::apply([expected](auto & ... cols)  {
+                    (cols.reserve(expected), ...);
+                }, columns);
+            }
+            append(done);
+            rows += done.rows;
+            pending.erase(pending.begin());
+            next_seq += 1;
+        }
+    }
+
+    // On an error, unblock and stop the other stages
+    //
+    blocks.close();
+    chunks.close();
+    free_buffers.close();
+    reader.join();
+    closer.join();
+    if (read_error)  std::rethrow_exception(read_error);
+    if (! error.empty())  throw DataFrameError(error.c_str());
+
+    scope.add_rows(rows);
+    scope.add_bytes(source.size());
+    std::apply([&df, &names](auto &index, auto & ... cols)  {
+        std::size_t c = 0;
+
+        df.load_index(std::move(index));
+        (df.load_column(names[c++].c_str(), std::move(cols)), ...);
+    }, columns);
+    return (rows);
+}
+
+}
@@ -1,12 +1,53 @@
+#include <DataFrame/AlignColumnAppender.h>
+#include <DataFrame/AsOfJoin.h>
+#include <DataFrame/CategoryColumn.h>
+#include <DataFrame/ColumnIndex.h>
+#include <DataFrame/ColumnarFile.h>
+#include <DataFrame/CompressedColumn.h>
+#include <DataFrame/CowFrame.h>
+#include <DataFrame/CsvIngest.h>
 #include <DataFrame/DataFrame.h>
 #include <DataFrame/DataFrameFinancialVisitors.h>
+#include <DataFrame/DataFrameIncrementalVisitors.h>
 #include <DataFrame/DataFrameMLVisitors.h>
+#include <DataFrame/DataFrameSIMDKernels.h>
 #include <DataFrame/DataFrameTransformVisitors.h>
+#include <DataFrame/LazyQuery.h>
+#include <DataFrame/LazyReindex.h>
+#include <DataFrame/LiveFrame.h>
+#include <DataFrame/ParallelRandGen.h>
+#include <DataFrame/ParallelVisit.h>
 #include <DataFrame/RandGen.h>
+#include <DataFrame/RetypeEngine.h>
+#include <DataFrame/Utils/ArenaAllocator.h>
+#include <DataFrame/Utils/FixedSizePriorityQueue.h>
+#include <DataFrame/Utils/Instrumentation.h>
+#include <DataFrame/Utils/ParallelFor.h>
+#include <DataFrame/Vectors/VectorSelectView.h>
+#include <DataFrame/Vectors/VectorView.h>
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
 #include <cassert>
+#include <cmath>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <set>
 #include <string> 
+#include <thread>
+
+using namespace hmdf;
 
 using MyDataFrame = StdDataFrame64<unsigned long>;
 
@@ -15,7 +56,7 @@ using StlVecType = typename MyDataFrame::template StlVecType<T>;
 
 static void test_get_reindexed() {
 
-    std::cout << "\nTesting get_reindexed( )..." << std:end1;
+    std::cout << "\nTesting get_reindexed( )..." << std::endl;
 
     MyDataFrame df;
 
@@ -34,7 +75,7 @@ static void test_get_reindexed() {
          "ll", "mm", "nn", "oo"};
     
     df.load_data(std::move(idxvec),
-                std:make_pair("dbl_col", dlbvec),
+                std::make_pair("dbl_col", dblvec),
                 std::make_pair("dbl_col_2", dblvec2),
                 std::make_pair("str_col", strvec));
     df.load_column("int_col",
@@ -53,7 +94,7 @@ static void test_get_reindexed() {
     assert(result1.get_index()[0] == 0);
     assert(result1.get_index()[14] == 10.0);
     assert(result1.get_column<int>("int_col")[3] == 4);
-    assert(result.get_column<int>("int_col")[9] == 14);
+    assert(result1.get_column<int>("int_col")[9] == 14);
     assert(result1.get_column<std::string>("str_col")[5] == "ff");
     assert(result1.get_column<double>("dbl_col_2")[10] == 112.0);
 
@@ -75,7 +116,7 @@ static void test_get_reindexed() {
 
 static void test_get_reindexed_view() {
 
-    std::cout << "\nTesting get_reindexed_view( )..." << std::end1;
+    std::cout << "\nTesting get_reindexed_view( )..." << std::endl;
 
     MyDataFrame df; 
 
@@ -94,7 +135,7 @@ static void test_get_reindexed_view() {
           "ll", "mm", "nn", "oo" };
 
     df.load_data(std::move(idxvec),
-                std::make_pair("dbl_col", dlbvec),
+                std::make_pair("dbl_col", dblvec),
                 std::make_pair("dbl_col_2", dblvec2),
                 std::make_pair("str_col", strvec));
     df.load_column("int_col",
@@ -141,7 +182,7 @@ static void test_get_reindexed_view() {
            ("int_col", "OLD_IDX");
 
     assert(result2.get_index().size() == 11);
-    assert(result2.get_colum<double>("dbl_col_2").size() == 11);
+    assert(result2.get_column<double>("dbl_col_2").size() == 11);
     assert(result2.get_column<double>("dbl_col").size() == 11);
     assert(result2.get_column<unsigned long>("OLD_IDX").size() == 11);
     assert(result2.get_column<std::string>("str_col").size() == 11);
@@ -170,7 +211,7 @@ static void test_get_reindexed_view() {
 
 static void test_retype_column() {
 
-    std::cout << "\nTesting retype_column( ) ..." << std::end1;
+    std::cout << "\nTesting retype_column( ) ..." << std::endl;
 
     StlVecType<unsigned long> idxvec = 
        { 1UL, 2UL, 3UL, 10UL, 5UL, 7UL, 8UL, 12UL, 9UL, 12UL,
@@ -212,7 +253,7 @@ static void test_retype_column() {
 
 static void test_load_align_column() {
 
-    std::cout << "\nTesting load_align_column( ) ..." << std::end1;
+    std::cout << "\nTesting load_align_column( ) ..." << std::endl;
 
     StlVecType<unsigned long> idxvec = 
        { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
@@ -228,7 +269,7 @@ static void test_load_align_column() {
                         std::move(summary_vec),
                         5,
                         true,
-                        std::numeric_limits<double>::quite_NaN());
+                        std::numeric_limits<double>::quiet_NaN());
     
     StlVecType<double> summary_vec_2 = { 102, 202, 302, 402, 502 };
 
@@ -253,3 +294,2418 @@ static void test_load_align_column() {
     assert(std::isnan(df.get_column<double>("summary_col_2")[26]));
 }
 
+// ----------------------------------------------------------------------------
+
+static void test_fixed_size_priority_queue() {
+
+    std::cout << "\nTesting FixedSizePriorityQueue ..." << std::endl;
+
+    using Queue = FixedSizePriorityQueue<int, 50>;
+
+    std::mt19937                        gen { 5 };
+    std::uniform_int_distribution<int>  dist (-1000, 1000);
+    StlVecType<int>                     items (5000);
+
+    for (auto &v : items)  v = dist(gen);
+
+    // After each push, against the 50 largest items so far
+    //
+    Queue                   queue;
+    std::multiset<int>      kept;
+
+    assert(queue.empty() && ! queue.full());
+    for (std::size_t i = 0; i < items.size(); ++i)  {
+        queue.push(items[i]);
+        kept.insert(items[i]);
+        if (kept.size() > Queue::capacity())  kept.erase(kept.begin());
+
+        assert(queue.size() == kept.size());
+        assert(queue.full() == (kept.size() == Queue::capacity()));
+        assert(queue.top() == *kept.rbegin());
+        assert(queue.threshold() == *kept.begin());
+    }
+
+    StlVecType<int> sorted = items;
+
+    std::sort(sorted.begin(), sorted.end());
+
+    const StlVecType<int>   largest (sorted.end() - 50, sorted.end());
+
+    assert(queue.data() == largest);
+
+    // Full, an item is admitted only if it beats the threshold, and then
+    // replaces it
+    //
+    const int   weakest = queue.threshold();
+
+    queue.push(weakest);
+    assert(queue.data() == largest);
+    queue.push(5000);
+    assert(queue.size() == 50 && queue.top() == 5000);
+    assert(queue.threshold() == largest[1]);
+
+    // pop() hands the items back strongest first
+    //
+    Queue   popped = queue;
+
+    assert(popped.top() == 5000);
+    popped.pop();
+    for (std::size_t i = largest.size() - 1; i > 0; --i)  {
+        assert(popped.top() == largest[i]);
+        popped.pop();
+    }
+    assert(popped.empty());
+    popped.pop();
+    assert(popped.empty());
+
+    // push_batch() retains what repeated push() does, in one span or many
+    //
+    Queue   batched;
+    Queue   pieces;
+
+    batched.push_batch(items);
+    for (std::size_t i = 0; i < items.size(); i += 777)
+        pieces.push_batch(std::span<const int>(
+            items.data() + i, std::min<std::size_t>(777, items.size() - i)));
+    assert(batched.data() == largest);
+    assert(pieces.data() == largest);
+
+    // data(span) fills the caller's buffer, strongest items first to go in
+    //
+    std::vector<int>    exact (50);
+    std::vector<int>    longer (60, -7);
+    std::vector<int>    shorter (10);
+
+    assert(batched.data(exact) == 50 && exact == largest);
+    assert(batched.data(longer) == 50);
+    assert(std::equal(largest.begin(), largest.end(), longer.begin()));
+    assert(longer[50] == -7);
+    assert(batched.data(shorter) == 10);
+    assert(std::equal(shorter.begin(), shorter.end(), largest.end() - 10));
+
+    // Copies and moves point at their own storage
+    //
+    Queue   copied (batched);
+    Queue   assigned;
+
+    copied.pop();
+    assert(copied.size() == 49 && batched.size() == 50);
+    assigned = batched;
+    assigned.push(5000);
+    assert(assigned.top() == 5000 && batched.top() == largest.back());
+
+    Queue   moved (std::move(copied));
+    Queue   move_assigned;
+
+    assert(moved.size() == 49 && moved.top() == largest[48]);
+    moved.push(6000);
+    assert(moved.full() && moved.top() == 6000);
+    move_assigned = std::move(assigned);
+    assert(move_assigned.size() == 50 && move_assigned.top() == 5000);
+    move_assigned.clear();
+    assert(move_assigned.empty());
+
+    // With std::greater the smallest items are retained
+    //
+    FixedSizePriorityQueue<int, 50, std::greater<int>>  smallest;
+
+    smallest.push_batch(items);
+    assert(smallest.top() == sorted.front());
+    assert(smallest.threshold() == sorted[49]);
+}
+
+// ----------------------------------------------------------------------------
+
+static void test_vector_view_iterators() {
+
+    std::cout << "\nTesting VectorView iterators ..." << std::endl;
+
+    StlVecType<int> vec (1000);
+
+    for (std::size_t i = 0; i < vec.size(); ++i)
+        vec[i] = int(i * 7919 % 1000);
+
+    VectorView<int>         view (vec.data() + 100, vec.data() + 900);
+    const VectorView<int>   &cview = view;
+    VectorConstView<int>    const_view (vec.data() + 100, vec.data() + 900);
+
+    // Distance, ordering and indexing are pointer arithmetic
+    //
+    const auto  first = view.begin();
+    const auto  last = view.end();
+
+    assert(view.data() == vec.data() + 100);
+    assert(cview.data() == vec.data() + 100);
+    assert(const_view.data() == vec.data() + 100);
+    assert(last - first == 800 && first - last == -800);
+    assert(std::distance(first, last) == 800);
+    assert(const_view.end() - const_view.begin() == 800);
+    assert(cview.end() - cview.begin() == 800);
+    assert((first <=> last) == std::strong_ordering::less);
+    assert((last <=> first) == std::strong_ordering::greater);
+    assert((first + 5 <=> 5 + first) == std::strong_ordering::equal);
+    assert(first < last && last >= first && first != last);
+    assert(first[7] == vec[107] && (3 + first)[4] == vec[107]);
+    assert(&*(last - 1) == &view.back());
+    assert(cview.begin()[799] == vec[899]);
+    assert((2 + const_view.begin())[5] == vec[107]);
+    assert(std::to_address(first + 10) == vec.data() + 110);
+
+    // The std algorithms work over views as over the vector
+    //
+    StlVecType<int> expected (vec.begin() + 100, vec.begin() + 900);
+
+    std::sort(expected.begin(), expected.end());
+    std::sort(view.begin(), view.end());
+    assert(std::equal(view.begin(), view.end(), expected.begin()));
+    assert(vec[99] == int(99 * 7919 % 1000));
+    assert(vec[900] == int(900 * 7919 % 1000));
+    for (const int value : { -1, 0, 500, 999, 1000 })  {
+        const auto  iter =
+            std::lower_bound(const_view.begin(), const_view.end(), value);
+        const auto  ref =
+            std::lower_bound(expected.begin(), expected.end(), value);
+
+        assert(iter - const_view.begin() == ref - expected.begin());
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+static void test_select_views() {
+
+    std::cout << "\nTesting strided and indexed views ..." << std::endl;
+
+    MyDataFrame df;
+
+    StlVecType<unsigned long> idxvec =
+        { 1UL, 2UL, 3UL, 10UL, 5UL, 7UL, 8UL, 12UL, 9UL, 12UL, 10UL, 13UL,
+          10UL, 15UL, 14UL };
+    StlVecType<double> dblvec =
+        { 0.0, 15.0, 14.0, 2.0, 1.0, 12.0, 11.0, 8.0, 7.0, 6.0, 5.0, 4.0, 3.0,
+          9.0, 10.0 };
+    StlVecType<double> dblvec2 =
+        { 100.0, 101.0, 102.0, 103.0, 104.0, 105.0, 106.55, 107.34, 1.8, 111.0,
+          112.0, 113.0, 114.0, 115.0, 116.0 };
+    StlVecType<std::string> strvec =
+        { "zz", "bb", "cc", "ww", "ee", "ff", "gg", "hh", "ii", "jj", "kk",
+          "ll", "mm", "nn", "oo" };
+
+    df.load_data(std::move(idxvec),
+                 std::make_pair("dbl_col", dblvec),
+                 std::make_pair("dbl_col_2", dblvec2),
+                 std::make_pair("str_col", strvec));
+
+    // Every 4th row
+    //
+    auto    strided = make_strided_view(df.get_column<double>("dbl_col_2"),
+                                        1, 4);
+
+    assert(strided.size() == 4);
+    assert(strided[0] == 101.0);
+    assert(strided[1] == 105.0);
+    assert(strided.back() == 115.0);
+    assert(strided.end() - strided.begin() == 4);
+
+    // A start past the end gives an empty view
+    //
+    auto    past_end = make_strided_view(df.get_column<double>("dbl_col_2"),
+                                         100, 4);
+
+    assert(past_end.size() == 0);
+    assert(past_end.begin() == past_end.end());
+
+    // Rows where dbl_col > 8
+    //
+    const auto          &dbl_col = df.get_column<double>("dbl_col");
+    std::vector<bool>   mask (dbl_col.size());
+
+    for (std::size_t i = 0; i < dbl_col.size(); ++i)
+        mask[i] = dbl_col[i] > 8.0;
+
+    const RowSelectionPtr   rows = make_row_selection(mask);
+    auto                    idx_view = make_indexed_view(df.get_index(), rows);
+    auto                    dbl_view =
+        make_indexed_view(df.get_column<double>("dbl_col_2"), rows);
+    auto                    str_view =
+        make_indexed_view(df.get_column<std::string>("str_col"), rows);
+
+    assert(rows->size() == 6);
+    assert(idx_view.size() == 6);
+    assert(dbl_view.size() == 6);
+    assert(str_view.size() == 6);
+    assert(idx_view[0] == 2UL);
+    assert(idx_view[5] == 14UL);
+    assert(dbl_view[2] == 105.0);
+    assert(str_view[3] == "gg");
+    assert(str_view.back() == "oo");
+    assert(dbl_view.end() - dbl_view.begin() == 6);
+
+    // Views write through to the frame
+    //
+    dbl_view[2] = 1002.45;
+    assert(df.get_column<double>("dbl_col_2")[5] == 1002.45);
+
+    const MyDataFrame   &const_df = df;
+    auto                const_view =
+        make_masked_view(const_df.get_column<std::string>("str_col"), mask);
+
+    assert(const_view.size() == 6);
+    assert(const_view.front() == "bb");
+}
+
+// ----------------------------------------------------------------------------
+
+static void test_lazy_reindex() {
+
+    std::cout << "\nTesting get_lazy_reindexed( ) ..." << std::endl;
+
+    MyDataFrame df;
+
+    StlVecType<unsigned long> idxvec =
+        { 1UL, 2UL, 3UL, 4UL, 5UL, 6UL, 7UL, 8UL, 12UL, 9UL, 10UL, 13UL,
+          10UL, 15UL, 14UL };
+    StlVecType<double> dblvec =
+        { 0.0, 15.0, 14.0, 2.0, 1.0, 12.0, 11.0, 8.0, 7.0, 6.0, 5.0, 4.0, 3.0,
+          9.0, 10.0 };
+    StlVecType<double> dblvec2 =
+        { 100.0, 101.0, 102.0, 103.0, 104.0, 105.0, 106.55, 107.34, 1.8, 111.0,
+          112.0, 113.0, 114.0, 115.0, 116.0 };
+    StlVecType<int> intvec = { 1, 2, 3, 4, 5, 8, 6, 7, 11, 14, 9 };
+    StlVecType<std::string> strvec =
+       { "zz", "bb", "cc", "ww", "ee", "ff", "gg", "hh", "ii", "jj", "kk",
+         "ll", "mm", "nn", "oo"};
+
+    df.load_data(std::move(idxvec),
+                 std::make_pair("dbl_col", dblvec),
+                 std::make_pair("dbl_col_2", dblvec2),
+                 std::make_pair("str_col", strvec));
+    df.load_column("int_col",
+                   std::move(intvec),
+                   nan_policy::dont_pad_with_nans);
+
+    // Same results as get_reindexed(), without copying columns
+    //
+    auto    result1 = get_lazy_reindexed<double>(df, "dbl_col", "OLD_IDX");
+
+    assert(result1.get_index().size() == 15);
+    assert(result1.get_column_view<double>("dbl_col_2").size() == 15);
+    assert(result1.get_column_view<unsigned long>("OLD_IDX").size() == 15);
+    assert(result1.get_column_view<std::string>("str_col").size() == 15);
+    assert(result1.get_column_view<int>("int_col").size() == 11);
+    assert(result1.get_index()[0] == 0);
+    assert(result1.get_index()[14] == 10.0);
+    assert(result1.get_column_view<int>("int_col")[3] == 4);
+    assert(result1.get_column_view<int>("int_col")[9] == 14);
+    assert(result1.get_column_view<std::string>("str_col")[5] == "ff");
+    assert(result1.get_column_view<double>("dbl_col_2")[10] == 112.0);
+    assert(! result1.is_materialized("dbl_col_2"));
+    assert(result1.get_column<double>("dbl_col_2")[10] == 112.0);
+    assert(result1.is_materialized("dbl_col_2"));
+
+    auto    result2 = get_lazy_reindexed<int>(df, "int_col", "OLD_IDX");
+
+    assert(result2.get_index().size() == 11);
+    assert(result2.get_column_view<double>("dbl_col_2").size() == 11);
+    assert(result2.get_column<double>("dbl_col_2").size() == 11);
+    assert(result2.get_column<double>("dbl_col").size() == 11);
+    assert(result2.get_column<unsigned long>("OLD_IDX").size() == 11);
+    assert(result2.get_column<double>("dbl_col_2")[10] == 112.0);
+    assert(result2.get_column<double>("dbl_col")[3] == 2.0);
+    assert(result2.get_column_view<std::string>("str_col")[5] == "ff");
+    assert(result2.get_index()[0] == 1);
+    assert(result2.get_index()[10] == 9);
+
+    // Reindex sorted by the new index. The permutation is computed once and
+    // shared by all columns.
+    //
+    auto                result3 =
+        get_lazy_reindexed<double>(df, "dbl_col", "OLD_IDX", true);
+    WorkStealingPool    pool (3);
+
+    result3.materialize<double>({ "dbl_col_2" }, pool);
+    assert(result3.is_materialized("dbl_col_2"));
+    assert(result3.get_index()[0] == 0.0);
+    assert(result3.get_index()[1] == 1.0);
+    assert(result3.get_index()[14] == 15.0);
+    assert(result3.get_column<double>("dbl_col_2")[1] == 104.0);
+    assert(result3.get_column<double>("dbl_col_2")[14] == 101.0);
+    assert(result3.get_column_view<std::string>("str_col")[14] == "bb");
+    assert(result3.get_column_view<unsigned long>("OLD_IDX")[2] == 4UL);
+    assert(result3.get_column<int>("int_col").size() == 15);
+    assert(result3.get_column<int>("int_col")[1] == 5);
+    assert(std::count(result3.get_column<int>("int_col").begin(),
+                      result3.get_column<int>("int_col").end(), 0) == 4);
+    assert(result3.get_permutation()->size() == 15);
+    try  {
+        (void) result3.get_column<float>("dbl_col_2");
+        assert(false);
+    }
+    catch (const NotFeasible &)  {  }
+}
+
+// ----------------------------------------------------------------------------
+
+static void test_retype_column_bulk() {
+
+    std::cout << "\nTesting retype_column_bulk( ) ..." << std::endl;
+
+    StlVecType<unsigned long> idxvec =
+       { 1UL, 2UL, 3UL, 10UL, 5UL, 7UL, 8UL, 12UL, 9UL, 12UL,
+         10UL, 13UL, 10UL, 15UL, 14UL };
+    StlVecType<int> intvec =
+       { -1, 2, 3, 4, 5, 8, -6, 7, 11, 14, -9, 12, 13, 14, 15 };
+    StlVecType<std::string> strvec =
+       { "11", "22", "33", "44", "55", "66", "-77", "88", "99", "100",
+         "101", "1o2", "103", " +104", "-105" };
+
+    MyDataFrame     df;
+    RetypeErrorMask errors;
+
+    df.load_data(std::move(idxvec),
+                 std::make_pair("str_col", strvec),
+                 std::make_pair("int_col", intvec));
+
+    // Same values as retype_column<int, unsigned int>(), with the wrapped
+    // rows flagged
+    //
+    assert((retype_column_bulk<int, unsigned int>(df, "int_col", errors) ==
+            3));
+    assert(df.get_index().size() == 15);
+    assert(df.get_column<unsigned int>("int_col").size() == 15);
+    assert(df.get_column<unsigned int>("int_col")[0] == 4294967295);
+    assert(df.get_column<unsigned int>("int_col")[1] == 2);
+    assert(df.get_column<unsigned int>("int_col")[6] == 4294967290);
+    assert(df.get_column<unsigned int>("int_col")[8] == 11);
+    assert(errors.size() == 15);
+    assert(errors[0] == RetypeError::out_of_range);
+    assert(errors[1] == RetypeError::none);
+    assert(errors[10] == RetypeError::out_of_range);
+
+    // Bad strings are reported, not thrown
+    //
+    WorkStealingPool    pool (3);
+
+    assert((retype_column_bulk<std::string, int>(df, "str_col", errors,
+                                                  pool) == 1));
+    assert(df.get_column<int>("str_col").size() == 15);
+    assert(df.get_column<int>("str_col")[0] == 11);
+    assert(df.get_column<int>("str_col")[6] == -77);
+    assert(df.get_column<int>("str_col")[13] == 104);
+    assert(df.get_column<int>("str_col")[14] == -105);
+    assert(errors[11] == RetypeError::invalid);
+    assert(errors[13] == RetypeError::none);
+
+    const StlVecType<std::string>   big = { "1e400", "2.5", "nan", "x" };
+    const auto                      dbls =
+        bulk_convert<std::string, double>(big, errors);
+
+    assert(errors[0] == RetypeError::out_of_range);
+    assert(dbls[1] == 2.5);
+    assert(std::isnan(dbls[2]) && errors[2] == RetypeError::none);
+    assert(std::isnan(dbls[3]) && errors[3] == RetypeError::invalid);
+
+    const StlVecType<std::string>   signs = { "+5", "+-5", "-5" };
+    const auto                      ints = bulk_convert<std::string, int>(
+                                               signs, errors);
+
+    assert(ints[0] == 5 && errors[0] == RetypeError::none);
+    assert(errors[1] == RetypeError::invalid);
+    assert(ints[2] == -5 && errors[2] == RetypeError::none);
+
+    const StlVecType<double>    huge = { 1e300, -2.5 };
+    const auto                  flts = bulk_convert<double, float>(huge,
+                                                                   errors);
+
+    assert(flts[0] == 0 && errors[0] == RetypeError::out_of_range);
+    assert(flts[1] == -2.5f && errors[1] == RetypeError::none);
+}
+
+// ----------------------------------------------------------------------------
+
+static void test_align_column_appender() {
+
+    std::cout << "\nTesting AlignColumnAppender ..." << std::endl;
+
+    StlVecType<unsigned long> idxvec =
+       { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+         16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28 };
+    StlVecType<int> intvec =
+       { -1, 2, 3, 4, 5, 8, -6, 7, 11, 14, -9, 12, 13, 14, 15 };
+    const StlVecType<double> summary_vec = { 100, 200, 300, 400, 500 };
+    const StlVecType<double> summary_vec_2 = { 102, 202, 302, 402, 502 };
+    const double             nan = std::numeric_limits<double>::quiet_NaN();
+
+    // The batch result to match
+    //
+    MyDataFrame batch_df;
+
+    batch_df.load_data(StlVecType<unsigned long>(idxvec),
+                       std::make_pair("int_col", intvec));
+    batch_df.load_align_column("summary_col",
+                               StlVecType<double>(summary_vec),
+                               5, true, nan);
+    batch_df.load_align_column("summary_col_2",
+                               StlVecType<double>(summary_vec_2),
+                               5, false, nan);
+
+    // Start with 3 rows and one summary value, then trickle in the rest
+    //
+    MyDataFrame live_df;
+
+    live_df.load_data(StlVecType<unsigned long>(idxvec.begin(),
+                                                idxvec.begin() + 3),
+                      std::make_pair("int_col", intvec));
+
+    auto    appender =
+        make_align_column_appender(live_df, "summary_col",
+                                   StlVecType<double> { 100 },
+                                   5, true, nan);
+    auto    appender_2 =
+        make_align_column_appender(live_df, "summary_col_2",
+                                   StlVecType<double> { },
+                                   5, false, nan);
+
+    assert(live_df.get_column<double>("summary_col").size() == 3);
+    assert(live_df.get_column<double>("summary_col")[0] == 100);
+    assert(live_df.get_column<double>("summary_col_2").size() == 3);
+
+    std::size_t summ_pos { 1 };
+
+    for (std::size_t i = 3; i < idxvec.size(); ++i) {
+        // First row of the index, then the summary values of the bar
+        //
+        appender.append_index(idxvec[i]);
+        appender_2.sync();
+        if (i % 5 == 0 && summ_pos < summary_vec.size()) {
+            appender.append_summary(summary_vec[summ_pos]);
+            appender_2.append_summary(summary_vec_2[summ_pos - 1]);
+            summ_pos += 1;
+        }
+    }
+    appender_2.append_summary(summary_vec_2.back());
+
+    // summary_col_2 starts one interval later, so its last value has no row
+    //
+    assert(appender.pending_count() == 0);
+    assert(appender_2.pending_count() == 0);
+    assert(appender.summary_count() == 5);
+
+    const auto  &live_col = live_df.get_column<double>("summary_col");
+    const auto  &live_col_2 = live_df.get_column<double>("summary_col_2");
+    const auto  &batch_col = batch_df.get_column<double>("summary_col");
+    const auto  &batch_col_2 = batch_df.get_column<double>("summary_col_2");
+
+    assert(live_df.get_index().size() == 28);
+    assert(live_col.size() == batch_col.size());
+    assert(live_col_2.size() == batch_col_2.size());
+    for (std::size_t i = 0; i < batch_col.size(); ++i) {
+        assert((std::isnan(live_col[i]) && std::isnan(batch_col[i])) ||
+               live_col[i] == batch_col[i]);
+        assert((std::isnan(live_col_2[i]) && std::isnan(batch_col_2[i])) ||
+               live_col_2[i] == batch_col_2[i]);
+    }
+    assert(live_col[5] == 200);
+    assert(live_col[20] == 500);
+    assert(live_col_2[25] == 502);
+    assert(std::isnan(live_col_2[0]));
+
+    // A summary value ahead of the index is held until its row arrives
+    //
+    appender.append_summary(600);
+    assert(appender.pending_count() == 0);
+    appender.append_summary(700);
+    assert(appender.pending_count() == 1);
+    appender.append_index(StlVecType<unsigned long> { 29, 30, 31 });
+    assert(appender.pending_count() == 0);
+    assert(live_df.get_column<double>("summary_col").size() == 31);
+    assert(live_df.get_column<double>("summary_col")[25] == 600);
+    assert(live_df.get_column<double>("summary_col")[30] == 700);
+    assert(std::isnan(live_df.get_column<double>("summary_col")[29]));
+}
+
+// ----------------------------------------------------------------------------
+
+static void test_columnar_file() {
+
+    std::cout << "\nTesting ColumnarFile ..." << std::endl;
+
+    const char  *path = "test_columnar_file.hmdf";
+    MyDataFrame df;
+
+    df.load_data(StlVecType<unsigned long> { 10, 20, 30, 40, 50, 60, 70 },
+                 std::make_pair("dbl_col",
+                                StlVecType<double> { 1.5, -2.25, 3, 0,
+                                                     1e300, -7, 8.125 }),
+                 std::make_pair("int_col",
+                                StlVecType<int> { -1, 2, -3, 4, -5, 6, -7 }),
+                 std::make_pair("str_col",
+                                StlVecType<std::string> { "AAPL", "", "IBM",
+                                                          "MSFT", "GOOG",
+                                                          "", "JPM" }));
+    write_columnar_file<double, int, std::string>(df, path);
+
+    ColumnarFile    file (path);
+
+    assert(file.is_open());
+    assert(file.shape_rows() == 7);
+    assert(file.column_count() == 3);
+    assert(file.has_column("dbl_col"));
+    assert(! file.has_column("INDEX"));
+
+    const auto  idx = file.get_index_view<unsigned long>();
+    const auto  dbl_view = file.get_column_view<double>("dbl_col");
+    const auto  int_view = file.get_column_view<int>("int_col");
+
+    // Views point straight into the mapping, on aligned blocks
+    //
+    assert(reinterpret_cast<std::uintptr_t>(dbl_view.data()) % 64 == 0);
+    assert(std::equal(idx.begin(), idx.end(), df.get_index().begin()));
+    assert(dbl_view.size() == 7);
+    assert(std::equal(dbl_view.begin(), dbl_view.end(),
+                      df.get_column<double>("dbl_col").begin()));
+    assert(std::equal(int_view.begin(), int_view.end(),
+                      df.get_column<int>("int_col").begin()));
+    assert(file.get_string_column("str_col") ==
+           df.get_column<std::string>("str_col"));
+    assert(file.column_meta("int_col").type == ColumnarType::int32);
+
+    try  {
+        (void) file.get_column_view<float>("dbl_col");
+        assert(false);
+    }
+    catch (const NotFeasible &)  {  }
+    try  {
+        (void) file.get_column_view<double>("no_col");
+        assert(false);
+    }
+    catch (const ColNotFound &)  {  }
+
+    // The views stay valid when the file object moves
+    //
+    ColumnarFile    moved = std::move(file);
+
+    assert(! file.is_open());
+    assert(dbl_view[6] == 8.125);
+
+    MyDataFrame df2;
+
+    moved.load_into<double, int, std::string>(df2);
+    assert(df2.get_index() == df.get_index());
+    assert(df2.get_column<double>("dbl_col") ==
+           df.get_column<double>("dbl_col"));
+    assert(df2.get_column<int>("int_col") == df.get_column<int>("int_col"));
+    assert(df2.get_column<std::string>("str_col")[4] == "GOOG");
+
+    moved.close();
+
+    // Corrupt copies, each with one bad field, must be refused at open
+    //
+    std::string bytes;
+
+    {
+        std::ifstream   stream (path, std::ios::binary);
+
+        bytes.assign(std::istreambuf_iterator<char>(stream),
+                     std::istreambuf_iterator<char>());
+    }
+
+    const auto  meta_at = [&bytes](const char *name)  {
+        for (std::size_t pos = sizeof(ColumnarFileHeader);
+             pos < bytes.size();
+             pos += sizeof(ColumnarColumnMeta))
+            if (! std::strcmp(bytes.data() + pos, name))  return (pos);
+        assert(false);
+        return (std::size_t(0));
+    };
+    const auto  opens_corrupt = [&bytes, path](std::size_t pos,
+                                               std::uint64_t value,
+                                               std::size_t width)  {
+        std::string corrupt = bytes;
+
+        std::memcpy(corrupt.data() + pos, &value, width);
+        std::ofstream(path, std::ios::binary | std::ios::trunc)
+            .write(corrupt.data(), std::streamsize(corrupt.size()));
+        try  {
+            ColumnarFile    bad (path);
+
+            return (false);
+        }
+        catch (const DataFrameError &)  {  }
+        return (true);
+    };
+    const std::size_t   dbl_meta = meta_at("dbl_col");
+    const std::size_t   str_meta = meta_at("str_col");
+    std::uint64_t       str_offset;
+
+    std::memcpy(&str_offset,
+                bytes.data() + str_meta + offsetof(ColumnarColumnMeta, offset),
+                sizeof(str_offset));
+    assert(opens_corrupt(dbl_meta + offsetof(ColumnarColumnMeta, count),
+                         1000, sizeof(std::uint64_t)));
+    assert(opens_corrupt(meta_at("int_col") +
+                             offsetof(ColumnarColumnMeta, type),
+                         99, sizeof(std::uint32_t)));
+    assert(opens_corrupt(dbl_meta + offsetof(ColumnarColumnMeta, elem_size),
+                         4, sizeof(std::uint32_t)));
+    assert(opens_corrupt(str_meta + offsetof(ColumnarColumnMeta, count),
+                         1000, sizeof(std::uint64_t)));
+    assert(opens_corrupt(str_offset + 2 * sizeof(std::uint64_t),
+                         0, sizeof(std::uint64_t)));    // Goes down
+    assert(opens_corrupt(str_offset + 7 * sizeof(std::uint64_t),
+                         1000, sizeof(std::uint64_t))); // Past the chars
+    assert(! opens_corrupt(0, bytes[0], 1));            // Unchanged
+
+    std::remove(path);
+}
+
+// ----------------------------------------------------------------------------
+
+static void test_arena_allocator() {
+
+    std::cout << "\nTesting ArenaAllocator ..." << std::endl;
+
+    MonotonicArena  arena (4096);
+
+    {
+        ArenaVector<double> col ((ArenaAllocator<double, 64>(arena)));
+
+        col.reserve(100);
+        for (int i = 0; i < 100; ++i)
+            col.push_back(double(i) * 0.5);
+        assert(reinterpret_cast<std::uintptr_t>(col.data()) % 64 == 0);
+        assert(arena.bytes_used() == 100 * sizeof(double));
+        assert(arena.allocation_count() == 1);
+
+        // A VectorView over it gets the alignment it is declared with
+        //
+        VectorView<double, 64>  vw;
+
+        vw = col;
+        assert(vw.size() == 100);
+        assert(vw[99] == 49.5);
+
+        // A block bigger than the first one gets its own block
+        //
+        ArenaVector<int, 128>   big ((ArenaAllocator<int, 128>(arena)));
+
+        big.resize(10000, 7);
+        assert(reinterpret_cast<std::uintptr_t>(big.data()) % 128 == 0);
+        assert(arena.block_count() == 2);
+        assert(col[10] == 5.0);
+    }
+
+    const std::size_t   reserved = arena.bytes_reserved();
+
+    arena.reset();
+    assert(arena.bytes_used() == 0);
+    assert(arena.bytes_reserved() == reserved);
+
+    // Default constructed allocators draw from the thread's arena while a
+    // scope is up, and from the heap otherwise
+    //
+    {
+        ArenaScope              scope (arena);
+        MonotonicArena          other;
+        ArenaVector<long, 64>   tmp (1000, 3L);
+        std::vector<unsigned long, ArenaAllocator<unsigned long>>   rows;
+
+        rows.push_back(5);
+        assert(tmp.get_allocator().arena() == &arena);
+        assert(rows.get_allocator().arena() == &arena);
+        assert(rows.get_allocator() == ArenaAllocator<unsigned long>());
+        assert(rows.get_allocator() == ArenaAllocator<int>(arena));
+        assert(ArenaAllocator<int>(arena) != ArenaAllocator<long>(other));
+        assert(ArenaAllocator<int>(arena) != ArenaAllocator<int>(other));
+        assert(arena.allocation_count() == 2);
+        assert(arena.block_count() == 2);  // The kept blocks are reused
+        assert(arena.bytes_reserved() == reserved);
+    }
+    assert(arena.bytes_used() == 0);
+
+    ArenaVector<double> heap_vec (10, 1.0);
+
+    assert(heap_vec.get_allocator().arena() == nullptr);
+    assert(reinterpret_cast<std::uintptr_t>(heap_vec.data()) % 64 == 0);
+
+    arena.release();
+    assert(arena.block_count() == 0);
+    assert(arena.bytes_reserved() == 0);
+}
+
+// ----------------------------------------------------------------------------
+
+static void test_sharded_top_k() {
+
+    std::cout << "\nTesting ShardedTopK ..." << std::endl;
+
+    std::mt19937_64                         gen { 42 };
+    std::lognormal_distribution<double>     dist { 10.0, 2.0 };
+    StlVecType<double>                      notionals (200000);
+
+    for (auto &v : notionals)  v = dist(gen);
+
+    FixedSizePriorityQueue<double, 100> single;
+
+    single.push_batch(notionals);
+
+    // merge() of two halves is the same as one queue over both
+    //
+    FixedSizePriorityQueue<double, 100> lower;
+    FixedSizePriorityQueue<double, 100> upper;
+
+    for (std::size_t i = 0; i < notionals.size(); ++i)
+        (i < notionals.size() / 2 ? lower : upper).push(notionals[i]);
+    lower.merge(upper);
+    assert(lower.data() == single.data());
+
+    constexpr std::size_t           shards { 4 };
+    ShardedTopK<double, 100>        top_k (shards);
+    std::vector<std::thread>        threads;
+    const std::size_t               slice = notionals.size() / shards;
+
+    assert(! top_k.has_threshold());
+    for (std::size_t t = 0; t < shards; ++t)
+        threads.emplace_back([&top_k, &notionals, slice, t]() {
+            auto            &shard = top_k.shard(t);
+            const double    *begin = notionals.data() + t * slice;
+
+            if (t % 2)  // push() on half the shards, push_batch() on the rest
+                for (std::size_t i = 0; i < slice; ++i)
+                    shard.push(begin[i]);
+            else
+                for (std::size_t i = 0; i < slice; i += 1000)
+                    shard.push_batch(std::span<const double>(begin + i,
+                                                             1000));
+        });
+    for (auto &thr : threads)  thr.join();
+
+    const auto  merged = top_k.data();
+
+    assert(merged == single.data());
+    assert(top_k.has_threshold());
+    assert(top_k.threshold() <= merged.front());
+
+    // Whole spans at once, after a clear()
+    //
+    top_k.clear();
+    assert(! top_k.has_threshold());
+    for (std::size_t t = 0; t < shards; ++t)
+        top_k.shard(t).push_batch(std::span<const double>(
+            notionals.data() + t * slice, slice));
+    assert(top_k.merge().top() == single.top());
+    assert(top_k.data() == single.data());
+
+    // The threshold starts below any item, whichever way Cmp orders them
+    //
+    using SmallestK = ShardedTopK<int, 3, std::greater<int>>;
+
+    ShardedTopK<int, 3>                 largest (2);
+    SmallestK                           smallest (2);
+    FixedSizePriorityQueue<int, 3>      largest_single;
+    FixedSizePriorityQueue<int, 3, std::greater<int>>   smallest_single;
+
+    for (int v = -50; v < 0; ++v)  {
+        largest.shard(v & 1).push(v);
+        smallest.shard(v & 1).push(-v);
+        largest_single.push(v);
+        smallest_single.push(-v);
+    }
+    assert(largest.threshold() == -5);
+    assert(largest.data() == largest_single.data());
+    assert(smallest.threshold() == 5);
+    assert(smallest.data() == smallest_single.data());
+}
+
+// ----------------------------------------------------------------------------
+
+static void test_category_column() {
+
+    std::cout << "\nTesting CategoryCode columns ..." << std::endl;
+
+    MyDataFrame df;
+
+    StlVecType<unsigned long> idxvec =
+        { 1UL, 2UL, 3UL, 10UL, 5UL, 7UL, 8UL, 12UL, 9UL, 12UL, 10UL, 13UL,
+          10UL, 15UL, 14UL };
+    StlVecType<double> dblvec =
+        { 0.0, 15.0, 14.0, 2.0, 1.0, 12.0, 11.0, 8.0, 7.0, 6.0, 5.0, 4.0, 3.0,
+          9.0, 10.0 };
+    StlVecType<std::string> strvec =
+        { "IBM", "AAPL", "IBM", "MSFT", "AAPL", "JPM", "IBM", "GS", "MSFT",
+          "AAPL", "GS", "JPM", "IBM", "MSFT", "AAPL" };
+    StlVecType<std::string> venues =
+        { "XNYS", "XNAS", "XNYS", "XNAS", "XNAS", "XNYS", "XNYS", "XNYS",
+          "XNAS", "XNAS", "XNYS", "XNYS", "XNYS", "XNAS", "XNAS" };
+
+    df.load_data(std::move(idxvec),
+                 std::make_pair("dbl_col", dblvec),
+                 std::make_pair("str_col", strvec));
+
+    auto    dict = std::make_shared<StringDictionary>();
+
+    df.retype_column<std::string, CategoryCode>("str_col",
+                                                category_encoder(dict));
+    load_category_column(df, "venue_col", venues, *dict);
+
+    const auto  &codes = df.get_column<CategoryCode>("str_col");
+
+    assert(dict->size() == 7);  // 5 symbols and 2 venues
+    assert(codes.size() == 15);
+    assert(codes[0] == codes[2] && codes[0] == codes[6]);
+    assert(codes[0] != codes[1]);
+    assert(dict->decode(codes[7]) == "GS");
+    assert(dict->find("GS") == codes[7]);
+    assert(dict->find("C").is_null());
+    assert(dict->decode(CategoryCode { }).empty());
+
+    // Codes order by first appearance, lexical_less() by the strings
+    //
+    const auto  lexical = dict->lexical_less();
+
+    assert(codes[0] < codes[1]);
+    assert(lexical(codes[1], codes[0]));  // AAPL < IBM
+    assert(! lexical(codes[0], codes[0]));
+    assert(lexical(CategoryCode { }, codes[1]));
+
+    // Reindexing moves codes, and decodes to the reindexed strings
+    //
+    auto    result =
+        df.get_reindexed<double, double, CategoryCode>("dbl_col", "OLD_IDX");
+
+    assert(result.get_column<CategoryCode>("str_col").size() == 15);
+    assert(decode_column(result.get_column<CategoryCode>("str_col"), *dict)
+               == strvec);
+    assert(decode_column(result.get_column<CategoryCode>("venue_col"), *dict)
+               == venues);
+
+    df.retype_column<CategoryCode, std::string>("str_col",
+                                                category_decoder(dict));
+    assert(df.get_column<std::string>("str_col") == strvec);
+}
+
+// ----------------------------------------------------------------------------
+
+static bool same_value(double lhs, double rhs) {
+
+    if (std::isnan(lhs) || std::isnan(rhs))
+        return (std::isnan(lhs) && std::isnan(rhs));
+    return (lhs == rhs || std::fabs(lhs - rhs) <=
+            1e-9 * std::max(1.0, std::max(std::fabs(lhs), std::fabs(rhs))));
+}
+
+static void test_incremental_visitors() {
+
+    std::cout << "\nTesting incremental visitors ..." << std::endl;
+
+    constexpr std::size_t   ticks { 3000 };
+    constexpr std::size_t   roll { 20 };
+    std::mt19937_64         gen { 7 };
+    std::normal_distribution<double>    dist { 0.0, 0.01 };
+    StlVecType<double>      prices (ticks);
+    StlVecType<double>      log_rets (ticks - 1);
+
+    prices[0] = 100.0;
+    for (std::size_t i = 1; i < ticks; ++i) {
+        prices[i] = prices[i - 1] * std::exp(dist(gen));
+        log_rets[i - 1] = std::log(prices[i] / prices[i - 1]);
+    }
+
+    IncrementalRollingMean<double>  sma (roll);
+    IncrementalRollingStd<double>   rstd (roll);
+    IncrementalVolatility<double>   vol (roll);
+    auto                            ewma =
+        IncrementalEWMA<double>::from_span(10);
+    IncrementalDrawdown<double>     drawdown;
+    IncrementalRSI<double>          rsi (return_policy::log, 14);
+    const double                    alpha = 2.0 / 11.0;
+    double                          ewma_batch { 0 };
+    double                          peak { 0 };
+    double                          max_dd { 0 };
+
+    static_assert(incremental_visitor<IncrementalRollingMean<double>>);
+    static_assert(incremental_visitor<IncrementalRSI<double>>);
+
+    // The batch visitors, run once over the whole column. Their results
+    // are causal and end with the column's last row, so what they report
+    // for the first end rows is end rows back from the end.
+    //
+    StlVecType<unsigned long>   idx (ticks);
+
+    std::iota(idx.begin(), idx.end(), 0UL);
+
+    const auto  batch = [&idx](auto &&visitor, const StlVecType<double> &col)  {
+        visitor.pre();
+        visitor(idx.begin(), idx.begin() + col.size(), col.begin(), col.end());
+        visitor.post();
+        return (StlVecType<double>(visitor.get_result()));
+    };
+    const auto  at_row = [](const StlVecType<double> &result,
+                            std::size_t col_s,
+                            std::size_t end)  {
+        return (result[result.size() - (col_s - end) - 1]);
+    };
+    using mean_roller = SimpleRollAdopter<MeanVisitor<double>, double>;
+    using std_roller = SimpleRollAdopter<StdVisitor<double>, double>;
+
+    const auto  batch_mean = batch(mean_roller(MeanVisitor<double>(), roll),
+                                   prices);
+    const auto  batch_std = batch(std_roller(StdVisitor<double>(), roll),
+                                  prices);
+    const auto  batch_vol = batch(std_roller(StdVisitor<double>(), roll),
+                                  log_rets);
+    const auto  batch_rsi = batch(RSIVisitor<double>(return_policy::log, 14),
+                                  prices);
+
+    // The first half goes through the visit() entry points
+    //
+    const std::size_t   half = ticks / 2;
+    const auto          catch_up = [&prices, half](auto &visitor) {
+        visitor.pre();
+        visitor(prices.begin(), prices.begin() + half,
+                prices.begin(), prices.begin() + half);
+        visitor.post();
+    };
+
+    catch_up(sma);
+    catch_up(rstd);
+    catch_up(vol);
+    catch_up(ewma);
+    catch_up(drawdown);
+    catch_up(rsi);
+    for (std::size_t i = 0; i < half; ++i) {
+        ewma_batch = i ? ewma_batch + alpha * (prices[i] - ewma_batch)
+                       : prices[i];
+        peak = i ? std::max(peak, prices[i]) : prices[i];
+        max_dd = std::max(max_dd, peak - prices[i]);
+    }
+    assert(same_value(sma.get_result(), at_row(batch_mean, ticks, half)));
+    assert(same_value(rsi.get_result(), at_row(batch_rsi, ticks, half)));
+
+    for (std::size_t i = half; i < ticks; ++i) {
+        const std::size_t   end = i + 1;
+
+        sma.update(prices[i]);
+        rstd.update(prices[i]);
+        vol.update(prices[i]);
+        ewma.update(prices[i]);
+        drawdown.update(prices[i]);
+        rsi.update(prices[i]);
+        ewma_batch += alpha * (prices[i] - ewma_batch);
+        peak = std::max(peak, prices[i]);
+        max_dd = std::max(max_dd, peak - prices[i]);
+
+        assert(same_value(sma.current(), at_row(batch_mean, ticks, end)));
+        assert(same_value(rstd.current(), at_row(batch_std, ticks, end)));
+        assert(same_value(rstd.mean(), sma.current()));
+        assert(same_value(vol.current(),
+                          at_row(batch_vol, ticks - 1, end - 1)));
+        assert(same_value(ewma.current(), ewma_batch));
+        assert(same_value(drawdown.current(), peak - prices[i]));
+        assert(same_value(drawdown.max_drawdown(), max_dd));
+        assert(same_value(rsi.current(), at_row(batch_rsi, ticks, end)));
+    }
+
+    // Other return policies
+    //
+    for (const auto rp : { return_policy::percentage,
+                           return_policy::monetary,
+                           return_policy::trinary })  {
+        IncrementalRSI<double>  other (rp, 10);
+
+        catch_up(other);
+        assert(same_value(other.current(),
+                          at_row(batch(RSIVisitor<double>(rp, 10), prices),
+                                 ticks, half)));
+    }
+
+    // Not warmed up yet
+    //
+    IncrementalRollingStd<double>   fresh (roll);
+
+    fresh.update(1.0);
+    assert(std::isnan(fresh.current()));
+    rsi.pre();
+    assert(std::isnan(rsi.current()));
+}
+
+// ----------------------------------------------------------------------------
+
+// The rolling results over the valid values of in[end - window, end)
+//
+static void naive_rolling(const StlVecType<double> &in,
+                          std::size_t end,
+                          std::size_t window,
+                          std::size_t min_count,
+                          double &mean,
+                          double &var) {
+
+    double      sum { 0 };
+    double      sq_dev { 0 };
+    std::size_t count { 0 };
+
+    for (std::size_t i = end > window ? end - window : 0; i < end; ++i)
+        if (! std::isnan(in[i])) {
+            sum += in[i];
+            count += 1;
+        }
+    mean = count >= min_count && count > 0
+               ? sum / double(count)
+               : std::numeric_limits<double>::quiet_NaN();
+    for (std::size_t i = end > window ? end - window : 0; i < end; ++i)
+        if (! std::isnan(in[i]))
+            sq_dev += (in[i] - sum / double(count)) *
+                      (in[i] - sum / double(count));
+    var = count >= min_count && count >= 2
+              ? sq_dev / double(count - 1)
+              : std::numeric_limits<double>::quiet_NaN();
+}
+
+static void check_simd_kernels(const StlVecType<double> &in,
+                               std::size_t window,
+                               std::size_t min_count) {
+
+    const std::size_t   n = in.size();
+    const double        nan = std::numeric_limits<double>::quiet_NaN();
+    const double        alpha = 0.1;
+    StlVecType<double>  out (n);
+    StlVecType<double>  out2 (n);
+    double              ewma = nan;
+    double              sum { 0 };
+    double              count { 0 };
+    double              sq_dev { 0 };
+
+    simd_returns(in, out);
+    for (std::size_t i = 0; i < n; ++i)
+        assert(same_value(out[i], i ? in[i] / in[i - 1] - 1 : nan));
+
+    simd_log_returns(in, out);
+    for (std::size_t i = 0; i < n; ++i)
+        assert(same_value(out[i], i ? std::log(in[i] / in[i - 1]) : nan));
+
+    simd_rolling_mean_var(in, out, out2, window, min_count);
+    for (std::size_t i = 0; i < n; ++i) {
+        double  mean, var;
+
+        naive_rolling(in, i + 1, window, min_count ? min_count : window,
+                      mean, var);
+        assert(same_value(out[i], mean));
+        assert(same_value(out2[i], var));
+    }
+    simd_rolling_var(in, out2, window, min_count);
+    for (std::size_t i = 0; i < n; ++i) {
+        double  mean, var;
+
+        naive_rolling(in, i + 1, window, min_count ? min_count : window,
+                      mean, var);
+        assert(same_value(out2[i], var));
+    }
+
+    simd_ewma(in, out, alpha);
+    for (std::size_t i = 0; i < n; ++i) {
+        if (! std::isnan(in[i]))
+            ewma = std::isnan(ewma) ? in[i]
+                                    : (1 - alpha) * ewma + alpha * in[i];
+        assert(same_value(out[i], ewma));
+    }
+
+    for (const auto value : in)
+        if (! std::isnan(value)) {
+            sum += value;
+            count += 1;
+        }
+    for (const auto value : in)
+        if (! std::isnan(value))
+            sq_dev += (value - sum / count) * (value - sum / count);
+    simd_zscore(in, out);
+    for (std::size_t i = 0; i < n; ++i)
+        assert(same_value(out[i], (in[i] - sum / count) /
+                                  std::sqrt(sq_dev / (count - 1))));
+}
+
+static void test_simd_kernels() {
+
+    std::cout << "\nTesting SIMD kernels ..." << std::endl;
+
+    constexpr std::size_t   n { 10007 };
+    const double            nan = std::numeric_limits<double>::quiet_NaN();
+    std::mt19937_64         gen { 11 };
+    std::normal_distribution<double>    dist { 0.0, 0.01 };
+    StlVecType<double>      prices (n);
+    StlVecType<double>      padded (n, nan);
+
+    prices[0] = 100.0;
+    for (std::size_t i = 1; i < n; ++i)
+        prices[i] = prices[i - 1] * std::exp(dist(gen));
+
+    // What load_align_column() leaves: a value every 5 rows, NaN between
+    //
+    for (std::size_t i = 0; i < n; i += 5)
+        padded[i] = prices[i];
+
+    // Leading NaN, a zero and a negative value
+    //
+    StlVecType<double>  odd (prices.begin(), prices.begin() + 203);
+
+    odd[0] = odd[1] = odd[2] = nan;
+    odd[50] = 0;
+    odd[51] = -odd[51];
+
+    const SIMDLevel supported = simd_level_supported();
+
+    for (int level = 0; level <= int(supported); ++level) {
+        set_simd_level(SIMDLevel(level));
+        assert(simd_level() == SIMDLevel(level));
+
+        check_simd_kernels(prices, 20, 0);
+        check_simd_kernels(prices, 1500, 0);
+        check_simd_kernels(padded, 20, 3);
+        check_simd_kernels(padded, 20, 0);
+        check_simd_kernels(odd, 7, 2);
+    }
+    set_simd_level(SIMDLevel::avx512);
+    assert(simd_level() == supported);
+
+    // Edge cases
+    //
+    StlVecType<double>  all_nan (9, nan);
+    StlVecType<double>  flat (9, 3.0);
+    StlVecType<double>  out (9);
+
+    simd_ewma(all_nan, out, 0.5);
+    assert(std::all_of(out.begin(), out.end(),
+                       [](double x) { return (std::isnan(x)); }));
+    simd_zscore(flat, out);
+    assert(std::all_of(out.begin(), out.end(),
+                       [](double x) { return (std::isnan(x)); }));
+
+    StlVecType<double>  empty;
+
+    simd_returns(empty, empty);
+
+    try  {
+        simd_rolling_mean(flat, empty, 2);
+        assert(false);
+    }
+    catch (const NotFeasible &)  {  }
+    try  {
+        simd_ewma(flat, out, 0.0);
+        assert(false);
+    }
+    catch (const NotFeasible &)  {  }
+}
+
+// ----------------------------------------------------------------------------
+
+// Throws on the chunk holding row 5000
+//
+struct  ThrowingVisitor  {
+
+    template<typename K, typename H>
+    void operator() (const K &idx_begin, const K &idx_end,
+                     const H &, const H &) {
+
+        if (*idx_begin <= 5000 && 5000 <= *(idx_end - 1))
+            throw NotFeasible("ThrowingVisitor");
+    }
+    void merge(const ThrowingVisitor &) {  }
+    void pre() {  }
+    void post() {  }
+};
+
+static void test_parallel_visit() {
+
+    std::cout << "\nTesting parallel_visit( ) ..." << std::endl;
+
+    constexpr std::size_t   n { 100003 };
+    std::mt19937_64         gen { 23 };
+    std::normal_distribution<double>    dist { 0.0, 1.0 };
+    StlVecType<unsigned long>   idx (n);
+    StlVecType<double>          xs (n);
+    StlVecType<double>          ys (n);
+    MyDataFrame                 df;
+
+    for (std::size_t i = 0; i < n; ++i) {
+        idx[i] = i;
+        xs[i] = 5.0 + dist(gen);
+        ys[i] = 0.5 * xs[i] + dist(gen);
+    }
+    xs[17] = xs[60000] = std::numeric_limits<double>::quiet_NaN();
+    df.load_index(std::move(idx));
+    df.load_column("x", std::move(xs));
+    df.load_column("y", std::move(ys));
+
+    const auto  &x = df.get_column<double>("x");
+    const auto  &y = df.get_column<double>("y");
+
+    // Serial references
+    //
+    MergeableStatsVisitor<double>   stats_ref;
+    MergeableCorrVisitor<double>    corr_ref;
+
+    stats_ref.pre();
+    stats_ref(df.get_index().begin(), df.get_index().end(),
+              x.begin(), x.end());
+    corr_ref.pre();
+    corr_ref(df.get_index().begin(), df.get_index().end(),
+             x.begin(), x.end(), y.begin(), y.end());
+    assert(stats_ref.get_count() == n - 2);
+    assert(corr_ref.get_count() == n - 2);
+
+    for (const unsigned int tc : { 1U, 3U, 8U }) {
+        WorkStealingPool    pool (tc);
+
+        for (const std::size_t chunk_rows : { 0UL, 1000UL, 99999UL }) {
+            MergeableStatsVisitor<double>   stats;
+            MergeableCorrVisitor<double>    corr;
+
+            parallel_visit<double>(df, "x", stats, pool, chunk_rows);
+            assert(stats.get_count() == stats_ref.get_count());
+            assert(same_value(stats.get_mean(), stats_ref.get_mean()));
+            assert(same_value(stats.get_variance(),
+                              stats_ref.get_variance()));
+            assert(stats.get_min() == stats_ref.get_min());
+            assert(stats.get_max() == stats_ref.get_max());
+
+            parallel_visit<double, double>(df, "x", "y", corr,
+                                           pool, chunk_rows);
+            assert(corr.get_count() == corr_ref.get_count());
+            assert(same_value(corr.get_result(), corr_ref.get_result()));
+            assert(same_value(corr.get_covariance(),
+                              corr_ref.get_covariance()));
+        }
+
+        // No merge(), so it runs serially and sees every row in order
+        //
+        IncrementalEWMA<double> ewma (0.1);
+        IncrementalEWMA<double> ewma_ref (0.1);
+
+        parallel_visit<double>(df, "y", ewma, pool, 1000);
+        for (const auto value : y)  ewma_ref.update(value);
+        assert(ewma.get_result() == ewma_ref.current());
+
+        // Exceptions from a chunk come out of parallel_visit()
+        //
+        ThrowingVisitor thrower;
+
+        try {
+            parallel_visit<double>(df, "x", thrower, pool, 1000);
+            assert(false);
+        }
+        catch (const NotFeasible &)  {  }
+
+        // Nested fork and join from inside the pool's tasks
+        //
+        std::atomic<std::size_t>    count { 0 };
+
+        pool.run_chunks(16, [&pool, &count](std::size_t) {
+            pool.run_chunks(64, [&count](std::size_t c) {
+                count.fetch_add(c + 1);
+            });
+        });
+        assert(count == 16 * (64 * 65 / 2));
+
+        // parallel_for_chunks() hands out whole chunks, each one once
+        //
+        std::vector<int>    hits (100003, 0);
+
+        parallel_for_chunks(hits.size(), 4096, pool,
+                            [&hits](std::size_t begin, std::size_t end) {
+            assert(begin % 4096 == 0);
+            assert(end == std::min(hits.size(), begin + 4096));
+            for (std::size_t i = begin; i < end; ++i)  hits[i] += 1;
+        });
+        assert(std::count(hits.begin(), hits.end(), 1) == 100003);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+static void test_column_index() {
+
+    std::cout << "\nTesting IndexedFrame ..." << std::endl;
+
+    // The index of test_get_reindexed(), with 10 twice and out of order
+    //
+    IndexedFrame<MyDataFrame>   iframe;
+    StlVecType<unsigned long>   idxvec =
+        { 1UL, 2UL, 3UL, 4UL, 5UL, 6UL, 7UL, 8UL, 12UL, 9UL, 10UL, 13UL,
+          10UL, 15UL, 14UL };
+    StlVecType<double>          dblvec =
+        { 0.0, 15.0, 14.0, 2.0, 1.0, 12.0, 11.0, 8.0, 7.0, 6.0, 5.0, 4.0,
+          3.0, 9.0, 10.0 };
+    StlVecType<int>             intvec =
+        { 7, 3, 7, 1, 9, 3, 7, 2, 2, 8, 3, 7, 5, 4, 6 };
+
+    iframe.index_on_index();
+    iframe.load_data(std::move(idxvec),
+                     std::make_pair("dbl_col", dblvec),
+                     std::make_pair("int_col", intvec));
+    iframe.index_on_column<int>("int_col");
+    iframe.index_on_column<double>("dbl_col", column_index_type::sorted);
+
+    assert((*iframe.find_rows_by_index(10UL) == RowSelection { 10, 12 }));
+    assert(iframe.find_rows_by_index(11UL)->empty());
+    assert((*iframe.find_rows<int>("int_col", 7) ==
+            RowSelection { 0, 2, 6, 11 }));
+    assert((*iframe.find_rows<double>("dbl_col", 12.0) == RowSelection { 5 }));
+    assert((*iframe.find_rows_in_range<double>("dbl_col", 2.0, 5.0) ==
+            RowSelection { 3, 11, 12 }));
+    assert(iframe.find_rows_in_range_by_index(9UL, 13UL)->size() == 4);
+    assert(iframe.get_hash_index<int>("int_col").distinct_count() == 9);
+    assert(iframe.get_sorted_index<double>("dbl_col").max_value() == 15.0);
+
+    // The same answers without the indices
+    //
+    IndexedFrame<MyDataFrame>   plain (MyDataFrame(iframe.frame()));
+
+    assert(! plain.has_index("int_col"));
+    assert(*plain.find_rows_by_index(10UL) ==
+           *iframe.find_rows_by_index(10UL));
+    assert(*plain.find_rows<int>("int_col", 3) ==
+           *iframe.find_rows<int>("int_col", 3));
+    assert(*plain.find_rows_in_range<double>("dbl_col", 2.0, 5.0) ==
+           *iframe.find_rows_in_range<double>("dbl_col", 2.0, 5.0));
+
+    const auto  view =
+        iframe.get_view_by_value<int, double>("int_col", 3, "dbl_col");
+
+    assert(view.size() == 3);
+    assert(view[0] == 15.0 && view[1] == 12.0 && view[2] == 5.0);
+
+    // Join: probe values against int_col, with and without the index
+    //
+    const StlVecType<int>   probe = { 3, 11, 2, 3 };
+    const auto              joined = iframe.join_rows<int>("int_col", probe);
+    const auto              scanned = plain.join_rows<int>("int_col", probe);
+
+    assert((joined.first == RowSelection { 0, 0, 0, 2, 2, 3, 3, 3 }));
+    assert((joined.second == RowSelection { 1, 5, 10, 7, 8, 1, 5, 10 }));
+    assert(scanned == joined);
+
+    // Loading a column rebuilds its index, removing it drops the index
+    //
+    iframe.load_column("int_col", StlVecType<int>(15, 4));
+    assert(iframe.find_rows<int>("int_col", 4)->size() == 15);
+    assert(iframe.find_rows<int>("int_col", 7)->empty());
+    iframe.load_index(StlVecType<unsigned long>(15, 3UL));
+    assert(iframe.find_rows_by_index(3UL)->size() == 15);
+    iframe.load_index(StlVecType<unsigned long>(iframe.frame().get_index()));
+
+    // Reindexing carries the indices over
+    //
+    auto    reindexed = iframe.get_reindexed<double, int, unsigned long>(
+        "dbl_col", "OLD_IDX");
+
+    assert(reindexed.has_index_on_index());
+    assert(reindexed.has_index("OLD_IDX"));
+    assert(reindexed.has_index("int_col"));
+    assert((*reindexed.find_rows_by_index(12.0) == RowSelection { 5 }));
+    assert(reindexed.find_rows<unsigned long>("OLD_IDX", 3UL)->size() == 15);
+
+    // Without old_index_name the old index, and its index, are dropped
+    //
+    auto    dropped = iframe.get_reindexed<double, int, unsigned long>(
+        "dbl_col", nullptr);
+
+    assert(dropped.has_index_on_index());
+    assert(dropped.has_index("int_col"));
+    assert(! dropped.has_index("OLD_IDX"));
+
+    iframe.remove_column<int>("int_col");
+    assert(! iframe.has_index("int_col"));
+    try {
+        (void) iframe.get_hash_index<double>("dbl_col");
+        assert(false);
+    }
+    catch (const DataFrameError &)  {  }
+
+    // NaN rows are left out
+    //
+    const SortedColumnIndex<double> sorted (
+        StlVecType<double> { 2.0, std::numeric_limits<double>::quiet_NaN(),
+                             1.0, 2.0 });
+
+    assert(sorted.size() == 3);
+    assert((std::vector<column_row_type>(sorted.find(2.0).begin(),
+                                         sorted.find(2.0).end()) ==
+            std::vector<column_row_type> { 0, 3 }));
+}
+
+// ----------------------------------------------------------------------------
+
+static void test_csv_ingest() {
+
+    std::cout << "\nTesting ingest_csv ..." << std::endl;
+
+    const char  *path = "test_csv_ingest.csv";
+    std::FILE   *file = std::fopen(path, "w");
+
+    // Enough rows for many 4K blocks, with a quoted field, an empty number,
+    // a CRLF line and a blank line among them
+    //
+    std::fputs("INDEX,price,qty,ticker\n", file);
+    for (int i = 0; i < 5000; ++i)  {
+        if (i == 10)
+            std::fprintf(file, "%d,,%d,\"A,\"\"B\"\"\"\r\n", i, -i);
+        else
+            std::fprintf(file, "%d,%d.25,%d,T%d\n", i, i, -i, i % 7);
+        if (i == 20)  std::fputs("\n", file);
+    }
+    std::fclose(file);
+
+    for (const bool use_mmap : { false, true })  {
+        MyDataFrame         df;
+        CsvIngestOptions    options;
+
+        options.use_mmap = use_mmap;
+        options.thread_count = 3;
+        options.block_size = 4096;
+
+        const auto  rows = ingest_csv<double, int, std::string>(df, path,
+                                                                options);
+        const auto  &price = df.get_column<double>("price");
+        const auto  &qty = df.get_column<int>("qty");
+        const auto  &ticker = df.get_column<std::string>("ticker");
+
+        assert(rows == 5000);
+        assert(df.get_index().size() == 5000);
+        for (unsigned long i = 0; i < 5000; ++i)  {
+            assert(df.get_index()[i] == i);
+            assert(qty[i] == -int(i));
+            if (i != 10)  {
+                assert(price[i] == double(i) + 0.25);
+                assert(ticker[i] == "T" + std::to_string(i % 7));
+            }
+        }
+        assert(std::isnan(price[10]));
+        assert(ticker[10] == "A,\"B\"");
+    }
+
+    // Appending a block keeps the whole-file reservation
+    //
+    std::vector<int>    reserved;
+    std::vector<int>    block { 1, 2, 3 };
+
+    _csv_append_column_(reserved, block);
+    assert((reserved == std::vector<int> { 1, 2, 3 }));
+    reserved.clear();
+    reserved.reserve(1000);
+
+    const int   *buffer = reserved.data();
+
+    block = { 4, 5, 6 };
+    _csv_append_column_(reserved, block);
+    _csv_append_column_(reserved, block);
+    assert(reserved.size() == 6 && reserved.capacity() >= 1000);
+    assert(reserved.data() == buffer && reserved[5] == 6);
+
+    // Rows are numbered from 1, after the header
+    //
+    file = std::fopen(path, "w");
+    std::fputs("INDEX,price\n", file);
+    for (int i = 0; i < 3000; ++i)
+        std::fprintf(file, i == 2500 ? "%d,x\n" : "%d,1.5\n", i);
+    std::fclose(file);
+    try  {
+        MyDataFrame         df;
+        CsvIngestOptions    options;
+
+        options.block_size = 4096;
+        ingest_csv<double>(df, path, options);
+        assert(false);
+    }
+    catch (const DataFrameError &ex)  {
+        assert(std::string(ex.what()).find("Row 2501:") != std::string::npos);
+    }
+    try  {
+        MyDataFrame df;
+
+        ingest_csv<double, int>(df, path);
+        assert(false);
+    }
+    catch (const DataFrameError &)  {  }
+
+    // No header
+    //
+    file = std::fopen(path, "w");
+    std::fputs("1;2\n3;+4", file);
+    std::fclose(file);
+
+    MyDataFrame         df;
+    CsvIngestOptions    options;
+
+    options.has_header = false;
+    options.delimiter = ';';
+    options.column_names = { "val" };
+    assert(ingest_csv<long>(df, path, options) == 2);
+    assert((df.get_column<long>("val") == StlVecType<long> { 2, 4 }));
+    std::remove(path);
+}
+
+// ----------------------------------------------------------------------------
+
+static void test_join_asof() {
+
+    std::cout << "\nTesting join_asof( ) ..." << std::endl;
+
+    using row_type = RowSelection::value_type;
+
+    constexpr row_type  none = std::numeric_limits<row_type>::max();
+
+    MyDataFrame quotes;
+    MyDataFrame trades;
+
+    quotes.load_data(StlVecType<unsigned long> { 10, 20, 20, 30, 40, 50 },
+                     std::make_pair("bid",
+                                    StlVecType<double> { 1, 2, 2.5, 3, 4, 5 }),
+                     std::make_pair("sym",
+                                    StlVecType<int> { 1, 2, 1, 2, 1, 2 }));
+    trades.load_data(StlVecType<unsigned long> { 5, 20, 25, 39, 60, 100 },
+                     std::make_pair("price",
+                                    StlVecType<double> { 9, 8, 7, 6, 5, 4 }),
+                     std::make_pair("sym",
+                                    StlVecType<int> { 1, 2, 1, 2, 2, 3 }));
+
+    // The last of equal timestamps wins
+    //
+    const auto  joined = join_asof(trades, quotes);
+
+    assert((joined.get_matches() ==
+            RowSelection { none, 2, 2, 3, 5, 5 }));
+    assert(joined.match_count() == 5);
+
+    const auto  bid_view = joined.get_right_column_view<double>("bid");
+    const auto  price_view = joined.get_left_column_view<double>("price");
+    const auto  ts_view = joined.get_index_view();
+
+    assert(bid_view.size() == 5);
+    assert((std::vector<double>(bid_view.begin(), bid_view.end()) ==
+            std::vector<double> { 2.5, 2.5, 3, 5, 5 }));
+    assert(price_view[0] == 8 && ts_view[0] == 20);
+    assert(joined.get_right_index_view()[2] == 30);
+
+    const auto  bids = joined.get_right_column<double>("bid");
+
+    assert(bids.size() == 6 && std::isnan(bids[0]) && bids[5] == 5);
+
+    // Tolerance and strictly before
+    //
+    assert((join_asof(trades, quotes, 5UL).get_matches() ==
+            RowSelection { none, 2, 2, none, none, none }));
+    assert((join_asof(trades, quotes, 1000UL, false).get_matches() ==
+            RowSelection { none, 0, 2, 3, 5, 5 }));
+
+    // By symbol
+    //
+    assert((join_asof_by<int>(trades, quotes, "sym", "sym").get_matches() ==
+            RowSelection { none, 1, 2, 3, 5, none }));
+    assert((join_asof_by<int>(trades, quotes, "sym", "sym", 8UL)
+                .get_matches() ==
+            RowSelection { none, 1, 2, none, none, none }));
+
+    try  {
+        MyDataFrame unsorted;
+
+        unsorted.load_index(StlVecType<unsigned long> { 2, 1 });
+        (void) join_asof(unsorted, quotes);
+        assert(false);
+    }
+    catch (const NotFeasible &)  {  }
+
+    // Against a brute force search, over many chunks and keys
+    //
+    std::mt19937                        gen { 7 };
+    std::uniform_int_distribution<int>  step (0, 3);
+    std::uniform_int_distribution<int>  key (0, 4);
+    StlVecType<unsigned long>           q_idx (300000);
+    StlVecType<unsigned long>           t_idx (200000);
+    StlVecType<int>                     q_sym (q_idx.size());
+    StlVecType<int>                     t_sym (t_idx.size());
+
+    for (std::size_t i = 1; i < q_idx.size(); ++i)
+        q_idx[i] = q_idx[i - 1] + step(gen);
+    for (std::size_t i = 1; i < t_idx.size(); ++i)
+        t_idx[i] = t_idx[i - 1] + step(gen) + 1;
+    for (auto &s : q_sym)  s = key(gen);
+    for (auto &s : t_sym)  s = key(gen);
+
+    MyDataFrame big_q;
+    MyDataFrame big_t;
+
+    big_q.load_data(std::move(q_idx), std::make_pair("sym", q_sym));
+    big_t.load_data(std::move(t_idx), std::make_pair("sym", t_sym));
+
+    WorkStealingPool    pool (3);
+    const auto          plain = join_asof(big_t, big_q, 6UL, true, pool);
+    const auto          by_sym =
+        join_asof_by<int>(big_t, big_q, "sym", "sym", 6UL, true, pool);
+    const auto          &qi = big_q.get_index();
+    const auto          &ti = big_t.get_index();
+    std::size_t         pos = 0;
+    std::vector<long>   last (5, -1);
+
+    for (std::size_t t = 0; t < ti.size(); ++t)  {
+        while (pos < qi.size() && qi[pos] <= ti[t])  {
+            last[q_sym[pos]] = long(pos);
+            pos += 1;
+        }
+
+        const bool  in_range = pos > 0 && ti[t] - qi[pos - 1] <= 6;
+        const long  same = last[t_sym[t]];
+
+        assert(plain.get_matches()[t] == (in_range ? pos - 1 : none));
+        assert(by_sym.get_matches()[t] ==
+               (same >= 0 && ti[t] - qi[same] <= 6 ? row_type(same) : none));
+    }
+
+    // Gathered on the pool, with T() for the unmatched rows
+    //
+    const auto  syms = plain.get_right_column<int>("sym", pool);
+
+    assert(syms.size() == ti.size());
+    for (std::size_t t = 0; t < ti.size(); ++t)  {
+        const row_type  r = plain.get_matches()[t];
+
+        assert(syms[t] == (r == none ? 0 : q_sym[r]));
+    }
+
+    // The pairs are listed up front, so readers can share a const frame
+    //
+    std::size_t viewed { 0 };
+    std::thread reader ([&by_sym, &viewed]() {
+        viewed = by_sym.get_right_index_view().size();
+    });
+    const auto  lrows = by_sym.left_rows();
+
+    reader.join();
+    assert(viewed == lrows->size() && viewed == by_sym.match_count());
+}
+
+// ----------------------------------------------------------------------------
+
+// Not mergeable, so it is given the whole column at once
+//
+struct  LastRowVisitor  {
+
+    template<typename K, typename H>
+    void operator() (const K &, const K &idx_end, const H &, const H &) {
+
+        stamp = *(idx_end - 1);
+        calls += 1;
+    }
+    void pre() {  }
+    void post() {  }
+
+    unsigned long   stamp { 0 };
+    int             calls { 0 };
+};
+
+static void test_compressed_columns() {
+
+    std::cout << "\nTesting compressed columns ..." << std::endl;
+
+    std::mt19937                        gen { 11 };
+    std::uniform_int_distribution<int>  step (0, 50);
+    std::normal_distribution<double>    move (0, 0.01);
+    constexpr std::size_t               rows { 5000 };  // Not whole blocks
+
+    StlVecType<unsigned long>   stamps (rows);
+    StlVecType<double>          prices (rows);
+    StlVecType<int>             sizes (rows);
+
+    stamps[0] = 1700000000000000000UL;
+    prices[0] = 100;
+    for (std::size_t i = 1; i < rows; ++i)  {
+        stamps[i] = stamps[i - 1] + 1000 + step(gen);
+        prices[i] = std::round((prices[i - 1] + move(gen)) * 100) / 100;
+        sizes[i] = step(gen) - 25;
+    }
+
+    // Exact round trips, including values that wrap the deltas
+    //
+    const DeltaForColumn<unsigned long> packed_stamps (stamps);
+
+    assert(decode_column(packed_stamps) == stamps);
+    assert(packed_stamps.memory_bytes() * 4 < rows * sizeof(unsigned long));
+    assert(packed_stamps.value(4321) == stamps[4321]);
+    assert(decode_column(DeltaForColumn<int>(sizes)) == sizes);
+
+    const StlVecType<unsigned long> wrap {
+        0, std::numeric_limits<unsigned long>::max(), 5, 5, 1UL << 63
+    };
+    const StlVecType<long>          extremes {
+        std::numeric_limits<long>::min(), std::numeric_limits<long>::max(),
+        -1, 0
+    };
+
+    assert(decode_column(DeltaForColumn<unsigned long>(wrap)) == wrap);
+    assert(decode_column(DeltaForColumn<long>(extremes)) == extremes);
+    assert(DeltaForColumn<int>(StlVecType<int> { }).size() == 0);
+
+    const GorillaColumn packed_prices (prices);
+
+    assert(decode_column(packed_prices) == prices);
+    assert(packed_prices.memory_bytes() * 2 < rows * sizeof(double));
+
+    StlVecType<double>  odd { 1.5, -0.0, 0.0,
+                              std::numeric_limits<double>::infinity(),
+                              std::numeric_limits<double>::quiet_NaN(),
+                              std::numeric_limits<double>::denorm_min(),
+                              1e308, 1.5 };
+    const auto          odd_back = decode_column(GorillaColumn(odd));
+
+    for (std::size_t i = 0; i < odd.size(); ++i)
+        assert(std::bit_cast<std::uint64_t>(odd[i]) ==
+               std::bit_cast<std::uint64_t>(odd_back[i]));
+    try  {
+        (void) packed_prices.value(rows);
+        assert(false);
+    }
+    catch (const NotFeasible &)  {  }
+
+    // A whole frame
+    //
+    MyDataFrame df;
+
+    df.load_data(StlVecType<unsigned long>(stamps),
+                 std::make_pair("price", prices),
+                 std::make_pair("size", sizes));
+
+    const auto  cframe = compress_frame<double, int>(df);
+
+    assert(cframe.shape_rows() == rows);
+    assert(cframe.has_column("price") && cframe.has_column("size"));
+    assert(cframe.memory_bytes() * 2 < cframe.raw_bytes());
+    assert(cframe.get_index() == stamps);
+    assert(cframe.get_column<double>("price") == prices);
+    assert(cframe.get_column<int>("size") == sizes);
+
+    double      sum { 0 };
+    std::size_t seen { 0 };
+
+    cframe.scan<double>("price", [&](const double *begin, const double *end,
+                                     std::size_t first_row)  {
+        assert(first_row == seen);
+        seen += end - begin;
+        sum = std::accumulate(begin, end, sum);
+    });
+    assert(seen == rows);
+    assert(sum == std::accumulate(prices.begin(), prices.end(), 0.0));
+
+    // Block by block with a mergeable visitor, whole with any other
+    //
+    MergeableStatsVisitor<double>   by_block;
+    MergeableStatsVisitor<double>   whole;
+    LastRowVisitor                  last;
+
+    cframe.visit<double>("price", by_block);
+    whole.pre();
+    whole(stamps.begin(), stamps.end(), prices.begin(), prices.end());
+    whole.post();
+    cframe.visit<double>("price", last);
+    assert(by_block.get_count() == rows);
+    assert(std::fabs(by_block.get_mean() - whole.get_mean()) < 1e-9);
+    assert(std::fabs(by_block.get_std() - whole.get_std()) < 1e-9);
+    assert(last.calls == 1 && last.stamp == stamps.back());
+
+    MyDataFrame back;
+
+    cframe.load_into<double, int>(back);
+    assert(back.get_index() == stamps);
+    assert(back.get_column<int>("size") == sizes);
+    try  {
+        (void) cframe.get_column<int>("price");
+        assert(false);
+    }
+    catch (const NotFeasible &)  {  }
+    try  {
+        (void) cframe.get_column<double>("no_col");
+        assert(false);
+    }
+    catch (const ColNotFound &)  {  }
+}
+
+static void test_instrumentation() {
+
+    std::cout << "\nTesting instrumentation ..." << std::endl;
+
+    InstrumentRegistry  &registry = instrument_registry();
+
+    registry.reset();
+    assert(registry.snapshot().empty());
+
+    OpCounters  &counters = registry.counters("test_op");
+
+    assert(&counters == &registry.counters("test_op"));
+    for (int i = 0; i < 3; ++i)  {
+        OpScope scope { counters };
+
+        scope.add_rows(10);
+        scope.add_bytes(80);
+        instrument_note_alloc(64);
+    }
+
+    auto    stats = registry.snapshot();
+
+    assert(stats.size() == 1);
+    assert(stats["test_op"].calls == 3);
+    assert(stats["test_op"].rows == 30);
+    assert(stats["test_op"].bytes_copied == 240);
+    assert(stats["test_op"].allocs >= 3);
+    assert(stats["test_op"].alloc_bytes >= 192);
+    assert(stats["test_op"].wall_ns >= stats["test_op"].max_ns);
+    assert(registry.to_text().find("test_op") != std::string::npos);
+    assert(registry.to_json().find("\"name\": \"test_op\"") !=
+               std::string::npos);
+
+    // Disabled scopes cost nothing and record nothing
+    //
+    {
+        NullOpScope scope;
+
+        scope.add_rows(10);
+    }
+    assert(registry.snapshot()["test_op"].calls == 3);
+
+#ifdef HMDF_INSTRUMENT
+    MyDataFrame                 df;
+    RetypeErrorMask             errors;
+    StlVecType<unsigned long>   idx (100);
+
+    std::iota(idx.begin(), idx.end(), 0UL);
+    df.load_data(std::move(idx),
+                 std::make_pair("int_col", StlVecType<int>(100, 7)));
+    (void) retype_column_bulk<int, long>(df, "int_col", errors);
+    stats = registry.snapshot();
+    assert(stats["retype_column_bulk"].calls == 1);
+    assert(stats["retype_column_bulk"].rows == 100);
+    assert(stats["retype_column_bulk"].bytes_copied == 100 * sizeof(long));
+#endif // HMDF_INSTRUMENT
+
+    registry.reset();
+    assert(registry.snapshot().empty());
+}
+
+static void test_cow_frame() {
+
+    std::cout << "\nTesting CowFrame ..." << std::endl;
+
+    StlVecType<unsigned long>   idxvec =
+        { 1UL, 2UL, 3UL, 10UL, 5UL, 7UL, 8UL, 12UL, 9UL, 12UL, 10UL, 13UL,
+          10UL, 15UL, 14UL };
+    StlVecType<double>          dblvec =
+        { 0.0, 15.0, 14.0, 2.0, 1.0, 12.0, 11.0, 8.0, 7.0, 6.0, 5.0, 4.0,
+          3.0, 9.0, 10.0 };
+    StlVecType<std::string>     strvec =
+        { "zz", "bb", "cc", "ww", "ee", "ff", "gg", "hh", "ii", "jj", "kk",
+          "ll", "mm", "nn", "oo" };
+    MyDataFrame                 df;
+
+    df.load_data(std::move(idxvec),
+                 std::make_pair("dbl_col", dblvec),
+                 std::make_pair("str_col", strvec));
+
+    auto    frame = make_cow_frame<double, std::string>(df);
+    auto    snap1 = frame->snapshot();
+
+    assert(snap1.version() == 1);
+    assert(snap1.shape_rows() == 15);
+    assert(snap1.get_index()[3] == 10UL);
+    assert(snap1.get_column<std::string>("str_col")[5] == "ff");
+
+    // Unlike a get_reindexed_view(), the write stays out of the snapshot
+    //
+    frame->set<double>("dbl_col", 3, 1002.45);
+    assert(frame->get_column<double>("dbl_col")[3] == 1002.45);
+    assert(snap1.get_column<double>("dbl_col")[3] == 2.0);
+    assert(frame->snapshot().get_column<double>("dbl_col")[3] == 2.0);
+    assert(df.get_column<double>("dbl_col")[3] == 2.0);
+    frame->publish();
+
+    auto    snap2 = frame->snapshot();
+
+    assert(snap2.version() == 2);
+    assert(snap2.get_column<double>("dbl_col")[3] == 1002.45);
+    assert(snap1.get_column<double>("dbl_col")[3] == 2.0);
+    assert(snap2.get_column<std::string>("str_col").shares_block(
+               snap1.get_column<std::string>("str_col"), 0));
+    assert(! snap2.get_column<double>("dbl_col").shares_block(
+                 snap1.get_column<double>("dbl_col"), 0));
+
+    MyDataFrame back;
+
+    snap1.load_into<double, std::string>(back);
+    assert(back.get_column<double>("dbl_col") == dblvec);
+    assert(back.get_column<std::string>("str_col") == strvec);
+
+    // Only the blocks written to are copied, once per publish
+    //
+    const std::size_t       rows = 3 * cow_block_rows + 10;
+    std::vector<unsigned long>  big_idx (rows);
+    std::vector<int>        big_col (rows, 1);
+    CowFrame<unsigned long> big;
+
+    std::iota(big_idx.begin(), big_idx.end(), 0UL);
+    big.load_index(big_idx);
+    big.load_column("int_col", big_col);
+    big.publish();
+
+    const auto  before = big.snapshot();
+
+    big.modify<int>("int_col", cow_block_rows + 5, cow_block_rows + 20,
+                    [](int &v) { v = 2; });
+    big.set<int>("int_col", cow_block_rows + 100, 3);
+    assert(big.copied_blocks() == 1);
+
+    const unsigned long more_idx[] = { 100000UL, 100001UL };
+    const int           more_col[] = { 7, 8 };
+
+    big.append_index(more_idx, 2);
+    big.append<int>("int_col", more_col, 2);
+    assert(big.copied_blocks() == 3);
+    big.publish();
+
+    const auto  after = big.snapshot();
+    const auto  &old_col = before.get_column<int>("int_col");
+    const auto  &new_col = after.get_column<int>("int_col");
+
+    assert(new_col.size() == rows + 2 && old_col.size() == rows);
+    assert(new_col.shares_block(old_col, 0));
+    assert(! new_col.shares_block(old_col, 1));
+    assert(new_col.shares_block(old_col, 2));
+    assert(! new_col.shares_block(old_col, 3));
+    assert(old_col[cow_block_rows + 5] == 1 && old_col[rows - 1] == 1);
+    assert(new_col[cow_block_rows + 5] == 2);
+    assert(new_col[cow_block_rows + 100] == 3);
+    assert(new_col[rows] == 7 && new_col[rows + 1] == 8);
+    assert(after.get_index()[rows + 1] == 100001UL);
+
+    std::size_t seen { 0 };
+
+    new_col.for_each_block([&seen](const int *begin, const int *end,
+                                   std::size_t first)  {
+        assert(first == seen);
+        seen += std::size_t(end - begin);
+    });
+    assert(seen == rows + 2);
+
+    try  {
+        big.set<int>("int_col", rows + 2, 0);
+        assert(false);
+    }
+    catch (const NotFeasible &)  {  }
+    try  {
+        (void) after.get_column<double>("int_col");
+        assert(false);
+    }
+    catch (const NotFeasible &)  {  }
+    try  {
+        (void) after.get_column<int>("no_col");
+        assert(false);
+    }
+    catch (const ColNotFound &)  {  }
+    try  {
+        (void) CowSnapshot<unsigned long>().get_index();
+        assert(false);
+    }
+    catch (const NotFeasible &)  {  }
+
+    // Readers on other threads see whole versions only: every value of a
+    // version's column is its version number
+    //
+    CowFrame<unsigned long> live;
+    std::atomic<bool>       done { false };
+
+    live.load_index(big_idx);
+    live.load_column("ver_col", std::vector<std::size_t>(rows, 1));
+    live.publish();
+
+    std::vector<std::thread>    readers;
+
+    for (int t = 0; t < 3; ++t)
+        readers.emplace_back([&live, &done]()  {
+            while (! done.load())  {
+                const auto  snap = live.snapshot();
+                const auto  &col = snap.get_column<std::size_t>("ver_col");
+
+                assert(col.size() == snap.shape_rows());
+                col.for_each_block([&snap](const std::size_t *begin,
+                                           const std::size_t *end,
+                                           std::size_t)  {
+                    for (; begin < end; ++begin)
+                        assert(*begin == snap.version());
+                });
+            }
+        });
+    for (std::size_t v = 2; v <= 50; ++v)  {
+        const unsigned long new_idx = 1000000UL + v;
+
+        live.modify<std::size_t>("ver_col", 0, live.shape_rows(),
+                                 [v](std::size_t &x) { x = v; });
+        live.append_index(&new_idx, 1);
+        live.append<std::size_t>("ver_col", &v, 1);
+        live.publish();
+    }
+    done = true;
+    for (auto &reader : readers)  reader.join();
+    assert(live.snapshot().version() == 50);
+    assert(live.snapshot().shape_rows() == rows + 49);
+}
+
+static void test_live_frame() {
+
+    std::cout << "\nTesting LiveFrame ..." << std::endl;
+
+    using LiveType = LiveFrame<unsigned long, double, std::string>;
+
+    LiveType    frame ({ "price", "venue" }, 4 * live_segment_rows);
+    const auto  empty = frame.snapshot();
+
+    assert(empty.shape_rows() == 0 && empty.segment_count() == 0);
+    frame.append_row(1UL, 10.5, "XNYS");
+    frame.append_row(2UL, 11.5, "BATS");
+
+    const auto  two = frame.snapshot();
+
+    frame.append_row(3UL, 12.5, "XNYS");
+    assert(two.shape_rows() == 2);
+    assert(frame.snapshot().shape_rows() == 3);
+    assert(two.get_index() == (std::vector<unsigned long> { 1UL, 2UL }));
+    assert(two.get_column<double>("price") ==
+               (std::vector<double> { 10.5, 11.5 }));
+    assert(two.get_column_view<std::string>("venue", 0)[1] == "BATS");
+    assert(two.get_column_view<std::string>("venue", 0).size() == 2);
+    assert(two.index_at(1) == 2UL);
+
+    MyDataFrame df;
+
+    frame.snapshot().load_into(df);
+    assert(df.get_index().size() == 3);
+    assert(df.get_column<double>("price")[2] == 12.5);
+    assert(df.get_column<std::string>("venue")[2] == "XNYS");
+
+    try  {
+        (void) two.get_column<int>("price");
+        assert(false);
+    }
+    catch (const NotFeasible &)  {  }
+    try  {
+        (void) two.get_column<double>("no_col");
+        assert(false);
+    }
+    catch (const ColNotFound &)  {  }
+    try  {
+        const std::vector<unsigned long>    idx (4 * live_segment_rows);
+        const std::vector<double>           prices (idx.size());
+        const std::vector<std::string>      venues (idx.size());
+
+        frame.append_rows(idx.size(), idx.data(), prices.data(),
+                          venues.data());
+        assert(false);
+    }
+    catch (const NotFeasible &)  {  }
+    assert(frame.committed_rows() == 3);
+    try  {
+        LiveType    bad ({ "price" });
+
+        assert(false);
+    }
+    catch (const NotFeasible &)  {  }
+
+    // Stress: one feed thread appends batches of random size, crossing
+    // segments, while readers check that every snapshot is whole. Row r
+    // has index r and value 0.5 * r, so each reader knows what it must
+    // see.
+    //
+    constexpr std::size_t   total = 3 * live_segment_rows + 1234;
+    using StressType = LiveFrame<unsigned long, double, int>;
+
+    StressType              live ({ "dbl_col", "int_col" }, total);
+    std::atomic<bool>       done { false };
+    std::atomic<std::size_t>    checks { 0 };
+    std::vector<std::thread>    readers;
+
+    for (int t = 0; t < 3; ++t)
+        readers.emplace_back([&live, &done, &checks]()  {
+            std::size_t last_rows { 0 };
+
+            while (! done.load())  {
+                const auto  snap = live.snapshot();
+                std::size_t seen { 0 };
+
+                assert(snap.shape_rows() >= last_rows);
+                last_rows = snap.shape_rows();
+                for (std::size_t s = 0; s < snap.segment_count(); ++s)  {
+                    const auto  idx = snap.get_index_view(s);
+                    const auto  dbl = snap.get_column_view<double>("dbl_col",
+                                                                   s);
+                    const auto  ints = snap.get_column_view<int>("int_col",
+                                                                 s);
+
+                    assert(idx.size() == dbl.size());
+                    assert(idx.size() == ints.size());
+                    for (std::size_t i = 0; i < idx.size(); ++i, ++seen)  {
+                        assert(idx[i] == seen);
+                        assert(dbl[i] == 0.5 * double(seen));
+                        assert(ints[i] == int(seen % 7));
+                    }
+                }
+                assert(seen == snap.shape_rows());
+
+                MergeableStatsVisitor<double, unsigned long>  stats;
+
+                snap.visit<double>("dbl_col", stats);
+                assert(stats.get_count() == snap.shape_rows());
+                if (snap.shape_rows() > 0)
+                    assert(stats.get_max() ==
+                               0.5 * double(snap.shape_rows() - 1));
+                checks += 1;
+            }
+        });
+
+    std::mt19937                                gen { 17 };
+    std::uniform_int_distribution<std::size_t>  batch (1, 5000);
+    std::vector<unsigned long>                  idx;
+    std::vector<double>                         dbl;
+    std::vector<int>                            ints;
+
+    for (std::size_t row = 0; row < total; )  {
+        const std::size_t   n = std::min(batch(gen), total - row);
+
+        idx.resize(n);
+        dbl.resize(n);
+        ints.resize(n);
+        for (std::size_t i = 0; i < n; ++i)  {
+            idx[i] = row + i;
+            dbl[i] = 0.5 * double(row + i);
+            ints[i] = int((row + i) % 7);
+        }
+        if (n == 1)
+            live.append_row(idx[0], dbl[0], ints[0]);
+        else
+            live.append_rows(n, idx.data(), dbl.data(), ints.data());
+        row += n;
+    }
+    while (checks.load() < 6)  std::this_thread::yield();
+    done = true;
+    for (auto &reader : readers)  reader.join();
+
+    const auto  full = live.snapshot();
+
+    assert(full.shape_rows() == total);
+    assert(full.segment_count() == 4);
+    assert(full.get_column_view<int>("int_col", 3).size() == 1234);
+    assert(full.get_column<double>("dbl_col").back() ==
+               0.5 * double(total - 1));
+}
+
+static void test_lazy_query() {
+
+    std::cout << "\nTesting lazy_query( ) ..." << std::endl;
+
+    StlVecType<unsigned long>   idxvec =
+        { 1UL, 2UL, 3UL, 10UL, 5UL, 7UL, 8UL, 12UL, 9UL, 12UL, 10UL, 13UL,
+          10UL, 15UL, 14UL };
+    StlVecType<double>          dblvec =
+        { 0.0, 15.0, 14.0, 2.0, 1.0, 12.0, 11.0, 8.0, 7.0, 6.0, 5.0, 4.0,
+          3.0, 9.0, 10.0 };
+    StlVecType<double>          dblvec2 =
+        { 100.0, 101.0, 102.0, 103.0, 104.0, 105.0, 106.55, 107.34, 1.8,
+          111.0, 112.0, 113.0, 114.0, 115.0, 116.0 };
+    StlVecType<int>             intvec =
+        { 1, 2, 3, 4, 5, 8, 6, 7, 11, 14, 9 };
+    StlVecType<std::string>     strvec =
+        { "zz", "bb", "cc", "ww", "ee", "ff", "gg", "hh", "ii", "jj", "kk",
+          "ll", "mm", "nn", "oo" };
+    MyDataFrame                 df;
+
+    df.load_data(std::move(idxvec),
+                 std::make_pair("dbl_col", dblvec),
+                 std::make_pair("dbl_col_2", dblvec2),
+                 std::make_pair("str_col", strvec));
+    df.load_column("int_col",
+                   std::move(intvec),
+                   nan_policy::dont_pad_with_nans);
+
+    // Rows 1, 2, 5, 6, 7, 8, 9, 13, 14 have dbl_col > 5.5, and of those
+    // rows 1, 6, 7, 9, 14 have an even index
+    //
+    auto    query = lazy_query(df);
+
+    query.filter<double>("dbl_col", [](double v)  { return (v > 5.5); })
+         .filter_index([](unsigned long i)  { return (i % 2 == 0); });
+    assert(query.count() == 5);
+    assert(query.get_index() ==
+               (std::vector<unsigned long> { 2UL, 8UL, 12UL, 12UL, 14UL }));
+    assert(query.get_column<double>("dbl_col") ==
+               (std::vector<double> { 15.0, 11.0, 8.0, 6.0, 10.0 }));
+
+    // The int column has 11 rows, so rows 13 and 14 are not in it
+    //
+    assert(query.get_column<int>("int_col") ==
+               (std::vector<int> { 2, 6, 7, 14 }));
+
+    const auto  reindexed = query.reindex<double>("dbl_col", "OLD_IDX");
+
+    assert(reindexed.get_index() ==
+               (std::vector<double> { 15.0, 11.0, 8.0, 6.0, 10.0 }));
+    assert(reindexed.get_column<unsigned long>("OLD_IDX") ==
+               (std::vector<unsigned long> { 2UL, 8UL, 12UL, 12UL, 14UL }));
+
+    // The old index filters like any other column
+    //
+    auto    by_old_idx = query.reindex<double>("dbl_col", "OLD_IDX");
+
+    by_old_idx.filter<unsigned long>("OLD_IDX",
+                                     [](unsigned long i)  { return (i > 8); });
+    assert(by_old_idx.get_index() ==
+               (std::vector<double> { 8.0, 6.0, 10.0 }));
+
+    StdDataFrame64<double>  result;
+
+    query.select({ "dbl_col_2", "int_col", "OLD_IDX" });
+
+    const auto  selected = query.reindex<double>("dbl_col", "OLD_IDX");
+
+    selected.load_into<int, double, std::string>(result);
+    assert(result.get_index() ==
+               (std::vector<double> { 15.0, 11.0, 8.0, 6.0, 10.0 }));
+    assert(result.get_column<unsigned long>("OLD_IDX")[2] == 12UL);
+    assert(result.get_column<double>("dbl_col_2") ==
+               (std::vector<double> { 101.0, 106.55, 107.34, 111.0,
+                                      116.0 }));
+    assert(result.get_column<int>("int_col").size() == 4);
+    try  {
+        (void) result.get_column<std::string>("str_col");
+        assert(false);
+    }
+    catch (const ColNotFound &)  {  }
+    try  {
+        (void) result.get_column<double>("dbl_col");
+        assert(false);
+    }
+    catch (const ColNotFound &)  {  }
+
+    // Without steps, the same as get_reindexed()
+    //
+    StdDataFrame64<double>  plain;
+    const auto              expected =
+        df.get_reindexed<double, int, double, std::string>("dbl_col",
+                                                           "OLD_IDX");
+
+    lazy_query(df).reindex<double>("dbl_col", "OLD_IDX")
+                  .load_into<int, double, std::string>(plain);
+    assert(plain.get_index() == expected.get_index());
+    assert(plain.get_column<int>("int_col") ==
+               expected.get_column<int>("int_col"));
+    assert(plain.get_column<std::string>("str_col") ==
+               expected.get_column<std::string>("str_col"));
+    assert(plain.get_column<unsigned long>("OLD_IDX") ==
+               expected.get_column<unsigned long>("OLD_IDX"));
+
+    // Mergeable visitors see block by block, others the whole selection
+    //
+    MergeableStatsVisitor<double, double>   stats;
+    LastRowVisitor                          last;
+
+    reindexed.visit<double>("dbl_col_2", stats);
+    assert(stats.get_count() == 5);
+    assert(stats.get_max() == 116.0);
+    query.visit<double>("dbl_col_2", last);
+    assert(last.calls == 1 && last.stamp == 14UL);
+
+    // Many blocks, most of them with no row left
+    //
+    constexpr std::size_t       rows = 5 * query_block_rows + 7;
+    StlVecType<unsigned long>   big_idx (rows);
+    StlVecType<int>             big_col (rows);
+    MyDataFrame                 big;
+
+    std::iota(big_idx.begin(), big_idx.end(), 0UL);
+    std::iota(big_col.begin(), big_col.end(), 0);
+    big.load_data(std::move(big_idx), std::make_pair("int_col", big_col));
+
+    auto    sparse = lazy_query(big);
+
+    sparse.filter<int>("int_col", [](int v)  { return (v % 5000 == 0); });
+    assert(sparse.count() == 5);
+    assert(sparse.get_column<int>("int_col").back() == 20000);
+}
+
+// ----------------------------------------------------------------------------
+
+static void test_par_fill_column() {
+
+    std::cout << "\nTesting par_fill_normal_dist( ) into a column ..."
+              << std::endl;
+
+    constexpr std::size_t       n { 100000 };
+    StlVecType<unsigned long>   idx (n);
+    MyDataFrame                 df;
+    RandGenParams<double>       p;
+    WorkStealingPool            pool (2);
+
+    std::iota(idx.begin(), idx.end(), 0UL);
+    df.load_index(std::move(idx));
+    df.load_column("noise", StlVecType<double>(n),
+                   nan_policy::dont_pad_with_nans);
+    p.mean = 0;
+    p.std = 2.0;
+    p.seed = 11;
+
+    auto            &noise = df.get_column<double>("noise");
+    const double    *before = noise.data();
+
+    // The whole column, then its second half again through a view, which
+    // continues the same sequence
+    //
+    par_fill_normal_dist(df.get_column<double>("noise"), p);
+    assert(noise.data() == before);
+
+    const auto  expected = par_gen_normal_dist<double>(n, p);
+
+    for (std::size_t i = 0; i < n; ++i)
+        assert(noise[i] == expected[i]);
+
+    std::fill(noise.begin() + n / 2, noise.end(), 0.0);
+    par_fill_normal_dist(VectorView<double>(noise.data() + n / 2,
+                                            noise.data() + n),
+                         p, pool, n / 2);
+    for (std::size_t i = 0; i < n; ++i)
+        assert(noise[i] == expected[i]);
+}
+
+// ----------------------------------------------------------------------------
+
+int main(int, char *[]) {
+
+    test_get_reindexed();
+    test_get_reindexed_view();
+    test_retype_column();
+    test_load_align_column();
+    test_fixed_size_priority_queue();
+    test_vector_view_iterators();
+    test_select_views();
+    test_lazy_reindex();
+    test_retype_column_bulk();
+    test_align_column_appender();
+    test_columnar_file();
+    test_arena_allocator();
+    test_sharded_top_k();
+    test_category_column();
+    test_incremental_visitors();
+    test_simd_kernels();
+    test_parallel_visit();
+    test_column_index();
+    test_csv_ingest();
+    test_join_asof();
+    test_compressed_columns();
+    test_instrumentation();
+    test_cow_frame();
+    test_live_frame();
+    test_lazy_query();
+    test_par_fill_column();
+
+    return (0);
+}
\ No newline at end of file
@@ -0,0 +1,506 @@
+#pragma once
+
+#include <DataFrame/DataFrame.h>
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace hmdf
+{
+
+// Financial visitors that update in O(1) per tick.
+//
+// The batch visitors walk the whole column on every call, so re-evaluating
+// them after each new tick costs O(history). The visitors here keep a
+// rolling state instead:
+//
+//   - update(value) takes the next value of the column.
+//   - current() is what the batch visitor would report for the last row of
+//     the column seen so far. It is NaN until enough values have been seen.
+//   - pre() resets the state.
+//
+// They also take the usual visitor calls, pre(), operator()(idx_begin,
+// idx_end, col_begin, col_end), post() and get_result(), so they can be
+// handed to visit() to catch up on a column and then be fed tick by tick.
+//
+// Rolling sums drift in floating point when values are added and removed
+// forever. The rolling visitors recompute their sums from the window each
+// time it wraps, which keeps the cost amortized O(1).
+//
+template<typename V>
+concept incremental_visitor =
+    requires(V visitor, const typename V::value_type &value)  {
+        visitor.pre();
+        visitor.update(value);
+        { visitor.current() } -> std::convertible_to<typename V::result_type>;
+    };
+
+template<typename T>
+inline constexpr T _incr_nan_() noexcept  {
+
+    return (std::numeric_limits<T>::quiet_NaN());
+}
+
+// The return from last to value, as ReturnVisitor<T> computes it
+//
+template<typename T>
+inline T _incr_return_(return_policy rp, T value, T last) noexcept  {
+
+    switch (rp)  {
+    case return_policy::log:
+        return (std::log(value / last));
+    case return_policy::percentage:
+        return ((value - last) / last);
+    case return_policy::monetary:
+        return (value - last);
+    case return_policy::trinary:
+        return (value > last ? T(1) : (value < last ? T(-1) : T(0)));
+    }
+    return (_incr_nan_<T>());
+}
+
+// The visit() entry points every incremental visitor shares
+//
+#define HMDF_INCREMENTAL_VISITOR_CALLS                                   \
+    template<typename K, typename H>                                     \
+    inline void                                                          \
+    operator() (const K &, const K &, const H &col_begin,                \
+                const H &col_end)  {                                     \
+                                                                         \
+        for (auto iter = col_begin; iter != col_end; ++iter)             \
+            update(*iter);                                               \
+    }                                                                    \
+    inline void post()  {   }                                            \
+    [[nodiscard]] inline result_type                                     \
+    get_result() const  { return (current()); }
+
+// ----------------------------------------------------------------------------
+
+// A window of the last roll_count values, oldest first
+//
+template<typename T>
+class   _RollingWindow_  {
+
+public:
+
+    using size_type = std::size_t;
+
+    explicit _RollingWindow_(size_type roll_count)
+        : values_(std::max<size_type>(roll_count, 1))  {   }
+
+    // Stores value and returns true if it pushed out the oldest one, which
+    // is then in evicted
+    //
+    inline bool push(const T &value, T &evicted) noexcept  {
+
+        const bool  full = count_ >= values_.size();
+
+        evicted = values_[pos_];
+        values_[pos_] = value;
+        pos_ = pos_ + 1 == values_.size() ? 0 : pos_ + 1;
+        count_ += 1;
+        return (full);
+    }
+
+    // True right after the window wrapped around
+    //
+    [[nodiscard]] inline bool
+    wrapped() const noexcept  { return (pos_ == 0 && count_ > 0); }
+    [[nodiscard]] inline bool
+    full() const noexcept  { return (count_ >= values_.size()); }
+    [[nodiscard]] inline size_type
+    size() const noexcept  { return (std::min(count_, values_.size())); }
+    [[nodiscard]] inline size_type
+    capacity() const noexcept  { return (values_.size()); }
+    [[nodiscard]] inline const std::vector<T> &
+    values() const noexcept  { return (values_); }
+
+    inline void clear() noexcept  {
+
+        pos_ = 0;
+        count_ = 0;
+    }
+
+private:
+
+    std::vector<T>  values_;
+    size_type       pos_ { 0 };
+    size_type       count_ { 0 };
+};
+
+// ----------------------------------------------------------------------------
+
+// Simple moving average over roll_count values, the incremental
+// counterpart of SimpleRollAdopter<MeanVisitor<T>, T>
+//
+template<typename T, typename I = unsigned long>
+class   IncrementalRollingMean  {
+
+public:
+
+    using value_type = T;
+    using index_type = I;
+    using result_type = T;
+    using size_type = std::size_t;
+
+    explicit IncrementalRollingMean(size_type roll_count)
+        : window_(roll_count)  {   }
+
+    inline void update(const value_type &value)  {
+
+        value_type  evicted { };
+
+        if (window_.push(value, evicted))  sum_ -= evicted;
+        sum_ += value;
+        if (window_.wrapped())
+            sum_ = sum_window_();
+    }
+
+    [[nodiscard]] inline result_type current() const noexcept  {
+
+        return (window_.full() ? sum_ / T(window_.capacity())
+                               : _incr_nan_<T>());
+    }
+
+    inline void pre()  {
+
+        window_.clear();
+        sum_ = 0;
+    }
+
+    HMDF_INCREMENTAL_VISITOR_CALLS
+
+private:
+
+    T sum_window_() const noexcept  {
+
+        T   sum { 0 };
+
+        for (const auto &v : window_.values())  sum += v;
+        return (sum);
+    }
+
+    _RollingWindow_<T>  window_;
+    T                   sum_ { 0 };
+};
+
+// ----------------------------------------------------------------------------
+
+// Rolling standard deviation over roll_count values, with the n - 1
+// denominator of StdVisitor<T>. It keeps a running mean and sum of squared
+// deviations (Welford), updated for the value coming in and the one going
+// out.
+//
+template<typename T, typename I = unsigned long>
+class   IncrementalRollingStd  {
+
+public:
+
+    using value_type = T;
+    using index_type = I;
+    using result_type = T;
+    using size_type = std::size_t;
+
+    explicit IncrementalRollingStd(size_type roll_count)
+        : window_(std::max<size_type>(roll_count, 2))  {   }
+
+    inline void update(const value_type &value)  {
+
+        value_type  evicted { };
+
+        if (window_.push(value, evicted))  {
+            const T old_mean = mean_;
+
+            mean_ += (value - evicted) / T(window_.capacity());
+            m2_ += (value - evicted) * (value - mean_ + evicted - old_mean);
+        }
+        else  {
+            const T delta = value - mean_;
+
+            mean_ += delta / T(window_.size());
+            m2_ += delta * (value - mean_);
+        }
+        if (window_.wrapped())
+            recompute_();
+    }
+
+    [[nodiscard]] inline result_type current() const noexcept  {
+
+        if (! window_.full())  return (_incr_nan_<T>());
+        return (std::sqrt(std::max(m2_, T(0)) /
+                          T(window_.capacity() - 1)));
+    }
+
+    // The rolling mean comes for free
+    //
+    [[nodiscard]] inline result_type mean() const noexcept  {
+
+        return (window_.full() ? mean_ : _incr_nan_<T>());
+    }
+
+    inline void pre()  {
+
+        window_.clear();
+        mean_ = 0;
+        m2_ = 0;
+    }
+
+    HMDF_INCREMENTAL_VISITOR_CALLS
+
+private:
+
+    void recompute_() noexcept  {
+
+        const auto  &values = window_.values();
+        T           sum { 0 };
+
+        for (const auto &v : values)  sum += v;
+        mean_ = sum / T(values.size());
+        m2_ = 0;
+        for (const auto &v : values)  m2_ += (v - mean_) * (v - mean_);
+    }
+
+    _RollingWindow_<T>  window_;
+    T                   mean_ { 0 };
+    T                   m2_ { 0 };
+};
+
+// ----------------------------------------------------------------------------
+
+// Rolling volatility: the standard deviation of the last roll_count log
+// returns, times annualization (for example std::sqrt(252.0))
+//
+template<typename T, typename I = unsigned long>
+class   IncrementalVolatility  {
+
+public:
+
+    using value_type = T;
+    using index_type = I;
+    using result_type = T;
+    using size_type = std::size_t;
+
+    explicit IncrementalVolatility(size_type roll_count,
+                                   T annualization = T(1))
+        : std_(roll_count), annualization_(annualization)  {   }
+
+    inline void update(const value_type &value)  {
+
+        if (count_++ > 0)
+            std_.update(std::log(value / last_));
+        last_ = value;
+    }
+
+    [[nodiscard]] inline result_type current() const noexcept  {
+
+        return (std_.current() * annualization_);
+    }
+
+    inline void pre()  {
+
+        std_.pre();
+        count_ = 0;
+    }
+
+    HMDF_INCREMENTAL_VISITOR_CALLS
+
+private:
+
+    IncrementalRollingStd<T, I> std_;
+    T                           annualization_;
+    T                           last_ { 0 };
+    size_type                   count_ { 0 };
+};
+
+// ----------------------------------------------------------------------------
+
+// Exponentially weighted moving average, s = alpha * x + (1 - alpha) * s,
+// starting from the first value
+//
+template<typename T, typename I = unsigned long>
+class   IncrementalEWMA  {
+
+public:
+
+    using value_type = T;
+    using index_type = I;
+    using result_type = T;
+
+    explicit IncrementalEWMA(T alpha) : alpha_(alpha)  {
+
+        if (alpha <= T(0) || alpha > T(1))
+            throw NotFeasible("IncrementalEWMA: alpha must be in (0, 1]");
+    }
+
+    // alpha for a span of n values, 2 / (n + 1)
+    //
+    [[nodiscard]] static IncrementalEWMA from_span(T span)  {
+
+        return (IncrementalEWMA(T(2) / (span + T(1))));
+    }
+
+    inline void update(const value_type &value) noexcept  {
+
+        ewma_ = started_ ? ewma_ + alpha_ * (value - ewma_) : value;
+        started_ = true;
+    }
+
+    [[nodiscard]] inline result_type current() const noexcept  {
+
+        return (started_ ? ewma_ : _incr_nan_<T>());
+    }
+
+    inline void pre() noexcept  { started_ = false; }
+
+    HMDF_INCREMENTAL_VISITOR_CALLS
+
+private:
+
+    T       alpha_;
+    T       ewma_ { 0 };
+    bool    started_ { false };
+};
+
+// ----------------------------------------------------------------------------
+
+// Drawdown from the running peak, the incremental counterpart of the last
+// row of DrawdownVisitor<T>
+//
+template<typename T, typename I = unsigned long>
+class   IncrementalDrawdown  {
+
+public:
+
+    using value_type = T;
+    using index_type = I;
+    using result_type = T;
+
+    inline void update(const value_type &value) noexcept  {
+
+        if (! started_ || value > peak_)  peak_ = value;
+        last_ = value;
+        max_drawdown_ = std::max(max_drawdown_, peak_ - value);
+        started_ = true;
+    }
+
+    // peak - last
+    //
+    [[nodiscard]] inline result_type current() const noexcept  {
+
+        return (started_ ? peak_ - last_ : _incr_nan_<T>());
+    }
+
+    // 1 - last / peak
+    //
+    [[nodiscard]] inline result_type pct_drawdown() const noexcept  {
+
+        return (started_ ? T(1) - last_ / peak_ : _incr_nan_<T>());
+    }
+
+    // The largest drawdown seen so far
+    //
+    [[nodiscard]] inline result_type max_drawdown() const noexcept  {
+
+        return (started_ ? max_drawdown_ : _incr_nan_<T>());
+    }
+
+    [[nodiscard]] inline result_type
+    peak() const noexcept  { return (started_ ? peak_ : _incr_nan_<T>()); }
+
+    inline void pre() noexcept  {
+
+        started_ = false;
+        max_drawdown_ = 0;
+    }
+
+    HMDF_INCREMENTAL_VISITOR_CALLS
+
+private:
+
+    T       peak_ { 0 };
+    T       last_ { 0 };
+    T       max_drawdown_ { 0 };
+    bool    started_ { false };
+};
+
+// ----------------------------------------------------------------------------
+
+// Relative strength index, the incremental counterpart of the last row of
+// RSIVisitor<T>. Prices are turned into returns by return_policy, as
+// ReturnVisitor<T> does. The first average is the sum of the first
+// avg_period - 1 gains and losses over avg_period, after that Wilder's
+// smoothing avg = (avg * (period - 1) + x) / period.
+//
+template<typename T, typename I = unsigned long>
+class   IncrementalRSI  {
+
+public:
+
+    using value_type = T;
+    using index_type = I;
+    using result_type = T;
+    using size_type = std::size_t;
+
+    explicit IncrementalRSI(return_policy rp = return_policy::log,
+                            size_type avg_period = 14)
+        : rp_(rp), period_(std::max<size_type>(avg_period, 1))  {   }
+
+    inline void update(const value_type &value) noexcept  {
+
+        if (count_++ > 0)  {
+            const T ret = _incr_return_(rp_, value, last_);
+            const T gain = ret > 0 ? ret : T(0);
+            const T loss = ret < 0 ? -ret : T(0);
+
+            if (count_ <= period_)  {
+                sum_gain_ += gain;
+                sum_loss_ += loss;
+            }
+            else  {
+                if (count_ == period_ + 1)  {
+                    avg_gain_ = sum_gain_ / T(period_);
+                    avg_loss_ = sum_loss_ / T(period_);
+                }
+                avg_gain_ = (avg_gain_ * T(period_ - 1) + gain) / T(period_);
+                avg_loss_ = (avg_loss_ * T(period_ - 1) + loss) / T(period_);
+            }
+        }
+        last_ = value;
+    }
+
+    [[nodiscard]] inline result_type current() const noexcept  {
+
+        if (count_ <= period_)  return (_incr_nan_<T>());
+        return (T(100) - T(100) / (T(1) + avg_gain_ / avg_loss_));
+    }
+
+    inline void pre() noexcept  {
+
+        count_ = 0;
+        sum_gain_ = 0;
+        sum_loss_ = 0;
+        avg_gain_ = 0;
+        avg_loss_ = 0;
+    }
+
+    HMDF_INCREMENTAL_VISITOR_CALLS
+
+private:
+
+    return_policy   rp_;
+    size_type       period_;
+    size_type       count_ { 0 };
+    T               last_ { 0 };
+    T               sum_gain_ { 0 };
+    T               sum_loss_ { 0 };
+    T               avg_gain_ { 0 };
+    T               avg_loss_ { 0 };
+};
+
+#undef HMDF_INCREMENTAL_VISITOR_CALLS
+
+}
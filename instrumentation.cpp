@@ -0,0 +1,411 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace hmdf
+{
+
+// Per-operation counters for finding where a slow query spends its time.
+//
+// An instrumented operation opens a scope at its top:
+//
+//   HMDF_INSTRUMENT_OP(scope, "retype_column_bulk");
+//   ...
+//   scope.add_rows(n);
+//   scope.add_bytes(n * sizeof(T));
+//
+// With HMDF_INSTRUMENT defined, the scope adds one call, its wall time, the
+// rows and bytes copied it was told about and the allocations made on its
+// thread to the operation's counters. Otherwise the scope is an empty
+// object whose members do nothing, and the compiler drops it.
+//
+// The counters live in the process-wide InstrumentRegistry, which works
+// either way: snapshot() and reset() from code, to_text() and to_json()
+// for a dump. Counters are relaxed atomics, so operations on several
+// threads can record at once.
+//
+// Allocations are counted only if operator new reports them through
+// instrument_note_alloc(). Defining HMDF_INSTRUMENT_DEFINE_NEW in one
+// translation unit, before including this, replaces operator new to do so.
+// Work an operation hands to other threads is timed but its allocations
+// are not counted. instrument_alloc_totals() has every thread's reported
+// allocations, for a harness that measures a whole program.
+//
+struct  OpStats  {
+
+    std::size_t calls { 0 };
+    std::size_t rows { 0 };
+    std::size_t bytes_copied { 0 };
+    std::size_t allocs { 0 };
+    std::size_t alloc_bytes { 0 };
+    double      wall_ns { 0 };
+    double      max_ns { 0 };
+};
+
+// The live counters of one operation
+//
+struct  OpCounters  {
+
+    std::atomic<std::size_t>    calls { 0 };
+    std::atomic<std::size_t>    rows { 0 };
+    std::atomic<std::size_t>    bytes_copied { 0 };
+    std::atomic<std::size_t>    allocs { 0 };
+    std::atomic<std::size_t>    alloc_bytes { 0 };
+    std::atomic<std::size_t>    wall_ns { 0 };
+    std::atomic<std::size_t>    max_ns { 0 };
+};
+
+// ----------------------------------------------------------------------------
+
+struct  _InstrumentAllocs_  {
+
+    std::size_t count { 0 };
+    std::size_t bytes { 0 };
+};
+
+[[nodiscard]] inline _InstrumentAllocs_ &_instrument_allocs_() noexcept  {
+
+    static thread_local _InstrumentAllocs_  allocs;
+
+    return (allocs);
+}
+
+struct  InstrumentAllocTotals  {
+
+    std::atomic<std::size_t>    count { 0 };
+    std::atomic<std::size_t>    bytes { 0 };
+};
+
+[[nodiscard]] inline InstrumentAllocTotals &
+instrument_alloc_totals() noexcept  {
+
+    static InstrumentAllocTotals    totals;
+
+    return (totals);
+}
+
+// For a replaced operator new to call
+//
+inline void instrument_note_alloc(std::size_t bytes) noexcept  {
+
+    _InstrumentAllocs_      &allocs = _instrument_allocs_();
+    InstrumentAllocTotals   &totals = instrument_alloc_totals();
+
+    allocs.count += 1;
+    allocs.bytes += bytes;
+    totals.count.fetch_add(1, std::memory_order_relaxed);
+    totals.bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+// ----------------------------------------------------------------------------
+
+class   InstrumentRegistry  {
+
+public:
+
+    using snapshot_type = std::map<std::string, OpStats>;
+
+    // The counters of operation name, created on first use. The reference
+    // stays valid for the life of the process, so call sites keep it.
+    //
+    OpCounters &counters(const char *name)  {
+
+        const std::lock_guard<std::mutex>   guard { mutex_ };
+        const auto                          iter = by_name_.find(name);
+
+        if (iter != by_name_.end())  return (*iter->second);
+        ops_.emplace_back();
+        by_name_.emplace(name, &ops_.back());
+        return (ops_.back());
+    }
+
+    // Operations with at least one call, by name
+    //
+    [[nodiscard]] snapshot_type snapshot() const  {
+
+        const std::lock_guard<std::mutex>   guard { mutex_ };
+        snapshot_type                       result;
+
+        for (const auto &[name, ops] : by_name_)  {
+            OpStats stats;
+
+            stats.calls = ops->calls.load(std::memory_order_relaxed);
+            if (stats.calls == 0)  continue;
+            stats.rows = ops->rows.load(std::memory_order_relaxed);
+            stats.bytes_copied =
+                ops->bytes_copied.load(std::memory_order_relaxed);
+            stats.allocs = ops->allocs.load(std::memory_order_relaxed);
+            stats.alloc_bytes =
+                ops->alloc_bytes.load(std::memory_order_relaxed);
+            stats.wall_ns =
+                double(ops->wall_ns.load(std::memory_order_relaxed));
+            stats.max_ns =
+                double(ops->max_ns.load(std::memory_order_relaxed));
+            result.emplace(name, stats);
+        }
+        return (result);
+    }
+
+    // Zeroes every counter. Operations keep their counters.
+    //
+    void reset()  {
+
+        const std::lock_guard<std::mutex>   guard { mutex_ };
+
+        for (auto &ops : ops_)  {
+            ops.calls = 0;
+            ops.rows = 0;
+            ops.bytes_copied = 0;
+            ops.allocs = 0;
+            ops.alloc_bytes = 0;
+            ops.wall_ns = 0;
+            ops.max_ns = 0;
+        }
+    }
+
+    // One line per operation: calls, total and mean wall time, rows,
+    // bytes copied and allocations
+    //
+    [[nodiscard]] std::string to_text() const  {
+
+        std::ostringstream  stream;
+        char                line[256];
+
+        std::snprintf(line, sizeof(line),
+                      "%-28s %10s %12s %12s %14s %14s %10s %14s\n",
+                      "operation", "calls", "total ms", "mean us", "rows",
+                      "bytes copied", "allocs", "alloc bytes");
+        stream << line;
+        for (const auto &[name, stats] : snapshot())  {
+            std::snprintf(line, sizeof(line),
+                          "%-28s %10zu %12.3f %12.3f %14zu %14zu %10zu "
+                          "%14zu\n",
+                          name.c_str(), stats.calls, stats.wall_ns * 1e-6,
+                          stats.wall_ns * 1e-3 / double(stats.calls),
+                          stats.rows, stats.bytes_copied, stats.allocs,
+                          stats.alloc_bytes);
+            stream << line;
+        }
+        return (stream.str());
+    }
+
+    // An array of objects, one per operation, with the fields of OpStats
+    //
+    [[nodiscard]] std::string to_json() const  {
+
+        const auto          stats = snapshot();
+        std::ostringstream  stream;
+        std::size_t         i = 0;
+
+        stream << "[\n";
+        for (const auto &[name, op] : stats)  {
+            stream << "  { \"name\": \"" << name
+                   << "\", \"calls\": " << op.calls
+                   << ", \"wall_ns\": " << op.wall_ns
+                   << ", \"max_ns\": " << op.max_ns
+                   << ", \"rows\": " << op.rows
+                   << ", \"bytes_copied\": " << op.bytes_copied
+                   << ", \"allocs\": " << op.allocs
+                   << ", \"alloc_bytes\": " << op.alloc_bytes << " }"
+                   << (++i < stats.size() ? ",\n" : "\n");
+        }
+        stream << "]\n";
+        return (stream.str());
+    }
+
+private:
+
+    // std::deque keeps the counters in place as it grows
+    //
+    std::deque<OpCounters>                  ops_ { };
+    std::map<std::string, OpCounters *>     by_name_ { };
+    mutable std::mutex                      mutex_ { };
+};
+
+[[nodiscard]] inline InstrumentRegistry &instrument_registry()  {
+
+    static InstrumentRegistry   registry;
+
+    return (registry);
+}
+
+// ----------------------------------------------------------------------------
+
+// Records one call of an operation when it goes out of scope
+//
+class   OpScope  {
+
+public:
+
+    explicit OpScope(OpCounters &counters) noexcept
+        : counters_(counters),
+          allocs_(_instrument_allocs_()),
+          start_(std::chrono::steady_clock::now())  {   }
+    OpScope(const OpScope &) = delete;
+    OpScope &operator = (const OpScope &) = delete;
+    ~OpScope()  {
+
+        const auto  ns = std::size_t(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start_).count());
+        const auto  &allocs = _instrument_allocs_();
+        std::size_t max_ns =
+            counters_.max_ns.load(std::memory_order_relaxed);
+
+        // Locked adds are the bulk of the cost, so zeros are left out
+        //
+        counters_.calls.fetch_add(1, std::memory_order_relaxed);
+        counters_.wall_ns.fetch_add(ns, std::memory_order_relaxed);
+        if (rows_)
+            counters_.rows.fetch_add(rows_, std::memory_order_relaxed);
+        if (bytes_)
+            counters_.bytes_copied.fetch_add(bytes_,
+                                             std::memory_order_relaxed);
+        if (allocs.count != allocs_.count)  {
+            counters_.allocs.fetch_add(allocs.count - allocs_.count,
+                                       std::memory_order_relaxed);
+            counters_.alloc_bytes.fetch_add(allocs.bytes - allocs_.bytes,
+                                            std::memory_order_relaxed);
+        }
+        while (ns > max_ns &&
+               ! counters_.max_ns.compare_exchange_weak(
+                     max_ns, ns, std::memory_order_relaxed))  {   }
+    }
+
+    inline void add_rows(std::size_t rows) noexcept  { rows_ += rows; }
+    inline void add_bytes(std::size_t bytes) noexcept  { bytes_ += bytes; }
+
+private:
+
+    OpCounters                              &counters_;
+    const _InstrumentAllocs_                allocs_;
+    std::size_t                             rows_ { 0 };
+    std::size_t                             bytes_ { 0 };
+    std::chrono::steady_clock::time_point   start_;
+};
+
+// What HMDF_INSTRUMENT_OP gives without HMDF_INSTRUMENT
+//
+struct  NullOpScope  {
+
+    inline void add_rows(std::size_t) noexcept  {   }
+    inline void add_bytes(std::size_t) noexcept  {   }
+};
+
+}
+
+// ----------------------------------------------------------------------------
+
+#ifdef HMDF_INSTRUMENT
+#  define HMDF_INSTRUMENT_OP(scope, name) \
+    static ::hmdf::OpCounters   &scope##_counters_ = \
+        ::hmdf::instrument_registry().counters(name); \
+    ::hmdf::OpScope             scope { scope##_counters_ }
+#else
+#  define HMDF_INSTRUMENT_OP(scope, name) \
+    [[maybe_unused]] ::hmdf::NullOpScope    scope { }
+#endif // HMDF_INSTRUMENT
+
+#ifdef HMDF_INSTRUMENT_DEFINE_NEW
+static void *_hmdf_counted_new_(std::size_t size, std::size_t align)  {
+
+    ::hmdf::instrument_note_alloc(size);
+
+    void    *ptr = align <= alignof(std::max_align_t)
+        ? std::malloc(size ? size : 1)
+        : std::aligned_alloc(align, (size + align - 1) / align * align);
+
+    if (! ptr)  throw std::bad_alloc();
+    return (ptr);
+}
+
+void *operator new(std::size_t size)  { return (_hmdf_counted_new_(size, 0)); }
+void *operator new[](std::size_t size)  {
+
+    return (_hmdf_counted_new_(size, 0));
+}
+void *operator new(std::size_t size, std::align_val_t align)  {
+
+    return (_hmdf_counted_new_(size, std::size_t(align)));
+}
+void *operator new[](std::size_t size, std::align_val_t align)  {
+
+    return (_hmdf_counted_new_(size, std::size_t(align)));
+}
+void operator delete(void *ptr) noexcept  { std::free(ptr); }
+void operator delete[](void *ptr) noexcept  { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept  { std::free(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept  { std::free(ptr); }
+void operator delete(void *ptr, std::align_val_t) noexcept  { std::free(ptr); }
+void operator delete[](void *ptr, std::align_val_t) noexcept  {
+
+    std::free(ptr);
+}
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept  {
+
+    std::free(ptr);
+}
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept  {
+
+    std::free(ptr);
+}
+
+// The nothrow forms are replaced too, so that no default allocation is
+// released by the free() above
+//
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept  {
+
+    try  { return (_hmdf_counted_new_(size, 0)); }
+    catch (...)  { return (nullptr); }
+}
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept  {
+
+    try  { return (_hmdf_counted_new_(size, 0)); }
+    catch (...)  { return (nullptr); }
+}
+void *operator new(std::size_t size,
+                   std::align_val_t align,
+                   const std::nothrow_t &) noexcept  {
+
+    try  { return (_hmdf_counted_new_(size, std::size_t(align))); }
+    catch (...)  { return (nullptr); }
+}
+void *operator new[](std::size_t size,
+                     std::align_val_t align,
+                     const std::nothrow_t &) noexcept  {
+
+    try  { return (_hmdf_counted_new_(size, std::size_t(align))); }
+    catch (...)  { return (nullptr); }
+}
+void operator delete(void *ptr, const std::nothrow_t &) noexcept  {
+
+    std::free(ptr);
+}
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept  {
+
+    std::free(ptr);
+}
+void operator delete(void *ptr,
+                     std::align_val_t,
+                     const std::nothrow_t &) noexcept  {
+
+    std::free(ptr);
+}
+void operator delete[](void *ptr,
+                       std::align_val_t,
+                       const std::nothrow_t &) noexcept  {
+
+    std::free(ptr);
+}
+#endif // HMDF_INSTRUMENT_DEFINE_NEW
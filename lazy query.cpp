@@ -0,0 +1,386 @@
+#pragma once
+
+#include <DataFrame/DataFrame.h>
+#include <DataFrame/ParallelVisit.h>
+#include <DataFrame/Utils/Instrumentation.h>
+#include <DataFrame/Vectors/VectorSelectView.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <numeric>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <typeindex>
+#include <utility>
+#include <vector>
+
+namespace hmdf
+{
+
+// A query that records its steps and runs them in one pass over the rows.
+//
+// Done step by step, filter -> select -> get_reindexed -> visit copies
+// every column it keeps into a new frame at each step. Here the steps are
+// only recorded:
+//
+//   lazy_query(df).filter<double>("price", [](double p)  { return (p > 0); })
+//                 .select({ "price", "size" })
+//                 .reindex<double>("price", "OLD_IDX")
+//                 .visit<int>("size", visitor);
+//
+// and nothing is read until a terminal operation: count(), get_index(),
+// get_column(), visit() or load_into(). It walks the rows in blocks of
+// query_block_rows. In each block the filters narrow a list of row
+// numbers, one after the other, and the surviving rows are then read
+// straight from the source columns. Only the columns the terminal
+// operation needs are touched, and only its result is allocated. A
+// mergeable visitor (see ParallelVisit.h) is fed block by block, so
+// visit() allocates two blocks' worth.
+//
+// As with get_reindexed(), a column shorter than the index has only the
+// selected rows it reaches, and a filter on it fails the rows past its end.
+//
+// The source frame must outlive the query and must not change under it.
+//
+inline constexpr std::size_t    query_block_rows { 4096 };
+
+template<typename DF, typename I = typename DF::IndexType>
+class   LazyQuery  {
+
+public:
+
+    using IndexType = I;
+    using OldIndexType = typename DF::IndexType;
+    using size_type = std::size_t;
+    using row_type = RowSelection::value_type;
+
+    // Keeps the rows it returns true for, compacting rows[0, n) in place
+    //
+    using FilterType = std::function<size_type(row_type *rows, size_type n)>;
+
+    explicit LazyQuery(const DF &df) requires std::is_same_v<I, OldIndexType>
+        : LazyQuery(df, df.get_index().data(), df.get_index().size())  {   }
+
+    // Keeps the rows where pred(column value) is true. The old index is a
+    // column after reindex().
+    //
+    template<typename T, typename P>
+    LazyQuery &filter(const char *name, P pred)  {
+
+        const auto  src = source_<T>(name);
+
+        filters_.push_back(filter_(src.first, src.second, std::move(pred)));
+        return (*this);
+    }
+
+    // Keeps the rows where pred(index value) is true
+    //
+    template<typename P>
+    LazyQuery &filter_index(P pred)  {
+
+        filters_.push_back(filter_(index_, rows_, std::move(pred)));
+        return (*this);
+    }
+
+    // The columns load_into() copies. All of them, by default.
+    //
+    LazyQuery &select(std::vector<std::string> names)  {
+
+        selected_ = std::move(names);
+        return (*this);
+    }
+
+    // The query over the rows of column col_to_be_index as the index. The
+    // old index becomes column old_index_name. Steps recorded so far are
+    // kept.
+    //
+    template<typename I2>
+    [[nodiscard]] LazyQuery<DF, I2>
+    reindex(const char *col_to_be_index, const char *old_index_name) const  {
+
+        const auto          &new_idx =
+            df_.template get_column<I2>(col_to_be_index);
+        LazyQuery<DF, I2>   result (df_, new_idx.data(), new_idx.size());
+
+        result.filters_ = filters_;
+        result.selected_ = selected_;
+        result.new_index_name_ = col_to_be_index;
+        result.old_index_name_ = old_index_name;
+        return (result);
+    }
+
+    // ------------------------------------------------------------------------
+
+    // Terminal operations. Each makes one pass.
+
+    [[nodiscard]] size_type count() const  {
+
+        size_type   result { 0 };
+
+        run_([&result](const row_type *, size_type n)  { result += n; });
+        return (result);
+    }
+
+    [[nodiscard]] std::vector<I> get_index() const  {
+
+        std::vector<I>  result;
+
+        run_([this, &result](const row_type *rows, size_type n)  {
+            append_(result, index_, rows_, rows, n);
+        });
+        return (result);
+    }
+
+    // The selected rows of column name. The old index is a column after
+    // reindex().
+    //
+    template<typename T>
+    [[nodiscard]] std::vector<T> get_column(const char *name) const  {
+
+        const auto      src = source_<T>(name);
+        std::vector<T>  result;
+
+        run_([&src, &result](const row_type *rows, size_type n)  {
+            append_(result, src.first, src.second, rows, n);
+        });
+        return (result);
+    }
+
+    // Visits column name of the selected rows as df.visit<T>() would
+    //
+    template<typename T, typename V>
+    V &visit(const char *name, V &visitor) const  {
+
+        const auto  src = source_<T>(name);
+
+        if constexpr (mergeable_visitor<V>)  {
+            std::vector<I>  idx_block;
+            std::vector<T>  col_block;
+
+            idx_block.reserve(query_block_rows);
+            col_block.reserve(query_block_rows);
+            _visit_blocks_(visitor, [&](auto &&visit_block)  {
+                run_([&](const row_type *rows, size_type n)  {
+                    col_block.clear();
+                    append_(col_block, src.first, src.second, rows, n);
+                    idx_block.clear();
+                    append_(idx_block, index_, rows_, rows,
+                            col_block.size());
+                    visit_block(idx_block.data(),
+                                idx_block.data() + idx_block.size(),
+                                col_block.data(),
+                                col_block.data() + col_block.size());
+                });
+            });
+        }
+        else  {
+            std::vector<I>  idx;
+            std::vector<T>  col;
+
+            run_([&](const row_type *rows, size_type n)  {
+                const size_type before = col.size();
+
+                append_(col, src.first, src.second, rows, n);
+                append_(idx, index_, rows_, rows, col.size() - before);
+            });
+            visitor.pre();
+            visitor(idx.begin(), idx.end(), col.begin(), col.end());
+            visitor.post();
+        }
+        return (visitor);
+    }
+
+    // Loads into df the index and, of the selected columns, those whose
+    // type is among Ts, all gathered in the same pass. After reindex(),
+    // the old index is one of the columns and the new index's column is
+    // not, as with get_reindexed().
+    //
+    template<typename ... Ts, typename RDF>
+    void load_into(RDF &df) const  {
+
+        std::tuple<std::vector<Out_<Ts>> ...>   outs;
+        Out_<I>                                 index_out {
+            std::string(), index_, rows_, { } };
+        std::vector<Out_<OldIndexType>>         old_index_out;
+        std::vector<std::string>                names;
+
+        for (const auto &info : df_.template get_columns_info<Ts ...>())  {
+            const std::string   &name = std::get<0>(info);
+            const auto          &type = std::get<2>(info);
+
+            if (name == new_index_name_ || ! is_selected_(name) ||
+                std::find(names.begin(), names.end(), name) != names.end())
+                continue;
+            names.push_back(name);
+            [&]<std::size_t ... K>(std::index_sequence<K ...>)  {
+                (void) ((type == std::type_index(
+                                     typeid(std::tuple_element_t<
+                                                K, std::tuple<Ts ...>>)) &&
+                         (add_out_(std::get<K>(outs), name), true)) || ...);
+            }(std::index_sequence_for<Ts ...> { });
+        }
+        if (! old_index_name_.empty() && is_selected_(old_index_name_))  {
+            const auto  &old_idx = df_.get_index();
+
+            old_index_out.push_back(Out_<OldIndexType> {
+                old_index_name_, old_idx.data(), old_idx.size(), { } });
+        }
+
+        run_([&](const row_type *rows, size_type n)  {
+            index_out.append(rows, n);
+            for (auto &out : old_index_out)  out.append(rows, n);
+            std::apply([rows, n](auto & ... out_vecs)  {
+                ((std::for_each(out_vecs.begin(), out_vecs.end(),
+                                [rows, n](auto &out)  {
+                                    out.append(rows, n);
+                                })), ...);
+            }, outs);
+        });
+
+        df.load_index(std::move(index_out.values));
+        for (auto &out : old_index_out)
+            df.load_column(out.name.c_str(), std::move(out.values),
+                           nan_policy::dont_pad_with_nans);
+        std::apply([&df](auto & ... out_vecs)  {
+            ((std::for_each(out_vecs.begin(), out_vecs.end(),
+                            [&df](auto &out)  {
+                                df.load_column(out.name.c_str(),
+                                               std::move(out.values),
+                                               nan_policy::dont_pad_with_nans);
+                            })), ...);
+        }, outs);
+    }
+
+private:
+
+    template<typename, typename>
+    friend class    LazyQuery;
+
+    LazyQuery(const DF &df, const I *index, size_type rows)
+        : df_(df), index_(index), rows_(rows)  {   }
+
+    // One column load_into() gathers
+    //
+    template<typename T>
+    struct  Out_  {
+
+        std::string     name;
+        const T         *src;
+        size_type       src_size;
+        std::vector<T>  values;
+
+        void append(const row_type *rows, size_type n)  {
+
+            append_(values, src, src_size, rows, n);
+        }
+    };
+
+    template<typename T>
+    void add_out_(std::vector<Out_<T>> &outs, const std::string &name) const  {
+
+        const auto  &col = df_.template get_column<T>(name.c_str());
+
+        outs.push_back(Out_<T> { name, col.data(), col.size(), { } });
+    }
+
+    template<typename T, typename P>
+    static FilterType filter_(const T *data, size_type size, P pred)  {
+
+        return ([data, size, pred = std::move(pred)]
+                (row_type *rows, size_type n) mutable  {
+            size_type   kept { 0 };
+
+            for (size_type i = 0; i < n; ++i)  {
+                const row_type  r = rows[i];
+
+                rows[kept] = r;
+                kept += (r < size && pred(data[r]));
+            }
+            return (kept);
+        });
+    }
+
+    // Appends src[rows[i]] for the rows src reaches. Rows are ascending,
+    // so those are a prefix.
+    //
+    template<typename T>
+    static void append_(std::vector<T> &dst,
+                        const T *src,
+                        size_type src_size,
+                        const row_type *rows,
+                        size_type n)  {
+
+        while (n > 0 && rows[n - 1] >= src_size)  --n;
+
+        const size_type before = dst.size();
+
+        dst.resize(before + n);
+        for (size_type i = 0; i < n; ++i)
+            dst[before + i] = src[rows[i]];
+    }
+
+    // Data and length of column name, or of the old index
+    //
+    template<typename T>
+    std::pair<const T *, size_type> source_(const char *name) const  {
+
+        if constexpr (std::is_same_v<T, OldIndexType>)
+            if (! old_index_name_.empty() && old_index_name_ == name)  {
+                const auto  &idx = df_.get_index();
+
+                return (std::make_pair(idx.data(), idx.size()));
+            }
+
+        const auto  &col = df_.template get_column<T>(name);
+
+        return (std::make_pair(col.data(), col.size()));
+    }
+
+    [[nodiscard]] bool is_selected_(const std::string &name) const  {
+
+        return (selected_.empty() ||
+                std::find(selected_.begin(), selected_.end(), name) !=
+                    selected_.end());
+    }
+
+    // Calls func(rows, n) with the rows of each block that pass every
+    // filter, in order. Blocks no row passes are skipped.
+    //
+    template<typename F>
+    void run_(F &&func) const  {
+
+        HMDF_INSTRUMENT_OP(scope, "lazy_query");
+
+        std::vector<row_type>   rows (std::min(rows_, query_block_rows));
+
+        scope.add_rows(rows_);
+        for (size_type begin = 0; begin < rows_; begin += query_block_rows)  {
+            size_type   n = std::min(rows_ - begin, query_block_rows);
+
+            std::iota(rows.begin(), rows.begin() + n, row_type(begin));
+            for (const auto &filter : filters_)
+                if ((n = filter(rows.data(), n)) == 0)  break;
+            if (n > 0)  func(rows.data(), n);
+        }
+    }
+
+    const DF                    &df_;
+    const I                     *index_ { nullptr };
+    size_type                   rows_ { 0 };
+    std::vector<FilterType>     filters_ { };
+    std::vector<std::string>    selected_ { };
+    std::string                 new_index_name_ { };
+    std::string                 old_index_name_ { };
+};
+
+// ----------------------------------------------------------------------------
+
+template<typename DF>
+[[nodiscard]] inline LazyQuery<DF> lazy_query(const DF &df)  {
+
+    return (LazyQuery<DF>(df));
+}
+
+}
@@ -0,0 +1,242 @@
+#pragma once
+
+#include <DataFrame/DataFrame.h>
+#include <DataFrame/Utils/Instrumentation.h>
+#include <DataFrame/Utils/ParallelFor.h>
+#include <DataFrame/Utils/ThreadPool.h>
+#include <DataFrame/Vectors/VectorSelectView.h>
+
+#include <algorithm>
+#include <any>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace hmdf
+{
+
+// A reindexed frame that does not copy the source frame's columns.
+//
+// get_reindexed() builds a new frame by copying every column. This instead
+// computes the row permutation once and applies it on demand:
+//
+//   - get_column_view<T>() returns a VectorIndexedConstView over the source
+//     column through the shared permutation. It never copies, so it is the
+//     way to read std::string columns.
+//   - get_column<T>() gathers the column on first access and keeps the
+//     result for later calls.
+//   - materialize<T>() gathers a list of columns ahead of time, in blocks
+//     spread over a WorkStealingPool.
+//
+// By default the row order is unchanged, as with get_reindexed(). With
+// sort_by_index, rows are ordered by the new index (stable sort), which is
+// where the permutation actually pays off.
+//
+// The source frame must outlive this object and its columns must not be
+// resized while it is alive. Like the frame, it is not thread-safe.
+//
+template<typename I, typename DF>
+class   LazyReindexedFrame  {
+
+public:
+
+    using IndexType = I;
+    using IndexVecType = std::vector<I>;
+    using OldIndexType = typename DF::IndexType;
+    using size_type = RowSelection::value_type;
+
+    // Gather block size for materialize(), in rows
+    //
+    static constexpr size_type  gather_block { 1 << 14 };
+
+    LazyReindexedFrame(const DF &df,
+                       const char *col_to_be_index,
+                       const char *old_index_name,
+                       bool sort_by_index = false)
+        : df_(df), old_index_name_(old_index_name)  {
+
+        HMDF_INSTRUMENT_OP(scope, "get_lazy_reindexed");
+
+        const auto      &new_idx = df.template get_column<I>(col_to_be_index);
+        const size_type col_s = new_idx.size();
+        auto            rows = std::make_shared<RowSelection>(col_s);
+
+        // The permutation and the new index
+        //
+        scope.add_rows(col_s);
+        scope.add_bytes(col_s * (sizeof(size_type) + sizeof(I)));
+
+        std::iota(rows->begin(), rows->end(), size_type(0));
+        if (sort_by_index)
+            std::stable_sort(rows->begin(), rows->end(),
+                             [&new_idx](size_type lhs, size_type rhs)  {
+                                 return (new_idx[lhs] < new_idx[rhs]);
+                             });
+        sorted_ = sort_by_index;
+        rows_ = std::move(rows);
+
+        indices_.reserve(col_s);
+        for (const auto r : *rows_)
+            indices_.push_back(new_idx[r]);
+    }
+
+    [[nodiscard]] const IndexVecType &
+    get_index() const noexcept  { return (indices_); }
+    [[nodiscard]] const RowSelectionPtr &
+    get_permutation() const noexcept  { return (rows_); }
+    [[nodiscard]] size_type
+    shape_rows() const noexcept  { return (indices_.size()); }
+
+    // Zero-copy view of a source column in the new row order. Asking for
+    // old_index_name gives the source frame's index.
+    //
+    // Without sort_by_index, a column shorter than the new index gives a
+    // shorter view, as get_reindexed() does. With it, the column must be
+    // at least as long as the new index.
+    //
+    template<typename T>
+    [[nodiscard]] VectorIndexedConstView<T>
+    get_column_view(const char *name) const  {
+
+        const auto  col = source_column_<T>(name);
+
+        if (col.size() >= rows_->size())
+            return (VectorIndexedConstView<T>(col.data(), rows_));
+        if (sorted_)
+            throw NotFeasible("LazyReindexedFrame::get_column_view(): "
+                              "Column is shorter than the sorted index");
+
+        auto    rows = std::make_shared<RowSelection>(
+                           rows_->begin(), rows_->begin() + col.size());
+
+        return (VectorIndexedConstView<T>(col.data(), std::move(rows)));
+    }
+
+    // The column gathered into its own storage. Gathers on first access.
+    // With sort_by_index, rows the column does not have are NaN padded, or
+    // hold T { } if T has no quiet NaN. Asking for a gathered column as
+    // another type throws NotFeasible.
+    //
+    template<typename T>
+    [[nodiscard]] const std::vector<T> &
+    get_column(const char *name,
+               WorkStealingPool &pool = default_thread_pool())  {
+
+        return (gathered_column_<T>(name, pool));
+    }
+
+    // Gathers the named columns of type T now, each one in gather_block
+    // sized pieces spread over pool.
+    //
+    template<typename T>
+    void materialize(const std::vector<const char *> &names,
+                     WorkStealingPool &pool = default_thread_pool())  {
+
+        for (const char *name : names)
+            gathered_column_<T>(name, pool);
+    }
+
+    [[nodiscard]] bool
+    is_materialized(const char *name) const  {
+
+        return (gathered_.find(name) != gathered_.end());
+    }
+
+private:
+
+    template<typename T>
+    const std::vector<T> &
+    gathered_column_(const char *name, WorkStealingPool &pool)  {
+
+        auto    iter = gathered_.find(name);
+
+        if (iter == gathered_.end())
+            iter = gathered_.emplace(
+                       name, gather_<T>(name, pool)).first;
+        else if (iter->second.type() != typeid(std::vector<T>))
+            throw NotFeasible("LazyReindexedFrame::get_column(): "
+                              "Column was gathered as another type");
+        return (std::any_cast<const std::vector<T> &>(iter->second));
+    }
+
+    template<typename T>
+    VectorConstView<T> source_column_(const char *name) const  {
+
+        if constexpr (std::is_same_v<T, OldIndexType>)
+            if (old_index_name_ == name)  {
+                const auto  &idx = df_.get_index();
+
+                return (VectorConstView<T>(idx.data(),
+                                           idx.data() + idx.size()));
+            }
+
+        const auto  &col = df_.template get_column<T>(name);
+
+        return (VectorConstView<T>(col.data(), col.data() + col.size()));
+    }
+
+    template<typename T>
+    std::vector<T>
+    gather_(const char *name, WorkStealingPool &pool) const  {
+
+        HMDF_INSTRUMENT_OP(scope, "lazy_reindex_gather");
+
+        const auto          col = source_column_<T>(name);
+        const size_type     col_s = col.size();
+        const size_type     result_s =
+            sorted_ ? rows_->size()
+                    : std::min<size_type>(col_s, rows_->size());
+        std::vector<T>      result (result_s);
+        const size_type     *rows = rows_->data();
+        const T             *src = col.data();
+        T                   *dst = result.data();
+        const auto          gather_range = [=](size_type begin,
+                                               size_type end)  {
+            for (size_type i = begin; i < end; ++i)
+                if (rows[i] < col_s)  dst[i] = src[rows[i]];
+                else if constexpr (std::numeric_limits<T>::has_quiet_NaN)
+                    dst[i] = std::numeric_limits<T>::quiet_NaN();
+        };
+
+        parallel_for_chunks(result_s, gather_block, pool,
+                            gather_range);
+        scope.add_rows(result_s);
+        scope.add_bytes(result_s * sizeof(T));
+        return (result);
+    }
+
+    using GatheredMap = std::unordered_map<std::string, std::any>;
+
+    const DF        &df_;
+    std::string     old_index_name_;
+    bool            sorted_ { false };
+    RowSelectionPtr rows_ { };
+    IndexVecType    indices_ { };
+    GatheredMap     gathered_ { };
+};
+
+// ----------------------------------------------------------------------------
+
+// The lazy counterpart of df.get_reindexed<T, ...>(col_to_be_index,
+// old_index_name)
+//
+template<typename T, typename DF>
+[[nodiscard]] inline LazyReindexedFrame<T, DF>
+get_lazy_reindexed(const DF &df,
+                   const char *col_to_be_index,
+                   const char *old_index_name,
+                   bool sort_by_index = false)  {
+
+    return (LazyReindexedFrame<T, DF>(df,
+                                      col_to_be_index,
+                                      old_index_name,
+                                      sort_by_index));
+}
+
+}
\ No newline at end of file
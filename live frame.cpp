@@ -0,0 +1,386 @@
+#pragma once
+
+#include <DataFrame/DataFrame.h>
+#include <DataFrame/ParallelVisit.h>
+#include <DataFrame/Utils/Instrumentation.h>
+#include <DataFrame/Vectors/VectorView.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace hmdf
+{
+
+// An append-only frame that one feed thread appends to while any number of
+// query threads read it, without a lock.
+//
+// The index and each column are a list of segments of live_segment_rows
+// rows. A segment, once allocated, never moves, and rows are only ever
+// added after the committed ones, so what a reader sees never changes
+// under it.
+//
+// The writer fills in rows past the committed row count, then publishes
+// them by storing the new count (release). snapshot() loads the count
+// (acquire) and is the rows up to it. That is all a reader does to
+// synchronize: the snapshot's rows were written before the count, and
+// the writer does not touch them again.
+//
+// The columns, their names and types Ts are fixed when the frame is made.
+// The segment directory is sized for max_rows up front, so growing never
+// reallocates it. The frame must outlive its snapshots.
+//
+// Only one thread may append at a time.
+//
+inline constexpr std::size_t    live_segment_rows { 1 << 16 };
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+class   _LiveColumn_  {
+
+public:
+
+    using size_type = std::size_t;
+
+    explicit _LiveColumn_(size_type max_segments)
+        : segments_(std::make_unique<std::atomic<T *>[]>(max_segments)),
+          max_segments_(max_segments)  {
+
+        for (size_type s = 0; s < max_segments_; ++s)
+            segments_[s].store(nullptr, std::memory_order_relaxed);
+    }
+    _LiveColumn_(_LiveColumn_ &&) = default;
+    ~_LiveColumn_()  {
+
+        if (segments_)
+            for (size_type s = 0; s < max_segments_; ++s)
+                delete[] segments_[s].load(std::memory_order_relaxed);
+    }
+
+    // A segment holding committed rows. The count a reader loaded (acquire)
+    // was stored after the segment pointer, so relaxed is enough here.
+    //
+    [[nodiscard]] const T *segment(size_type s) const noexcept  {
+
+        return (segments_[s].load(std::memory_order_relaxed));
+    }
+
+    // The writer's side. Copies n values to rows [first, first + n),
+    // allocating segments as it goes.
+    //
+    void write(size_type first, const T *values, size_type n)  {
+
+        while (n > 0)  {
+            const size_type s = first / live_segment_rows;
+            const size_type offset = first % live_segment_rows;
+            const size_type take = std::min(n, live_segment_rows - offset);
+
+            std::copy(values, values + take, segment_for_write_(s) + offset);
+            first += take;
+            values += take;
+            n -= take;
+        }
+    }
+    void write(size_type row, const T &value)  {
+
+        segment_for_write_(row / live_segment_rows)
+            [row % live_segment_rows] = value;
+    }
+
+private:
+
+    T *segment_for_write_(size_type s)  {
+
+        T   *seg = segments_[s].load(std::memory_order_relaxed);
+
+        if (! seg)  {
+            seg = new T[live_segment_rows];
+            segments_[s].store(seg, std::memory_order_relaxed);
+        }
+        return (seg);
+    }
+
+    std::unique_ptr<std::atomic<T *>[]>    segments_;
+    size_type                               max_segments_;
+};
+
+// ----------------------------------------------------------------------------
+
+template<typename I, typename ... Ts>
+class   LiveFrame;
+
+// The committed rows of a LiveFrame when snapshot() was called. Cheap to
+// copy. The views it hands out stay valid for the life of the frame.
+//
+template<typename I, typename ... Ts>
+class   LiveSnapshot  {
+
+public:
+
+    using IndexType = I;
+    using size_type = std::size_t;
+    using FrameType = LiveFrame<I, Ts ...>;
+
+    LiveSnapshot() = default;
+
+    [[nodiscard]] size_type shape_rows() const noexcept  { return (rows_); }
+    [[nodiscard]] size_type segment_count() const noexcept  {
+
+        return ((rows_ + live_segment_rows - 1) / live_segment_rows);
+    }
+
+    // The rows of segment s, [s * live_segment_rows, ...), up to the
+    // snapshot's row count
+    //
+    [[nodiscard]] VectorConstView<I>
+    get_index_view(size_type s) const noexcept  {
+
+        return (view_(frame_->index_, s));
+    }
+    template<typename T>
+    [[nodiscard]] VectorConstView<T>
+    get_column_view(const char *name, size_type s) const  {
+
+        return (view_(frame_->template column_<T>(name), s));
+    }
+
+    [[nodiscard]] const I &index_at(size_type row) const noexcept  {
+
+        return (frame_->index_.segment(row / live_segment_rows)
+                    [row % live_segment_rows]);
+    }
+
+    // Copies of the index and column name
+    //
+    [[nodiscard]] std::vector<I> get_index() const  {
+
+        return (gather_(frame_->index_));
+    }
+    template<typename T>
+    [[nodiscard]] std::vector<T> get_column(const char *name) const  {
+
+        return (gather_(frame_->template column_<T>(name)));
+    }
+
+    // Visits column name as df.visit<T>() would. A mergeable visitor (see
+    // ParallelVisit.h) sees one segment at a time, through a copy merged
+    // back after each, so nothing is copied. Any other is given copies of
+    // the whole index and column.
+    //
+    template<typename T, typename V>
+    V &visit(const char *name, V &visitor) const  {
+
+        HMDF_INSTRUMENT_OP(scope, "live_visit");
+
+        const auto  &col = frame_->template column_<T>(name);
+
+        scope.add_rows(rows_);
+        if constexpr (mergeable_visitor<V>)  {
+            _visit_blocks_(visitor, [this, &col](auto &&visit_block)  {
+                for (size_type s = 0; s < segment_count(); ++s)  {
+                    const auto  idx = view_(frame_->index_, s);
+                    const auto  vals = view_(col, s);
+
+                    visit_block(idx.data(), idx.data() + idx.size(),
+                                vals.data(), vals.data() + vals.size());
+                }
+            });
+        }
+        else  {
+            const auto  idx = get_index();
+            const auto  vals = gather_(col);
+
+            scope.add_bytes(rows_ * (sizeof(I) + sizeof(T)));
+            visitor.pre();
+            visitor(idx.begin(), idx.end(), vals.begin(), vals.end());
+            visitor.post();
+        }
+        return (visitor);
+    }
+
+    // Copies the snapshot into df
+    //
+    template<typename DF>
+    void load_into(DF &df) const  {
+
+        df.load_index(get_index());
+        [this, &df]<std::size_t ... K>(std::index_sequence<K ...>)  {
+            (df.load_column(frame_->names_[K].c_str(),
+                            gather_(std::get<K>(frame_->columns_)),
+                            nan_policy::dont_pad_with_nans), ...);
+        }(std::index_sequence_for<Ts ...> { });
+    }
+
+private:
+
+    friend class    LiveFrame<I, Ts ...>;
+
+    LiveSnapshot(const FrameType *frame, size_type rows) noexcept
+        : frame_(frame), rows_(rows)  {   }
+
+    template<typename T>
+    VectorConstView<T>
+    view_(const _LiveColumn_<T> &col, size_type s) const noexcept  {
+
+        const T         *seg = col.segment(s);
+        const size_type first = s * live_segment_rows;
+        const size_type n =
+            first < rows_ ? std::min(live_segment_rows, rows_ - first) : 0;
+
+        return (VectorConstView<T>(seg, seg + n));
+    }
+
+    template<typename T>
+    std::vector<T> gather_(const _LiveColumn_<T> &col) const  {
+
+        std::vector<T>  result;
+
+        result.reserve(rows_);
+        for (size_type s = 0; s < segment_count(); ++s)  {
+            const auto  vals = view_(col, s);
+
+            result.insert(result.end(),
+                          vals.data(), vals.data() + vals.size());
+        }
+        return (result);
+    }
+
+    const FrameType *frame_ { nullptr };
+    size_type       rows_ { 0 };
+};
+
+// ----------------------------------------------------------------------------
+
+template<typename I, typename ... Ts>
+class   LiveFrame  {
+
+public:
+
+    using IndexType = I;
+    using size_type = std::size_t;
+    using SnapshotType = LiveSnapshot<I, Ts ...>;
+
+    // One name for each of Ts, in order. max_rows is rounded up to whole
+    // segments.
+    //
+    explicit LiveFrame(std::vector<std::string> column_names,
+                       size_type max_rows = size_type(1) << 32)
+        : names_(std::move(column_names)),
+          max_segments_((max_rows + live_segment_rows - 1) /
+                        live_segment_rows),
+          index_(max_segments_),
+          columns_(_LiveColumn_<Ts>(max_segments_) ...)  {
+
+        if (names_.size() != sizeof ... (Ts))
+            throw NotFeasible("LiveFrame: Need one name for each column");
+    }
+    LiveFrame(const LiveFrame &) = delete;
+    LiveFrame &operator = (const LiveFrame &) = delete;
+
+    [[nodiscard]] size_type capacity() const noexcept  {
+
+        return (max_segments_ * live_segment_rows);
+    }
+    [[nodiscard]] size_type committed_rows() const noexcept  {
+
+        return (committed_.load(std::memory_order_acquire));
+    }
+    [[nodiscard]] const std::vector<std::string> &
+    get_column_names() const noexcept  { return (names_); }
+
+    // Lock-free. Any thread.
+    //
+    [[nodiscard]] SnapshotType snapshot() const noexcept  {
+
+        return (SnapshotType(this, committed_rows()));
+    }
+
+    // Appends and commits one row
+    //
+    void append_row(const I &index, const Ts & ... values)  {
+
+        const size_type row = reserve_(1);
+
+        index_.write(row, index);
+        [&]<std::size_t ... K>(std::index_sequence<K ...>)  {
+            (std::get<K>(columns_).write(row, values), ...);
+        }(std::index_sequence_for<Ts ...> { });
+        committed_.store(row + 1, std::memory_order_release);
+    }
+
+    // Appends n rows, an array of n for the index and each column, and
+    // commits them together
+    //
+    void append_rows(size_type n, const I *index, const Ts * ... columns)  {
+
+        HMDF_INSTRUMENT_OP(scope, "live_append_rows");
+
+        const size_type first = reserve_(n);
+
+        index_.write(first, index, n);
+        [&]<std::size_t ... K>(std::index_sequence<K ...>)  {
+            (std::get<K>(columns_).write(first, columns, n), ...);
+        }(std::index_sequence_for<Ts ...> { });
+        committed_.store(first + n, std::memory_order_release);
+        scope.add_rows(n);
+        scope.add_bytes(n * (sizeof(I) + (sizeof(Ts) + ... + 0)));
+    }
+
+private:
+
+    friend class    LiveSnapshot<I, Ts ...>;
+
+    // The first row to write. Only the writer changes the count.
+    //
+    size_type reserve_(size_type n) const  {
+
+        const size_type first = committed_.load(std::memory_order_relaxed);
+
+        if (n > capacity() - first)
+            throw NotFeasible("LiveFrame: Appending past max_rows");
+        return (first);
+    }
+
+    template<typename T, typename U>
+    static const _LiveColumn_<T> *
+    as_(const _LiveColumn_<U> &col) noexcept  {
+
+        if constexpr (std::is_same_v<T, U>)  return (&col);
+        else  return (nullptr);
+    }
+
+    template<typename T>
+    const _LiveColumn_<T> &column_(const char *name) const  {
+
+        const auto  iter = std::find(names_.begin(), names_.end(), name);
+
+        if (iter == names_.end())
+            throw ColNotFound(std::string("LiveFrame: ") + name);
+
+        const size_type         pos = size_type(iter - names_.begin());
+        const _LiveColumn_<T>   *result { nullptr };
+
+        [&]<std::size_t ... K>(std::index_sequence<K ...>)  {
+            (void) ((K == pos &&
+                     (result = as_<T>(std::get<K>(columns_)))) || ...);
+        }(std::index_sequence_for<Ts ...> { });
+        if (! result)
+            throw NotFeasible("LiveFrame: Column type does not match");
+        return (*result);
+    }
+
+    std::vector<std::string>            names_;
+    size_type                           max_segments_;
+    _LiveColumn_<I>                     index_;
+    std::tuple<_LiveColumn_<Ts> ...>    columns_;
+    std::atomic<size_type>              committed_ { 0 };
+};
+
+}
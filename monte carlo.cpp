@@ -0,0 +1,336 @@
+#pragma once
+
+#include <DataFrame/DataFrameSIMDKernels.h>
+#include <DataFrame/ParallelRandGen.h>
+#include <DataFrame/Utils/Instrumentation.h>
+#include <DataFrame/Utils/ThreadPool.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace hmdf
+{
+
+// Monte Carlo price paths, geometric Brownian motion with optional Merton
+// jumps, generated and stepped in the same pass.
+//
+// Over each step of dt, the log price moves by
+//
+//   (drift - volatility^2 / 2 - jump_intensity * k) * dt
+//       + volatility * sqrt(dt) * Z + J
+//
+// with Z standard normal and J the sum of a Poisson(jump_intensity * dt)
+// number of Normal(jump_mean, jump_std^2) log jumps. k = E[e^J] - 1 for
+// one jump, so E[S(t)] = s0 * e^(drift * t).
+//
+// The output is column-major: one column per time, holding that time's
+// price on every path, with column 0 all s0. That is how a frame of paths
+// is laid out, and it lets the kernel step 16 paths at once. Paths are
+// split into chunks of _path_chunk_ that run on a WorkStealingPool. Each
+// chunk is stepped through all the times with its log prices kept in a
+// small buffer, so the random numbers never go through memory.
+//
+// The normals come from _box_muller_() in ParallelRandGen.h, the kernel
+// par_gen_normal_dist() uses. It and the e^x here are branch-free, so the
+// loops over the 16 paths of a block vectorize. An AVX2 build of the
+// kernel is picked at run time, as in DataFrameSIMDKernels.h. Each random
+// number is a function of (seed, step, path), so for a given seed the
+// paths are bit-identical whatever the thread count. The AVX2 and scalar
+// builds can differ in the last bits, where FMA rounds differently.
+//
+template<typename T>
+struct  PathGenParams  {
+
+    T               s0 { 100 };
+    T               drift { 0 };            // Per unit of time
+    T               volatility { T(0.2) };  // Per sqrt unit of time
+    T               dt { T(1) / T(252) };   // Time per step
+    T               jump_intensity { 0 };   // Jumps per unit of time
+    T               jump_mean { 0 };        // Of the log of a jump
+    T               jump_std { 0 };
+    unsigned int    seed { (unsigned int) -1 };
+};
+
+// ----------------------------------------------------------------------------
+
+// Paths stepped together, one Philox block's words
+//
+inline constexpr std::size_t    _path_block_ { 2 * _philox_width_ };
+
+// Paths a thread takes through all the steps before moving on
+//
+inline constexpr std::size_t    _path_chunk_ { 1024 };
+
+// jump_intensity * dt past which the jump count table gets too long
+//
+inline constexpr double _path_max_jump_rate_ { 64 };
+
+// 1 / k! for k in [0, 13], for e^r with |r| <= ln(2) / 2
+//
+inline constexpr double _mc_exp_coeffs_[14] =  {
+    1.0, 1.0, 1.0 / 2, 1.0 / 6, 1.0 / 24, 1.0 / 120, 1.0 / 720,
+    1.0 / 5040, 1.0 / 40320, 1.0 / 362880, 1.0 / 3628800,
+    1.0 / 39916800, 1.0 / 479001600, 1.0 / 6227020800
+};
+
+// What the kernel needs about a run, worked out once
+//
+struct  _PathConsts_  {
+
+    PhiloxKey           key;
+    double              s0;
+    double              step_drift;
+    double              step_vol;
+    double              jump_mean;
+    double              jump_std;
+    std::vector<double> jump_cdf;   // P(N <= n) while under 1 - 2^-53
+};
+
+// e^x, as 2^k * e^r with r = x - k * ln(2). Saturates outside
+// [-708, 709].
+//
+[[gnu::always_inline]] inline double _mc_exp_(double x) noexcept  {
+
+    const double        kr = x * std::numbers::log2e + _rand_round_magic_;
+    const double        k = kr - _rand_round_magic_;
+    const double        r = x - k * _simd_ln2_hi_ - k * _simd_ln2_lo_;
+    std::int64_t        ki =
+        std::bit_cast<std::int64_t>(kr) -
+        std::bit_cast<std::int64_t>(_rand_round_magic_);
+
+    ki = ki < -1022 ? -1022 : ki;
+    ki = ki > 1023 ? 1023 : ki;
+
+    return (_rand_poly_(r, _mc_exp_coeffs_) *
+            std::bit_cast<double>(std::uint64_t(ki + 1023) << 52));
+}
+
+// The 16 normals of Philox counters [first_ctr, first_ctr + 8) on stream.
+// Counter k gives normals 2k and 2k + 1, as in _par_fill_normal_().
+//
+[[gnu::always_inline]] inline void
+_mc_normals_(std::uint64_t first_ctr,
+             std::uint64_t stream,
+             const PhiloxKey &key,
+             double *z) noexcept  {
+
+    std::uint64_t   bits[_path_block_];
+
+    _philox_block_(first_ctr, stream, key, bits);
+    _box_muller_(bits, z);
+}
+
+// Paths [begin, end) of every column. begin is on a chunk boundary. Step t
+// draws its normals from Philox stream 3t + 1, and with jumps its jump
+// counts and sizes from streams 3t + 2 and 3t + 3. Path p is word p of
+// each stream.
+//
+template<typename T, bool JUMPS>
+[[gnu::always_inline]] inline void
+_mc_paths_body_(T *const *columns,
+                std::size_t steps,
+                std::size_t begin,
+                std::size_t end,
+                const _PathConsts_ &pc) noexcept  {
+
+    // Copied out of pc, as the stores to the columns could alias it
+    //
+    constexpr std::size_t   B { _path_block_ };
+    const double            s0 = pc.s0;
+    const double            step_drift = pc.step_drift;
+    const double            step_vol = pc.step_vol;
+    const double            jump_mean = pc.jump_mean;
+    const double            jump_std = pc.jump_std;
+    alignas(64) double      x[_path_chunk_];
+
+    for (std::size_t cbegin = begin; cbegin < end; cbegin += _path_chunk_)  {
+        const std::size_t   cend = std::min(end, cbegin + _path_chunk_);
+
+        std::fill(x, x + _path_chunk_, 0.0);
+        std::fill(columns[0] + cbegin, columns[0] + cend, T(s0));
+        for (std::size_t t = 0; t < steps; ++t)  {
+            T   *col = columns[t + 1];
+
+            for (std::size_t blk = cbegin; blk < cend; blk += B)  {
+                double  *xb = x + (blk - cbegin);
+                double  z[B];
+
+                _mc_normals_(blk / 2, 3 * t + 1, pc.key, z);
+                for (std::size_t j = 0; j < B; ++j)
+                    xb[j] += step_drift + step_vol * z[j];
+
+                if constexpr (JUMPS)  {
+                    std::uint64_t   bits[B];
+                    double          u[B], count[B] = { }, jz[B];
+
+                    _philox_block_(blk / 2, 3 * t + 2, pc.key, bits);
+                    _mc_normals_(blk / 2, 3 * t + 3, pc.key, jz);
+                    for (std::size_t j = 0; j < B; ++j)
+                        u[j] = _bits_to_unit_(bits[j]);
+                    for (const double cdf : pc.jump_cdf)
+                        for (std::size_t j = 0; j < B; ++j)
+                            count[j] +=
+                                std::isgreaterequal(u[j], cdf) ? 1.0 : 0.0;
+                    for (std::size_t j = 0; j < B; ++j)
+                        xb[j] += count[j] * jump_mean +
+                                 _rand_sqrt_(count[j]) * jump_std * jz[j];
+                }
+
+                if (cend - blk >= B)
+                    for (std::size_t j = 0; j < B; ++j)
+                        col[blk + j] = T(s0 * _mc_exp_(xb[j]));
+                else
+                    for (std::size_t j = 0; j < cend - blk; ++j)
+                        col[blk + j] = T(s0 * _mc_exp_(xb[j]));
+            }
+        }
+    }
+}
+
+template<typename T, bool JUMPS>
+inline void
+_mc_paths_scalar_(T *const *columns,
+                  std::size_t steps,
+                  std::size_t begin,
+                  std::size_t end,
+                  const _PathConsts_ &pc) noexcept  {
+
+    _mc_paths_body_<T, JUMPS>(columns, steps, begin, end, pc);
+}
+
+#ifdef HMDF_SIMD_X86
+template<typename T, bool JUMPS>
+HMDF_TARGET_AVX2 void
+_mc_paths_avx2_(T *const *columns,
+                std::size_t steps,
+                std::size_t begin,
+                std::size_t end,
+                const _PathConsts_ &pc) noexcept  {
+
+    _mc_paths_body_<T, JUMPS>(columns, steps, begin, end, pc);
+}
+#endif // HMDF_SIMD_X86
+
+template<typename T>
+inline _PathConsts_ _mc_consts_(const PathGenParams<T> &params)  {
+
+    const double    vol = double(params.volatility);
+    const double    dt = double(params.dt);
+    const double    rate = double(params.jump_intensity) * dt;
+    const double    jm = double(params.jump_mean);
+    const double    js = double(params.jump_std);
+
+    if (! (dt > 0) || ! (vol >= 0) || ! (rate >= 0) || ! (js >= 0))
+        throw NotFeasible("gen_price_paths(): dt must be positive, and "
+                          "volatility, jump_intensity and jump_std "
+                          "not negative");
+    if (rate > _path_max_jump_rate_)
+        throw NotFeasible("gen_price_paths(): jump_intensity * dt is too "
+                          "large. Use a smaller dt");
+
+    const double    k = rate > 0 ? std::expm1(jm + 0.5 * js * js) : 0.0;
+    _PathConsts_    result {
+        _philox_key_(params.seed),
+        double(params.s0),
+        (double(params.drift) - 0.5 * vol * vol -
+         double(params.jump_intensity) * k) * dt,
+        vol * std::sqrt(dt),
+        jm,
+        js,
+        { }
+    };
+
+    if (rate > 0)  {
+        double  p = std::exp(-rate);
+        double  cdf = p;
+
+        while (cdf < 1.0 - 0x1p-53 && result.jump_cdf.size() < 1024)  {
+            result.jump_cdf.push_back(cdf);
+            p *= rate / double(result.jump_cdf.size());
+            cdf += p;
+        }
+    }
+    return (result);
+}
+
+// ----------------------------------------------------------------------------
+
+// Fills columns[t][p], the price of path p at step t, for t in
+// [0, columns.size()) and p in [0, paths). Each column must hold paths
+// values.
+//
+template<typename T>
+inline void
+gen_price_paths(const std::vector<T *> &columns,
+                std::size_t paths,
+                const PathGenParams<T> &params = { },
+                WorkStealingPool &pool = default_thread_pool())  {
+
+    static_assert(std::is_floating_point_v<T>,
+                  "gen_price_paths() needs a floating point type");
+
+    HMDF_INSTRUMENT_OP(scope, "gen_price_paths");
+
+    if (columns.empty())  return;
+
+    const _PathConsts_  pc = _mc_consts_(params);
+    const std::size_t   steps = columns.size() - 1;
+    const bool          jumps = ! pc.jump_cdf.empty();
+    auto                kernel = jumps ? &_mc_paths_scalar_<T, true>
+                                       : &_mc_paths_scalar_<T, false>;
+
+#ifdef HMDF_SIMD_X86
+    if (simd_level() >= SIMDLevel::avx2)
+        kernel = jumps ? &_mc_paths_avx2_<T, true>
+                       : &_mc_paths_avx2_<T, false>;
+#endif // HMDF_SIMD_X86
+
+    pool.run_chunks((paths + _path_chunk_ - 1) / _path_chunk_,
+                    [&](std::size_t c)  {
+                        kernel(columns.data(), steps,
+                               c * _path_chunk_,
+                               std::min(paths, (c + 1) * _path_chunk_), pc);
+                    });
+    scope.add_rows(paths * columns.size());
+    scope.add_bytes(paths * columns.size() * sizeof(T));
+}
+
+// The same into one buffer of (steps + 1) * paths values, step t's column
+// at out + t * paths
+//
+template<typename T>
+inline void
+gen_price_paths(T *out,
+                std::size_t paths,
+                std::size_t steps,
+                const PathGenParams<T> &params = { },
+                WorkStealingPool &pool = default_thread_pool())  {
+
+    std::vector<T *>    columns (steps + 1);
+
+    for (std::size_t t = 0; t <= steps; ++t)
+        columns[t] = out + t * paths;
+    gen_price_paths(columns, paths, params, pool);
+}
+
+template<typename T>
+[[nodiscard]] inline std::vector<T>
+gen_price_paths(std::size_t paths,
+                std::size_t steps,
+                const PathGenParams<T> &params = { },
+                WorkStealingPool &pool = default_thread_pool())  {
+
+    std::vector<T>  result ((steps + 1) * paths);
+
+    gen_price_paths(result.data(), paths, steps, params, pool);
+    return (result);
+}
+
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <DataFrame/Utils/ThreadPool.h>
+
+#include <algorithm>
+#include <cstddef>
+
+namespace hmdf
+{
+
+// Runs func(begin, end) over [0, n) on pool, once per chunk of chunk_size
+// elements. Only the last chunk can be partial. The calling thread takes
+// part, as in WorkStealingPool::run_chunks().
+//
+// Where each chunk starts does not depend on the pool's size, so work that
+// is a function of the chunk comes out the same however many workers the
+// pool has.
+//
+template<typename F>
+inline void
+parallel_for_chunks(std::size_t n,
+                    std::size_t chunk_size,
+                    WorkStealingPool &pool,
+                    F &&func)  {
+
+    const std::size_t   chunks = (n + chunk_size - 1) / chunk_size;
+
+    if (chunks <= 1)  {
+        func(std::size_t(0), n);
+        return;
+    }
+
+    pool.run_chunks(chunks, [n, chunk_size, &func](std::size_t c)  {
+        func(c * chunk_size, std::min(n, (c + 1) * chunk_size));
+    });
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,762 @@
+#pragma once
+
+#include <DataFrame/DataFrameSIMDKernels.h>
+#include <DataFrame/RandGen.h>
+#include <DataFrame/Utils/ParallelFor.h>
+#include <DataFrame/Utils/ThreadPool.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numbers>
+#include <random>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace hmdf
+{
+
+// Counter-based random generation for Monte Carlo sized fills.
+//
+// Every sample is a pure function of (seed, sample position), computed with
+// the Philox4x32-10 block function (Salmon et al., "Parallel Random Numbers:
+// As Easy as 1, 2, 3", SC11). So the output can be split across any number
+// of threads, and for a given RandGenParams::seed the result is bit-identical
+// whatever WorkStealingPool it runs on. The pool is default_thread_pool()
+// unless one is given.
+//
+// The uniform, normal and Bernoulli families map each sample straight to a
+// Philox output. Philox blocks are generated _philox_width_ at a time in
+// structure-of-arrays form, so the rounds compile to SIMD multiplies.
+// Normals are Box-Muller with a branch-free log, sqrt, sin and cos, which
+// vectorize too. They can differ from the std functions in the last bits.
+// Binomial and negative binomial samples need a varying number of random
+// words each. They are drawn from a PhiloxEngine stream per fixed-size chunk
+// of the output, and the chunk grid does not depend on the thread count
+// either.
+//
+// As in RandGen.h, a seed of (unsigned int) -1 means "seed from
+// std::random_device", which is not reproducible.
+
+using PhiloxKey = std::array<std::uint32_t, 2>;
+
+// ----------------------------------------------------------------------------
+
+inline constexpr std::size_t _philox_width_ { 8 };
+
+// Samples per work unit. Output positions are handed to threads in whole
+// chunks, and binomial-type samples use one random stream per chunk.
+//
+inline constexpr std::size_t _rand_chunk_size_ { 1 << 16 };
+
+// Computes Philox4x32-10 for the counters
+// { first_ctr + w, stream } for w in [0, _philox_width_) and stores each
+// 128 bit result as two 64 bit words in bits[2 * w] and bits[2 * w + 1].
+//
+inline void
+_philox_block_(std::uint64_t first_ctr,
+               std::uint64_t stream,
+               const PhiloxKey &key,
+               std::uint64_t *bits) noexcept {
+
+    constexpr std::uint32_t M0 { 0xD2511F53 };
+    constexpr std::uint32_t M1 { 0xCD9E8D57 };
+    constexpr std::uint32_t W0 { 0x9E3779B9 };
+    constexpr std::uint32_t W1 { 0xBB67AE85 };
+    constexpr std::size_t   W { _philox_width_ };
+
+    std::uint32_t   c0[W], c1[W], c2[W], c3[W];
+
+    for (std::size_t w = 0; w < W; ++w) {
+        const std::uint64_t ctr = first_ctr + w;
+
+        c0[w] = static_cast<std::uint32_t>(ctr);
+        c1[w] = static_cast<std::uint32_t>(ctr >> 32);
+        c2[w] = static_cast<std::uint32_t>(stream);
+        c3[w] = static_cast<std::uint32_t>(stream >> 32);
+    }
+
+    std::uint32_t   k0 = key[0];
+    std::uint32_t   k1 = key[1];
+
+    for (int round = 0; round < 10; ++round) {
+        for (std::size_t w = 0; w < W; ++w) {
+            const std::uint64_t p0 = std::uint64_t(M0) * c0[w];
+            const std::uint64_t p1 = std::uint64_t(M1) * c2[w];
+            const std::uint32_t n0 =
+                static_cast<std::uint32_t>(p1 >> 32) ^ c1[w] ^ k0;
+            const std::uint32_t n2 =
+                static_cast<std::uint32_t>(p0 >> 32) ^ c3[w] ^ k1;
+
+            c1[w] = static_cast<std::uint32_t>(p1);
+            c3[w] = static_cast<std::uint32_t>(p0);
+            c0[w] = n0;
+            c2[w] = n2;
+        }
+        k0 += W0;
+        k1 += W1;
+    }
+
+    for (std::size_t w = 0; w < W; ++w) {
+        bits[2 * w] = (std::uint64_t(c1[w]) << 32) | c0[w];
+        bits[2 * w + 1] = (std::uint64_t(c3[w]) << 32) | c2[w];
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+// A UniformRandomBitGenerator over one Philox stream, for feeding the
+// std distributions
+//
+class   PhiloxEngine  {
+
+public:
+
+    using result_type = std::uint32_t;
+
+    PhiloxEngine(const PhiloxKey &key, std::uint64_t stream) noexcept
+        : key_(key), stream_(stream)  {   }
+
+    static constexpr result_type min() noexcept  { return (0); }
+    static constexpr result_type
+    max() noexcept  { return (std::numeric_limits<result_type>::max()); }
+
+    inline result_type operator() () noexcept  {
+
+        if (pos_ == buffer_.size() * 2)  {
+            _philox_block_(ctr_, stream_, key_, buffer_.data());
+            ctr_ += _philox_width_;
+            pos_ = 0;
+        }
+
+        const std::uint64_t word = buffer_[pos_ >> 1];
+        const result_type   result =
+            static_cast<result_type>(word >> ((pos_ & 1) * 32));
+
+        pos_ += 1;
+        return (result);
+    }
+
+private:
+
+    using buffer_type = std::array<std::uint64_t, 2 * _philox_width_>;
+
+    PhiloxKey       key_;
+    std::uint64_t   stream_;
+    std::uint64_t   ctr_ { 0 };
+    buffer_type     buffer_ { };
+    std::size_t     pos_ { 4 * _philox_width_ };  // In 32 bit words
+};
+
+// ----------------------------------------------------------------------------
+
+inline PhiloxKey _philox_key_(unsigned int seed)  {
+
+    if (seed == (unsigned int) -1)  {
+        std::random_device  rd;
+
+        return (PhiloxKey { rd(), rd() });
+    }
+    return (PhiloxKey { seed, 0x5EED5EED });
+}
+
+// Calls xform(bits) for every sample position in [begin, end), where bits
+// is the 64 bit Philox word owned by that position, and stores the result
+// at out[pos - begin].
+//
+template<typename T, typename F>
+inline void
+_philox_transform_(T *out,
+                   std::size_t begin,
+                   std::size_t end,
+                   const PhiloxKey &key,
+                   F &&xform)  {
+
+    constexpr std::size_t   per_block { 2 * _philox_width_ };
+    std::uint64_t           bits[per_block];
+
+    for (std::size_t blk = begin / per_block * per_block;
+         blk < end;
+         blk += per_block)  {
+        _philox_block_(blk / 2, 0, key, bits);
+
+        const std::size_t   first = std::max(begin, blk);
+        const std::size_t   last = std::min(end, blk + per_block);
+
+        for (std::size_t i = first; i < last; ++i)
+            out[i - begin] = xform(bits[i - blk]);
+    }
+}
+
+// Maps a 64 bit word to [0, 1), as (bits >> 11) * 2^-53. The top 52 bits
+// go through the mantissa of a double in [1, 2) and the 53rd is added
+// exactly, so there is no integer to double conversion, which keeps vector
+// loops out.
+//
+[[gnu::always_inline]] inline double
+_bits_to_unit_(std::uint64_t bits) noexcept  {
+
+    return ((std::bit_cast<double>((bits >> 12) | 0x3FF0000000000000UL) -
+             1.0) +
+            std::bit_cast<double>((0 - ((bits >> 11) & 1)) &
+                                  0x3CA0000000000000UL));
+}
+
+// Maps a 64 bit word to (0, 1], as ((bits >> 11) + 1) * 2^-53
+//
+[[gnu::always_inline]] inline double
+_bits_to_open_unit_(std::uint64_t bits) noexcept  {
+
+    return (_bits_to_unit_(bits) + 0x1.0p-53);
+}
+
+// ----------------------------------------------------------------------------
+
+// Branch-free math for the normal kernels, so the loops calling it
+// vectorize. std::log, std::sqrt, std::sin and std::cos are calls, and
+// may set errno.
+
+// Taylor terms of sin(a) / a - 1 in a^2 and (cos(a) - 1) / a^2 in a^2,
+// for |a| <= pi / 4
+//
+inline constexpr double _rand_sin_coeffs_[8] =  {
+    -1.0 / 6, 1.0 / 120, -1.0 / 5040, 1.0 / 362880, -1.0 / 39916800,
+    1.0 / 6227020800, -1.0 / 1307674368000, 1.0 / 355687428096000
+};
+inline constexpr double _rand_cos_coeffs_[9] =  {
+    -1.0 / 2, 1.0 / 24, -1.0 / 720, 1.0 / 40320, -1.0 / 3628800,
+    1.0 / 479001600, -1.0 / 87178291200, 1.0 / 20922789888000,
+    -1.0 / 6402373705728000
+};
+
+// Adding and subtracting it rounds a double under 2^51 in size to an
+// integer, which then sits in the low bits of the sum
+//
+inline constexpr double _rand_round_magic_ { 0x1.8p52 };
+
+// c[0] + c[1] * x + ... + c[N - 1] * x^(N - 1), unrolled so the loops
+// calling it vectorize
+//
+template<std::size_t N>
+[[gnu::always_inline]] inline double
+_rand_poly_(double x, const double (&c)[N]) noexcept  {
+
+    double  result = c[N - 1];
+
+    [&]<std::size_t ... K>(std::index_sequence<K ...>)  {
+        ((result = result * x + c[N - 2 - K]), ...);
+    }(std::make_index_sequence<N - 1> { });
+    return (result);
+}
+
+// sqrt(x) for x in [0, 2^64), as x / sqrt(x) from Newton steps on
+// 1 / sqrt(x). 0 gives 0.
+//
+[[gnu::always_inline]] inline double _rand_sqrt_(double x) noexcept  {
+
+    double  inv = std::bit_cast<double>(
+        0x5FE6EB50C7B537A9UL - (std::bit_cast<std::uint64_t>(x) >> 1));
+
+    inv *= 1.5 - 0.5 * x * inv * inv;
+    inv *= 1.5 - 0.5 * x * inv * inv;
+    inv *= 1.5 - 0.5 * x * inv * inv;
+    inv *= 1.5 - 0.5 * x * inv * inv;
+    return (x * inv);
+}
+
+// log(x) for a positive normal x. x = m * 2^e with m in [sqrt(2) / 2,
+// sqrt(2)), and log(m) = 2 * atanh(s) with s = (m - 1) / (m + 1). Adding
+// 1 - sqrt(2) / 2 to x's bits carries into the exponent exactly when its
+// mantissa is past sqrt(2), which splits x without a compare.
+//
+[[gnu::always_inline]] inline double _rand_log_(double x) noexcept  {
+
+    constexpr std::uint64_t half_sqrt2 { 0x3FE6A09E667F3BCDUL };
+    const std::uint64_t     bits =
+        std::bit_cast<std::uint64_t>(x) + (0x3FF0000000000000UL - half_sqrt2);
+    const double            e =
+        std::bit_cast<double>((bits >> 52) | 0x4330000000000000UL) -
+        (0x1p52 + 1023.0);
+    const double            m =
+        std::bit_cast<double>((bits & 0x000FFFFFFFFFFFFFUL) + half_sqrt2);
+    const double            s = (m - 1.0) / (m + 1.0);
+
+    return (2.0 * s * _rand_poly_(s * s, _simd_log_coeffs_) +
+            e * _simd_ln2_hi_ + e * _simd_ln2_lo_);
+}
+
+// sin and cos of 2 * pi * v for v in [0, 1). The angle is taken to
+// [-pi / 4, pi / 4] from the nearest quarter turn q, then turned by q.
+//
+[[gnu::always_inline]] inline void
+_rand_sincos_2pi_(double v, double &sin_v, double &cos_v) noexcept  {
+
+    const double    r = v * 4.0;
+    const double    q = (r + _rand_round_magic_) - _rand_round_magic_;
+    const double    a = (r - q) * (std::numbers::pi / 2.0);
+    const double    a2 = a * a;
+    const double    s = a + a * a2 * _rand_poly_(a2, _rand_sin_coeffs_);
+    const double    c = 1.0 + a2 * _rand_poly_(a2, _rand_cos_coeffs_);
+
+    const bool      odd = (q == 1.0) | (q == 3.0);
+    const double    sin_a = odd ? c : s;
+    const double    cos_a = odd ? s : c;
+
+    sin_v = (q == 2.0) | (q == 3.0) ? -sin_a : sin_a;
+    cos_v = (q == 1.0) | (q == 2.0) ? -cos_a : cos_a;
+}
+
+// Box-Muller over the 2 * _philox_width_ words of one Philox block. Words
+// 2k and 2k + 1, the two halves of counter k, give normals 2k and 2k + 1.
+//
+[[gnu::always_inline]] inline void
+_box_muller_(const std::uint64_t *bits, double *z) noexcept  {
+
+    for (std::size_t w = 0; w < 2 * _philox_width_; w += 2)  {
+        const double    radius =
+            _rand_sqrt_(-2.0 * _rand_log_(_bits_to_open_unit_(bits[w])));
+        double          sin_v, cos_v;
+
+        _rand_sincos_2pi_(_bits_to_unit_(bits[w + 1]), sin_v, cos_v);
+        z[w] = radius * cos_v;
+        z[w + 1] = radius * sin_v;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+inline void
+_par_fill_uniform_int_(T *out,
+                       std::size_t begin,
+                       std::size_t end,
+                       const PhiloxKey &key,
+                       const RandGenParams<T> &params)  {
+
+    static_assert(std::is_integral_v<T>,
+                  "_par_fill_uniform_int_() needs an integral type");
+
+    // Number of values in [min_value, max_value], 0 meaning 2^64. Lemire's
+    // multiply-shift maps a word into it. Its bias is at most range / 2^64.
+    //
+    const std::uint64_t range =
+        std::uint64_t(params.max_value) - std::uint64_t(params.min_value) + 1;
+
+    _philox_transform_(out, begin, end, key,
+                       [&params, range](std::uint64_t bits) -> T  {
+                           const std::uint64_t off = range == 0
+                               ? bits
+                               : std::uint64_t(
+                                     (__uint128_t(bits) * range) >> 64);
+
+                           return (T(std::uint64_t(params.min_value) + off));
+                       });
+}
+
+template<typename T>
+inline void
+_par_fill_uniform_real_(T *out,
+                        std::size_t begin,
+                        std::size_t end,
+                        const PhiloxKey &key,
+                        const RandGenParams<T> &params)  {
+
+    static_assert(std::is_floating_point_v<T>,
+                  "_par_fill_uniform_real_() needs a floating point type");
+
+    const double    min_v = double(params.min_value);
+    const double    width = double(params.max_value) - min_v;
+
+    _philox_transform_(out, begin, end, key,
+                       [min_v, width](std::uint64_t bits) -> T  {
+                           return (T(min_v + _bits_to_unit_(bits) * width));
+                       });
+}
+
+// Positions 2k and 2k + 1 share Philox counter k
+//
+template<typename T>
+inline void
+_par_fill_normal_(T *out,
+                  std::size_t begin,
+                  std::size_t end,
+                  const PhiloxKey &key,
+                  const RandGenParams<T> &params)  {
+
+    constexpr std::size_t   per_block { 2 * _philox_width_ };
+    std::uint64_t           bits[per_block];
+    double                  normals[per_block];
+
+    for (std::size_t blk = begin / per_block * per_block;
+         blk < end;
+         blk += per_block)  {
+        _philox_block_(blk / 2, 0, key, bits);
+        _box_muller_(bits, normals);
+
+        const std::size_t   first = std::max(begin, blk);
+        const std::size_t   last = std::min(end, blk + per_block);
+
+        for (std::size_t i = first; i < last; ++i)
+            out[i - begin] = T(params.mean + params.std * normals[i - blk]);
+    }
+}
+
+// Samples a std distribution from one PhiloxEngine stream per chunk. If
+// begin is inside a chunk, the samples of that chunk before it are drawn
+// and dropped.
+//
+template<typename T, typename D>
+inline void
+_par_fill_chunked_(T *out,
+                   std::size_t begin,
+                   std::size_t end,
+                   const PhiloxKey &key,
+                   const D &proto_dist)  {
+
+    for (std::size_t cbegin = begin; cbegin < end; )  {
+        const std::size_t   chunk = cbegin / _rand_chunk_size_;
+        const std::size_t   cend =
+            std::min(end, (chunk + 1) * _rand_chunk_size_);
+        PhiloxEngine        engine (key, chunk + 1);
+        D                   dist = proto_dist;
+
+        for (std::size_t i = chunk * _rand_chunk_size_; i < cbegin; ++i)
+            (void) dist(engine);
+        for (std::size_t i = cbegin; i < cend; ++i)
+            out[i - begin] = dist(engine);
+        cbegin = cend;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+// Calls func(begin, end) over the sample positions [first, first + n), in
+// whole chunks of the chunk grid, which is what _par_fill_chunked_() wants.
+// If first is inside a chunk, the rest of that chunk is done first, on the
+// calling thread.
+//
+template<typename F>
+inline void
+_par_for_positions_(std::size_t first,
+                    std::size_t n,
+                    WorkStealingPool &pool,
+                    F &&func)  {
+
+    const std::size_t   head =
+        std::min(n, (_rand_chunk_size_ - first % _rand_chunk_size_) %
+                        _rand_chunk_size_);
+
+    if (head > 0)  func(first, first + head);
+    parallel_for_chunks(n - head, _rand_chunk_size_, pool,
+                        [&func, first = first + head]
+                        (std::size_t begin, std::size_t end)  {
+                            func(first + begin, first + end);
+                        });
+}
+
+// Anything with data() and size() over contiguous T, like std::vector,
+// VectorView, std::span or a DataFrame column
+//
+template<typename V>
+concept _rand_fill_target_ = requires(V &v)  {
+    { v.data() } ->
+        std::convertible_to<typename std::remove_cvref_t<V>::value_type *>;
+    { v.size() } -> std::convertible_to<std::size_t>;
+};
+
+template<typename V>
+using _rand_fill_params_ =
+    RandGenParams<typename std::remove_cvref_t<V>::value_type>;
+
+// Fill in place. par_fill_X_dist(out, n, params) writes out[0, n) with the
+// values par_gen_X_dist(n, params) would return, without allocating. The
+// overloads taking a container fill all of it. They take a std::vector, a
+// VectorView or a frame's column:
+//
+//   par_fill_normal_dist(df.get_column<double>("noise"), params);
+//
+// Sample position first + i goes to out[i]. So a column can be generated
+// in pieces, each par_fill_X_dist(piece, m, params, pool, first)
+// with first the number of samples before it, and come out the same as in
+// one call. That needs a fixed seed. A seed of (unsigned int) -1 draws a
+// new key on every call.
+//
+template<typename T>
+inline void
+par_fill_uniform_int_dist(T *out,
+                          std::size_t n,
+                          const RandGenParams<T> &params = { },
+                          WorkStealingPool &pool = default_thread_pool(),
+                          std::size_t first = 0)  {
+
+    const PhiloxKey key = _philox_key_(params.seed);
+
+    parallel_for_chunks(n, _rand_chunk_size_, pool,
+                        [&](std::size_t begin, std::size_t end)  {
+                            _par_fill_uniform_int_(out + begin,
+                                                   first + begin,
+                                                   first + end,
+                                                   key, params);
+                        });
+}
+
+template<typename T>
+inline void
+par_fill_uniform_real_dist(T *out,
+                           std::size_t n,
+                           const RandGenParams<T> &params = { },
+                           WorkStealingPool &pool = default_thread_pool(),
+                           std::size_t first = 0)  {
+
+    const PhiloxKey key = _philox_key_(params.seed);
+
+    parallel_for_chunks(n, _rand_chunk_size_, pool,
+                        [&](std::size_t begin, std::size_t end)  {
+                            _par_fill_uniform_real_(out + begin,
+                                                    first + begin,
+                                                    first + end,
+                                                    key, params);
+                        });
+}
+
+template<typename T>
+inline void
+par_fill_normal_dist(T *out,
+                     std::size_t n,
+                     const RandGenParams<T> &params = { },
+                     WorkStealingPool &pool = default_thread_pool(),
+                     std::size_t first = 0)  {
+
+    const PhiloxKey key = _philox_key_(params.seed);
+
+    parallel_for_chunks(n, _rand_chunk_size_, pool,
+                        [&](std::size_t begin, std::size_t end)  {
+                            _par_fill_normal_(out + begin,
+                                              first + begin,
+                                              first + end,
+                                              key, params);
+                        });
+}
+
+// out is an iterator to bool, like a bool * or a std::vector<bool>
+// iterator. A std::vector<bool> iterator must be at a multiple of the
+// vector's word size from its begin(), so threads never share a word.
+//
+template<typename I>
+inline void
+par_fill_bernouilli_dist(I out,
+                         std::size_t n,
+                         const RandGenParams<bool> &params = { },
+                         WorkStealingPool &pool = default_thread_pool(),
+                         std::size_t first = 0)  {
+
+    const PhiloxKey key = _philox_key_(params.seed);
+    const double    prob = params.prob_true;
+
+    const auto      fill = [&](std::size_t begin, std::size_t end)  {
+        constexpr std::size_t   blk_sz { 2 * _philox_width_ };
+        std::uint64_t           bits[blk_sz];
+
+        begin += first;
+        end += first;
+        for (std::size_t blk = begin / blk_sz * blk_sz;
+             blk < end;
+             blk += blk_sz)  {
+            _philox_block_(blk / 2, 0, key, bits);
+            for (std::size_t i = std::max(begin, blk);
+                 i < std::min(end, blk + blk_sz);
+                 ++i)
+                out[i - first] = _bits_to_unit_(bits[i - blk]) < prob;
+        }
+    };
+
+    parallel_for_chunks(n, _rand_chunk_size_, pool, fill);
+}
+
+template<typename T>
+inline void
+par_fill_binominal_dist(T *out,
+                        std::size_t n,
+                        const RandGenParams<T> &params = { },
+                        WorkStealingPool &pool = default_thread_pool(),
+                        std::size_t first = 0)  {
+
+    const PhiloxKey                     key = _philox_key_(params.seed);
+    const std::binomial_distribution<T> dist (T(params.t_dist),
+                                              params.prob_true);
+
+    _par_for_positions_(first, n, pool,
+                        [&](std::size_t begin, std::size_t end)  {
+                            _par_fill_chunked_(out + (begin - first),
+                                               begin, end, key, dist);
+                        });
+}
+
+template<typename T>
+inline void
+par_fill_negative_binominal_dist(T *out,
+                                 std::size_t n,
+                                 const RandGenParams<T> &params = { },
+                                 WorkStealingPool &pool = default_thread_pool(),
+                                 std::size_t first = 0)  {
+
+    const PhiloxKey                             key = _philox_key_(params.seed);
+    const std::negative_binomial_distribution<T> dist (T(params.t_dist),
+                                                       params.prob_true);
+
+    _par_for_positions_(first, n, pool,
+                        [&](std::size_t begin, std::size_t end)  {
+                            _par_fill_chunked_(out + (begin - first),
+                                               begin, end, key, dist);
+                        });
+}
+
+template<_rand_fill_target_ V>
+inline void
+par_fill_uniform_int_dist(V &&out,
+                          const _rand_fill_params_<V> &params = { },
+                          WorkStealingPool &pool = default_thread_pool(),
+                          std::size_t first = 0)  {
+
+    par_fill_uniform_int_dist(out.data(), std::size_t(out.size()), params,
+                              pool, first);
+}
+
+template<_rand_fill_target_ V>
+inline void
+par_fill_uniform_real_dist(V &&out,
+                           const _rand_fill_params_<V> &params = { },
+                           WorkStealingPool &pool = default_thread_pool(),
+                           std::size_t first = 0)  {
+
+    par_fill_uniform_real_dist(out.data(), std::size_t(out.size()), params,
+                               pool, first);
+}
+
+template<_rand_fill_target_ V>
+inline void
+par_fill_normal_dist(V &&out,
+                     const _rand_fill_params_<V> &params = { },
+                     WorkStealingPool &pool = default_thread_pool(),
+                     std::size_t first = 0)  {
+
+    par_fill_normal_dist(out.data(), std::size_t(out.size()), params,
+                         pool, first);
+}
+
+inline void
+par_fill_bernouilli_dist(std::vector<bool> &out,
+                         const RandGenParams<bool> &params = { },
+                         WorkStealingPool &pool = default_thread_pool(),
+                         std::size_t first = 0)  {
+
+    par_fill_bernouilli_dist(out.begin(), out.size(), params,
+                             pool, first);
+}
+
+template<_rand_fill_target_ V>
+inline void
+par_fill_binominal_dist(V &&out,
+                        const _rand_fill_params_<V> &params = { },
+                        WorkStealingPool &pool = default_thread_pool(),
+                        std::size_t first = 0)  {
+
+    par_fill_binominal_dist(out.data(), std::size_t(out.size()), params,
+                            pool, first);
+}
+
+template<_rand_fill_target_ V>
+inline void
+par_fill_negative_binominal_dist(V &&out,
+                                 const _rand_fill_params_<V> &params = { },
+                                 WorkStealingPool &pool = default_thread_pool(),
+                                 std::size_t first = 0)  {
+
+    par_fill_negative_binominal_dist(out.data(), std::size_t(out.size()),
+                                     params, pool, first);
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+inline std::vector<T>
+par_gen_uniform_int_dist(std::size_t n,
+                         const RandGenParams<T> &params = { },
+                         WorkStealingPool &pool = default_thread_pool())  {
+
+    std::vector<T>  result (n);
+
+    par_fill_uniform_int_dist(result.data(), n, params, pool);
+    return (result);
+}
+
+template<typename T>
+inline std::vector<T>
+par_gen_uniform_real_dist(std::size_t n,
+                          const RandGenParams<T> &params = { },
+                          WorkStealingPool &pool = default_thread_pool())  {
+
+    std::vector<T>  result (n);
+
+    par_fill_uniform_real_dist(result.data(), n, params, pool);
+    return (result);
+}
+
+template<typename T>
+inline std::vector<T>
+par_gen_normal_dist(std::size_t n,
+                    const RandGenParams<T> &params = { },
+                    WorkStealingPool &pool = default_thread_pool())  {
+
+    std::vector<T>  result (n);
+
+    par_fill_normal_dist(result.data(), n, params, pool);
+    return (result);
+}
+
+// Chunks are a multiple of the vector<bool> word size, so threads never
+// share a word
+//
+inline std::vector<bool>
+par_gen_bernouilli_dist(std::size_t n,
+                        const RandGenParams<bool> &params = { },
+                        WorkStealingPool &pool = default_thread_pool())  {
+
+    std::vector<bool>   result (n);
+
+    par_fill_bernouilli_dist(result, params, pool);
+    return (result);
+}
+
+template<typename T>
+inline std::vector<T>
+par_gen_binominal_dist(std::size_t n,
+                       const RandGenParams<T> &params = { },
+                       WorkStealingPool &pool = default_thread_pool())  {
+
+    std::vector<T>  result (n);
+
+    par_fill_binominal_dist(result.data(), n, params, pool);
+    return (result);
+}
+
+template<typename T>
+inline std::vector<T>
+par_gen_negative_binominal_dist(std::size_t n,
+                                const RandGenParams<T> &params = { },
+                                WorkStealingPool &pool =
+                                    default_thread_pool())  {
+
+    std::vector<T>  result (n);
+
+    par_fill_negative_binominal_dist(result.data(), n, params, pool);
+    return (result);
+}
+
+}
@@ -0,0 +1,390 @@
+#pragma once
+
+#include <DataFrame/DataFrame.h>
+#include <DataFrame/Utils/Instrumentation.h>
+#include <DataFrame/Utils/ThreadPool.h>
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace hmdf
+{
+
+// Visiting columns on all cores.
+//
+// parallel_visit() splits the rows into chunks that fit in L2, runs a copy
+// of the visitor over each chunk on a WorkStealingPool and merges the
+// copies, in row order, into the visitor:
+//
+//   visitor.pre();
+//   each chunk: copy(idx_begin, idx_end, col_begin, col_end);
+//   merge the copies, then visitor.post();
+//
+// A visitor opts in by having merge(const V &rhs), which folds in the
+// state of the chunk that comes right after its own. Visitors without
+// merge() depend on seeing all the rows in order, so they are run serially
+// on the calling thread, the same as visit().
+//
+// The rows visited are those the index and the column both have.
+//
+template<typename V>
+concept mergeable_visitor =
+    std::copyable<V> && requires(V lhs, const V &rhs)  { lhs.merge(rhs); };
+
+// Runs a mergeable visitor over blocks of rows one after the other, as
+// the frames that keep their rows in pieces do. for_each_block(visit_block)
+// calls visit_block(idx_begin, idx_end, col_begin, col_end) for each block
+// in row order. Each block goes through a copy of the visitor, reset to
+// its state after pre(), which is then merged into visitor.
+//
+template<mergeable_visitor V, typename F>
+inline void _visit_blocks_(V &visitor, F &&for_each_block)  {
+
+    visitor.pre();
+
+    V       part = visitor;
+    const V empty = part;
+
+    for_each_block([&visitor, &part, &empty](const auto &idx_begin,
+                                             const auto &idx_end,
+                                             const auto &col_begin,
+                                             const auto &col_end)  {
+        part = empty;
+        part(idx_begin, idx_end, col_begin, col_end);
+        visitor.merge(part);
+    });
+    visitor.post();
+}
+
+// Bytes of column data a chunk covers by default
+//
+inline constexpr std::size_t    _visit_chunk_bytes_ { 1 << 18 };
+
+template<typename V, typename F>
+inline void
+_parallel_chunks_(V &visitor,
+                  std::size_t rows,
+                  std::size_t chunk_rows,
+                  WorkStealingPool &pool,
+                  const F &visit_rows)  {
+
+    const std::size_t   chunks = (rows + chunk_rows - 1) / chunk_rows;
+
+    visitor.pre();
+    if constexpr (mergeable_visitor<V>)  {
+        if (chunks > 1 && pool.thread_count() > 0)  {
+            std::vector<V>  partials (chunks, visitor);
+
+            pool.run_chunks(chunks,
+                            [&partials, &visit_rows, rows, chunk_rows]
+                            (std::size_t c)  {
+                                visit_rows(partials[c],
+                                           c * chunk_rows,
+                                           std::min(rows,
+                                                    (c + 1) * chunk_rows));
+                            });
+            for (std::size_t c = 1; c < chunks; ++c)
+                partials[0].merge(partials[c]);
+            visitor = std::move(partials[0]);
+            visitor.post();
+            return;
+        }
+    }
+    visit_rows(visitor, 0, rows);
+    visitor.post();
+}
+
+// Visits column name of type T. chunk_rows of 0 picks an L2-sized chunk.
+//
+template<typename T, typename DF, typename V>
+inline V &
+parallel_visit(const DF &df,
+               const char *name,
+               V &visitor,
+               WorkStealingPool &pool = default_thread_pool(),
+               std::size_t chunk_rows = 0)  {
+
+    using I = typename DF::IndexType;
+
+    HMDF_INSTRUMENT_OP(scope, "parallel_visit");
+
+    const auto          &idx = df.get_index();
+    const auto          &col = df.template get_column<T>(name);
+    const std::size_t   rows = std::min(idx.size(), col.size());
+
+    scope.add_rows(rows);
+
+    if (chunk_rows == 0)
+        chunk_rows = std::max<std::size_t>(
+            _visit_chunk_bytes_ / (sizeof(I) + sizeof(T)), 1024);
+    _parallel_chunks_(visitor, rows, chunk_rows, pool,
+                      [&idx, &col](V &v, std::size_t begin, std::size_t end)  {
+                          v(idx.begin() + begin, idx.begin() + end,
+                            col.begin() + begin, col.begin() + end);
+                      });
+    return (visitor);
+}
+
+// Visits columns name1 and name2 together, as visit<T1, T2>() does
+//
+template<typename T1, typename T2, typename DF, typename V>
+inline V &
+parallel_visit(const DF &df,
+               const char *name1,
+               const char *name2,
+               V &visitor,
+               WorkStealingPool &pool = default_thread_pool(),
+               std::size_t chunk_rows = 0)  {
+
+    using I = typename DF::IndexType;
+
+    HMDF_INSTRUMENT_OP(scope, "parallel_visit");
+
+    const auto          &idx = df.get_index();
+    const auto          &col1 = df.template get_column<T1>(name1);
+    const auto          &col2 = df.template get_column<T2>(name2);
+    const std::size_t   rows =
+        std::min({ idx.size(), col1.size(), col2.size() });
+
+    scope.add_rows(rows);
+
+    if (chunk_rows == 0)
+        chunk_rows = std::max<std::size_t>(
+            _visit_chunk_bytes_ / (sizeof(I) + sizeof(T1) + sizeof(T2)),
+            1024);
+    _parallel_chunks_(visitor, rows, chunk_rows, pool,
+                      [&idx, &col1, &col2]
+                      (V &v, std::size_t begin, std::size_t end)  {
+                          v(idx.begin() + begin, idx.begin() + end,
+                            col1.begin() + begin, col1.begin() + end,
+                            col2.begin() + begin, col2.begin() + end);
+                      });
+    return (visitor);
+}
+
+// ----------------------------------------------------------------------------
+
+// Count, mean, variance (n - 1), min and max in one pass. Partial results
+// merge with Chan's formula, so it gives the same answer in parallel.
+//
+template<typename T, typename I = unsigned long>
+class   MergeableStatsVisitor  {
+
+public:
+
+    using value_type = T;
+    using index_type = I;
+    using result_type = T;
+    using size_type = std::size_t;
+
+    explicit MergeableStatsVisitor(bool skipnan = true)
+        : skipnan_(skipnan)  {   }
+
+    template<typename K, typename H>
+    inline void
+    operator() (const K &, const K &, const H &col_begin, const H &col_end)  {
+
+        // In locals, since the column could alias the members as far as the
+        // compiler knows
+        //
+        size_type   count = count_;
+        T           mean = mean_;
+        T           m2 = m2_;
+        T           min_v = min_;
+        T           max_v = max_;
+
+        for (auto iter = col_begin; iter != col_end; ++iter)  {
+            const T value = *iter;
+
+            if (skipnan_ && std::isnan(value))  continue;
+
+            const T delta = value - mean;
+
+            count += 1;
+            mean += delta / T(count);
+            m2 += delta * (value - mean);
+            if (count == 1 || value < min_v)  min_v = value;
+            if (count == 1 || value > max_v)  max_v = value;
+        }
+        count_ = count;
+        mean_ = mean;
+        m2_ = m2;
+        min_ = min_v;
+        max_ = max_v;
+    }
+
+    inline void merge(const MergeableStatsVisitor &rhs)  {
+
+        if (rhs.count_ == 0)  return;
+        if (count_ == 0)  {
+            *this = rhs;
+            return;
+        }
+
+        const T n_l = T(count_);
+        const T n_r = T(rhs.count_);
+        const T delta = rhs.mean_ - mean_;
+
+        count_ += rhs.count_;
+        mean_ += delta * n_r / T(count_);
+        m2_ += rhs.m2_ + delta * delta * n_l * n_r / T(count_);
+        min_ = std::min(min_, rhs.min_);
+        max_ = std::max(max_, rhs.max_);
+    }
+
+    inline void pre()  {
+
+        count_ = 0;
+        mean_ = 0;
+        m2_ = 0;
+    }
+    inline void post()  {   }
+
+    [[nodiscard]] inline result_type
+    get_result() const  { return (get_mean()); }
+
+    [[nodiscard]] inline size_type
+    get_count() const noexcept  { return (count_); }
+    [[nodiscard]] inline T get_mean() const noexcept  {
+
+        return (count_ > 0 ? mean_ : std::numeric_limits<T>::quiet_NaN());
+    }
+    [[nodiscard]] inline T get_variance() const noexcept  {
+
+        return (count_ > 1 ? m2_ / T(count_ - 1)
+                           : std::numeric_limits<T>::quiet_NaN());
+    }
+    [[nodiscard]] inline T
+    get_std() const noexcept  { return (std::sqrt(get_variance())); }
+    [[nodiscard]] inline T get_min() const noexcept  {
+
+        return (count_ > 0 ? min_ : std::numeric_limits<T>::quiet_NaN());
+    }
+    [[nodiscard]] inline T get_max() const noexcept  {
+
+        return (count_ > 0 ? max_ : std::numeric_limits<T>::quiet_NaN());
+    }
+
+private:
+
+    size_type   count_ { 0 };
+    T           mean_ { 0 };
+    T           m2_ { 0 };
+    T           min_ { 0 };
+    T           max_ { 0 };
+    bool        skipnan_;
+};
+
+// ----------------------------------------------------------------------------
+
+// Pearson correlation and covariance (n - 1) of two columns. Rows where
+// either is NaN are skipped if skipnan.
+//
+template<typename T, typename I = unsigned long>
+class   MergeableCorrVisitor  {
+
+public:
+
+    using value_type = T;
+    using index_type = I;
+    using result_type = T;
+    using size_type = std::size_t;
+
+    explicit MergeableCorrVisitor(bool skipnan = true)
+        : skipnan_(skipnan)  {   }
+
+    template<typename K, typename H>
+    inline void
+    operator() (const K &, const K &,
+                const H &col1_begin, const H &col1_end,
+                const H &col2_begin, const H &)  {
+
+        size_type   count = count_;
+        T           mean_x = mean_x_;
+        T           mean_y = mean_y_;
+        T           m2_x = m2_x_;
+        T           m2_y = m2_y_;
+        T           c_xy = c_xy_;
+        auto        iter2 = col2_begin;
+
+        for (auto iter1 = col1_begin; iter1 != col1_end; ++iter1, ++iter2)  {
+            const T x = *iter1;
+            const T y = *iter2;
+
+            if (skipnan_ && (std::isnan(x) || std::isnan(y)))  continue;
+
+            const T delta_x = x - mean_x;
+            const T delta_y = y - mean_y;
+
+            count += 1;
+            mean_x += delta_x / T(count);
+            mean_y += delta_y / T(count);
+            m2_x += delta_x * (x - mean_x);
+            m2_y += delta_y * (y - mean_y);
+            c_xy += delta_x * (y - mean_y);
+        }
+        count_ = count;
+        mean_x_ = mean_x;
+        mean_y_ = mean_y;
+        m2_x_ = m2_x;
+        m2_y_ = m2_y;
+        c_xy_ = c_xy;
+    }
+
+    inline void merge(const MergeableCorrVisitor &rhs)  {
+
+        if (rhs.count_ == 0)  return;
+        if (count_ == 0)  {
+            *this = rhs;
+            return;
+        }
+
+        const T n_l = T(count_);
+        const T n_r = T(rhs.count_);
+        const T delta_x = rhs.mean_x_ - mean_x_;
+        const T delta_y = rhs.mean_y_ - mean_y_;
+
+        count_ += rhs.count_;
+
+        const T weight = n_l * n_r / T(count_);
+
+        mean_x_ += delta_x * n_r / T(count_);
+        mean_y_ += delta_y * n_r / T(count_);
+        m2_x_ += rhs.m2_x_ + delta_x * delta_x * weight;
+        m2_y_ += rhs.m2_y_ + delta_y * delta_y * weight;
+        c_xy_ += rhs.c_xy_ + delta_x * delta_y * weight;
+    }
+
+    inline void pre()  { *this = MergeableCorrVisitor(skipnan_); }
+    inline void post()  {   }
+
+    [[nodiscard]] inline result_type get_result() const noexcept  {
+
+        return (count_ > 1 ? c_xy_ / std::sqrt(m2_x_ * m2_y_)
+                           : std::numeric_limits<T>::quiet_NaN());
+    }
+
+    [[nodiscard]] inline size_type
+    get_count() const noexcept  { return (count_); }
+    [[nodiscard]] inline T get_covariance() const noexcept  {
+
+        return (count_ > 1 ? c_xy_ / T(count_ - 1)
+                           : std::numeric_limits<T>::quiet_NaN());
+    }
+
+private:
+
+    size_type   count_ { 0 };
+    T           mean_x_ { 0 };
+    T           mean_y_ { 0 };
+    T           m2_x_ { 0 };
+    T           m2_y_ { 0 };
+    T           c_xy_ { 0 };
+    bool        skipnan_;
+};
+
+}
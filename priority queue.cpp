@@ -1,48 +1,165 @@
-#pragma once 
+#pragma once
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
 #include <functional>
 #include <iterator>
+#include <limits>
+#include <mutex>
+#include <span>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
-namespace hmdf 
+namespace hmdf
 {
 
+// A bounded priority queue that retains the N "largest" items (according
+// to Cmp) it has been offered.
+//
+// The items are kept in a min-max heap. The root is the weakest retained
+// item, which is the admission threshold once the queue is full, so
+// replacing it costs O(log N). The strongest item sits on one of the
+// root's children, so top() and pop() keep their usual semantics.
+//
 template <typename T, std::size_t N, typename Cmp = std::less<T>>
 class FixedSizePriorityQueue {
 
+    static_assert(N > 0, "FixedSizePriorityQueue needs a non-zero size");
+
     using container_type = std::array<T, N>;
     using iterator = typename container_type::iterator;
     using const_iterator = typename container_type::const_iterator;
 
 public:
-    
+
     using value_type = T;
     using compare_type = Cmp;
-    using size_type = std::size_t,;
+    using size_type = std::size_t;
+
+    // Number of items push_batch() screens against the threshold at once
+    //
+    static constexpr size_type batch_block { 64 };
+
+    FixedSizePriorityQueue() = default;
+    FixedSizePriorityQueue(const FixedSizePriorityQueue &that)
+        : array_(that.array_), data_end_(array_.begin() + that.size()),
+          cmp_(that.cmp_)  {   }
+    FixedSizePriorityQueue(FixedSizePriorityQueue &&that)
+        : array_(std::move(that.array_)),
+          data_end_(array_.begin() + that.size()),
+          cmp_(std::move(that.cmp_))  {   }
+    FixedSizePriorityQueue &operator = (const FixedSizePriorityQueue &rhs) {
+
+        if (this != &rhs) {
+            array_ = rhs.array_;
+            data_end_ = array_.begin() + rhs.size();
+            cmp_ = rhs.cmp_;
+        }
+        return (*this);
+    }
+    FixedSizePriorityQueue &operator = (FixedSizePriorityQueue &&rhs) {
+
+        if (this != &rhs) {
+            array_ = std::move(rhs.array_);
+            data_end_ = array_.begin() + rhs.size();
+            cmp_ = std::move(rhs.cmp_);
+        }
+        return (*this);
+    }
+    ~FixedSizePriorityQueue() = default;
 
     void push(value_type &&item) {
 
         if (data_end_ != array_.end()) {
             *data_end_++ = std::move(item);
-            std::push_heap(array_.begin(), data_end_, cmp_);
+            sift_up_(size() - 1);
         }
-        else {
-            std:sort_heap(array_.begin(), array_.end(), cmp_);
-            if (cmp_(array_.front(), item))
-                array_[0] = std::move(item);
-            std::make_heap(array_.begin(), array_.end(), cmp_);
+        else if (cmp_(array_.front(), item)) {
+            array_.front() = std::move(item);
+            trickle_down_(0);
+        }
+    }
+    void push(const value_type &item) {
+
+        if (data_end_ != array_.end()) {
+            *data_end_++ = item;
+            sift_up_(size() - 1);
+        }
+        else if (cmp_(array_.front(), item)) {
+            array_.front() = item;
+            trickle_down_(0);
+        }
+    }
+
+    // Offers all items in the span. Once the queue is full, items are
+    // screened in blocks against the current threshold with a branch-free
+    // loop, so blocks that hold no candidate are skipped without touching
+    // the heap. For arithmetic types and the std comparators the screening
+    // loop is auto-vectorized.
+    //
+    void push_batch(std::span<const value_type> items) {
+
+        size_type   i { 0 };
+        const auto  sz = items.size();
+
+        for (; i < sz && data_end_ != array_.end(); ++i)
+            push(items[i]);
+
+        while (i < sz) {
+            const size_type     blk_end = std::min(i + batch_block, sz);
+            const value_type    thresh = array_.front();
+            bool                any_hit { false };
+
+            for (size_type j = i; j < blk_end; ++j)
+                any_hit |= cmp_(thresh, items[j]);
+
+            if (any_hit) {
+                for (; i < blk_end; ++i)
+                    if (cmp_(array_.front(), items[i])) {
+                        array_.front() = items[i];
+                        trickle_down_(0);
+                    }
+            }
+            i = blk_end;
         }
     }
 
+    // Offers every item retained by that
+    //
+    void merge(const FixedSizePriorityQueue &that) {
+
+        push_batch(std::span<const value_type>(
+                       that.array_.data(), that.size()));
+    }
+
+    // The strongest retained item
+    //
     [[nodiscard]] inline const value_type
-    &top() const noexcept { return (array_.front()); }
+    &top() const noexcept { return (array_[max_pos_()]); }
     inline void pop() {
 
-        if (! empty())
-            std::pop_heap(array_.begin(), data_end_--, cmp_);
+        if (! empty()) {
+            const size_type pos = max_pos_();
+
+            --data_end_;
+            if (pos != size()) {
+                array_[pos] = std::move(*data_end_);
+                trickle_down_(pos);
+            }
+        }
+    }
+
+    // The weakest retained item. Once the queue is full, an item must
+    // compare greater than this to be admitted.
+    //
+    [[nodiscard]] inline const value_type
+    &threshold() const noexcept { return (array_.front()); }
+    [[nodiscard]] inline bool full() const noexcept {
+
+        return (data_end_ == array_.end());
     }
 
     [[nodiscard]] inline size_type size() const noexcept {
@@ -51,25 +168,362 @@ public:
                               static_cast<const_iterator>(data_end_)));
     }
     [[nodiscard]] inline bool empty() const noexcept { return (size() == 0); }
+    [[nodiscard]] static constexpr size_type
+    capacity() noexcept { return (N); }
 
     inline void clear() { data_end_ = array_.begin(); }
 
+    // Retained items sorted ascending by Cmp
+    //
     [[nodiscard]] inline std::vector<value_type> data() const {
 
-        std::vector<value_type> result;
+        std::vector<value_type> result (array_.begin(),
+                                        static_cast<const_iterator>(data_end_));
 
-        result.reserve(size());
-        for (auto citer = array_.begin(); citer < data_end_; ++citer)
-            result.push_back(*citer);
-        std::sort_heap(result.begin(), result.end(), cmp_);
+        std::sort(result.begin(), result.end(), cmp_);
         return (result);
     }
 
+    // Same as above, but writes into the caller's buffer without
+    // allocating. It returns the number of items written, which is
+    // min(size(), out.size()). If the buffer is short, the strongest
+    // items are the ones written.
+    //
+    size_type data(std::span<value_type> out) const {
+
+        const size_type sz = size();
+        const size_type n = std::min(sz, out.size());
+
+        if (n == sz) {
+            std::copy(array_.begin(),
+                      static_cast<const_iterator>(data_end_),
+                      out.begin());
+            std::sort(out.begin(), out.begin() + n, cmp_);
+        }
+        else {
+            std::partial_sort_copy(array_.begin(),
+                                   static_cast<const_iterator>(data_end_),
+                                   out.begin(), out.begin() + n,
+                                   [this](const value_type &lhs,
+                                          const value_type &rhs) -> bool {
+                                       return (cmp_(rhs, lhs));
+                                   });
+            std::reverse(out.begin(), out.begin() + n);
+        }
+        return (n);
+    }
+
 private:
 
+    // Even levels of the min-max heap hold minimums, odd levels maximums
+    //
+    static inline bool is_min_level_(size_type pos) noexcept {
+
+        return ((std::bit_width(pos + 1) & 1) == 1);
+    }
+
+    inline size_type max_pos_() const noexcept {
+
+        const size_type sz = size();
+
+        if (sz < 3)  return (sz == 2 ? 1 : 0);
+        return (cmp_(array_[1], array_[2]) ? 2 : 1);
+    }
+
+    template<bool IS_MIN>
+    inline bool before_(const value_type &lhs,
+                        const value_type &rhs) const noexcept {
+
+        if constexpr (IS_MIN)  return (cmp_(lhs, rhs));
+        else  return (cmp_(rhs, lhs));
+    }
+
+    template<bool IS_MIN>
+    void bubble_up_(size_type pos) {
+
+        while (pos > 2) {
+            const size_type grand = (((pos - 1) >> 1) - 1) >> 1;
+
+            if (! before_<IS_MIN>(array_[pos], array_[grand]))  break;
+            std::swap(array_[pos], array_[grand]);
+            pos = grand;
+        }
+    }
+
+    void sift_up_(size_type pos) {
+
+        if (pos == 0)  return;
+
+        const size_type parent = (pos - 1) >> 1;
+
+        if (is_min_level_(pos)) {
+            if (cmp_(array_[parent], array_[pos])) {
+                std::swap(array_[pos], array_[parent]);
+                bubble_up_<false>(parent);
+            }
+            else
+                bubble_up_<true>(pos);
+        }
+        else {
+            if (cmp_(array_[pos], array_[parent])) {
+                std::swap(array_[pos], array_[parent]);
+                bubble_up_<true>(parent);
+            }
+            else
+                bubble_up_<false>(pos);
+        }
+    }
+
+    template<bool IS_MIN>
+    void trickle_down_impl_(size_type pos) {
+
+        const size_type sz = size();
+
+        while (true) {
+            const size_type child = (pos << 1) + 1;
+
+            if (child >= sz)  break;
+
+            // Find the most extreme among children and grandchildren
+            //
+            size_type       best = child;
+            const size_type last = std::min((child << 1) + 4, sz - 1);
+
+            if (child + 1 < sz && before_<IS_MIN>(array_[child + 1],
+                                                  array_[best]))
+                best = child + 1;
+            for (size_type g = (child << 1) + 1; g <= last; ++g)
+                if (before_<IS_MIN>(array_[g], array_[best]))
+                    best = g;
+
+            if (! before_<IS_MIN>(array_[best], array_[pos]))  break;
+            std::swap(array_[best], array_[pos]);
+            if (best <= child + 1)  break;  // It was a direct child
+
+            const size_type parent = (best - 1) >> 1;
+
+            if (before_<IS_MIN>(array_[parent], array_[best]))
+                std::swap(array_[best], array_[parent]);
+            pos = best;
+        }
+    }
+
+    inline void trickle_down_(size_type pos) {
+
+        if (is_min_level_(pos))
+            trickle_down_impl_<true>(pos);
+        else
+            trickle_down_impl_<false>(pos);
+    }
+
     container_type array_ { };
-    iterator data_end {array_.begin() };
+    iterator data_end_ { array_.begin() };
     compare_type cmp_ { };
 };
 
+// ----------------------------------------------------------------------------
+
+// The lowest or highest value arithmetic T has, whichever Cmp puts first
+//
+template <typename T, typename Cmp>
+[[nodiscard]] inline T _top_k_floor_() {
+
+    static_assert(std::numeric_limits<T>::is_specialized,
+                  "ShardedTopK needs a floor for this type");
+
+    using limits = std::numeric_limits<T>;
+
+    const T lo = limits::has_infinity ? -limits::infinity() : limits::lowest();
+    const T hi = limits::has_infinity ? limits::infinity() : limits::max();
+
+    return (Cmp { }(hi, lo) ? hi : lo);
+}
+
+// ----------------------------------------------------------------------------
+
+// Top-K over many producer threads without a shared lock.
+//
+// Each thread owns a Shard, a FixedSizePriorityQueue of its own that it
+// pushes to without synchronization. A full shard's threshold is a lower
+// bound for the global top-K: the shard alone holds N items above it. The
+// shards publish the highest such bound in one atomic, and every shard
+// drops items at or below it before touching its queue, so a shard that
+// sees few large items still discards at the rate of the busiest one.
+//
+// merge() combines the shards into the global top-K. It must not run
+// concurrently with pushes.
+//
+// T must be trivially copyable, since the threshold is published in a
+// std::atomic<T>. The atomic starts at floor, a value no item is below by
+// Cmp, so publishing is a CAS loop and nothing else. For arithmetic T the
+// floor defaults to _top_k_floor_(). Other types must give one.
+//
+template <typename T, std::size_t N, typename Cmp = std::less<T>>
+class ShardedTopK {
+
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "ShardedTopK publishes its threshold in a std::atomic<T>");
+
+public:
+
+    using value_type = T;
+    using compare_type = Cmp;
+    using size_type = std::size_t;
+    using queue_type = FixedSizePriorityQueue<T, N, Cmp>;
+
+    // One producer's queue. Shards sit on their own cache lines.
+    //
+    class alignas(64) Shard {
+
+    public:
+
+        void push(const value_type &item) {
+
+            if (owner_->discards_(item))  return;
+            queue_.push(item);
+            publish_();
+        }
+
+        // Blocks of items that are all below the published threshold are
+        // skipped before the queue's own screening
+        //
+        void push_batch(std::span<const value_type> items) {
+
+            const size_type block = queue_type::batch_block;
+
+            for (size_type i = 0; i < items.size(); i += block) {
+                const auto  chunk =
+                    items.subspan(i, std::min(block, items.size() - i));
+
+                if (owner_->discards_all_(chunk))  continue;
+                queue_.push_batch(chunk);
+                publish_();
+            }
+        }
+
+        [[nodiscard]] const queue_type &
+        queue() const noexcept { return (queue_); }
+
+    private:
+
+        friend class ShardedTopK;
+
+        // Publishes this shard's threshold when it has risen
+        //
+        inline void publish_() {
+
+            if (queue_.full() &&
+                (! published_ || cmp_(last_published_, queue_.threshold()))) {
+                last_published_ = queue_.threshold();
+                published_ = true;
+                owner_->raise_threshold_(last_published_);
+            }
+        }
+
+        ShardedTopK     *owner_ { nullptr };
+        queue_type      queue_ { };
+        value_type      last_published_ { };
+        bool            published_ { false };
+        compare_type    cmp_ { };
+    };
+
+    explicit ShardedTopK(size_type shard_count,
+                         const value_type &floor = _top_k_floor_<T, Cmp>())
+        : shards_(std::max<size_type>(shard_count, 1)),
+          threshold_(floor),
+          floor_(floor)  {
+
+        for (auto &shard : shards_)  shard.owner_ = this;
+    }
+    ShardedTopK(const ShardedTopK &) = delete;
+    ShardedTopK &operator = (const ShardedTopK &) = delete;
+
+    // The calling thread's shard. Two threads must not share one.
+    //
+    [[nodiscard]] inline Shard &
+    shard(size_type i) noexcept { return (shards_[i]); }
+    [[nodiscard]] inline size_type
+    shard_count() const noexcept { return (shards_.size()); }
+
+    // The published lower bound of the global top-K, if any shard is full
+    //
+    [[nodiscard]] inline bool has_threshold() const noexcept {
+
+        return (has_threshold_.load(std::memory_order_acquire));
+    }
+    [[nodiscard]] inline value_type threshold() const noexcept {
+
+        return (threshold_.load(std::memory_order_relaxed));
+    }
+
+    // The global top-K
+    //
+    [[nodiscard]] queue_type merge() const {
+
+        queue_type  result;
+
+        for (const auto &shard : shards_)
+            result.merge(shard.queue_);
+        return (result);
+    }
+
+    // Retained items sorted ascending by Cmp, same as queue_type::data()
+    //
+    [[nodiscard]] std::vector<value_type>
+    data() const { return (merge().data()); }
+
+    void clear() {
+
+        for (auto &shard : shards_) {
+            shard.queue_.clear();
+            shard.published_ = false;
+        }
+        threshold_.store(floor_, std::memory_order_relaxed);
+        has_threshold_.store(false, std::memory_order_relaxed);
+    }
+
+private:
+
+    inline bool discards_(const value_type &item) const noexcept {
+
+        return (has_threshold_.load(std::memory_order_acquire) &&
+                ! cmp_(threshold_.load(std::memory_order_relaxed), item));
+    }
+
+    inline bool
+    discards_all_(std::span<const value_type> items) const noexcept {
+
+        if (! has_threshold_.load(std::memory_order_acquire))  return (false);
+
+        const value_type    thresh = threshold_.load(std::memory_order_relaxed);
+        bool                any_hit { false };
+
+        for (const auto &item : items)
+            any_hit |= cmp_(thresh, item);
+        return (! any_hit);
+    }
+
+    // Lifts the published threshold to value if that is higher. The flag
+    // is set after the raise, so whoever sees it also sees a threshold at
+    // least that high.
+    //
+    void raise_threshold_(const value_type &value) noexcept {
+
+        value_type  current = threshold_.load(std::memory_order_relaxed);
+
+        while (cmp_(current, value) &&
+               ! threshold_.compare_exchange_weak(current, value,
+                                                  std::memory_order_relaxed))
+            ;
+        if (! has_threshold_.load(std::memory_order_relaxed))
+            has_threshold_.store(true, std::memory_order_release);
+    }
+
+    std::vector<Shard>                  shards_;
+    alignas(64) std::atomic<value_type> threshold_;
+    std::atomic<bool>                   has_threshold_ { false };
+    value_type                          floor_;
+    compare_type                        cmp_ { };
+};
+
 }
\ No newline at end of file
@@ -1,7 +1,13 @@
-#include <DataFame/RandGen.h>
+#include <DataFrame/RandGen.h>
+#include <DataFrame/MonteCarlo.h>
+#include <DataFrame/ParallelRandGen.h>
+#include <DataFrame/Vectors/VectorView.h>
 
 #include <cassert>
+#include <cmath>
 #include <iostream>
+#include <numbers>
+#include <vector>
 
 using namespace hmdf;
 
@@ -46,5 +52,252 @@ int main(int, char *[]) {
         gen_negative_binominal_dist<int>(1024, p);
     }
 
-    <
+    {
+        // Philox4x32-10 known-answer test from Random123
+        //
+        std::uint64_t   bits[2 * _philox_width_];
+
+        _philox_block_(0x85a308d3243f6a88UL, 0x0370734413198a2eUL,
+                       { 0xa4093822, 0x299f31d0 }, bits);
+        assert(bits[0] == 0x94fdccebd16cfe09UL);
+        assert(bits[1] == 0x24126ea15001e420UL);
+    }
+
+    {
+        // Counter-based fills must not depend on the thread count
+        //
+        constexpr std::size_t   n { 1000003 };
+        RandGenParams<long>     p;
+        WorkStealingPool        one_worker (1);
+        WorkStealingPool        three_workers (3);
+
+        p.min_value = -5;
+        p.max_value = 10;
+        p.seed = 23;
+
+        const auto  ints = par_gen_uniform_int_dist<long>(n, p, one_worker);
+
+        assert(ints == par_gen_uniform_int_dist<long>(n, p, three_workers));
+        assert(ints == par_gen_uniform_int_dist<long>(n, p));
+        for (const auto v : ints)
+            assert(v >= -5 && v <= 10);
+
+        RandGenParams<double>   pd;
+
+        pd.min_value = 0;
+        pd.max_value = 2.0;
+        pd.mean = 0;
+        pd.std = 1.0;
+        pd.seed = 23;
+
+        const auto  reals =
+            par_gen_uniform_real_dist<double>(n, pd, one_worker);
+
+        assert(reals ==
+               par_gen_uniform_real_dist<double>(n, pd, three_workers));
+        for (const auto v : reals)
+            assert(v >= 0 && v < 2.0);
+        assert(par_gen_normal_dist<double>(n, pd, one_worker) ==
+               par_gen_normal_dist<double>(n, pd, three_workers));
+
+        RandGenParams<bool> pb;
+
+        pb.seed = 23;
+        assert(par_gen_bernouilli_dist(n, pb, one_worker) ==
+               par_gen_bernouilli_dist(n, pb, three_workers));
+
+        RandGenParams<int>  pi;
+
+        pi.t_dist = 1000;
+        pi.seed = 23;
+        assert(par_gen_binominal_dist<int>(n, pi, one_worker) ==
+               par_gen_binominal_dist<int>(n, pi, three_workers));
+        assert(par_gen_negative_binominal_dist<int>(n, pi, one_worker) ==
+               par_gen_negative_binominal_dist<int>(n, pi, three_workers));
+    }
+
+    {
+        // Price paths must not depend on the thread count, and must match
+        // the recursion done with the std functions
+        //
+        constexpr std::size_t   paths { 5000 };
+        constexpr std::size_t   steps { 12 };
+        PathGenParams<double>   p;
+        WorkStealingPool        one_worker (1);
+        WorkStealingPool        two_workers (2);
+
+        p.s0 = 50;
+        p.drift = 0.05;
+        p.volatility = 0.3;
+        p.dt = 1.0 / 12;
+        p.seed = 23;
+
+        const auto  out = gen_price_paths<double>(paths, steps, p);
+
+        assert(out.size() == (steps + 1) * paths);
+        assert(out == gen_price_paths<double>(paths, steps, p, two_workers));
+
+        std::vector<double>     cols (2 * paths);
+        std::vector<double *>   col_ptrs { cols.data(), cols.data() + paths };
+
+        gen_price_paths(col_ptrs, paths, p, one_worker);
+        for (std::size_t i = 0; i < 2 * paths; ++i)
+            assert(cols[i] == out[i]);
+
+        const PhiloxKey key = _philox_key_(p.seed);
+        const double    step_drift = (p.drift - 0.5 * p.volatility *
+                                                p.volatility) * p.dt;
+        const double    step_vol = p.volatility * std::sqrt(p.dt);
+
+        for (std::size_t path = 0; path < 64; ++path)  {
+            double  x = 0;
+
+            assert(out[path] == p.s0);
+            for (std::size_t t = 0; t < steps; ++t)  {
+                std::uint64_t   bits[2 * _philox_width_];
+
+                _philox_block_(path / 16 * 8, 3 * t + 1, key, bits);
+
+                const std::size_t   w = path % 16 / 2 * 2;
+                const double        u1 = _bits_to_open_unit_(bits[w]);
+                const double        u2 = _bits_to_unit_(bits[w + 1]);
+                const double        radius = std::sqrt(-2.0 * std::log(u1));
+                const double        theta = 2.0 * std::numbers::pi * u2;
+                const double        z = path % 2 ? radius * std::sin(theta)
+                                                 : radius * std::cos(theta);
+
+                x += step_drift + step_vol * z;
+
+                const double    expected = p.s0 * std::exp(x);
+
+                assert(std::fabs(out[(t + 1) * paths + path] - expected) <=
+                       1e-12 * expected);
+            }
+        }
+    }
+
+    {
+        // E[S(T)] = s0 * e^(drift * T), with and without jumps
+        //
+        constexpr std::size_t   paths { 200000 };
+        constexpr std::size_t   steps { 50 };
+        PathGenParams<double>   p;
+
+        p.s0 = 100;
+        p.drift = 0.08;
+        p.volatility = 0.25;
+        p.dt = 1.0 / 50;
+        p.seed = 7;
+
+        for (int jumps = 0; jumps < 2; ++jumps)  {
+            if (jumps)  {
+                p.jump_intensity = 3;
+                p.jump_mean = -0.05;
+                p.jump_std = 0.1;
+            }
+
+            const auto  out = gen_price_paths<double>(paths, steps, p);
+            double      sum { 0 };
+            double      sum2 { 0 };
+
+            for (std::size_t i = steps * paths; i < out.size(); ++i)  {
+                assert(out[i] > 0);
+                sum += out[i];
+                sum2 += out[i] * out[i];
+            }
+
+            const double    mean = sum / paths;
+            const double    std_err =
+                std::sqrt((sum2 / paths - mean * mean) / paths);
+
+            assert(std::fabs(mean - 100 * std::exp(0.08)) < 5 * std_err);
+        }
+
+        // No volatility, no jumps: the path is the drift
+        //
+        p.volatility = 0;
+        p.jump_intensity = 0;
+
+        const auto  flat = gen_price_paths<double>(100, steps, p);
+
+        for (std::size_t t = 0; t <= steps; ++t)
+            for (std::size_t path = 0; path < 100; ++path)
+                assert(std::fabs(flat[t * 100 + path] -
+                                 100 * std::exp(0.08 * t * p.dt)) < 1e-10);
+
+        p.dt = 0;
+        try  {
+            (void) gen_price_paths<double>(100, steps, p);
+            assert(false);
+        }
+        catch (const NotFeasible &)  {  }
+    }
+
+    {
+        // Filling in place gives what the par_gen_*_dist() calls return,
+        // in one go or in pieces
+        //
+        constexpr std::size_t   n { 200003 };
+        RandGenParams<double>   pd;
+        RandGenParams<int>      pi;
+        RandGenParams<bool>     pb;
+        WorkStealingPool        two_workers (2);
+
+        pd.min_value = 0;
+        pd.max_value = 2.0;
+        pd.mean = 1.0;
+        pd.std = 0.5;
+        pd.seed = 41;
+        pi.min_value = -3;
+        pi.max_value = 3;
+        pi.t_dist = 100;
+        pi.seed = 41;
+        pb.seed = 41;
+
+        const auto  normals = par_gen_normal_dist<double>(n, pd);
+        const auto  reals = par_gen_uniform_real_dist<double>(n, pd);
+        const auto  ints = par_gen_uniform_int_dist<int>(n, pi);
+        const auto  binoms = par_gen_binominal_dist<int>(n, pi);
+        const auto  neg_binoms =
+            par_gen_negative_binominal_dist<int>(n, pi);
+        const auto  bools = par_gen_bernouilli_dist(n, pb);
+
+        std::vector<double> dbl_out (n);
+        std::vector<int>    int_out (n);
+        std::vector<bool>   bool_out (n);
+
+        par_fill_normal_dist(dbl_out, pd, two_workers);
+        assert(dbl_out == normals);
+        par_fill_uniform_real_dist(dbl_out, pd, two_workers);
+        assert(dbl_out == reals);
+        par_fill_uniform_int_dist(int_out, pi, two_workers);
+        assert(int_out == ints);
+        par_fill_binominal_dist(int_out, pi, two_workers);
+        assert(int_out == binoms);
+        par_fill_negative_binominal_dist(int_out, pi, two_workers);
+        assert(int_out == neg_binoms);
+        par_fill_bernouilli_dist(bool_out, pb, two_workers);
+        assert(bool_out == bools);
+
+        // In uneven pieces, through views, the binomial ones starting
+        // inside their chunks
+        //
+        const std::size_t   cuts[] = { 0, 7, 65536, 70001, 150000, n };
+
+        for (std::size_t c = 0; c + 1 < std::size(cuts); ++c)  {
+            const std::size_t   first = cuts[c];
+            const std::size_t   m = cuts[c + 1] - first;
+
+            par_fill_normal_dist(
+                VectorView<double>(dbl_out.data() + first,
+                                   dbl_out.data() + first + m),
+                pd, two_workers, first);
+            par_fill_binominal_dist(int_out.data() + first, m, pi,
+                                    two_workers, first);
+        }
+        assert(dbl_out == normals);
+        assert(int_out == binoms);
+    }
+
+    return (0);
 }
\ No newline at end of file
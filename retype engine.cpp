@@ -0,0 +1,232 @@
+#pragma once
+
+#include <DataFrame/DataFrame.h>
+#include <DataFrame/Utils/Instrumentation.h>
+#include <DataFrame/Utils/ParallelFor.h>
+#include <DataFrame/Utils/ThreadPool.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <concepts>
+#include <limits>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace hmdf
+{
+
+// Bulk column conversion for retype_column() sized workloads.
+//
+// retype_column() calls a converter per element, on one thread, and a bad
+// value has to throw. The functions here convert a whole column in chunks
+// spread over threads and report per-row failures in a RetypeErrorMask
+// instead of throwing:
+//
+//   - std::string to arithmetic goes through std::from_chars. It does not
+//     allocate and does not depend on the locale. Leading white space and
+//     a leading '+' are skipped and trailing white space is allowed, like
+//     std::stoi. Anything else left over marks the row invalid.
+//   - Arithmetic to arithmetic is a plain cast loop that the compiler
+//     vectorizes. Values keep static_cast semantics, so int -1 becomes
+//     4294967295 as with retype_column<int, unsigned int>(). Rows whose
+//     value does not fit the new type are flagged out_of_range. A floating
+//     point value that does not fit converts to 0, since the cast itself
+//     would be undefined.
+//
+// Rows that fail to parse hold NaN for floating point targets and T { }
+// otherwise.
+//
+enum class  RetypeError : unsigned char  {
+    none = 0,
+    invalid = 1,
+    out_of_range = 2,
+};
+
+using RetypeErrorMask = std::vector<RetypeError>;
+
+// ----------------------------------------------------------------------------
+
+inline constexpr std::size_t _retype_chunk_size_ { 1 << 16 };
+
+template<typename T>
+inline constexpr T _retype_failed_value_() noexcept  {
+
+    if constexpr (std::numeric_limits<T>::has_quiet_NaN)
+        return (std::numeric_limits<T>::quiet_NaN());
+    else
+        return (T { });
+}
+
+inline bool _is_space_(char c) noexcept  {
+
+    return (c == ' ' || c == '\t' || c == '\n' ||
+            c == '\r' || c == '\f' || c == '\v');
+}
+
+template<typename T>
+inline RetypeError
+_parse_number_(const std::string &str, T &value) noexcept  {
+
+    const char  *first = str.data();
+    const char  *last = first + str.size();
+
+    while (first != last && _is_space_(*first))  ++first;
+    while (last != first && _is_space_(*(last - 1)))  --last;
+    if (first != last && *first == '+')  {
+        ++first;
+        if (first != last && *first == '-')  return (RetypeError::invalid);
+    }
+
+    const auto  [ptr, ec] = std::from_chars(first, last, value);
+
+    if (ec == std::errc::result_out_of_range)
+        return (RetypeError::out_of_range);
+    if (ec != std::errc { } || ptr != last || first == last)
+        return (RetypeError::invalid);
+    return (RetypeError::none);
+}
+
+// [lo, hi) bounds of integral I, exactly represented in floating point R
+//
+template<typename I, typename R>
+inline constexpr R _int_lower_bound_() noexcept  {
+
+    return (R(std::numeric_limits<I>::min()));
+}
+template<typename I, typename R>
+inline constexpr R _int_upper_bound_() noexcept  {
+
+    return (R(std::numeric_limits<I>::max() / 2 + 1) * R(2));
+}
+
+// Whether a numeric cast keeps the value
+//
+template<typename F, typename T>
+inline constexpr bool _fits_(F value) noexcept  {
+
+    if constexpr (std::is_integral_v<F> && std::is_integral_v<T>)
+        return (std::in_range<T>(value));
+    else if constexpr (std::is_floating_point_v<F> && std::is_integral_v<T>)
+        return (value >= _int_lower_bound_<T, F>() &&
+                value < _int_upper_bound_<T, F>());
+    else if constexpr (std::is_floating_point_v<F> &&
+                       std::is_floating_point_v<T>)
+        return (! std::isfinite(value) ||
+                (value >= F(std::numeric_limits<T>::lowest()) &&
+                 value <= F(std::numeric_limits<T>::max())));
+    else  {  // Integral to floating point
+        const T converted = T(value);
+
+        return (converted >= _int_lower_bound_<F, T>() &&
+                converted < _int_upper_bound_<F, T>() &&
+                F(converted) == value);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+// Converts src[0, n) into dst[0, n), recording failures in errors[0, n)
+//
+template<typename F, typename T>
+inline void
+_retype_range_(const F *src,
+               T *dst,
+               RetypeError *errors,
+               std::size_t n) noexcept  {
+
+    if constexpr (std::is_same_v<F, std::string>)  {
+        for (std::size_t i = 0; i < n; ++i)  {
+            T   value;
+
+            errors[i] = _parse_number_(src[i], value);
+            dst[i] = errors[i] == RetypeError::none
+                         ? value : _retype_failed_value_<T>();
+        }
+    }
+    else if constexpr (std::is_floating_point_v<F>)  {
+        for (std::size_t i = 0; i < n; ++i)  {
+            const bool  fits = _fits_<F, T>(src[i]);
+
+            dst[i] = fits ? static_cast<T>(src[i]) : T { };
+            errors[i] = fits ? RetypeError::none : RetypeError::out_of_range;
+        }
+    }
+    else  {
+        for (std::size_t i = 0; i < n; ++i)  {
+            dst[i] = static_cast<T>(src[i]);
+            errors[i] = _fits_<F, T>(src[i])
+                            ? RetypeError::none : RetypeError::out_of_range;
+        }
+    }
+}
+
+// Converts a whole column on pool. errors is resized to the column's length.
+//
+template<typename F, typename T, typename V>
+[[nodiscard]] inline std::vector<T>
+bulk_convert(const V &src,
+             RetypeErrorMask &errors,
+             WorkStealingPool &pool = default_thread_pool())  {
+
+    static_assert(std::is_arithmetic_v<T>,
+                  "bulk_convert() converts to arithmetic types only");
+    static_assert(std::is_arithmetic_v<F> || std::is_same_v<F, std::string>,
+                  "bulk_convert() converts from arithmetic types or "
+                  "std::string only");
+
+    const std::size_t   n = src.size();
+    std::vector<T>      result (n);
+
+    errors.resize(n);
+    parallel_for_chunks(n, _retype_chunk_size_, pool,
+                        [&](std::size_t begin, std::size_t end)  {
+                            _retype_range_(src.data() + begin,
+                                           result.data() + begin,
+                                           errors.data() + begin,
+                                           end - begin);
+                        });
+    return (result);
+}
+
+// Number of rows that failed
+//
+[[nodiscard]] inline std::size_t
+count_errors(const RetypeErrorMask &errors) noexcept  {
+
+    return (std::size_t(std::count_if(errors.begin(), errors.end(),
+                                      [](RetypeError e) -> bool  {
+                                          return (e != RetypeError::none);
+                                      })));
+}
+
+// The bulk counterpart of df.retype_column<F, T>(name). The converted
+// column replaces the old one under the same name. Per-row failures are
+// left in errors. It returns the number of failed rows.
+//
+template<typename F, typename T, typename DF>
+inline std::size_t
+retype_column_bulk(DF &df,
+                   const char *name,
+                   RetypeErrorMask &errors,
+                   WorkStealingPool &pool = default_thread_pool())  {
+
+    HMDF_INSTRUMENT_OP(scope, "retype_column_bulk");
+
+    std::vector<T>  result =
+        bulk_convert<F, T>(df.template get_column<F>(name),
+                           errors,
+                           pool);
+
+    scope.add_rows(result.size());
+    scope.add_bytes(result.size() * sizeof(T));
+
+    df.template remove_column<F>(name);
+    df.load_column(name, std::move(result), nan_policy::dont_pad_with_nans);
+    return (count_errors(errors));
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,1057 @@
+#pragma once
+
+#include <DataFrame/DataFrame.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#  define HMDF_SIMD_X86 1
+#  include <immintrin.h>
+#  define HMDF_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#  define HMDF_TARGET_AVX512 \
+       __attribute__((target("avx2,fma,avx512f,avx512dq")))
+#endif
+
+namespace hmdf
+{
+
+// Vectorized kernels for the heavy financial and transform visitors, with
+// the instruction set picked at run time.
+//
+//   - simd_returns() and simd_log_returns(): in[i] / in[i - 1] - 1 and its
+//     log. Row 0 is NaN.
+//   - simd_rolling_mean() and simd_rolling_var(): the mean and the n - 1
+//     variance of the last window rows.
+//   - simd_ewma(): s = alpha * x + (1 - alpha) * s, from the first value.
+//   - simd_zscore(): (x - mean) / std over the column.
+//
+// Each kernel has an AVX2, an AVX-512 and a scalar path. simd_level() is
+// the best the CPU supports, unless capped with set_simd_level(). Other
+// compilers and CPUs get the scalar path.
+//
+// NaN rows, like the padding load_align_column() writes between summary
+// rows, are treated the way the visitors treat missing data:
+//
+//   - Returns involving a NaN row are NaN.
+//   - The rolling kernels skip NaN rows. A row's result is NaN if its
+//     window has fewer than min_count valid values (window by default, so
+//     a window without NaN gives the usual rolling result).
+//   - EWMA skips NaN rows and repeats the last value on them. Rows before
+//     the first valid value are NaN.
+//   - Z-score takes the mean and std of the valid rows. NaN rows stay NaN.
+//
+// out must be as long as in and must not overlap it.
+//
+// The rolling sums are computed as a prefix scan of the differences
+// x[i] - x[i - window], restarted from an exact sum every block of rows.
+// Values are shifted by one near the block, which keeps the variance from
+// cancelling when the column drifts away from where it started. EWMA is
+// the same kind of scan over the linear recurrence. The vector paths add
+// in a different order than the scalar one, so results can differ in the
+// last few bits.
+//
+enum class  SIMDLevel : unsigned char  {
+    scalar = 0,
+    avx2 = 1,
+    avx512 = 2,
+};
+
+inline SIMDLevel _detect_simd_level_() noexcept  {
+
+#ifdef HMDF_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") &&
+        __builtin_cpu_supports("avx512dq"))
+        return (SIMDLevel::avx512);
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return (SIMDLevel::avx2);
+#endif // HMDF_SIMD_X86
+    return (SIMDLevel::scalar);
+}
+
+inline std::atomic<SIMDLevel> &_simd_level_cap_() noexcept  {
+
+    static std::atomic<SIMDLevel>   cap { SIMDLevel::avx512 };
+
+    return (cap);
+}
+
+// What the CPU supports
+//
+[[nodiscard]] inline SIMDLevel simd_level_supported() noexcept  {
+
+    static const SIMDLevel  level = _detect_simd_level_();
+
+    return (level);
+}
+
+// What the kernels use
+//
+[[nodiscard]] inline SIMDLevel simd_level() noexcept  {
+
+    return (std::min(simd_level_supported(),
+                     _simd_level_cap_().load(std::memory_order_relaxed)));
+}
+
+// Caps the level the kernels use, to compare paths. It cannot go above what
+// the CPU supports.
+//
+inline void set_simd_level(SIMDLevel level) noexcept  {
+
+    _simd_level_cap_().store(level, std::memory_order_relaxed);
+}
+
+// ----------------------------------------------------------------------------
+
+inline constexpr double _simd_nan_ { std::numeric_limits<double>::quiet_NaN() };
+
+// Rows the rolling kernels go through between exact sums
+//
+inline constexpr std::size_t    _simd_resync_block_ { 4096 };
+
+// 1 / (2k + 1), for log(m) = 2 * atanh(s) = 2 * s * sum(s^2k / (2k + 1))
+//
+inline constexpr double _simd_log_coeffs_[11] =  {
+    1.0, 1.0 / 3, 1.0 / 5, 1.0 / 7, 1.0 / 9, 1.0 / 11, 1.0 / 13, 1.0 / 15,
+    1.0 / 17, 1.0 / 19, 1.0 / 21
+};
+inline constexpr double _simd_ln2_hi_ { 6.93147180369123816490e-01 };
+inline constexpr double _simd_ln2_lo_ { 1.90821492927058770002e-10 };
+inline constexpr double _simd_sqrt2_ { 1.41421356237309504880 };
+
+inline void
+_simd_check_sizes_(std::span<const double> in,
+                   std::span<double> out,
+                   const char *name)  {
+
+    if (in.size() != out.size())
+        throw NotFeasible(name);
+}
+
+// The rolling kernels keep s1, s2 and c, the sums of x - shift,
+// (x - shift)^2 and the count of valid rows in the window. shift is moved
+// to a value near the block at each resync.
+//
+struct  _RollingState_  {
+
+    const double    *in;
+    std::size_t     size;
+    double          *mean;
+    double          *var;
+    std::size_t     window;
+    std::size_t     block;
+    double          min_count;
+    double          shift;
+};
+
+inline void _rolling_row_(const _RollingState_ &st,
+                          std::size_t i,
+                          double &s1,
+                          double &s2,
+                          double &c) noexcept  {
+
+    const double    x = st.in[i];
+
+    if (x == x)  {
+        const double    xs = x - st.shift;
+
+        s1 += xs;
+        s2 += xs * xs;
+        c += 1;
+    }
+    if (i >= st.window)  {
+        const double    y = st.in[i - st.window];
+
+        if (y == y)  {
+            const double    ys = y - st.shift;
+
+            s1 -= ys;
+            s2 -= ys * ys;
+            c -= 1;
+        }
+    }
+    if (st.mean)
+        st.mean[i] = c >= st.min_count ? st.shift + s1 / c : _simd_nan_;
+    if (st.var)
+        st.var[i] = c >= st.min_count && c >= 2
+                        ? (s2 - s1 * s1 / c) / (c - 1) : _simd_nan_;
+}
+
+// The exact sums of the window ending at row end - 1, around the first
+// valid value from the start of that window
+//
+inline void _rolling_resync_(_RollingState_ &st,
+                             std::size_t end,
+                             double &s1,
+                             double &s2,
+                             double &c) noexcept  {
+
+    const std::size_t   begin = end > st.window ? end - st.window : 0;
+    const std::size_t   limit = std::min(end + st.block, st.size);
+
+    for (std::size_t i = begin; i < limit; ++i)
+        if (st.in[i] == st.in[i])  {
+            st.shift = st.in[i];
+            break;
+        }
+    s1 = s2 = c = 0;
+    for (std::size_t i = begin; i < end; ++i)
+        if (st.in[i] == st.in[i])  {
+            const double    xs = st.in[i] - st.shift;
+
+            s1 += xs;
+            s2 += xs * xs;
+            c += 1;
+        }
+}
+
+// ----------------------------------------------------------------------------
+
+template<bool LOG>
+inline void _returns_scalar_(const double *in,
+                             double *out,
+                             std::size_t begin,
+                             std::size_t end) noexcept  {
+
+    for (std::size_t i = begin; i < end; ++i)  {
+        const double    ratio = in[i] / in[i - 1];
+
+        out[i] = LOG ? std::log(ratio) : ratio - 1.0;
+    }
+}
+
+inline void _rolling_scalar_(_RollingState_ st) noexcept  {
+
+    double  s1, s2, c;
+
+    for (std::size_t b = 0; b < st.size; b += st.block)  {
+        _rolling_resync_(st, b, s1, s2, c);
+        for (std::size_t i = b; i < std::min(b + st.block, st.size); ++i)
+            _rolling_row_(st, i, s1, s2, c);
+    }
+}
+
+// Returns the EWMA after rows [begin, end), starting from s
+//
+inline double _ewma_scalar_(const double *in,
+                            double *out,
+                            std::size_t begin,
+                            std::size_t end,
+                            double alpha,
+                            double s) noexcept  {
+
+    for (std::size_t i = begin; i < end; ++i)  {
+        if (in[i] == in[i])
+            s = (1.0 - alpha) * s + alpha * in[i];
+        out[i] = s;
+    }
+    return (s);
+}
+
+// Sum and count of the valid rows, then the sum of their squared
+// deviations from mean
+//
+inline void _sum_count_scalar_(const double *in,
+                               std::size_t n,
+                               double &sum,
+                               double &count) noexcept  {
+
+    sum = count = 0;
+    for (std::size_t i = 0; i < n; ++i)
+        if (in[i] == in[i])  {
+            sum += in[i];
+            count += 1;
+        }
+}
+inline double _sum_sq_dev_scalar_(const double *in,
+                                  std::size_t n,
+                                  double mean) noexcept  {
+
+    double  sum { 0 };
+
+    for (std::size_t i = 0; i < n; ++i)
+        if (in[i] == in[i])
+            sum += (in[i] - mean) * (in[i] - mean);
+    return (sum);
+}
+inline void _scale_scalar_(const double *in,
+                           double *out,
+                           std::size_t begin,
+                           std::size_t end,
+                           double mean,
+                           double inv_std) noexcept  {
+
+    for (std::size_t i = begin; i < end; ++i)
+        out[i] = (in[i] - mean) * inv_std;
+}
+
+// ----------------------------------------------------------------------------
+
+#ifdef HMDF_SIMD_X86
+
+// GCC 12 warns about the intrinsics' own _undefined_pd() placeholders
+//
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+// log() of 4 lanes. Lanes that are not positive normal numbers go through
+// std::log().
+//
+HMDF_TARGET_AVX2 inline __m256d _avx2_log_(__m256d x) noexcept  {
+
+    const __m256d   normal =
+        _mm256_and_pd(
+            _mm256_cmp_pd(x, _mm256_set1_pd(
+                                 std::numeric_limits<double>::min()),
+                          _CMP_GE_OQ),
+            _mm256_cmp_pd(x, _mm256_set1_pd(
+                                 std::numeric_limits<double>::max()),
+                          _CMP_LE_OQ));
+
+    if (_mm256_movemask_pd(normal) != 0xF)  {
+        alignas(32) double  lanes[4];
+
+        _mm256_store_pd(lanes, x);
+        for (auto &lane : lanes)  lane = std::log(lane);
+        return (_mm256_load_pd(lanes));
+    }
+
+    // x = m * 2^e with m in [sqrt(2) / 2, sqrt(2))
+    //
+    const __m256i   bits = _mm256_castpd_si256(x);
+    __m256d         e =
+        _mm256_sub_pd(
+            _mm256_castsi256_pd(
+                _mm256_or_si256(_mm256_srli_epi64(bits, 52),
+                                _mm256_set1_epi64x(0x4330000000000000))),
+            _mm256_set1_pd(4503599627370496.0 + 1023.0));
+    __m256d         m =
+        _mm256_castsi256_pd(
+            _mm256_or_si256(
+                _mm256_and_si256(bits,
+                                 _mm256_set1_epi64x(0x000FFFFFFFFFFFFF)),
+                _mm256_set1_epi64x(0x3FF0000000000000)));
+    const __m256d   big =
+        _mm256_cmp_pd(m, _mm256_set1_pd(_simd_sqrt2_), _CMP_GT_OQ);
+
+    m = _mm256_blendv_pd(m, _mm256_mul_pd(m, _mm256_set1_pd(0.5)), big);
+    e = _mm256_add_pd(e, _mm256_and_pd(big, _mm256_set1_pd(1.0)));
+
+    const __m256d   one = _mm256_set1_pd(1.0);
+    const __m256d   s =
+        _mm256_div_pd(_mm256_sub_pd(m, one), _mm256_add_pd(m, one));
+    const __m256d   z = _mm256_mul_pd(s, s);
+    __m256d         p = _mm256_set1_pd(_simd_log_coeffs_[10]);
+
+    for (int k = 9; k >= 0; --k)
+        p = _mm256_fmadd_pd(p, z, _mm256_set1_pd(_simd_log_coeffs_[k]));
+
+    const __m256d   log_m = _mm256_mul_pd(_mm256_add_pd(s, s), p);
+
+    return (_mm256_fmadd_pd(e, _mm256_set1_pd(_simd_ln2_hi_),
+                            _mm256_fmadd_pd(e, _mm256_set1_pd(_simd_ln2_lo_),
+                                            log_m)));
+}
+
+// [a, b, c, d] to [f, a, b, c] and [f, f, a, b]
+//
+HMDF_TARGET_AVX2 inline __m256d
+_avx2_shift1_(__m256d v, __m256d fill) noexcept  {
+
+    return (_mm256_blend_pd(_mm256_permute4x64_pd(v, 0x90), fill, 0x1));
+}
+HMDF_TARGET_AVX2 inline __m256d
+_avx2_shift2_(__m256d v, __m256d fill) noexcept  {
+
+    return (_mm256_permute2f128_pd(fill, v, 0x20));
+}
+
+// Inclusive prefix sum of the lanes, plus carry
+//
+HMDF_TARGET_AVX2 inline __m256d
+_avx2_scan_(__m256d v, __m256d carry) noexcept  {
+
+    const __m256d   zero = _mm256_setzero_pd();
+
+    v = _mm256_add_pd(v, _avx2_shift1_(v, zero));
+    v = _mm256_add_pd(v, _avx2_shift2_(v, zero));
+    return (_mm256_add_pd(v, carry));
+}
+
+HMDF_TARGET_AVX2 inline __m256d _avx2_last_(__m256d v) noexcept  {
+
+    return (_mm256_permute4x64_pd(v, 0xFF));
+}
+
+HMDF_TARGET_AVX2 inline double _avx2_hsum_(__m256d v) noexcept  {
+
+    const __m128d   sum2 = _mm_add_pd(_mm256_castpd256_pd128(v),
+                                      _mm256_extractf128_pd(v, 1));
+
+    return (_mm_cvtsd_f64(_mm_add_sd(sum2, _mm_unpackhi_pd(sum2, sum2))));
+}
+
+template<bool LOG>
+HMDF_TARGET_AVX2 inline void _returns_avx2_(const double *in,
+                                            double *out,
+                                            std::size_t n) noexcept  {
+
+    std::size_t i = 1;
+
+    for (; i + 4 <= n; i += 4)  {
+        const __m256d   ratio = _mm256_div_pd(_mm256_loadu_pd(in + i),
+                                              _mm256_loadu_pd(in + i - 1));
+
+        _mm256_storeu_pd(out + i,
+                         LOG ? _avx2_log_(ratio)
+                             : _mm256_sub_pd(ratio, _mm256_set1_pd(1.0)));
+    }
+    _returns_scalar_<LOG>(in, out, i, n);
+}
+
+HMDF_TARGET_AVX2 inline void
+_rolling_avx2_(_RollingState_ st) noexcept  {
+
+    const __m256d   one = _mm256_set1_pd(1.0);
+    const __m256d   two = _mm256_set1_pd(2.0);
+    const __m256d   nan = _mm256_set1_pd(_simd_nan_);
+    const __m256d   min_count = _mm256_set1_pd(st.min_count);
+    double          s1, s2, c;
+
+    for (std::size_t b = 0; b < st.size; b += st.block)  {
+        const std::size_t   end = std::min(b + st.block, st.size);
+        std::size_t         i = b;
+
+        _rolling_resync_(st, b, s1, s2, c);
+
+        const __m256d   shift = _mm256_set1_pd(st.shift);
+
+        for (; i < std::min(end, st.window); ++i)
+            _rolling_row_(st, i, s1, s2, c);
+
+        __m256d carry1 = _mm256_set1_pd(s1);
+        __m256d carry2 = _mm256_set1_pd(s2);
+        __m256d carryc = _mm256_set1_pd(c);
+
+        for (; i + 4 <= end; i += 4)  {
+            const __m256d   x = _mm256_loadu_pd(st.in + i);
+            const __m256d   y = _mm256_loadu_pd(st.in + i - st.window);
+            const __m256d   x_ok = _mm256_cmp_pd(x, x, _CMP_ORD_Q);
+            const __m256d   y_ok = _mm256_cmp_pd(y, y, _CMP_ORD_Q);
+            const __m256d   xs = _mm256_and_pd(x_ok, _mm256_sub_pd(x, shift));
+            const __m256d   ys = _mm256_and_pd(y_ok, _mm256_sub_pd(y, shift));
+
+            carry1 = _avx2_scan_(_mm256_sub_pd(xs, ys), carry1);
+            carry2 = _avx2_scan_(_mm256_fmsub_pd(xs, xs,
+                                                 _mm256_mul_pd(ys, ys)),
+                                 carry2);
+            carryc = _avx2_scan_(_mm256_sub_pd(_mm256_and_pd(x_ok, one),
+                                               _mm256_and_pd(y_ok, one)),
+                                 carryc);
+
+            const __m256d   enough =
+                _mm256_cmp_pd(carryc, min_count, _CMP_GE_OQ);
+
+            if (st.mean)
+                _mm256_storeu_pd(
+                    st.mean + i,
+                    _mm256_blendv_pd(
+                        nan,
+                        _mm256_add_pd(shift, _mm256_div_pd(carry1, carryc)),
+                        enough));
+            if (st.var)  {
+                const __m256d   dev =
+                    _mm256_sub_pd(carry2,
+                                  _mm256_div_pd(_mm256_mul_pd(carry1, carry1),
+                                                carryc));
+
+                _mm256_storeu_pd(
+                    st.var + i,
+                    _mm256_blendv_pd(
+                        nan,
+                        _mm256_div_pd(dev, _mm256_sub_pd(carryc, one)),
+                        _mm256_and_pd(enough,
+                                      _mm256_cmp_pd(carryc, two,
+                                                    _CMP_GE_OQ))));
+            }
+            carry1 = _avx2_last_(carry1);
+            carry2 = _avx2_last_(carry2);
+            carryc = _avx2_last_(carryc);
+        }
+        s1 = _mm256_cvtsd_f64(carry1);
+        s2 = _mm256_cvtsd_f64(carry2);
+        c = _mm256_cvtsd_f64(carryc);
+        for (; i < end; ++i)
+            _rolling_row_(st, i, s1, s2, c);
+    }
+}
+
+// Each row is the affine map s -> b * s + c, with b = 1 - alpha, c = alpha
+// * x for a valid row and the identity for NaN. The lanes are composed by
+// a prefix scan and applied to the carried s.
+//
+HMDF_TARGET_AVX2 inline double _ewma_avx2_(const double *in,
+                                           double *out,
+                                           std::size_t begin,
+                                           std::size_t end,
+                                           double alpha,
+                                           double s) noexcept  {
+
+    const __m256d   zero = _mm256_setzero_pd();
+    const __m256d   one = _mm256_set1_pd(1.0);
+    const __m256d   a = _mm256_set1_pd(alpha);
+    const __m256d   one_minus_a = _mm256_set1_pd(1.0 - alpha);
+    __m256d         carry = _mm256_set1_pd(s);
+    std::size_t     i = begin;
+
+    for (; i + 4 <= end; i += 4)  {
+        const __m256d   x = _mm256_loadu_pd(in + i);
+        const __m256d   ok = _mm256_cmp_pd(x, x, _CMP_ORD_Q);
+        __m256d         b = _mm256_blendv_pd(one, one_minus_a, ok);
+        __m256d         c = _mm256_and_pd(ok, _mm256_mul_pd(a, x));
+
+        c = _mm256_fmadd_pd(b, _avx2_shift1_(c, zero), c);
+        b = _mm256_mul_pd(b, _avx2_shift1_(b, one));
+        c = _mm256_fmadd_pd(b, _avx2_shift2_(c, zero), c);
+        b = _mm256_mul_pd(b, _avx2_shift2_(b, one));
+        carry = _mm256_fmadd_pd(b, carry, c);
+        _mm256_storeu_pd(out + i, carry);
+        carry = _avx2_last_(carry);
+    }
+    return (_ewma_scalar_(in, out, i, end, alpha, _mm256_cvtsd_f64(carry)));
+}
+
+HMDF_TARGET_AVX2 inline void _sum_count_avx2_(const double *in,
+                                              std::size_t n,
+                                              double &sum,
+                                              double &count) noexcept  {
+
+    const __m256d   one = _mm256_set1_pd(1.0);
+    __m256d         sums = _mm256_setzero_pd();
+    __m256d         counts = _mm256_setzero_pd();
+    std::size_t     i = 0;
+
+    for (; i + 4 <= n; i += 4)  {
+        const __m256d   x = _mm256_loadu_pd(in + i);
+        const __m256d   ok = _mm256_cmp_pd(x, x, _CMP_ORD_Q);
+
+        sums = _mm256_add_pd(sums, _mm256_and_pd(ok, x));
+        counts = _mm256_add_pd(counts, _mm256_and_pd(ok, one));
+    }
+    _sum_count_scalar_(in + i, n - i, sum, count);
+    sum += _avx2_hsum_(sums);
+    count += _avx2_hsum_(counts);
+}
+
+HMDF_TARGET_AVX2 inline double _sum_sq_dev_avx2_(const double *in,
+                                                 std::size_t n,
+                                                 double mean) noexcept  {
+
+    const __m256d   m = _mm256_set1_pd(mean);
+    __m256d         sums = _mm256_setzero_pd();
+    std::size_t     i = 0;
+
+    for (; i + 4 <= n; i += 4)  {
+        const __m256d   x = _mm256_loadu_pd(in + i);
+        const __m256d   dev =
+            _mm256_and_pd(_mm256_cmp_pd(x, x, _CMP_ORD_Q),
+                          _mm256_sub_pd(x, m));
+
+        sums = _mm256_fmadd_pd(dev, dev, sums);
+    }
+    return (_avx2_hsum_(sums) + _sum_sq_dev_scalar_(in + i, n - i, mean));
+}
+
+HMDF_TARGET_AVX2 inline void _scale_avx2_(const double *in,
+                                          double *out,
+                                          std::size_t n,
+                                          double mean,
+                                          double inv_std) noexcept  {
+
+    const __m256d   m = _mm256_set1_pd(mean);
+    const __m256d   f = _mm256_set1_pd(inv_std);
+    std::size_t     i = 0;
+
+    for (; i + 4 <= n; i += 4)
+        _mm256_storeu_pd(out + i,
+                         _mm256_mul_pd(_mm256_sub_pd(_mm256_loadu_pd(in + i),
+                                                     m),
+                                       f));
+    _scale_scalar_(in, out, i, n, mean, inv_std);
+}
+
+// ----------------------------------------------------------------------------
+
+HMDF_TARGET_AVX512 inline __m512d _avx512_log_(__m512d x) noexcept  {
+
+    const __mmask8  normal =
+        _mm512_cmp_pd_mask(x, _mm512_set1_pd(
+                                  std::numeric_limits<double>::min()),
+                           _CMP_GE_OQ) &
+        _mm512_cmp_pd_mask(x, _mm512_set1_pd(
+                                  std::numeric_limits<double>::max()),
+                           _CMP_LE_OQ);
+
+    if (normal != 0xFF)  {
+        alignas(64) double  lanes[8];
+
+        _mm512_store_pd(lanes, x);
+        for (auto &lane : lanes)  lane = std::log(lane);
+        return (_mm512_load_pd(lanes));
+    }
+
+    const __m512i   bits = _mm512_castpd_si512(x);
+    __m512d         e =
+        _mm512_cvtepi64_pd(
+            _mm512_sub_epi64(_mm512_srli_epi64(bits, 52),
+                             _mm512_set1_epi64(1023)));
+    __m512d         m =
+        _mm512_castsi512_pd(
+            _mm512_or_si512(
+                _mm512_and_si512(bits,
+                                 _mm512_set1_epi64(0x000FFFFFFFFFFFFF)),
+                _mm512_set1_epi64(0x3FF0000000000000)));
+    const __mmask8  big =
+        _mm512_cmp_pd_mask(m, _mm512_set1_pd(_simd_sqrt2_), _CMP_GT_OQ);
+    const __m512d   one = _mm512_set1_pd(1.0);
+
+    m = _mm512_mask_mul_pd(m, big, m, _mm512_set1_pd(0.5));
+    e = _mm512_mask_add_pd(e, big, e, one);
+
+    const __m512d   s =
+        _mm512_div_pd(_mm512_sub_pd(m, one), _mm512_add_pd(m, one));
+    const __m512d   z = _mm512_mul_pd(s, s);
+    __m512d         p = _mm512_set1_pd(_simd_log_coeffs_[10]);
+
+    for (int k = 9; k >= 0; --k)
+        p = _mm512_fmadd_pd(p, z, _mm512_set1_pd(_simd_log_coeffs_[k]));
+
+    const __m512d   log_m = _mm512_mul_pd(_mm512_add_pd(s, s), p);
+
+    return (_mm512_fmadd_pd(e, _mm512_set1_pd(_simd_ln2_hi_),
+                            _mm512_fmadd_pd(e, _mm512_set1_pd(_simd_ln2_lo_),
+                                            log_m)));
+}
+
+// Lane j takes lane j - k, the first k lanes take fill
+//
+template<int K>
+HMDF_TARGET_AVX512 inline __m512d
+_avx512_shift_(__m512d v, __m512d fill) noexcept  {
+
+    const __m512i   idx = _mm512_set_epi64(7 - K, 6 - K, 5 - K, 4 - K,
+                                           3 - K, 2 - K, 1 - K, 0 - K);
+
+    return (_mm512_mask_permutexvar_pd(fill, __mmask8(0xFF << K), idx, v));
+}
+
+HMDF_TARGET_AVX512 inline __m512d
+_avx512_scan_(__m512d v, __m512d carry) noexcept  {
+
+    const __m512d   zero = _mm512_setzero_pd();
+
+    v = _mm512_add_pd(v, _avx512_shift_<1>(v, zero));
+    v = _mm512_add_pd(v, _avx512_shift_<2>(v, zero));
+    v = _mm512_add_pd(v, _avx512_shift_<4>(v, zero));
+    return (_mm512_add_pd(v, carry));
+}
+
+HMDF_TARGET_AVX512 inline __m512d _avx512_last_(__m512d v) noexcept  {
+
+    return (_mm512_permutexvar_pd(_mm512_set1_epi64(7), v));
+}
+
+template<bool LOG>
+HMDF_TARGET_AVX512 inline void _returns_avx512_(const double *in,
+                                                double *out,
+                                                std::size_t n) noexcept  {
+
+    std::size_t i = 1;
+
+    for (; i + 8 <= n; i += 8)  {
+        const __m512d   ratio = _mm512_div_pd(_mm512_loadu_pd(in + i),
+                                              _mm512_loadu_pd(in + i - 1));
+
+        _mm512_storeu_pd(out + i,
+                         LOG ? _avx512_log_(ratio)
+                             : _mm512_sub_pd(ratio, _mm512_set1_pd(1.0)));
+    }
+    _returns_scalar_<LOG>(in, out, i, n);
+}
+
+HMDF_TARGET_AVX512 inline void
+_rolling_avx512_(_RollingState_ st) noexcept  {
+
+    const __m512d   one = _mm512_set1_pd(1.0);
+    const __m512d   two = _mm512_set1_pd(2.0);
+    const __m512d   nan = _mm512_set1_pd(_simd_nan_);
+    const __m512d   min_count = _mm512_set1_pd(st.min_count);
+    double          s1, s2, c;
+
+    for (std::size_t b = 0; b < st.size; b += st.block)  {
+        const std::size_t   end = std::min(b + st.block, st.size);
+        std::size_t         i = b;
+
+        _rolling_resync_(st, b, s1, s2, c);
+
+        const __m512d   shift = _mm512_set1_pd(st.shift);
+
+        for (; i < std::min(end, st.window); ++i)
+            _rolling_row_(st, i, s1, s2, c);
+
+        __m512d carry1 = _mm512_set1_pd(s1);
+        __m512d carry2 = _mm512_set1_pd(s2);
+        __m512d carryc = _mm512_set1_pd(c);
+
+        for (; i + 8 <= end; i += 8)  {
+            const __m512d   x = _mm512_loadu_pd(st.in + i);
+            const __m512d   y = _mm512_loadu_pd(st.in + i - st.window);
+            const __mmask8  x_ok = _mm512_cmp_pd_mask(x, x, _CMP_ORD_Q);
+            const __mmask8  y_ok = _mm512_cmp_pd_mask(y, y, _CMP_ORD_Q);
+            const __m512d   xs = _mm512_maskz_sub_pd(x_ok, x, shift);
+            const __m512d   ys = _mm512_maskz_sub_pd(y_ok, y, shift);
+
+            carry1 = _avx512_scan_(_mm512_sub_pd(xs, ys), carry1);
+            carry2 = _avx512_scan_(_mm512_fmsub_pd(xs, xs,
+                                                   _mm512_mul_pd(ys, ys)),
+                                   carry2);
+            carryc =
+                _avx512_scan_(_mm512_sub_pd(_mm512_maskz_mov_pd(x_ok, one),
+                                            _mm512_maskz_mov_pd(y_ok, one)),
+                              carryc);
+
+            const __mmask8  enough =
+                _mm512_cmp_pd_mask(carryc, min_count, _CMP_GE_OQ);
+
+            if (st.mean)
+                _mm512_storeu_pd(
+                    st.mean + i,
+                    _mm512_mask_blend_pd(
+                        enough, nan,
+                        _mm512_add_pd(shift,
+                                      _mm512_div_pd(carry1, carryc))));
+            if (st.var)  {
+                const __m512d   dev =
+                    _mm512_sub_pd(carry2,
+                                  _mm512_div_pd(_mm512_mul_pd(carry1, carry1),
+                                                carryc));
+
+                _mm512_storeu_pd(
+                    st.var + i,
+                    _mm512_mask_blend_pd(
+                        enough & _mm512_cmp_pd_mask(carryc, two, _CMP_GE_OQ),
+                        nan,
+                        _mm512_div_pd(dev, _mm512_sub_pd(carryc, one))));
+            }
+            carry1 = _avx512_last_(carry1);
+            carry2 = _avx512_last_(carry2);
+            carryc = _avx512_last_(carryc);
+        }
+        s1 = _mm512_cvtsd_f64(carry1);
+        s2 = _mm512_cvtsd_f64(carry2);
+        c = _mm512_cvtsd_f64(carryc);
+        for (; i < end; ++i)
+            _rolling_row_(st, i, s1, s2, c);
+    }
+}
+
+HMDF_TARGET_AVX512 inline double _ewma_avx512_(const double *in,
+                                               double *out,
+                                               std::size_t begin,
+                                               std::size_t end,
+                                               double alpha,
+                                               double s) noexcept  {
+
+    const __m512d   zero = _mm512_setzero_pd();
+    const __m512d   one = _mm512_set1_pd(1.0);
+    const __m512d   a = _mm512_set1_pd(alpha);
+    const __m512d   one_minus_a = _mm512_set1_pd(1.0 - alpha);
+    __m512d         carry = _mm512_set1_pd(s);
+    std::size_t     i = begin;
+
+    for (; i + 8 <= end; i += 8)  {
+        const __m512d   x = _mm512_loadu_pd(in + i);
+        const __mmask8  ok = _mm512_cmp_pd_mask(x, x, _CMP_ORD_Q);
+        __m512d         b = _mm512_mask_blend_pd(ok, one, one_minus_a);
+        __m512d         c = _mm512_maskz_mul_pd(ok, a, x);
+
+        c = _mm512_fmadd_pd(b, _avx512_shift_<1>(c, zero), c);
+        b = _mm512_mul_pd(b, _avx512_shift_<1>(b, one));
+        c = _mm512_fmadd_pd(b, _avx512_shift_<2>(c, zero), c);
+        b = _mm512_mul_pd(b, _avx512_shift_<2>(b, one));
+        c = _mm512_fmadd_pd(b, _avx512_shift_<4>(c, zero), c);
+        b = _mm512_mul_pd(b, _avx512_shift_<4>(b, one));
+        carry = _mm512_fmadd_pd(b, carry, c);
+        _mm512_storeu_pd(out + i, carry);
+        carry = _avx512_last_(carry);
+    }
+    return (_ewma_scalar_(in, out, i, end, alpha, _mm512_cvtsd_f64(carry)));
+}
+
+HMDF_TARGET_AVX512 inline void _sum_count_avx512_(const double *in,
+                                                  std::size_t n,
+                                                  double &sum,
+                                                  double &count) noexcept  {
+
+    const __m512d   one = _mm512_set1_pd(1.0);
+    __m512d         sums = _mm512_setzero_pd();
+    __m512d         counts = _mm512_setzero_pd();
+    std::size_t     i = 0;
+
+    for (; i + 8 <= n; i += 8)  {
+        const __m512d   x = _mm512_loadu_pd(in + i);
+        const __mmask8  ok = _mm512_cmp_pd_mask(x, x, _CMP_ORD_Q);
+
+        sums = _mm512_mask_add_pd(sums, ok, sums, x);
+        counts = _mm512_mask_add_pd(counts, ok, counts, one);
+    }
+    _sum_count_scalar_(in + i, n - i, sum, count);
+    sum += _mm512_reduce_add_pd(sums);
+    count += _mm512_reduce_add_pd(counts);
+}
+
+HMDF_TARGET_AVX512 inline double _sum_sq_dev_avx512_(const double *in,
+                                                     std::size_t n,
+                                                     double mean) noexcept  {
+
+    const __m512d   m = _mm512_set1_pd(mean);
+    __m512d         sums = _mm512_setzero_pd();
+    std::size_t     i = 0;
+
+    for (; i + 8 <= n; i += 8)  {
+        const __m512d   x = _mm512_loadu_pd(in + i);
+        const __m512d   dev =
+            _mm512_maskz_sub_pd(_mm512_cmp_pd_mask(x, x, _CMP_ORD_Q), x, m);
+
+        sums = _mm512_fmadd_pd(dev, dev, sums);
+    }
+    return (_mm512_reduce_add_pd(sums) +
+            _sum_sq_dev_scalar_(in + i, n - i, mean));
+}
+
+HMDF_TARGET_AVX512 inline void _scale_avx512_(const double *in,
+                                              double *out,
+                                              std::size_t n,
+                                              double mean,
+                                              double inv_std) noexcept  {
+
+    const __m512d   m = _mm512_set1_pd(mean);
+    const __m512d   f = _mm512_set1_pd(inv_std);
+    std::size_t     i = 0;
+
+    for (; i + 8 <= n; i += 8)
+        _mm512_storeu_pd(out + i,
+                         _mm512_mul_pd(_mm512_sub_pd(_mm512_loadu_pd(in + i),
+                                                     m),
+                                       f));
+    _scale_scalar_(in, out, i, n, mean, inv_std);
+}
+
+#pragma GCC diagnostic pop
+
+#endif // HMDF_SIMD_X86
+
+// ----------------------------------------------------------------------------
+
+template<bool LOG>
+inline void _returns_dispatch_(std::span<const double> in,
+                               std::span<double> out)  {
+
+    _simd_check_sizes_(in, out, "simd_returns(): in and out sizes differ");
+    if (in.empty())  return;
+    out[0] = _simd_nan_;
+#ifdef HMDF_SIMD_X86
+    switch (simd_level())  {
+    case SIMDLevel::avx512:
+        _returns_avx512_<LOG>(in.data(), out.data(), in.size());
+        return;
+    case SIMDLevel::avx2:
+        _returns_avx2_<LOG>(in.data(), out.data(), in.size());
+        return;
+    default:
+        break;
+    }
+#endif // HMDF_SIMD_X86
+    _returns_scalar_<LOG>(in.data(), out.data(), 1, in.size());
+}
+
+inline void _rolling_dispatch_(std::span<const double> in,
+                               double *mean,
+                               double *var,
+                               std::size_t window,
+                               std::size_t min_count)  {
+
+    if (window == 0)
+        throw NotFeasible("simd_rolling_*(): window cannot be 0");
+
+    const _RollingState_    st {
+        in.data(), in.size(), mean, var, window,
+        std::max(_simd_resync_block_, 4 * window),
+        double(min_count ? min_count : window), 0.0
+    };
+
+#ifdef HMDF_SIMD_X86
+    switch (simd_level())  {
+    case SIMDLevel::avx512:
+        _rolling_avx512_(st);
+        return;
+    case SIMDLevel::avx2:
+        _rolling_avx2_(st);
+        return;
+    default:
+        break;
+    }
+#endif // HMDF_SIMD_X86
+    _rolling_scalar_(st);
+}
+
+// ----------------------------------------------------------------------------
+
+// out[i] = in[i] / in[i - 1] - 1
+//
+inline void
+simd_returns(std::span<const double> in, std::span<double> out)  {
+
+    _returns_dispatch_<false>(in, out);
+}
+
+// out[i] = log(in[i] / in[i - 1])
+//
+inline void
+simd_log_returns(std::span<const double> in, std::span<double> out)  {
+
+    _returns_dispatch_<true>(in, out);
+}
+
+// Mean of the valid values among the last window rows. min_count of 0
+// means window.
+//
+inline void simd_rolling_mean(std::span<const double> in,
+                              std::span<double> out,
+                              std::size_t window,
+                              std::size_t min_count = 0)  {
+
+    _simd_check_sizes_(in, out,
+                       "simd_rolling_mean(): in and out sizes differ");
+    _rolling_dispatch_(in, out.data(), nullptr, window, min_count);
+}
+
+// Variance (n - 1) of the valid values among the last window rows
+//
+inline void simd_rolling_var(std::span<const double> in,
+                             std::span<double> out,
+                             std::size_t window,
+                             std::size_t min_count = 0)  {
+
+    _simd_check_sizes_(in, out,
+                       "simd_rolling_var(): in and out sizes differ");
+    _rolling_dispatch_(in, nullptr, out.data(), window, min_count);
+}
+
+// Both in one pass
+//
+inline void simd_rolling_mean_var(std::span<const double> in,
+                                  std::span<double> mean_out,
+                                  std::span<double> var_out,
+                                  std::size_t window,
+                                  std::size_t min_count = 0)  {
+
+    _simd_check_sizes_(in, mean_out,
+                       "simd_rolling_mean_var(): in and out sizes differ");
+    _simd_check_sizes_(in, var_out,
+                       "simd_rolling_mean_var(): in and out sizes differ");
+    _rolling_dispatch_(in, mean_out.data(), var_out.data(),
+                       window, min_count);
+}
+
+inline void simd_ewma(std::span<const double> in,
+                      std::span<double> out,
+                      double alpha)  {
+
+    _simd_check_sizes_(in, out, "simd_ewma(): in and out sizes differ");
+    if (alpha <= 0 || alpha > 1)
+        throw NotFeasible("simd_ewma(): alpha must be in (0, 1]");
+
+    std::size_t i = 0;
+
+    while (i < in.size() && in[i] != in[i])
+        out[i++] = _simd_nan_;
+    if (i == in.size())  return;
+    out[i] = in[i];
+
+    const double    s = in[i];
+
+#ifdef HMDF_SIMD_X86
+    switch (simd_level())  {
+    case SIMDLevel::avx512:
+        _ewma_avx512_(in.data(), out.data(), i + 1, in.size(), alpha, s);
+        return;
+    case SIMDLevel::avx2:
+        _ewma_avx2_(in.data(), out.data(), i + 1, in.size(), alpha, s);
+        return;
+    default:
+        break;
+    }
+#endif // HMDF_SIMD_X86
+    _ewma_scalar_(in.data(), out.data(), i + 1, in.size(), alpha, s);
+}
+
+// (x - mean) / std, std with the n - 1 denominator. All NaN if there are
+// fewer than 2 valid values or they are all the same.
+//
+inline void
+simd_zscore(std::span<const double> in, std::span<double> out)  {
+
+    _simd_check_sizes_(in, out, "simd_zscore(): in and out sizes differ");
+
+    [[maybe_unused]] const SIMDLevel    level = simd_level();
+    const double    *data = in.data();
+    const auto      n = in.size();
+    double          sum, count;
+
+#ifdef HMDF_SIMD_X86
+    if (level == SIMDLevel::avx512)
+        _sum_count_avx512_(data, n, sum, count);
+    else if (level == SIMDLevel::avx2)
+        _sum_count_avx2_(data, n, sum, count);
+    else
+#endif // HMDF_SIMD_X86
+        _sum_count_scalar_(data, n, sum, count);
+
+    const double    mean = count > 0 ? sum / count : _simd_nan_;
+    double          sq_dev;
+
+#ifdef HMDF_SIMD_X86
+    if (level == SIMDLevel::avx512)
+        sq_dev = _sum_sq_dev_avx512_(data, n, mean);
+    else if (level == SIMDLevel::avx2)
+        sq_dev = _sum_sq_dev_avx2_(data, n, mean);
+    else
+#endif // HMDF_SIMD_X86
+        sq_dev = _sum_sq_dev_scalar_(data, n, mean);
+
+    const double    std = count > 1 ? std::sqrt(sq_dev / (count - 1)) : 0;
+
+    if (! (std > 0))  {
+        std::fill(out.begin(), out.end(), _simd_nan_);
+        return;
+    }
+
+#ifdef HMDF_SIMD_X86
+    if (level == SIMDLevel::avx512)
+        _scale_avx512_(data, out.data(), n, mean, 1.0 / std);
+    else if (level == SIMDLevel::avx2)
+        _scale_avx2_(data, out.data(), n, mean, 1.0 / std);
+    else
+#endif // HMDF_SIMD_X86
+        _scale_scalar_(data, out.data(), 0, n, mean, 1.0 / std);
+}
+
+}
@@ -0,0 +1,310 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace hmdf
+{
+
+// A thread pool where idle workers steal work from busy ones.
+//
+// Each worker has its own task deque. It runs its newest task first, and
+// an idle worker steals the oldest task of another worker, which for fork
+// and join work is the biggest piece left. Tasks submitted from outside
+// the pool go on a shared queue.
+//
+// run_chunks() is the fork and join entry point. The chunks are split into
+// one contiguous run per thread taking part. A thread works through its own
+// run and then takes chunks from the front of the others', so a slow chunk
+// or a busy core does not hold the rest up. The calling thread takes part
+// too, and can do all of the chunks itself if no worker is free. That is
+// why calling run_chunks() from inside a task does not deadlock.
+//
+class   WorkStealingPool  {
+
+public:
+
+    using size_type = std::size_t;
+    using task_type = std::function<void()>;
+
+    // thread_count is the number of workers, not counting the threads that
+    // call run_chunks(). 0 means one per core, less one for the caller.
+    //
+    explicit WorkStealingPool(unsigned int thread_count = 0)  {
+
+        if (thread_count == 0)
+            thread_count =
+                std::max(std::thread::hardware_concurrency(), 2U) - 1;
+
+        queues_.reserve(thread_count);
+        for (unsigned int t = 0; t < thread_count; ++t)
+            queues_.push_back(std::make_unique<Queue_>());
+        threads_.reserve(thread_count);
+        for (unsigned int t = 0; t < thread_count; ++t)
+            threads_.emplace_back(&WorkStealingPool::worker_loop_, this, t);
+    }
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator = (const WorkStealingPool &) = delete;
+
+    // Runs the tasks still queued, then joins the workers
+    //
+    ~WorkStealingPool()  {
+
+        {
+            const std::lock_guard<std::mutex>   guard { mutex_ };
+
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto &thr : threads_)  thr.join();
+    }
+
+    [[nodiscard]] unsigned int thread_count() const noexcept  {
+
+        return (static_cast<unsigned int>(threads_.size()));
+    }
+
+    // Queues task. From one of this pool's workers, it goes on the worker's
+    // own deque.
+    //
+    void submit(task_type &&task)  {
+
+        const auto  &self = current_worker_();
+
+        if (self.first == this)  {
+            const std::lock_guard<std::mutex>   guard {
+                queues_[self.second]->mutex
+            };
+
+            queues_[self.second]->tasks.push_back(std::move(task));
+        }
+        else  {
+            const std::lock_guard<std::mutex>   guard { mutex_ };
+
+            shared_.push_back(std::move(task));
+        }
+        {
+            const std::lock_guard<std::mutex>   guard { mutex_ };
+
+            pending_ += 1;
+        }
+        wake_.notify_one();
+    }
+
+    // Calls func(c) for each chunk c in [0, chunk_count) and returns once
+    // they are all done. If func throws, the chunks not yet started are
+    // skipped and the first exception is rethrown here.
+    //
+    template<typename F>
+    void run_chunks(size_type chunk_count, F &&func)  {
+
+        const size_type parts =
+            std::min<size_type>(chunk_count, thread_count() + 1);
+
+        if (parts <= 1)  {
+            for (size_type c = 0; c < chunk_count; ++c)  func(c);
+            return;
+        }
+
+        auto    job = std::make_shared<ChunkJob_>(chunk_count, parts);
+
+        job->context = const_cast<void *>(static_cast<const void *>(&func));
+        job->call = [](void *context, size_type c)  {
+            (*static_cast<std::remove_reference_t<F> *>(context))(c);
+        };
+        for (size_type p = 1; p < parts; ++p)
+            submit([job]()  {
+                job->work(job->next_part.fetch_add(1) % job->ranges.size());
+            });
+        job->work(0);
+        job->wait();
+        if (job->error)  std::rethrow_exception(job->error);
+    }
+
+private:
+
+    struct  alignas(64) Queue_  {
+
+        std::mutex              mutex { };
+        std::deque<task_type>   tasks { };
+    };
+
+    // The state of one run_chunks() call. The workers hold it by shared
+    // pointer, since a task can start after the call has returned. It then
+    // finds no chunks left and never touches func.
+    //
+    struct  ChunkJob_  {
+
+        struct  alignas(64) Range_  {
+
+            std::atomic<size_type>  next { 0 };
+            size_type               end { 0 };
+        };
+
+        ChunkJob_(size_type chunk_count, size_type parts)
+            : ranges(parts), total(chunk_count)  {
+
+            for (size_type p = 0; p < parts; ++p)  {
+                ranges[p].next = chunk_count * p / parts;
+                ranges[p].end = chunk_count * (p + 1) / parts;
+            }
+        }
+
+        // Its own run first, then the others', starting with the next one
+        //
+        void work(size_type self)  {
+
+            for (size_type k = 0; k < ranges.size(); ++k)  {
+                Range_  &range = ranges[(self + k) % ranges.size()];
+
+                for (size_type c = range.next.fetch_add(1);
+                     c < range.end;
+                     c = range.next.fetch_add(1))
+                    run(c);
+            }
+        }
+
+        void run(size_type c)  {
+
+            if (! failed.load(std::memory_order_relaxed))  {
+                try  { call(context, c); }
+                catch (...)  {
+                    const std::lock_guard<std::mutex>   guard { mutex };
+
+                    if (! error)  error = std::current_exception();
+                    failed = true;
+                }
+            }
+            if (done.fetch_add(1) + 1 == total)  {
+                const std::lock_guard<std::mutex>   guard { mutex };
+
+                finished.notify_all();
+            }
+        }
+
+        void wait()  {
+
+            std::unique_lock<std::mutex>    lock { mutex };
+
+            finished.wait(lock, [this]() { return (done.load() == total); });
+        }
+
+        std::vector<Range_>     ranges;
+        const size_type         total;
+        std::atomic<size_type>  done { 0 };
+        std::atomic<size_type>  next_part { 1 };
+        std::atomic<bool>       failed { false };
+        void                    *context { nullptr };
+        void                    (*call)(void *, size_type) { nullptr };
+        std::exception_ptr      error { };
+        std::mutex              mutex { };
+        std::condition_variable finished { };
+    };
+
+    // The pool and the worker number of the calling thread
+    //
+    static std::pair<const WorkStealingPool *, size_type> &
+    current_worker_() noexcept  {
+
+        static thread_local std::pair<const WorkStealingPool *, size_type>
+            self { nullptr, 0 };
+
+        return (self);
+    }
+
+    // Its own newest task, then the oldest shared one, then the oldest of
+    // another worker's
+    //
+    bool pop_task_(size_type self, task_type &task)  {
+
+        {
+            Queue_                              &own = *queues_[self];
+            const std::lock_guard<std::mutex>   guard { own.mutex };
+
+            if (! own.tasks.empty())  {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                return (true);
+            }
+        }
+        {
+            const std::lock_guard<std::mutex>   guard { mutex_ };
+
+            if (! shared_.empty())  {
+                task = std::move(shared_.front());
+                shared_.pop_front();
+                return (true);
+            }
+        }
+        for (size_type k = 1; k < queues_.size(); ++k)  {
+            Queue_                              &victim =
+                *queues_[(self + k) % queues_.size()];
+            const std::lock_guard<std::mutex>   guard { victim.mutex };
+
+            if (! victim.tasks.empty())  {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return (true);
+            }
+        }
+        return (false);
+    }
+
+    void worker_loop_(size_type self)  {
+
+        current_worker_() = { this, self };
+
+        task_type   task;
+
+        while (true)  {
+            if (pop_task_(self, task))  {
+                {
+                    const std::lock_guard<std::mutex>   guard { mutex_ };
+
+                    pending_ -= 1;
+                }
+                task();
+                task = nullptr;
+                continue;
+            }
+
+            std::unique_lock<std::mutex>    lock { mutex_ };
+
+            // pending_ can be ahead of the queues for a moment, while a
+            // task is being pushed
+            //
+            wake_.wait(lock, [this]() { return (stop_ || pending_ > 0); });
+            if (stop_ && pending_ <= 0)  return;
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue_>>    queues_ { };
+    std::vector<std::thread>                threads_ { };
+    std::deque<task_type>                   shared_ { };
+    std::mutex                              mutex_ { };
+    std::condition_variable                 wake_ { };
+    std::ptrdiff_t                          pending_ { 0 };
+    bool                                    stop_ { false };
+};
+
+// The pool the parallel entry points use unless they are given one
+//
+inline WorkStealingPool &default_thread_pool()  {
+
+    static WorkStealingPool pool;
+
+    return (pool);
+}
+
+}
@@ -0,0 +1,608 @@
+#pragma once
+
+#include <DataFrame/Vectors/VectorView.h>
+
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace hmdf
+{
+
+// These are non-owning views over a column that, unlike VectorView, do not
+// need the selected elements to be adjacent:
+//
+//   VectorStridedView: every stride-th element starting at a given one
+//                      (e.g. downsampling every Nth row)
+//   VectorIndexedView: the elements at a list of row positions
+//                      (e.g. rows that passed a boolean filter)
+//
+// They have the same interface as VectorView, so they can stand in for it
+// wherever a column is only read or written in place. Like VectorView, T
+// may be const qualified. VectorStridedConstView and VectorIndexedConstView
+// are spelled that way for symmetry with VectorConstView.
+//
+// Building a view never copies column data. An indexed view holds its row
+// positions through a shared_ptr, so every column view of a filtered frame
+// shares the one RowSelection.
+
+using RowSelection = std::vector<unsigned long long int>;
+using RowSelectionPtr = std::shared_ptr<const RowSelection>;
+
+// ----------------------------------------------------------------------------
+
+template<typename T, std::size_t A = 0>
+class VectorStridedView {
+
+public:
+
+   static constexpr std::align_val_t align_value { A };
+
+   using value_type = std::remove_const_t<T>;
+   using size_type = unsigned long long int;
+   using difference_type = std::ptrdiff_t;
+   using pointer = T *;
+   using const_pointer = const value_type *;
+   using const_pointer_const = const value_type *const;
+   using reference = T &;
+   using const_reference = const value_type &;
+
+   static const size_type value_size = sizeof(value_type);
+
+   VectorStridedView() = default;
+   VectorStridedView(const VectorStridedView &) = default;
+   VectorStridedView(VectorStridedView &&) = default;
+   VectorStridedView &operator = (const VectorStridedView &) = default;
+   VectorStridedView &operator = (VectorStridedView &&) = default;
+   ~VectorStridedView() = default;
+
+   // bp points to the first selected element. The view covers sz elements,
+   // each stride (> 0) elements after the previous one.
+   //
+   inline VectorStridedView (pointer bp,
+                             size_type sz,
+                             difference_type stride) noexcept
+      : begin_ptr_(bp), size_(sz), stride_(stride) { }
+
+   [[nodiscard]] inline bool
+   empty () const noexcept { return (size_ == 0); }
+   [[nodiscard]] inline size_type size () const noexcept { return (size_); }
+   [[nodiscard]] inline size_type
+   capacity () const noexcept { return (size()); }
+   [[nodiscard]] inline difference_type
+   stride () const noexcept { return (stride_); }
+   inline void clear () noexcept { begin_ptr_ = nullptr; size_ = 0; }
+
+   [[nodiscard]] inline reference
+   as (size_type i) noexcept { return (*(begin_ptr_ + i * stride_)); }
+   [[nodiscard]] inline const_reference
+   at (size_type i) const noexcept { return (*(begin_ptr_ + i * stride_)); }
+   [[nodiscard]] inline reference operator [] (size_type i) noexcept {
+
+      return (*(begin_ptr_ + i * stride_));
+   }
+   [[nodiscard]] inline const_reference
+   operator [] (size_type i) const noexcept {
+
+      return (*(begin_ptr_ + i * stride_));
+   }
+   [[nodiscard]] inline reference front() noexcept { return (*begin_ptr_); }
+   [[nodiscard]] inline const_reference
+   front() const noexcept { return (*begin_ptr_); }
+   [[nodiscard]] inline reference
+   back() noexcept { return (operator[](size_ - 1)); }
+   [[nodiscard]] inline const_reference
+   back() const noexcept { return (operator[](size_ - 1)); }
+
+   inline void shrink_to_fit() { }
+   inline void reserve (size_type) { }
+
+   inline void swap (VectorStridedView &rhs) noexcept {
+
+      std::swap (begin_ptr_, rhs.begin_ptr_);
+      std::swap (size_, rhs.size_);
+      std::swap (stride_, rhs.stride_);
+      return;
+   }
+
+public:
+
+   template<typename U>
+   class strided_iterator {
+
+   public:
+
+      using iterator_category = std::random_access_iterator_tag;
+      using value_type = std::remove_const_t<U>;
+      using pointer = U *;
+      using reference = U &;
+      using difference_type = std::ptrdiff_t;
+
+   public:
+
+      inline strided_iterator () = default;
+
+      inline strided_iterator (pointer base,
+                               difference_type pos,
+                               difference_type stride) noexcept
+         : base_ (base), pos_ (pos), stride_ (stride) { }
+
+      template<typename V>
+         requires std::is_convertible_v<V *, U *>
+      inline strided_iterator (const strided_iterator<V> &itr) noexcept
+         : base_ (itr.base()), pos_ (itr.pos()), stride_ (itr.stride()) { }
+
+      inline bool
+      operator == (const strided_iterator &rhs) const noexcept {
+
+         return (pos_ == rhs.pos_);
+      }
+      inline std::strong_ordering
+      operator <=> (const strided_iterator &rhs) const noexcept {
+
+         return (pos_ <=> rhs.pos_);
+      }
+
+      inline pointer operator -> () const noexcept {
+
+         return (base_ + pos_ * stride_);
+      }
+      inline reference operator * () const noexcept {
+
+         return (base_[pos_ * stride_]);
+      }
+      inline reference operator [] (difference_type i) const noexcept {
+
+         return (base_[(pos_ + i) * stride_]);
+      }
+      [[nodiscard]] inline pointer base () const noexcept { return (base_); }
+      [[nodiscard]] inline difference_type
+      pos () const noexcept { return (pos_); }
+      [[nodiscard]] inline difference_type
+      stride () const noexcept { return (stride_); }
+
+      inline strided_iterator &operator ++ () noexcept {
+
+         pos_ += 1;
+         return (*this);
+      }
+      inline strided_iterator operator ++ (int) noexcept {
+
+         const difference_type ret_pos = pos_;
+
+         pos_ += 1;
+         return (strided_iterator (base_, ret_pos, stride_));
+      }
+
+      inline strided_iterator &operator += (difference_type step) noexcept {
+
+         pos_ += step;
+         return (*this);
+      }
+
+      inline strided_iterator &operator -- () noexcept {
+
+         pos_ -= 1;
+         return (*this);
+      }
+      inline strided_iterator operator -- (int) noexcept {
+
+         const difference_type ret_pos = pos_;
+
+         pos_ -= 1;
+         return (strided_iterator (base_, ret_pos, stride_));
+      }
+
+      inline strided_iterator &operator -= (difference_type step) noexcept {
+
+         pos_ -= step;
+         return (*this);
+      }
+
+      inline strided_iterator
+      operator + (difference_type step) const noexcept {
+
+         return (strided_iterator (base_, pos_ + step, stride_));
+      }
+      friend inline strided_iterator
+      operator + (difference_type step,
+                  const strided_iterator &rhs) noexcept {
+
+         return (rhs + step);
+      }
+
+      inline strided_iterator
+      operator - (difference_type step) const noexcept {
+
+         return (strided_iterator (base_, pos_ - step, stride_));
+      }
+
+      friend inline difference_type
+      operator - (const strided_iterator &lhs,
+                  const strided_iterator &rhs) noexcept {
+
+         return (lhs.pos_ - rhs.pos_);
+      }
+
+   private:
+
+      pointer base_ { nullptr };
+      difference_type pos_ { 0 };
+      difference_type stride_ { 1 };
+   };
+
+   using iterator = strided_iterator<T>;
+   using const_iterator = strided_iterator<const value_type>;
+
+   [[nodiscard]] inline iterator
+   begin () noexcept { return (iterator (begin_ptr_, 0, stride_)); }
+   [[nodiscard]] inline iterator
+   end () noexcept {
+
+      return (iterator (begin_ptr_,
+                        static_cast<difference_type>(size_),
+                        stride_));
+   }
+   [[nodiscard]] inline const_iterator
+   begin () const noexcept {
+
+      return (const_iterator (begin_ptr_, 0, stride_));
+   }
+   [[nodiscard]] inline const_iterator
+   end () const noexcept {
+
+      return (const_iterator (begin_ptr_,
+                              static_cast<difference_type>(size_),
+                              stride_));
+   }
+
+   [[nodiscard]] inline std::reverse_iterator<iterator>
+   rbegin() noexcept { return (std::make_reverse_iterator(end())); }
+   [[nodiscard]] inline std::reverse_iterator<iterator>
+   rend() noexcept { return (std::make_reverse_iterator(begin())); }
+   [[nodiscard]] inline std::reverse_iterator<const_iterator>
+   rbegin() const noexcept { return (std::make_reverse_iterator(end())); }
+   [[nodiscard]] inline std::reverse_iterator<const_iterator>
+   rend() const noexcept { return (std::make_reverse_iterator(begin())); }
+
+private:
+
+   pointer begin_ptr_ { nullptr };
+   size_type size_ { 0 };
+   difference_type stride_ { 1 };
+};
+
+template<typename T, std::size_t A = 0>
+using VectorStridedConstView = VectorStridedView<const T, A>;
+
+// ----------------------------------------------------------------------------
+
+template<typename T, std::size_t A = 0>
+class VectorIndexedView {
+
+public:
+
+   static constexpr std::align_val_t align_value { A };
+
+   using value_type = std::remove_const_t<T>;
+   using size_type = unsigned long long int;
+   using difference_type = std::ptrdiff_t;
+   using pointer = T *;
+   using const_pointer = const value_type *;
+   using const_pointer_const = const value_type *const;
+   using reference = T &;
+   using const_reference = const value_type &;
+
+   static const size_type value_size = sizeof(value_type);
+
+   VectorIndexedView() = default;
+   VectorIndexedView(const VectorIndexedView &) = default;
+   VectorIndexedView(VectorIndexedView &&) = default;
+   VectorIndexedView &operator = (const VectorIndexedView &) = default;
+   VectorIndexedView &operator = (VectorIndexedView &&) = default;
+   ~VectorIndexedView() = default;
+
+   // base points to row 0 of the column. Every position in rows must be
+   // less than the column's length.
+   //
+   inline VectorIndexedView (pointer base, RowSelectionPtr rows) noexcept
+      : base_ptr_(base), rows_(std::move(rows)) { }
+
+   [[nodiscard]] inline bool
+   empty () const noexcept { return (size() == 0); }
+   [[nodiscard]] inline size_type size () const noexcept {
+
+      return (rows_ ? rows_->size() : 0);
+   }
+   [[nodiscard]] inline size_type
+   capacity () const noexcept { return (size()); }
+   [[nodiscard]] inline const RowSelectionPtr &
+   rows () const noexcept { return (rows_); }
+   inline void clear () noexcept { base_ptr_ = nullptr; rows_.reset(); }
+
+   [[nodiscard]] inline reference
+   as (size_type i) noexcept { return (base_ptr_[(*rows_)[i]]); }
+   [[nodiscard]] inline const_reference
+   at (size_type i) const noexcept { return (base_ptr_[(*rows_)[i]]); }
+   [[nodiscard]] inline reference operator [] (size_type i) noexcept {
+
+      return (base_ptr_[(*rows_)[i]]);
+   }
+   [[nodiscard]] inline const_reference
+   operator [] (size_type i) const noexcept {
+
+      return (base_ptr_[(*rows_)[i]]);
+   }
+   [[nodiscard]] inline reference
+   front() noexcept { return (base_ptr_[rows_->front()]); }
+   [[nodiscard]] inline const_reference
+   front() const noexcept { return (base_ptr_[rows_->front()]); }
+   [[nodiscard]] inline reference
+   back() noexcept { return (base_ptr_[rows_->back()]); }
+   [[nodiscard]] inline const_reference
+   back() const noexcept { return (base_ptr_[rows_->back()]); }
+
+   inline void shrink_to_fit() { }
+   inline void reserve (size_type) { }
+
+   inline void swap (VectorIndexedView &rhs) noexcept {
+
+      std::swap (base_ptr_, rhs.base_ptr_);
+      rows_.swap (rhs.rows_);
+      return;
+   }
+
+public:
+
+   template<typename U>
+   class indexed_iterator {
+
+   public:
+
+      using iterator_category = std::random_access_iterator_tag;
+      using value_type = std::remove_const_t<U>;
+      using pointer = U *;
+      using reference = U &;
+      using difference_type = std::ptrdiff_t;
+      using row_pointer = const RowSelection::value_type *;
+
+   public:
+
+      inline indexed_iterator () = default;
+
+      inline indexed_iterator (pointer base, row_pointer row) noexcept
+         : base_ (base), row_ (row) { }
+
+      template<typename V>
+         requires std::is_convertible_v<V *, U *>
+      inline indexed_iterator (const indexed_iterator<V> &itr) noexcept
+         : base_ (itr.base()), row_ (itr.row()) { }
+
+      inline bool
+      operator == (const indexed_iterator &rhs) const noexcept {
+
+         return (row_ == rhs.row_);
+      }
+      inline std::strong_ordering
+      operator <=> (const indexed_iterator &rhs) const noexcept {
+
+         return (row_ <=> rhs.row_);
+      }
+
+      inline pointer operator -> () const noexcept { return (base_ + *row_); }
+      inline reference operator * () const noexcept { return (base_[*row_]); }
+      inline reference operator [] (difference_type i) const noexcept {
+
+         return (base_[row_[i]]);
+      }
+      [[nodiscard]] inline pointer base () const noexcept { return (base_); }
+      [[nodiscard]] inline row_pointer row () const noexcept { return (row_); }
+
+      inline indexed_iterator &operator ++ () noexcept {
+
+         row_ += 1;
+         return (*this);
+      }
+      inline indexed_iterator operator ++ (int) noexcept {
+
+         row_pointer ret_row = row_;
+
+         row_ += 1;
+         return (indexed_iterator (base_, ret_row));
+      }
+
+      inline indexed_iterator &operator += (difference_type step) noexcept {
+
+         row_ += step;
+         return (*this);
+      }
+
+      inline indexed_iterator &operator -- () noexcept {
+
+         row_ -= 1;
+         return (*this);
+      }
+      inline indexed_iterator operator -- (int) noexcept {
+
+         row_pointer ret_row = row_;
+
+         row_ -= 1;
+         return (indexed_iterator (base_, ret_row));
+      }
+
+      inline indexed_iterator &operator -= (difference_type step) noexcept {
+
+         row_ -= step;
+         return (*this);
+      }
+
+      inline indexed_iterator
+      operator + (difference_type step) const noexcept {
+
+         return (indexed_iterator (base_, row_ + step));
+      }
+      friend inline indexed_iterator
+      operator + (difference_type step,
+                  const indexed_iterator &rhs) noexcept {
+
+         return (rhs + step);
+      }
+
+      inline indexed_iterator
+      operator - (difference_type step) const noexcept {
+
+         return (indexed_iterator (base_, row_ - step));
+      }
+
+      friend inline difference_type
+      operator - (const indexed_iterator &lhs,
+                  const indexed_iterator &rhs) noexcept {
+
+         return (lhs.row_ - rhs.row_);
+      }
+
+   private:
+
+      pointer base_ { nullptr };
+      row_pointer row_ { nullptr };
+   };
+
+   using iterator = indexed_iterator<T>;
+   using const_iterator = indexed_iterator<const value_type>;
+
+   [[nodiscard]] inline iterator
+   begin () noexcept { return (iterator (base_ptr_, rows_begin_())); }
+   [[nodiscard]] inline iterator
+   end () noexcept { return (iterator (base_ptr_, rows_begin_() + size())); }
+   [[nodiscard]] inline const_iterator
+   begin () const noexcept {
+
+      return (const_iterator (base_ptr_, rows_begin_()));
+   }
+   [[nodiscard]] inline const_iterator
+   end () const noexcept {
+
+      return (const_iterator (base_ptr_, rows_begin_() + size()));
+   }
+
+   [[nodiscard]] inline std::reverse_iterator<iterator>
+   rbegin() noexcept { return (std::make_reverse_iterator(end())); }
+   [[nodiscard]] inline std::reverse_iterator<iterator>
+   rend() noexcept { return (std::make_reverse_iterator(begin())); }
+   [[nodiscard]] inline std::reverse_iterator<const_iterator>
+   rbegin() const noexcept { return (std::make_reverse_iterator(end())); }
+   [[nodiscard]] inline std::reverse_iterator<const_iterator>
+   rend() const noexcept { return (std::make_reverse_iterator(begin())); }
+
+private:
+
+   inline const RowSelection::value_type *rows_begin_ () const noexcept {
+
+      return (rows_ ? rows_->data() : nullptr);
+   }
+
+   pointer base_ptr_ { nullptr };
+   RowSelectionPtr rows_ { };
+};
+
+template<typename T, std::size_t A = 0>
+using VectorIndexedConstView = VectorIndexedView<const T, A>;
+
+// ----------------------------------------------------------------------------
+
+// Positions of the set entries of a boolean mask. The mask is scanned once
+// and the result holds exactly the selected rows.
+//
+template<typename M>
+[[nodiscard]] inline RowSelectionPtr
+make_row_selection(const M &mask) {
+
+   RowSelection::size_type  count { 0 };
+
+   for (const auto m : mask)
+      count += static_cast<bool>(m) ? 1 : 0;
+
+   auto                     rows = std::make_shared<RowSelection>();
+   RowSelection::value_type pos { 0 };
+
+   rows->reserve(count);
+   for (const auto m : mask) {
+      if (static_cast<bool>(m))  rows->push_back(pos);
+      pos += 1;
+   }
+   return (rows);
+}
+
+// Rows start, start + stride, ... that are less than col_size
+//
+[[nodiscard]] inline RowSelectionPtr
+make_row_selection(RowSelection::value_type start,
+                   RowSelection::value_type stride,
+                   RowSelection::value_type col_size) {
+
+   auto rows = std::make_shared<RowSelection>();
+
+   if (start < col_size && stride > 0) {
+      rows->reserve((col_size - start + stride - 1) / stride);
+      for (auto pos = start; pos < col_size; pos += stride)
+         rows->push_back(pos);
+   }
+   return (rows);
+}
+
+// Every stride-th element of a column, starting with element start
+//
+template<typename V>
+[[nodiscard]] inline auto
+make_strided_view(V &vec,
+                  typename V::size_type start,
+                  typename V::size_type stride) {
+
+   using elem_t = std::remove_reference_t<decltype(*vec.data())>;
+   using size_type = typename VectorStridedView<elem_t>::size_type;
+
+   const size_type sz = start < vec.size() && stride > 0
+                        ? (vec.size() - start + stride - 1) / stride : 0;
+
+   // An empty view doesn't point past the end of vec
+   //
+   return (VectorStridedView<elem_t>(
+              sz > 0 ? vec.data() + start : vec.data(),
+              sz,
+              static_cast<std::ptrdiff_t>(stride)));
+}
+
+// The rows of a column named by a RowSelection. The same selection can be
+// shared by views on any number of columns with at least as many rows.
+//
+template<typename V>
+[[nodiscard]] inline auto
+make_indexed_view(V &vec, RowSelectionPtr rows) {
+
+   using elem_t = std::remove_reference_t<decltype(*vec.data())>;
+
+   return (VectorIndexedView<elem_t>(vec.data(), std::move(rows)));
+}
+
+// Rows of a column for which mask is true
+//
+template<typename V, typename M>
+[[nodiscard]] inline auto
+make_masked_view(V &vec, const M &mask) {
+
+   return (make_indexed_view(vec, make_row_selection(mask)));
+}
+
+static_assert(std::random_access_iterator<VectorStridedView<int>::iterator>);
+static_assert(
+   std::random_access_iterator<VectorStridedConstView<int>::const_iterator>);
+static_assert(std::random_access_iterator<VectorIndexedView<int>::iterator>);
+static_assert(
+   std::random_access_iterator<VectorIndexedConstView<int>::const_iterator>);
+
+}
\ No newline at end of file
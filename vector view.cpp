@@ -1,5 +1,7 @@
 #pragma once 
 
+#include <compare>
+#include <cstddef>
 #include <iterator>
 #include <new>
 #include <utility>
@@ -60,7 +62,7 @@ public:
 
       return (*(begin_ptr_ + i));
    }
-   [[nodiscad]] inline const_reference 
+   [[nodiscard]] inline const_reference 
    operator [] (size_type i) const noexcept {
 
       return (*(begin_ptr_ + i));
@@ -72,6 +74,9 @@ public:
    back() noexcept { return (*(end_ptr_ - 1)); }
    [[nodiscard]] inline const_reference 
    back() const noexcept { return (*(end_ptr_ - 1)); }
+   [[nodiscard]] inline pointer data() noexcept { return (begin_ptr_); }
+   [[nodiscard]] inline const_pointer
+   data() const noexcept { return (begin_ptr_); }
 
    inline void shrink_to_fit() { }
    inline void reserve (size_type) { }
@@ -83,9 +88,10 @@ public:
       return;
    }
 
-   VectorView &operator = (std::vector<T> &rhs) {
+   template<typename Al>
+   VectorView &operator = (std::vector<T, Al> &rhs) {
 
-      VectorView vw(&*(rhs.begin()), &(rhs.back()) + 1);
+      VectorView vw(rhs.data(), rhs.data() + rhs.size());
 
       swap(vw);
       return (*this);
@@ -97,22 +103,24 @@ public:
    class const_iterator {
 
    public:
-       
+
       using iterator_category = std::random_access_iterator_tag;
+      using iterator_concept = std::contiguous_iterator_tag;
       using value_type = T;
-      using pointer = value_type *;
-      using reference = value_type &;
-      using difference_type = long;
+      using element_type = const T;
+      using pointer = const value_type *;
+      using reference = const value_type &;
+      using difference_type = std::ptrdiff_t;
 
    public:
-      
-      inline const_iterator () = default; 
 
-      inline const_iterator (value_type const *const node) noexcept 
+      inline const_iterator () = default;
+
+      inline const_iterator (value_type const *const node) noexcept
          : node_ (node) { }
 
-      inline const_iterator (const iterator &itr) noexcept 
-         : node_ (nullptr) { *this = itr; }
+      inline const_iterator (const iterator &itr) noexcept
+         : node_ (itr.node_) { }
 
       inline const_iterator &operator = (const iterator &rhs) noexcept {
 
@@ -124,18 +132,19 @@ public:
 
          return (node_ == rhs.node_);
       }
-      inline bool operator != (const const_iterator &rhs) const noexcept {
+      inline std::strong_ordering
+      operator <=> (const const_iterator &rhs) const noexcept {
 
-         return (node_ != rhs.node_);
+         return (node_ <=> rhs.node_);
       }
 
+      inline pointer operator -> () const noexcept { return (node_); }
+      inline reference operator * () const noexcept { return (*node_); }
+      inline reference operator [] (difference_type i) const noexcept {
 
-      inline const_pointer operator -> () const noexcept { return (node_); }
-      inline const_reference operator * () const noexcept {
-
-         return (*node_);
+         return (node_[i]);
       }
-      inline operator const_pointer () const noexcept { return (node_); }
+      inline operator pointer () const noexcept { return (node_); }
 
       inline const_iterator &operator ++ () noexcept {
 
@@ -151,7 +160,7 @@ public:
          return (const_iterator (ret_node));
       }
 
-      inline const_iterator &operator += (int step) noexcept {
+      inline const_iterator &operator += (difference_type step) noexcept {
 
          node_ += step;
          return (*this);
@@ -171,55 +180,52 @@ public:
          return (const_iterator (ret_node));
       }
 
-      inline const_iterator &operator -= (int step) noexcept {
+      inline const_iterator &operator -= (difference_type step) noexcept {
 
          node_ -= step;
          return (*this);
       }
 
-      template<typename I>
-      inline const_iterator operator + (I step) noexcept {
+      inline const_iterator
+      operator + (difference_type step) const noexcept {
 
-         value_type const *ret_node = node_;
+         return (const_iterator (node_ + step));
+      }
+      friend inline const_iterator
+      operator + (difference_type step, const const_iterator &rhs) noexcept {
 
-         ret_node += static_cast<long>(step);
-         return (const_iterator (ret_node));
+         return (const_iterator (rhs.node_ + step));
       }
 
-      template<typename I>
-      inline const_iterator operator - (I step) noexcept {
+      inline const_iterator
+      operator - (difference_type step) const noexcept {
 
-         value_type const *ret_node = node_;
-
-         ret_node -= static_cast<long>(step);
-         return (const_iterator (ret_node));
+         return (const_iterator (node_ - step));
       }
 
-      friend difference_type operator - (const_iterator, lhs,
-                                         const_iterator rhs) {
-         difference_type count { 0 };
+      friend inline difference_type
+      operator - (const const_iterator &lhs,
+                  const const_iterator &rhs) noexcept {
 
-         while (lhs != rhs) {
-            ++rhs;
-            ++count;
-         }
-         return (count);
+         return (lhs.node_ - rhs.node_);
       }
 
    private:
-       
-       const_pointer node_ { nullptr };
+
+       pointer node_ { nullptr };
    };
 
    class iterator {
 
    public:
-       
+
       using iterator_category = std::random_access_iterator_tag;
+      using iterator_concept = std::contiguous_iterator_tag;
       using value_type = T;
+      using element_type = T;
       using pointer = value_type *;
       using reference = value_type &;
-      using difference_type = long;
+      using difference_type = std::ptrdiff_t;
 
    public:
 
@@ -231,9 +237,18 @@ public:
 
          return (node_ == rhs.node_);
       }
+      inline std::strong_ordering
+      operator <=> (const iterator &rhs) const noexcept {
+
+         return (node_ <=> rhs.node_);
+      }
 
       inline pointer operator -> () const noexcept { return (node_); }
       inline reference operator * () const noexcept { return (*node_); }
+      inline reference operator [] (difference_type i) const noexcept {
+
+         return (node_[i]);
+      }
       inline operator pointer () const noexcept { return (node_); }
 
       inline iterator &operator ++ () noexcept {
@@ -249,7 +264,7 @@ public:
          return (iterator (ret_node));
       }
 
-      inline iterator &operator += (long step) noexcept {
+      inline iterator &operator += (difference_type step) noexcept {
 
          node_ += step;
          return (*this);
@@ -268,39 +283,31 @@ public:
          return (iterator (ret_node));
       }
 
-      inline iterator &operator -= (int step) noexcept {
+      inline iterator &operator -= (difference_type step) noexcept {
 
          node_ -= step;
          return (*this);
       }
 
-      template<typename I>
-      inline iterator operator + (I step) noexcept {
-
-         value_type *ret_node = node_;
+      inline iterator operator + (difference_type step) const noexcept {
 
-         ret_node += static_cast<long>(step);
-         return (iterator (ret_node));
+         return (iterator (node_ + step));
       }
+      friend inline iterator
+      operator + (difference_type step, const iterator &rhs) noexcept {
 
-      template<typename I>
-      inline iterator operator - (I step) noexcept {
+         return (iterator (rhs.node_ + step));
+      }
 
-         value_type *ret_node = node_;
+      inline iterator operator - (difference_type step) const noexcept {
 
-         ret_node -= static_cast<long>(step);
-         return (iterator (ret_node));
+         return (iterator (node_ - step));
       }
 
-      friend difference_type operator - (iterator lhs, iterator rhs) {
-
-         difference_type count { 0 };
+      friend inline difference_type
+      operator - (const iterator &lhs, const iterator &rhs) noexcept {
 
-         while (lhs != rhs) {
-            ++rhs;
-            ++count;
-         }
-         return (count);
+         return (lhs.node_ - rhs.node_);
       }
 
    private:
@@ -364,7 +371,7 @@ public:
 
 
    inline void 
-   set_begin_end_special(const value_type *bp,, const value_type *ep_1) {
+   set_begin_end_special(const value_type *bp, const value_type *ep_1) {
 
       begin_ptr_ = bp;
       end_ptr_ = ep_1;
@@ -384,12 +391,14 @@ public:
    [[nodiscard]] inline const_reference 
    operator [] (size_type i) const noexcept {
 
-      return (*(begin_ptr + i));
+      return (*(begin_ptr_ + i));
    }
    [[nodiscard]] inline const_reference 
-   ront() const noexcept { return (*begin_ptr_); }
+   front() const noexcept { return (*begin_ptr_); }
    [[nodiscard]] inline const_reference 
    back() const noexcept { return (*(end_ptr_ - 1)); }
+   [[nodiscard]] inline const_pointer
+   data() const noexcept { return (begin_ptr_); }
 
    inline void shrink_to_fit() { }
    inline void reserve (size_type) { }
@@ -401,9 +410,10 @@ public:
       return;
    }
 
-   VectorConstView &operator = (const std::vector<T> &rhs) {
+   template<typename Al>
+   VectorConstView &operator = (const std::vector<T, Al> &rhs) {
 
-      VectorConstView vw(&*(rhs.begin()), &(rhs.back()) + 1);
+      VectorConstView vw(rhs.data(), rhs.data() + rhs.size());
 
       swap(vw);
       return (*this);
@@ -414,37 +424,41 @@ public:
    class const_iterator {
 
    public:
-       
+
       using iterator_category = std::random_access_iterator_tag;
+      using iterator_concept = std::contiguous_iterator_tag;
       using value_type = T;
-      using pointer = value_type *;
-      using reference = value_type &;
-      using difference_type = long;
+      using element_type = const T;
+      using pointer = const value_type *;
+      using reference = const value_type &;
+      using difference_type = std::ptrdiff_t;
 
    public:
-      
+
       inline const_iterator () = default;
 
-      inline const_iterator (value_type const *const node) noexcept 
+      inline const_iterator (value_type const *const node) noexcept
          : node_ (node) { }
 
       inline bool operator == (const const_iterator &rhs) const noexcept {
 
          return (node_ == rhs.node_);
       }
-      inline bool operator != (const const_iterator &rhs) const noexcept {
+      inline std::strong_ordering
+      operator <=> (const const_iterator &rhs) const noexcept {
 
-         return (node_ != rhs.node_);
+         return (node_ <=> rhs.node_);
       }
 
-      inline const_pointer operator -> () const noexcept { return (node_); }
-      inline const_reference operator * () const noexcept {
+      inline pointer operator -> () const noexcept { return (node_); }
+      inline reference operator * () const noexcept { return (*node_); }
+      inline reference operator [] (difference_type i) const noexcept {
 
-         return (*node_);
+         return (node_[i]);
       }
-      inline operator const_pointer () const noexcept { return (node_); }
+      inline operator pointer () const noexcept { return (node_); }
 
-      inline const_iterator &operator && () noexcept {
+      inline const_iterator &operator ++ () noexcept {
 
          node_ += 1;
          return (*this);
@@ -458,7 +472,7 @@ public:
          return (const_iterator (ret_node));
       }
 
-      inline const_iterator &operator += (int step) noexcept {
+      inline const_iterator &operator += (difference_type step) noexcept {
 
          node_ += step;
          return (*this);
@@ -478,49 +492,43 @@ public:
          return (const_iterator (ret_node));
       }
 
-      inline const_iterator &operator -= (int step) noexcept {
+      inline const_iterator &operator -= (difference_type step) noexcept {
 
          node_ -= step;
          return (*this);
       }
 
-      inline const_iterator operator + (int step) noexcept {
-
-         value_type const *ret_node = node_;
+      inline const_iterator
+      operator + (difference_type step) const noexcept {
 
-         ret_node += step;
-         return (const_iterator (ret_node));
+         return (const_iterator (node_ + step));
       }
+      friend inline const_iterator
+      operator + (difference_type step, const const_iterator &rhs) noexcept {
 
-      inline const_iterator operator - (int step) noexcept {
-
-         value_type const *ret_node = node_;
-
-         ret_node -= step;
-         return (const_iterator (ret_node));
+         return (const_iterator (rhs.node_ + step));
       }
 
-      inline const_iterator operator + (long step) noexcept {
-
-         value_type const *ret_node = node_;
+      inline const_iterator
+      operator - (difference_type step) const noexcept {
 
-         ret_node += step;
-         return (const_iterator (ret_node));
+         return (const_iterator (node_ - step));
       }
 
-      inline const_iterator operator - (long step) noexcept {
-
-         value_type const *ret_node = node_;
+      friend inline difference_type
+      operator - (const const_iterator &lhs,
+                  const const_iterator &rhs) noexcept {
 
-         ret_node -= step;
-         return (const_iterator (ret_node));
+         return (lhs.node_ - rhs.node_);
       }
 
    private:
 
-      const_pointer node_ { nullptr };
+      pointer node_ { nullptr };
    };
 
+   using iterator = const_iterator;
+
    [[nodiscard]] inline const_iterator 
    begin () const noexcept { return (const_iterator (begin_ptr_)); }
    [[nodiscard]] inline const_iterator 
@@ -537,4 +545,11 @@ private:
    const value_type *end_ptr_ { nullptr };
 };
 
+// Standard algorithms rely on these to reduce copies and searches over
+// views to plain pointer loops and memmove.
+//
+static_assert(std::contiguous_iterator<VectorView<int>::iterator>);
+static_assert(std::contiguous_iterator<VectorView<int>::const_iterator>);
+static_assert(std::contiguous_iterator<VectorConstView<int>::const_iterator>);
+
 }
\ No newline at end of file